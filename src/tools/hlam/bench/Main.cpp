@@ -0,0 +1,990 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include "AudioFile/AudioFile.h"
+
+#include "engine/shared/renderer/studiomodel/StudioModelLighting.hpp"
+
+#include "engine/shared/sprite/Sprite.hpp"
+
+#include "engine/shared/studiomodel/BoneTransformer.hpp"
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+#include "engine/shared/studiomodel/StudioModel.hpp"
+#include "engine/shared/studiomodel/StudioModelGenerator.hpp"
+#include "engine/shared/studiomodel/StudioModelIO.hpp"
+#include "engine/shared/studiomodel/StudioModelUtils.hpp"
+
+#include "graphics/TextureLoader.hpp"
+
+#include "soundsystem/WaveFile.hpp"
+
+#include "utility/IOUtils.hpp"
+#include "utility/JsonWriter.hpp"
+#include "utility/MemoryMappedFile.hpp"
+#include "utility/Random.hpp"
+
+namespace
+{
+//Seed for all generated input data, so every run measures the same work
+constexpr int InputSeed = 1234;
+
+/**
+*	@brief A model about as complex as a detailed player model, with blended sequences.
+*/
+studiomdl::GeneratorSettings GetDefaultGeneratorSettings()
+{
+	studiomdl::GeneratorSettings settings;
+
+	settings.Bones = 48;
+	settings.Hitboxes = 48;
+	settings.VerticesPerModel = 9409;
+	settings.MeshesPerModel = 2;
+	settings.Sequences = 2;
+	settings.FramesPerSequence = 30;
+	settings.BlendsPerSequence = 2;
+	settings.EventsPerSequence = 4;
+	settings.Textures = 2;
+
+	return settings;
+}
+
+struct Options
+{
+	//Only benchmarks whose name contains this are run
+	std::string Filter;
+
+	//Multiplies the number of iterations of every benchmark
+	double IterationScale = 1;
+
+	bool List = false;
+
+	//File to write results to as json, or "-" for standard output
+	std::filesystem::path JsonOutput;
+
+	//Real content to use instead of generated inputs
+	std::filesystem::path Model;
+	std::filesystem::path Sprite;
+	std::filesystem::path Wave;
+
+	//Contents of the generated model
+	studiomdl::GeneratorSettings Generator = GetDefaultGeneratorSettings();
+};
+
+struct BenchmarkResult
+{
+	std::string Name;
+	std::size_t Iterations = 0;
+
+	//Times of a single iteration, in microseconds
+	double Mean = 0;
+	double Min = 0;
+	double Max = 0;
+	double P50 = 0;
+	double P90 = 0;
+	double P99 = 0;
+};
+
+/**
+*	@brief Runs benchmarks a fixed number of times after a short warmup and collects the time of every iteration.
+*/
+class BenchmarkRunner final
+{
+public:
+	/**
+	*	@param log File to print results to as they come in.
+	*/
+	BenchmarkRunner(const Options& options, FILE* log)
+		: _options(options)
+		, _log(log)
+	{
+	}
+
+	const std::vector<BenchmarkResult>& GetResults() const { return _results; }
+
+	bool ShouldRun(std::string_view name) const
+	{
+		return name.find(_options.Filter) != std::string_view::npos;
+	}
+
+	/**
+	*	@param iterations Number of iterations to measure, before scaling.
+	*	@param function Called once per iteration with the index of the iteration.
+	*/
+	void Run(const std::string& name, std::size_t iterations, const std::function<void(std::size_t)>& function)
+	{
+		if (!ShouldRun(name))
+		{
+			return;
+		}
+
+		if (_options.List)
+		{
+			std::printf("%s\n", name.c_str());
+			return;
+		}
+
+		iterations = std::max<std::size_t>(1, static_cast<std::size_t>(iterations * _options.IterationScale));
+
+		const std::size_t warmupIterations = std::max<std::size_t>(1, iterations / 10);
+
+		for (std::size_t i = 0; i < warmupIterations; ++i)
+		{
+			function(i);
+		}
+
+		std::vector<double> samples;
+
+		samples.reserve(iterations);
+
+		for (std::size_t i = 0; i < iterations; ++i)
+		{
+			const auto start = std::chrono::steady_clock::now();
+
+			function(i);
+
+			const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+			samples.push_back(elapsed.count());
+		}
+
+		std::sort(samples.begin(), samples.end());
+
+		BenchmarkResult result;
+
+		result.Name = name;
+		result.Iterations = iterations;
+
+		double total = 0;
+
+		for (const auto sample : samples)
+		{
+			total += sample;
+		}
+
+		result.Mean = total / samples.size();
+		result.Min = samples.front();
+		result.Max = samples.back();
+		result.P50 = Percentile(samples, 50);
+		result.P90 = Percentile(samples, 90);
+		result.P99 = Percentile(samples, 99);
+
+		std::fprintf(_log, "%-48s %8zu %12.2f %12.2f %12.2f %12.2f %12.2f\n",
+			result.Name.c_str(), result.Iterations, result.Mean, result.Min, result.P50, result.P90, result.P99);
+		std::fflush(_log);
+
+		_results.push_back(std::move(result));
+	}
+
+private:
+	/**
+	*	@brief Nearest rank percentile of sorted samples.
+	*/
+	static double Percentile(const std::vector<double>& samples, int percentile)
+	{
+		const auto rank = static_cast<std::size_t>(std::ceil(percentile / 100.0 * samples.size()));
+
+		return samples[std::clamp<std::size_t>(rank, 1, samples.size()) - 1];
+	}
+
+private:
+	const Options& _options;
+	FILE* const _log;
+
+	std::vector<BenchmarkResult> _results;
+};
+
+//Results of benchmarked code are accumulated here so the compiler can't remove it
+volatile std::size_t Sink = 0;
+
+void PrintUsage()
+{
+	std::fprintf(stderr,
+		"Usage: hlam_bench [options]\n"
+		"\n"
+		"Measures the time taken by model, texture, sprite and sound loading and by the CPU side of model rendering.\n"
+		"Inputs are generated with a fixed seed unless real files are given, so results are comparable between runs.\n"
+		"Times are reported in microseconds per iteration.\n"
+		"\n"
+		"Options:\n"
+		"  --filter <text>      Only run benchmarks whose name contains this text\n"
+		"  --iterations <scale> Multiply the number of iterations of every benchmark by this (default: 1)\n"
+		"  --json <file>        Also write the results to this file as json, or to standard output if the file is -\n"
+		"  --list               List the benchmarks instead of running them\n"
+		"  --model <file>       Model to use instead of a generated one\n"
+		"  --generator <name>=<value>\n"
+		"                       Change a setting of the generated model. Values are clamped to the format limits. Names:\n"
+		"                       seed, bones, bone-controllers, attachments, hitboxes, bodyparts, models, vertices,\n"
+		"                       meshes, sequences, frames, blends, events, sequence-groups, textures, texture-width,\n"
+		"                       texture-height, skin-families, external-textures\n"
+		"  --sprite <file>      Sprite to use instead of a generated one\n"
+		"  --wave <file>        8 or 16 bit wave file to use instead of generated ones\n"
+		"  -h, --help           Show this help\n");
+}
+
+bool ParseGeneratorSetting(std::string_view setting, studiomdl::GeneratorSettings& settings)
+{
+	const auto separator = setting.find('=');
+
+	if (separator == std::string_view::npos)
+	{
+		std::fprintf(stderr, "Generator setting \"%.*s\" must have the form <name>=<value>\n\n", static_cast<int>(setting.size()), setting.data());
+		return false;
+	}
+
+	const auto name = setting.substr(0, separator);
+	const auto valueText = setting.substr(separator + 1);
+
+	int value = 0;
+
+	if (const auto [end, error] = std::from_chars(valueText.data(), valueText.data() + valueText.size(), value);
+		error != std::errc{} || end != valueText.data() + valueText.size())
+	{
+		std::fprintf(stderr, "Invalid generator setting value \"%.*s\"\n\n", static_cast<int>(valueText.size()), valueText.data());
+		return false;
+	}
+
+	if (!studiomdl::SetGeneratorSetting(settings, name, value))
+	{
+		std::fprintf(stderr, "Unknown generator setting \"%.*s\"\n\n", static_cast<int>(name.size()), name.data());
+		return false;
+	}
+
+	return true;
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view argument{argv[i]};
+
+		if (argument == "--filter" || argument == "--iterations" || argument == "--json"
+			|| argument == "--model" || argument == "--generator" || argument == "--sprite" || argument == "--wave")
+		{
+			if (i + 1 >= argc)
+			{
+				std::fprintf(stderr, "Missing value for option \"%s\"\n\n", argv[i]);
+				return false;
+			}
+
+			const char* const value = argv[++i];
+
+			if (argument == "--filter")
+			{
+				options.Filter = value;
+			}
+			else if (argument == "--iterations")
+			{
+				options.IterationScale = std::atof(value);
+
+				if (!(options.IterationScale > 0))
+				{
+					std::fprintf(stderr, "Invalid iteration scale \"%s\"\n\n", value);
+					return false;
+				}
+			}
+			else if (argument == "--json")
+			{
+				options.JsonOutput = std::filesystem::u8path(value);
+			}
+			else if (argument == "--model")
+			{
+				options.Model = std::filesystem::u8path(value);
+			}
+			else if (argument == "--generator")
+			{
+				if (!ParseGeneratorSetting(value, options.Generator))
+				{
+					return false;
+				}
+			}
+			else if (argument == "--sprite")
+			{
+				options.Sprite = std::filesystem::u8path(value);
+			}
+			else
+			{
+				options.Wave = std::filesystem::u8path(value);
+			}
+		}
+		else if (argument == "--list")
+		{
+			options.List = true;
+		}
+		else
+		{
+			if (argument != "-h" && argument != "--help")
+			{
+				std::fprintf(stderr, "Unknown option \"%s\"\n\n", argv[i]);
+			}
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+*	@brief Directory for generated input files, removed when the benchmarks are done.
+*/
+class TemporaryDirectory final
+{
+public:
+	TemporaryDirectory()
+		: _path(std::filesystem::temp_directory_path() / "hlam_bench")
+	{
+		std::filesystem::create_directories(_path);
+	}
+
+	~TemporaryDirectory()
+	{
+		std::error_code ec;
+		std::filesystem::remove_all(_path, ec);
+	}
+
+	TemporaryDirectory(const TemporaryDirectory&) = delete;
+	TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+	const std::filesystem::path& GetPath() const { return _path; }
+
+private:
+	const std::filesystem::path _path;
+};
+
+void WriteFile(const std::filesystem::path& fileName, const std::vector<std::uint8_t>& data)
+{
+	FILE* file = utf8_fopen(fileName.u8string().c_str(), "wb");
+
+	if (!file)
+	{
+		throw std::runtime_error("Could not open \"" + fileName.u8string() + "\" for writing");
+	}
+
+	const bool success = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+
+	if (std::fclose(file) != 0 || !success)
+	{
+		throw std::runtime_error("Error writing \"" + fileName.u8string() + "\"");
+	}
+}
+
+template<typename T>
+void Append(std::vector<std::uint8_t>& data, const T& value)
+{
+	const auto bytes = reinterpret_cast<const std::uint8_t*>(&value);
+	data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+void AppendTag(std::vector<std::uint8_t>& data, const char (&tag)[5])
+{
+	data.insert(data.end(), tag, tag + 4);
+}
+
+void FillPalette(Random& random, graphics::RGBPalette& palette)
+{
+	for (auto& color : palette)
+	{
+		color.R = static_cast<std::uint8_t>(random.Next(0, 255));
+		color.G = static_cast<std::uint8_t>(random.Next(0, 255));
+		color.B = static_cast<std::uint8_t>(random.Next(0, 255));
+	}
+}
+
+std::vector<std::byte> GeneratePixels(Random& random, int width, int height)
+{
+	std::vector<std::byte> pixels(static_cast<std::size_t>(width) * height);
+
+	for (auto& pixel : pixels)
+	{
+		pixel = static_cast<std::byte>(random.Next(0, 255));
+	}
+
+	return pixels;
+}
+
+/**
+*	@brief Generates a sprite with 4 frames of 128x128 pixels.
+*/
+std::vector<std::uint8_t> GenerateSprite()
+{
+	using namespace sprite;
+
+	constexpr int FrameCount = 4;
+	constexpr int FrameSize = 128;
+
+	Random random{InputSeed};
+
+	std::vector<std::uint8_t> data;
+
+	dsprite_t header{};
+
+	header.ident = SPRITE_ID;
+	header.version = SPRITE_VERSION;
+	header.type = Type::VP_PARALLEL;
+	header.texFormat = TexFormat::SPR_ALPHTEST;
+	header.boundingradius = FrameSize;
+	header.width = FrameSize;
+	header.height = FrameSize;
+	header.numframes = FrameCount;
+	header.synctype = synctype_t::SYNC;
+
+	Append(data, header);
+	Append(data, static_cast<short>(graphics::RGBPalette::EntriesCount));
+
+	graphics::RGBPalette palette;
+
+	FillPalette(random, palette);
+
+	const auto paletteData = reinterpret_cast<const std::uint8_t*>(palette.AsByteArray());
+
+	data.insert(data.end(), paletteData, paletteData + palette.GetSizeInBytes());
+
+	for (int i = 0; i < FrameCount; ++i)
+	{
+		Append(data, spriteframetype_t::SINGLE);
+
+		dspriteframe_t frame{};
+
+		frame.origin = glm::ivec2{-FrameSize / 2, FrameSize / 2};
+		frame.width = FrameSize;
+		frame.height = FrameSize;
+
+		Append(data, frame);
+
+		const auto pixels = GeneratePixels(random, FrameSize, FrameSize);
+
+		for (const auto pixel : pixels)
+		{
+			data.push_back(std::to_integer<std::uint8_t>(pixel));
+		}
+	}
+
+	return data;
+}
+
+/**
+*	@brief Generates a PCM wave file containing a sine wave.
+*/
+std::vector<std::uint8_t> GenerateWaveFile(int seconds, int sampleRate, int bitsPerSample, int channels)
+{
+	const int bytesPerFrame = channels * (bitsPerSample / 8);
+	const auto dataSize = static_cast<std::uint32_t>(seconds * sampleRate * bytesPerFrame);
+
+	std::vector<std::uint8_t> data;
+
+	data.reserve(44 + dataSize);
+
+	AppendTag(data, "RIFF");
+	Append(data, static_cast<std::uint32_t>(36 + dataSize));
+	AppendTag(data, "WAVE");
+
+	AppendTag(data, "fmt ");
+	Append(data, std::uint32_t{16});
+	Append(data, std::uint16_t{1});
+	Append(data, static_cast<std::uint16_t>(channels));
+	Append(data, static_cast<std::uint32_t>(sampleRate));
+	Append(data, static_cast<std::uint32_t>(sampleRate * bytesPerFrame));
+	Append(data, static_cast<std::uint16_t>(bytesPerFrame));
+	Append(data, static_cast<std::uint16_t>(bitsPerSample));
+
+	AppendTag(data, "data");
+	Append(data, dataSize);
+
+	for (int i = 0; i < seconds * sampleRate; ++i)
+	{
+		const double value = std::sin(i * 440.0 * 6.283185307 / sampleRate) * 0.8;
+
+		for (int channel = 0; channel < channels; ++channel)
+		{
+			if (bitsPerSample == 8)
+			{
+				data.push_back(static_cast<std::uint8_t>(128 + value * 127));
+			}
+			else
+			{
+				Append(data, static_cast<std::int16_t>(value * 32767));
+			}
+		}
+	}
+
+	return data;
+}
+
+void RunModelBenchmarks(BenchmarkRunner& runner, const std::filesystem::path& fileName)
+{
+	using namespace studiomdl;
+
+	const auto studioModel = LoadStudioModel(fileName, nullptr);
+
+	runner.Run("LoadStudioModel", 50, [&](std::size_t)
+		{
+			const auto model = LoadStudioModel(fileName, nullptr);
+			Sink = Sink + model->GetStudioHeader()->length;
+		});
+
+	runner.Run("ConvertToEditable", 50, [&](std::size_t)
+		{
+			const auto model = ConvertToEditable(*studioModel);
+			Sink = Sink + model.Bones.size();
+		});
+
+	const auto editableModel = ConvertToEditable(*studioModel);
+
+	runner.Run("ConvertFromEditable", 50, [&](std::size_t)
+		{
+			const auto model = ConvertFromEditable(fileName, editableModel);
+			Sink = Sink + model.GetStudioHeader()->length;
+		});
+
+	if (editableModel.Sequences.empty())
+	{
+		return;
+	}
+
+	//Use the sequence with the most blends so blending is measured if the model has any
+	const auto sequenceIt = std::max_element(editableModel.Sequences.begin(), editableModel.Sequences.end(), [](const auto& lhs, const auto& rhs)
+		{
+			return lhs->AnimationBlends.size() < rhs->AnimationBlends.size();
+		});
+
+	const int blendSequence = static_cast<int>(sequenceIt - editableModel.Sequences.begin());
+
+	BoneTransformer boneTransformer;
+
+	const auto setUpBones = [&](int sequenceIndex, float frame, std::uint8_t blender)
+	{
+		return boneTransformer.SetUpBones(editableModel, BoneTransformInfo{sequenceIndex, frame, glm::vec3{1}, {blender, 0}, {0, 0, 0, 0}, 0});
+	};
+
+	const auto frameAt = [&](int sequenceIndex, std::size_t iteration)
+	{
+		//Cover every frame, including interpolation between frames
+		const int frameCount = std::max(1, editableModel.Sequences[sequenceIndex]->NumFrames - 1);
+		return static_cast<float>(iteration % (frameCount * 4)) / 4.f;
+	};
+
+	runner.Run("SetUpBones/first frame", 10000, [&](std::size_t)
+		{
+			Sink = Sink + static_cast<std::size_t>(setUpBones(0, 0, 0)[0][3][0]);
+		});
+
+	runner.Run("SetUpBones/all frames", 10000, [&](std::size_t iteration)
+		{
+			Sink = Sink + static_cast<std::size_t>(setUpBones(0, frameAt(0, iteration), 0)[0][3][0]);
+		});
+
+	for (const int blender : {0, 127, 255})
+	{
+		runner.Run("SetUpBones/blend " + std::to_string(blender), 10000, [&](std::size_t iteration)
+			{
+				Sink = Sink + static_cast<std::size_t>(setUpBones(blendSequence, frameAt(blendSequence, iteration), static_cast<std::uint8_t>(blender))[0][3][0]);
+			});
+	}
+
+	//The CPU side of StudioModelRenderer::DrawPoints: vertex transforms and lighting of every model in the first body
+	const auto& boneTransforms = setUpBones(0, 0, 0);
+
+	const StudioModelLighting lighting;
+	const glm::vec3 lightVector{0, 0, -1};
+
+	std::vector<glm::vec3> boneLightVectors(editableModel.Bones.size());
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec3> lightValues;
+
+	runner.Run("DrawPoints/transform and light", 500, [&](std::size_t)
+		{
+			CalculateBoneLightVectors(editableModel.Bones.size(), boneTransforms.data(), lightVector, boneLightVectors.data());
+
+			for (std::size_t bodypart = 0; bodypart < editableModel.Bodyparts.size(); ++bodypart)
+			{
+				const auto model = editableModel.GetModelByBodyPart(0, static_cast<int>(bodypart));
+
+				if (!model)
+				{
+					continue;
+				}
+
+				vertices.resize(model->Vertices.size());
+				lightValues.resize(model->Normals.size());
+
+				TransformVertices(*model, boneTransforms.data(), vertices.data());
+
+				auto lightValue = lightValues.begin();
+				auto normal = model->Normals.begin();
+
+				for (const auto& mesh : model->Meshes)
+				{
+					const auto& skins = editableModel.SkinFamilies[0];
+					const int flags = mesh.SkinRef < static_cast<int>(skins.size()) ? skins[mesh.SkinRef]->Flags : 0;
+
+					for (int i = 0; i < mesh.NumNorms && normal != model->Normals.end(); ++i, ++lightValue, ++normal)
+					{
+						*lightValue = CalculateVertexLighting(lighting, boneLightVectors[normal->Bone->ArrayIndex], flags, normal->Vertex);
+					}
+				}
+
+				Sink = Sink + static_cast<std::size_t>(vertices[0].x + lightValues[0].x);
+			}
+		});
+}
+
+void RunTextureBenchmarks(BenchmarkRunner& runner)
+{
+	Random random{InputSeed};
+
+	graphics::RGBPalette palette;
+
+	FillPalette(random, palette);
+
+	//Sizes used by real models. Textures are resized to the next power of 2 when uploaded
+	const std::pair<int, int> sizes[] = {{64, 64}, {256, 256}, {200, 160}, {512, 512}};
+
+	std::vector<std::byte> rgbaPixels;
+	std::vector<std::byte> resampledPixels;
+
+	for (const auto& [width, height] : sizes)
+	{
+		const auto pixels = GeneratePixels(random, width, height);
+
+		const std::string size = std::to_string(width) + "x" + std::to_string(height);
+
+		for (const bool masked : {false, true})
+		{
+			runner.Run("Texture/expand palette " + size + (masked ? " masked" : ""), 1000, [&](std::size_t)
+				{
+					graphics::ConvertIndexed8ToRGBA8888(width, height, pixels.data(), palette, masked, rgbaPixels);
+					Sink = Sink + std::to_integer<std::size_t>(rgbaPixels[0]);
+				});
+		}
+
+		int newWidth = 1;
+		int newHeight = 1;
+
+		while (newWidth < width)
+		{
+			newWidth *= 2;
+		}
+
+		while (newHeight < height)
+		{
+			newHeight *= 2;
+		}
+
+		//Power of 2 textures are resampled to half size instead, as if the maximum texture size was smaller
+		if (newWidth == width && newHeight == height)
+		{
+			newWidth /= 2;
+			newHeight /= 2;
+		}
+
+		graphics::ConvertIndexed8ToRGBA8888(width, height, pixels.data(), palette, false, rgbaPixels);
+
+		runner.Run("Texture/resample " + size + " to " + std::to_string(newWidth) + "x" + std::to_string(newHeight), 500, [&](std::size_t)
+			{
+				graphics::ResampleRGBA8888(width, height, rgbaPixels.data(), newWidth, newHeight, false, resampledPixels);
+				Sink = Sink + std::to_integer<std::size_t>(resampledPixels[0]);
+			});
+	}
+}
+
+void RunSpriteBenchmarks(BenchmarkRunner& runner, const std::filesystem::path& fileName)
+{
+	//Without an OpenGL context texture creation does nothing, so this measures reading and converting the frames
+	runner.Run("LoadSprite", 200, [&](std::size_t)
+		{
+			sprite::msprite_t* sprite = nullptr;
+
+			if (!sprite::LoadSprite(fileName.u8string().c_str(), sprite))
+			{
+				throw std::runtime_error("Could not load sprite \"" + fileName.u8string() + "\"");
+			}
+
+			Sink = Sink + sprite->numframes;
+
+			sprite::FreeSprite(sprite);
+		});
+}
+
+/**
+*	@brief How wave files were converted before the native reader was added, kept to compare against it.
+*/
+namespace audiofile
+{
+struct DataConverter8Bit
+{
+	using Type = std::uint8_t;
+
+	static Type Convert(double value)
+	{
+		value = (value + 1.) / 2.;
+		return static_cast<std::uint8_t>(value * 255.);
+	}
+};
+
+struct DataConverter16Bit
+{
+	using Type = std::int16_t;
+
+	static Type Convert(double value)
+	{
+		value = std::clamp(value, -1., 1.);
+		return static_cast<std::int16_t>(value * 32767.);
+	}
+};
+
+template<typename T>
+void ConvertToAL(const AudioFile<double>& file, std::vector<std::uint8_t>& data)
+{
+	std::size_t byteIndex = 0;
+
+	for (int i = 0; i < file.getNumSamplesPerChannel(); ++i)
+	{
+		for (int channel = 0; channel < file.getNumChannels(); ++channel)
+		{
+			auto& dest = *reinterpret_cast<typename T::Type*>(&data[byteIndex]);
+			dest = T::Convert(file.samples[channel][i]);
+
+			byteIndex += sizeof(typename T::Type);
+		}
+	}
+}
+
+bool LoadWaveFile(const std::filesystem::path& fileName, std::vector<std::uint8_t>& data)
+{
+	AudioFile<double> file;
+
+	file.shouldLogErrorsToConsole(false);
+
+	if (!file.load(fileName.u8string()))
+	{
+		return false;
+	}
+
+	data.resize(file.getNumChannels() * file.getNumSamplesPerChannel() * (file.getBitDepth() / 8));
+
+	switch (file.getBitDepth())
+	{
+	case 8:
+		ConvertToAL<DataConverter8Bit>(file, data);
+		return true;
+
+	case 16:
+		ConvertToAL<DataConverter16Bit>(file, data);
+		return true;
+
+	default: return false;
+	}
+}
+}
+
+void RunSoundBenchmarks(BenchmarkRunner& runner, const std::string& name, const std::filesystem::path& fileName)
+{
+	//Stands in for alBufferData, which copies the samples into the OpenAL buffer.
+	//Both benchmarks end with this copy so every sample is read, the same as when the sound system loads a sound
+	std::vector<std::uint8_t> uploaded;
+
+	const auto upload = [&](const void* samples, std::size_t size)
+	{
+		uploaded.resize(size);
+		std::memcpy(uploaded.data(), samples, size);
+		Sink = Sink + uploaded[size / 2];
+	};
+
+	//Maps the file, parses the headers and copies the samples straight from the mapping
+	runner.Run("Wave/native " + name, 100, [&](std::size_t)
+		{
+			const auto file = MemoryMappedFile::TryMap(fileName.u8string().c_str());
+
+			const auto waveFile = file ? soundsystem::TryParseWaveFile(file->GetData(), file->GetSize()) : std::nullopt;
+
+			if (!waveFile || waveFile->DataSize == 0)
+			{
+				throw std::runtime_error("Could not load wave file \"" + fileName.u8string() + "\"");
+			}
+
+			upload(waveFile->Data, waveFile->DataSize);
+		});
+
+	std::vector<std::uint8_t> data;
+
+	//Reads the file, decodes every sample to double precision and converts it back to 8 or 16 bit before copying it
+	runner.Run("Wave/AudioFile " + name, 100, [&](std::size_t)
+		{
+			if (!audiofile::LoadWaveFile(fileName, data) || data.empty())
+			{
+				throw std::runtime_error("Could not load wave file \"" + fileName.u8string() + "\"");
+			}
+
+			upload(data.data(), data.size());
+		});
+}
+
+bool WriteJson(const Options& options, const std::vector<BenchmarkResult>& results)
+{
+	const bool useStdout = options.JsonOutput == "-";
+
+	FILE* file = useStdout ? stdout : utf8_fopen(options.JsonOutput.u8string().c_str(), "wb");
+
+	if (!file)
+	{
+		std::fprintf(stderr, "Could not open \"%s\" for writing\n", options.JsonOutput.u8string().c_str());
+		return false;
+	}
+
+	bool success = true;
+
+	{
+		JsonWriter writer{file};
+
+		writer.BeginObject();
+
+		writer.Field("unit", "us");
+
+		writer.Key("benchmarks");
+		writer.BeginArray();
+
+		for (const auto& result : results)
+		{
+			writer.BeginObject();
+			writer.Field("name", std::string_view{result.Name});
+			writer.Field("iterations", static_cast<int>(result.Iterations));
+			writer.Field("mean", static_cast<float>(result.Mean));
+			writer.Field("min", static_cast<float>(result.Min));
+			writer.Field("max", static_cast<float>(result.Max));
+			writer.Field("p50", static_cast<float>(result.P50));
+			writer.Field("p90", static_cast<float>(result.P90));
+			writer.Field("p99", static_cast<float>(result.P99));
+			writer.EndObject();
+		}
+
+		writer.EndArray();
+		writer.EndObject();
+		writer.Raw("\n");
+
+		success = writer.Flush();
+	}
+
+	success = std::fflush(file) == 0 && !std::ferror(file) && success;
+
+	if (!useStdout)
+	{
+		success = std::fclose(file) == 0 && success;
+	}
+
+	if (!success)
+	{
+		std::fprintf(stderr, "Error writing benchmark results\n");
+	}
+
+	return success;
+}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	//Results go to standard error when standard output is used for json
+	FILE* log = options.JsonOutput == "-" ? stderr : stdout;
+
+	BenchmarkRunner runner{options, log};
+
+	try
+	{
+		TemporaryDirectory directory;
+
+		if (!options.List)
+		{
+			std::fprintf(log, "%-48s %8s %12s %12s %12s %12s %12s\n", "Benchmark", "Iters", "Mean us", "Min us", "p50 us", "p90 us", "p99 us");
+		}
+
+		auto modelFileName = options.Model;
+
+		if (modelFileName.empty())
+		{
+			modelFileName = directory.GetPath() / "generated.mdl";
+
+			auto settings = options.Generator;
+
+			settings.Name = "generated";
+
+			auto editableModel = studiomdl::GenerateStudioModel(settings);
+
+			//The first sequence isn't blended so bone setup is measured with and without blending
+			editableModel.Sequences[0]->AnimationBlends.resize(1);
+
+			auto model = studiomdl::ConvertFromEditable(modelFileName, editableModel);
+			studiomdl::SaveStudioModel(modelFileName, model, false);
+		}
+
+		RunModelBenchmarks(runner, modelFileName);
+
+		RunTextureBenchmarks(runner);
+
+		auto spriteFileName = options.Sprite;
+
+		if (spriteFileName.empty())
+		{
+			spriteFileName = directory.GetPath() / "generated.spr";
+			WriteFile(spriteFileName, GenerateSprite());
+		}
+
+		RunSpriteBenchmarks(runner, spriteFileName);
+
+		if (!options.Wave.empty())
+		{
+			RunSoundBenchmarks(runner, options.Wave.filename().u8string(), options.Wave);
+		}
+		else
+		{
+			const auto mono16 = directory.GetPath() / "mono16.wav";
+			const auto stereo8 = directory.GetPath() / "stereo8.wav";
+
+			WriteFile(mono16, GenerateWaveFile(10, 22050, 16, 1));
+			WriteFile(stereo8, GenerateWaveFile(5, 11025, 8, 2));
+
+			RunSoundBenchmarks(runner, "10 s 22 kHz 16 bit mono", mono16);
+			RunSoundBenchmarks(runner, "5 s 11 kHz 8 bit stereo", stereo8);
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::fprintf(stderr, "Error: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+
+	if (!options.JsonOutput.empty() && !options.List)
+	{
+		if (!WriteJson(options, runner.GetResults()))
+		{
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
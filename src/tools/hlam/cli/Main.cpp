@@ -0,0 +1,906 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "assets/AssetIO.hpp"
+
+#include "engine/shared/studiomodel/DumpModelInfo.hpp"
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+#include "engine/shared/studiomodel/StudioModel.hpp"
+#include "engine/shared/studiomodel/StudioModelFileFormat.hpp"
+#include "engine/shared/studiomodel/StudioModelGenerator.hpp"
+#include "engine/shared/studiomodel/StudioModelIO.hpp"
+#include "engine/shared/studiomodel/StudioModelRenderCost.hpp"
+#include "engine/shared/studiomodel/StudioModelStripifier.hpp"
+#include "engine/shared/studiomodel/StudioModelUtils.hpp"
+#include "engine/shared/studiomodel/StudioModelValidator.hpp"
+
+#include "utility/IOUtils.hpp"
+#include "utility/JsonWriter.hpp"
+#include "utility/Parallel.hpp"
+
+namespace
+{
+enum class Command
+{
+	Validate,
+	Dump,
+	Convert,
+	Analyze,
+	Stripify,
+	Generate
+};
+
+enum class InfoFormat
+{
+	Text,
+	Json,
+	NdJson
+};
+
+struct SectionName
+{
+	std::string_view Name;
+	int Section;
+};
+
+constexpr SectionName SectionNames[] =
+{
+	{"header", studiomdl::ModelInfoSection::Header},
+	{"bones", studiomdl::ModelInfoSection::Bones},
+	{"boneControllers", studiomdl::ModelInfoSection::BoneControllers},
+	{"hitboxes", studiomdl::ModelInfoSection::Hitboxes},
+	{"sequences", studiomdl::ModelInfoSection::Sequences},
+	{"sequenceGroups", studiomdl::ModelInfoSection::SequenceGroups},
+	{"textures", studiomdl::ModelInfoSection::Textures},
+	{"skins", studiomdl::ModelInfoSection::Skins},
+	{"bodyparts", studiomdl::ModelInfoSection::Bodyparts},
+	{"attachments", studiomdl::ModelInfoSection::Attachments},
+	{"all", studiomdl::ModelInfoSection::All}
+};
+
+struct Options
+{
+	Command Action = Command::Validate;
+	std::vector<std::filesystem::path> Inputs;
+
+	//Directory for per-model output files, or the file to write json and ndjson model info to
+	std::filesystem::path Output;
+
+	std::size_t JobCount = 0;
+	bool Quiet = false;
+
+	InfoFormat Format = InfoFormat::Text;
+	int Sections = studiomdl::ModelInfoSection::All;
+
+	studiomdl::RenderCostBudget Budget;
+
+	studiomdl::GeneratorSettings Generator;
+};
+
+/**
+*	@brief Destination for json and ndjson model info, shared by all workers.
+*/
+struct InfoOutput
+{
+	FILE* File = nullptr;
+	std::mutex Mutex;
+	bool IsFirst = true;
+};
+
+/**
+*	@brief A model to process, along with the directory that output paths are made relative to.
+*/
+struct InputFile
+{
+	std::filesystem::path FileName;
+	std::filesystem::path BaseDirectory;
+};
+
+struct FileResult
+{
+	bool Success = false;
+	bool OverBudget = false;
+	std::size_t Bytes = 0;
+
+	//Problems that made processing fail, or budgets that the model exceeds
+	std::vector<std::string> Problems;
+
+	std::string Report;
+};
+
+void PrintUsage()
+{
+	std::fprintf(stderr,
+		"Usage: hlam-cli <command> [options] <file or directory>...\n"
+		"\n"
+		"Commands:\n"
+		"  validate  Load models, check them for corrupt data and convert them to and from the editable format\n"
+		"  dump      Write model info to <model name>_modelinfo.txt, or to a single json or ndjson stream\n"
+		"  convert   Load models and save them again, converting .dol models to .mdl\n"
+		"  analyze   Report what models cost to render and flag models that exceed the budget\n"
+		"  stripify  Rebuild triangle strips and fans to draw models with fewer commands, then save them like convert\n"
+		"  generate  Write synthetic models to the given file names, then load and validate them\n"
+		"\n"
+		"Directories are searched recursively for .mdl and .dol models, except by generate.\n"
+		"Texture and sequence group files are loaded along with their main file.\n"
+		"\n"
+		"Options:\n"
+		"  -j, --jobs <count>       Number of models to process at the same time (default: one per core)\n"
+		"  -o, --output <directory> Directory to write output files to, keeping the input directory structure\n"
+		"                           Required for convert and stripify. Dump writes next to the models by default\n"
+		"                           For json and ndjson model info this is the file to write to (default: standard output)\n"
+		"  --format <format>        Output format for dump and analyze: text, json (an array of objects) or ndjson (one object per line)\n"
+		"  --sections <list>        Comma separated model info sections for json and ndjson (default: all):\n"
+		"                           header, bones, boneControllers, hitboxes, sequences, sequenceGroups, textures,\n"
+		"                           skins, bodyparts, attachments\n"
+		"  --budget <name>=<value>  Change a render cost budget for analyze. 0 disables the check. Names:\n"
+		"                           triangles, draw-calls (per body part and skin combination), texture-kib, bones,\n"
+		"                           bones-per-mesh, animation-kib (per sequence)\n"
+		"  --generator <name>=<value>\n"
+		"                           Change a setting of generated models. Values are clamped to the format limits. Names:\n"
+		"                           seed, bones, bone-controllers, attachments, hitboxes, bodyparts, models (per body part),\n"
+		"                           vertices (per model), meshes (per model), sequences, frames, blends, events (per sequence),\n"
+		"                           sequence-groups, textures, texture-width, texture-height, skin-families, external-textures\n"
+		"  -q, --quiet              Only report failures and the summary\n"
+		"  -h, --help               Show this help\n");
+}
+
+bool ParseSections(std::string_view list, int& sections)
+{
+	sections = studiomdl::ModelInfoSection::None;
+
+	while (!list.empty())
+	{
+		const auto end = list.find(',');
+		const auto name = list.substr(0, end);
+
+		const auto it = std::find_if(std::begin(SectionNames), std::end(SectionNames),
+			[&](const auto& section) { return section.Name == name; });
+
+		if (it == std::end(SectionNames))
+		{
+			std::fprintf(stderr, "Unknown model info section \"%.*s\"\n\n", static_cast<int>(name.size()), name.data());
+			return false;
+		}
+
+		sections |= it->Section;
+
+		list.remove_prefix(end == std::string_view::npos ? list.size() : end + 1);
+	}
+
+	return true;
+}
+
+bool ParseBudget(std::string_view budget, studiomdl::RenderCostBudget& result)
+{
+	const auto separator = budget.find('=');
+
+	if (separator == std::string_view::npos)
+	{
+		std::fprintf(stderr, "Budget \"%.*s\" must have the form <name>=<value>\n\n", static_cast<int>(budget.size()), budget.data());
+		return false;
+	}
+
+	const auto name = budget.substr(0, separator);
+	const auto valueText = budget.substr(separator + 1);
+
+	int value = 0;
+
+	if (const auto [end, error] = std::from_chars(valueText.data(), valueText.data() + valueText.size(), value);
+		error != std::errc{} || end != valueText.data() + valueText.size() || value < 0)
+	{
+		std::fprintf(stderr, "Invalid budget value \"%.*s\"\n\n", static_cast<int>(valueText.size()), valueText.data());
+		return false;
+	}
+
+	if (name == "triangles")
+	{
+		result.MaxTrianglesPerCombination = value;
+	}
+	else if (name == "draw-calls")
+	{
+		result.MaxDrawCallsPerCombination = value;
+	}
+	else if (name == "texture-kib")
+	{
+		result.MaxTextureMemory = static_cast<std::size_t>(value) * 1024;
+	}
+	else if (name == "bones")
+	{
+		result.MaxBones = value;
+	}
+	else if (name == "bones-per-mesh")
+	{
+		result.MaxBonesPerMesh = value;
+	}
+	else if (name == "animation-kib")
+	{
+		result.MaxAnimationBytesPerSequence = static_cast<std::size_t>(value) * 1024;
+	}
+	else
+	{
+		std::fprintf(stderr, "Unknown budget \"%.*s\"\n\n", static_cast<int>(name.size()), name.data());
+		return false;
+	}
+
+	return true;
+}
+
+bool ParseGeneratorSetting(std::string_view setting, studiomdl::GeneratorSettings& settings)
+{
+	const auto separator = setting.find('=');
+
+	if (separator == std::string_view::npos)
+	{
+		std::fprintf(stderr, "Generator setting \"%.*s\" must have the form <name>=<value>\n\n", static_cast<int>(setting.size()), setting.data());
+		return false;
+	}
+
+	const auto name = setting.substr(0, separator);
+	const auto valueText = setting.substr(separator + 1);
+
+	int value = 0;
+
+	if (const auto [end, error] = std::from_chars(valueText.data(), valueText.data() + valueText.size(), value);
+		error != std::errc{} || end != valueText.data() + valueText.size())
+	{
+		std::fprintf(stderr, "Invalid generator setting value \"%.*s\"\n\n", static_cast<int>(valueText.size()), valueText.data());
+		return false;
+	}
+
+	if (!studiomdl::SetGeneratorSetting(settings, name, value))
+	{
+		std::fprintf(stderr, "Unknown generator setting \"%.*s\"\n\n", static_cast<int>(name.size()), name.data());
+		return false;
+	}
+
+	return true;
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options)
+{
+	if (argc < 2)
+	{
+		return false;
+	}
+
+	const std::string_view command{argv[1]};
+
+	if (command == "validate")
+	{
+		options.Action = Command::Validate;
+	}
+	else if (command == "dump")
+	{
+		options.Action = Command::Dump;
+	}
+	else if (command == "convert")
+	{
+		options.Action = Command::Convert;
+	}
+	else if (command == "analyze")
+	{
+		options.Action = Command::Analyze;
+	}
+	else if (command == "stripify")
+	{
+		options.Action = Command::Stripify;
+	}
+	else if (command == "generate")
+	{
+		options.Action = Command::Generate;
+	}
+	else
+	{
+		if (command != "-h" && command != "--help")
+		{
+			std::fprintf(stderr, "Unknown command \"%s\"\n\n", argv[1]);
+		}
+
+		return false;
+	}
+
+	for (int i = 2; i < argc; ++i)
+	{
+		const std::string_view argument{argv[i]};
+
+		if (argument == "-j" || argument == "--jobs" || argument == "-o" || argument == "--output"
+			|| argument == "--format" || argument == "--sections" || argument == "--budget" || argument == "--generator")
+		{
+			if (i + 1 >= argc)
+			{
+				std::fprintf(stderr, "Missing value for option \"%s\"\n\n", argv[i]);
+				return false;
+			}
+
+			const char* const value = argv[++i];
+
+			if (argument == "-j" || argument == "--jobs")
+			{
+				const int jobCount = std::atoi(value);
+
+				if (jobCount <= 0)
+				{
+					std::fprintf(stderr, "Invalid job count \"%s\"\n\n", value);
+					return false;
+				}
+
+				options.JobCount = static_cast<std::size_t>(jobCount);
+			}
+			else if (argument == "--format")
+			{
+				const std::string_view format{value};
+
+				if (format == "text")
+				{
+					options.Format = InfoFormat::Text;
+				}
+				else if (format == "json")
+				{
+					options.Format = InfoFormat::Json;
+				}
+				else if (format == "ndjson")
+				{
+					options.Format = InfoFormat::NdJson;
+				}
+				else
+				{
+					std::fprintf(stderr, "Unknown format \"%s\"\n\n", value);
+					return false;
+				}
+			}
+			else if (argument == "--sections")
+			{
+				if (!ParseSections(value, options.Sections))
+				{
+					return false;
+				}
+			}
+			else if (argument == "--budget")
+			{
+				if (!ParseBudget(value, options.Budget))
+				{
+					return false;
+				}
+			}
+			else if (argument == "--generator")
+			{
+				if (!ParseGeneratorSetting(value, options.Generator))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				options.Output = std::filesystem::u8path(value);
+			}
+		}
+		else if (argument == "-q" || argument == "--quiet")
+		{
+			options.Quiet = true;
+		}
+		else if (argument == "-h" || argument == "--help")
+		{
+			return false;
+		}
+		else if (argument.size() > 1 && argument[0] == '-')
+		{
+			std::fprintf(stderr, "Unknown option \"%s\"\n\n", argv[i]);
+			return false;
+		}
+		else
+		{
+			options.Inputs.push_back(std::filesystem::u8path(argument));
+		}
+	}
+
+	if (options.Inputs.empty())
+	{
+		std::fprintf(stderr, "No files or directories specified\n\n");
+		return false;
+	}
+
+	if ((options.Action == Command::Convert || options.Action == Command::Stripify) && options.Output.empty())
+	{
+		std::fprintf(stderr, "The %s command requires an output directory\n\n", argv[1]);
+		return false;
+	}
+
+	return true;
+}
+
+bool HasModelExtension(const std::filesystem::path& fileName)
+{
+	auto extension = fileName.extension().u8string();
+
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return std::tolower(c); });
+
+	return extension == ".mdl" || extension == ".dol";
+}
+
+/**
+*	@brief Texture and sequence group files are loaded along with their main file, so they are skipped.
+*	Texture files have the main file id but no name; sequence group files have a different id.
+*/
+bool IsMainFile(const std::filesystem::path& fileName)
+{
+	FILE* file = utf8_fopen(fileName.u8string().c_str(), "rb");
+
+	if (!file)
+	{
+		//Let the loader report the error
+		return true;
+	}
+
+	bool isMainFile = false;
+
+	if (studiomdl::IsStudioModel(file))
+	{
+		char name[sizeof(studiohdr_t::name)];
+
+		isMainFile = std::fread(name, sizeof(name), 1, file) == 1 && name[0] != '\0';
+	}
+
+	std::fclose(file);
+
+	return isMainFile;
+}
+
+bool FindModels(const Options& options, std::vector<InputFile>& models)
+{
+	bool success = true;
+
+	for (const auto& input : options.Inputs)
+	{
+		std::error_code error;
+
+		if (std::filesystem::is_directory(input, error))
+		{
+			std::filesystem::recursive_directory_iterator it{input, std::filesystem::directory_options::skip_permission_denied, error};
+
+			for (; !error && it != std::filesystem::recursive_directory_iterator{}; it.increment(error))
+			{
+				if (it->is_regular_file(error) && HasModelExtension(it->path()) && IsMainFile(it->path()))
+				{
+					models.push_back({it->path(), input});
+				}
+			}
+
+			if (error)
+			{
+				std::fprintf(stderr, "Error searching directory \"%s\": %s\n", input.u8string().c_str(), error.message().c_str());
+				success = false;
+			}
+		}
+		else if (std::filesystem::is_regular_file(input, error))
+		{
+			models.push_back({input, input.parent_path()});
+		}
+		else
+		{
+			std::fprintf(stderr, "\"%s\" does not exist\n", input.u8string().c_str());
+			success = false;
+		}
+	}
+
+	return success;
+}
+
+std::filesystem::path GetOutputFileName(const Options& options, const InputFile& input, const std::filesystem::path& fileName)
+{
+	if (options.Output.empty())
+	{
+		return input.FileName.parent_path() / fileName;
+	}
+
+	const auto relativeDirectory = input.FileName.parent_path().lexically_relative(input.BaseDirectory);
+
+	const auto directory = options.Output / relativeDirectory;
+
+	std::filesystem::create_directories(directory);
+
+	return directory / fileName;
+}
+
+std::size_t GetModelSize(const studiomdl::StudioModel& studioModel)
+{
+	std::size_t size = studioModel.GetStudioHeader()->length;
+
+	if (studioModel.HasSeparateTextureHeader())
+	{
+		size += studioModel.GetTextureHeader()->length;
+	}
+
+	for (int i = 1; i < studioModel.GetStudioHeader()->numseqgroups; ++i)
+	{
+		size += studioModel.GetSeqGroupHeader(i - 1)->length;
+	}
+
+	return size;
+}
+
+bool UsesStructuredOutput(const Options& options)
+{
+	return (options.Action == Command::Dump || options.Action == Command::Analyze) && options.Format != InfoFormat::Text;
+}
+
+/**
+*	@brief Adds the object written by @p write to the json or ndjson output.
+*/
+template<typename Function>
+void WriteStructuredOutput(const Options& options, InfoOutput& output, Function&& write)
+{
+	//Each worker formats into its own buffer so the output only needs to be locked to copy it
+	thread_local JsonWriter writer;
+
+	writer.Clear();
+
+	write(writer);
+
+	const auto data = writer.GetData();
+
+	std::lock_guard lock{output.Mutex};
+
+	if (options.Format == InfoFormat::Json)
+	{
+		std::fputs(output.IsFirst ? "[\n" : ",\n", output.File);
+	}
+
+	output.IsFirst = false;
+
+	std::fwrite(data.data(), 1, data.size(), output.File);
+
+	if (options.Format == InfoFormat::NdJson)
+	{
+		std::fputc('\n', output.File);
+	}
+}
+
+void SaveModel(const Options& options, const InputFile& input, const studiomdl::EditableStudioModel& editableModel)
+{
+	auto fileName = GetOutputFileName(options, input, input.FileName.filename());
+
+	//Same as the editor, dol models are saved as mdl
+	fileName.replace_extension(".mdl");
+
+	auto convertedModel = studiomdl::ConvertFromEditable(fileName, editableModel);
+
+	studiomdl::SaveStudioModel(fileName, convertedModel, false);
+}
+
+void WriteGeneratedModel(const Options& options, const InputFile& input)
+{
+	auto settings = options.Generator;
+
+	//Sequence group files are named after the main file
+	settings.Name = input.FileName.stem().u8string();
+
+	const auto editableModel = studiomdl::GenerateStudioModel(settings);
+
+	if (const auto directory = input.FileName.parent_path(); !directory.empty())
+	{
+		std::filesystem::create_directories(directory);
+	}
+
+	auto convertedModel = studiomdl::ConvertFromEditable(input.FileName, editableModel);
+
+	studiomdl::SaveStudioModel(input.FileName, convertedModel, false);
+}
+
+void ProcessModel(const Options& options, const InputFile& input, InfoOutput& infoOutput, FileResult& result)
+{
+	if (options.Action == Command::Generate)
+	{
+		WriteGeneratedModel(options, input);
+	}
+
+	const auto studioModel = studiomdl::LoadStudioModel(input.FileName, nullptr);
+
+	result.Bytes = GetModelSize(*studioModel);
+
+	//Corrupt models can't be converted safely, so stop here for every command
+	result.Problems = studiomdl::ValidateStudioModel(*studioModel);
+
+	if (!result.Problems.empty())
+	{
+		return;
+	}
+
+	//Structured info is written straight from the file data, no conversion needed
+	if (options.Action == Command::Dump && options.Format != InfoFormat::Text)
+	{
+		WriteStructuredOutput(options, infoOutput, [&](JsonWriter& writer)
+			{
+				studiomdl::WriteModelInfo(writer, input.FileName.u8string(), *studioModel, options.Sections);
+			});
+
+		result.Success = true;
+		return;
+	}
+
+	auto editableModel = studiomdl::ConvertToEditable(*studioModel);
+
+	switch (options.Action)
+	{
+	case Command::Validate:
+	{
+		studiomdl::ConvertFromEditable(input.FileName, editableModel);
+		break;
+	}
+
+	case Command::Dump:
+	{
+		const auto fileName = GetOutputFileName(options, input,
+			std::filesystem::u8path(input.FileName.stem().u8string() + "_modelinfo.txt"));
+
+		FILE* file = utf8_fopen(fileName.u8string().c_str(), "w");
+
+		if (!file)
+		{
+			throw assets::AssetException(std::string{"Could not open \""} + fileName.u8string() + "\" for writing");
+		}
+
+		studiomdl::DumpModelInfo(file, editableModel);
+
+		std::fclose(file);
+		break;
+	}
+
+	case Command::Convert:
+	{
+		SaveModel(options, input, editableModel);
+		break;
+	}
+
+	case Command::Analyze:
+	{
+		const auto report = studiomdl::AnalyzeRenderCost(editableModel, options.Budget);
+
+		if (options.Format != InfoFormat::Text)
+		{
+			WriteStructuredOutput(options, infoOutput, [&](JsonWriter& writer)
+				{
+					studiomdl::WriteRenderCostReport(writer, input.FileName.u8string(), report);
+				});
+		}
+		else if (!options.Quiet)
+		{
+			result.Report = studiomdl::FormatRenderCostReport(report);
+		}
+
+		result.OverBudget = report.IsOverBudget();
+		result.Problems = report.BudgetViolations;
+		break;
+	}
+
+	case Command::Stripify:
+	{
+		const auto stripified = studiomdl::StripifyModel(editableModel);
+
+		studiomdl::ApplyTriangleCommands(editableModel, stripified.NewCommands);
+
+		SaveModel(options, input, editableModel);
+
+		char buffer[256];
+
+		std::snprintf(buffer, sizeof(buffer), "       Strips and fans: %d -> %d, vertices drawn: %d -> %d\n",
+			stripified.Before.GetCommandCount(), stripified.After.GetCommandCount(),
+			stripified.Before.Vertices, stripified.After.Vertices);
+
+		result.Report = buffer;
+		break;
+	}
+
+	case Command::Generate:
+	{
+		//Same checks as validate on the model as it was loaded back
+		studiomdl::ConvertFromEditable(input.FileName, editableModel);
+
+		std::size_t vertices = 0;
+		int triangles = 0;
+
+		for (const auto& bodypart : editableModel.Bodyparts)
+		{
+			for (const auto& model : bodypart->Models)
+			{
+				vertices += model.Vertices.size();
+
+				for (const auto& mesh : model.Meshes)
+				{
+					triangles += mesh.NumTriangles;
+				}
+			}
+		}
+
+		char buffer[256];
+
+		std::snprintf(buffer, sizeof(buffer), "       Bones: %zu, vertices: %zu, triangles: %d, sequences: %zu, textures: %zu, %zu bytes\n",
+			editableModel.Bones.size(), vertices, triangles, editableModel.Sequences.size(), editableModel.Textures.size(), result.Bytes);
+
+		result.Report = buffer;
+		break;
+	}
+	}
+
+	result.Success = true;
+}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	InfoOutput infoOutput;
+
+	//Progress goes to standard error when standard output is used for model info
+	FILE* log = stdout;
+
+	if (UsesStructuredOutput(options))
+	{
+		if (options.Output.empty())
+		{
+			infoOutput.File = stdout;
+			log = stderr;
+		}
+		else
+		{
+			infoOutput.File = utf8_fopen(options.Output.u8string().c_str(), "wb");
+
+			if (!infoOutput.File)
+			{
+				std::fprintf(stderr, "Could not open \"%s\" for writing\n", options.Output.u8string().c_str());
+				return EXIT_FAILURE;
+			}
+		}
+
+		std::setvbuf(infoOutput.File, nullptr, _IOFBF, JsonWriter::DefaultBufferSize);
+	}
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	std::vector<InputFile> models;
+
+	bool foundAll = true;
+
+	if (options.Action == Command::Generate)
+	{
+		//The inputs are the models to write
+		for (const auto& input : options.Inputs)
+		{
+			models.push_back({input, input.parent_path()});
+		}
+	}
+	else
+	{
+		foundAll = FindModels(options, models);
+	}
+
+	std::vector<FileResult> results(models.size());
+
+	std::mutex outputMutex;
+
+	RunInParallel(models.size(), [&](std::size_t index)
+		{
+			const auto& input = models[index];
+			auto& result = results[index];
+
+			std::string error;
+
+			try
+			{
+				ProcessModel(options, input, infoOutput, result);
+			}
+			catch (const std::exception& e)
+			{
+				error = e.what();
+			}
+
+			std::lock_guard lock{outputMutex};
+
+			if (result.Success && result.OverBudget)
+			{
+				std::fprintf(stderr, "OVER   %s\n", input.FileName.u8string().c_str());
+
+				for (const auto& problem : result.Problems)
+				{
+					std::fprintf(stderr, "       %s\n", problem.c_str());
+				}
+
+				std::fputs(result.Report.c_str(), log);
+			}
+			else if (result.Success)
+			{
+				if (!options.Quiet)
+				{
+					std::fprintf(log, "OK     %s\n", input.FileName.u8string().c_str());
+					std::fputs(result.Report.c_str(), log);
+				}
+			}
+			else
+			{
+				std::fprintf(stderr, "FAILED %s\n", input.FileName.u8string().c_str());
+
+				if (!error.empty())
+				{
+					std::fprintf(stderr, "       %s\n", error.c_str());
+				}
+
+				for (const auto& problem : result.Problems)
+				{
+					std::fprintf(stderr, "       %s\n", problem.c_str());
+				}
+			}
+		}, options.JobCount);
+
+	bool wroteInfo = true;
+
+	if (infoOutput.File)
+	{
+		if (options.Format == InfoFormat::Json)
+		{
+			std::fputs(infoOutput.IsFirst ? "[]\n" : "\n]\n", infoOutput.File);
+		}
+
+		wroteInfo = std::fflush(infoOutput.File) == 0 && !std::ferror(infoOutput.File);
+
+		if (infoOutput.File != stdout)
+		{
+			wroteInfo = std::fclose(infoOutput.File) == 0 && wroteInfo;
+		}
+
+		if (!wroteInfo)
+		{
+			std::fprintf(stderr, "Error writing model info\n");
+		}
+	}
+
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+	std::size_t failedCount = 0;
+	std::size_t overBudgetCount = 0;
+	std::size_t totalBytes = 0;
+
+	for (const auto& result : results)
+	{
+		if (!result.Success)
+		{
+			++failedCount;
+		}
+		else if (result.OverBudget)
+		{
+			++overBudgetCount;
+		}
+
+		totalBytes += result.Bytes;
+	}
+
+	const double seconds = std::max(elapsed.count(), 0.001);
+	const double megabytes = totalBytes / (1024.0 * 1024.0);
+
+	std::fprintf(log, "\n%zu models, %zu failed, %.1f MiB in %.2f seconds (%.1f models/s, %.1f MiB/s)\n",
+		results.size(), failedCount, megabytes, elapsed.count(), results.size() / seconds, megabytes / seconds);
+
+	if (options.Action == Command::Analyze)
+	{
+		std::fprintf(log, "%zu models over budget\n", overBudgetCount);
+	}
+
+	return foundAll && wroteInfo && failedCount == 0 && overBudgetCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -7,6 +7,8 @@
 
 #include "graphics/GraphicsUtils.hpp"
 
+#include "engine/shared/renderer/studiomodel/StudioModelLighting.hpp"
+
 #include "engine/shared/studiomodel/EditableStudioModel.hpp"
 
 #include "engine/renderer/studiomodel/StudioModelRenderer.hpp"
@@ -468,10 +470,7 @@ void StudioModelRenderer::DrawNormals()
 	{
 		SetupModel(iBodyPart);
 
-		for (int i = 0; i < _model->Vertices.size(); i++)
-		{
-			_xformverts[i] = _bonetransform[_model->Vertices[i].Bone->ArrayIndex] * glm::vec4{_model->Vertices[i].Vertex, 1};
-		}
+		TransformVertices(*_model, _bonetransform, _xformverts);
 
 		for (int i = 0; i < _model->Normals.size(); i++)
 		{
@@ -528,13 +527,7 @@ void StudioModelRenderer::SetupLighting()
 	_ambientlight = 32;
 	_shadelight = 192;
 
-	for (int i = 0; i < _studioModel->Bones.size(); i++)
-	{
-		auto matrix = _bonetransform[i];
-		matrix[3] = glm::vec4{0, 0, 0, 1};
-		matrix = glm::inverse(matrix);
-		_blightvec[i] = matrix * glm::vec4{_lightvec, 1};
-	}
+	CalculateBoneLightVectors(_studioModel->Bones.size(), _bonetransform, _lightvec, _blightvec);
 }
 
 void StudioModelRenderer::SetupModel(int bodypart)
@@ -555,10 +548,7 @@ unsigned int StudioModelRenderer::DrawPoints(const bool bWireframe)
 	//TODO: do this earlier
 	_renderInfo->Skin = std::clamp(_renderInfo->Skin, 0, static_cast<int>(_studioModel->SkinFamilies.size()));
 
-	for (int i = 0; i < _model->Vertices.size(); i++)
-	{
-		_xformverts[i] = _bonetransform[_model->Vertices[i].Bone->ArrayIndex] * glm::vec4{_model->Vertices[i].Vertex, 1};
-	}
+	TransformVertices(*_model, _bonetransform, _xformverts);
 
 	SortedMesh meshes[MAXSTUDIOMESHES]{};
 
@@ -568,6 +558,8 @@ unsigned int StudioModelRenderer::DrawPoints(const bool bWireframe)
 
 	auto normals = _model->Normals.data();
 
+	const StudioModelLighting lighting{_ambientlight, _shadelight, _lambert, _lightcolor};
+
 	glm::vec3* lv = _lightvalues;
 	for (int j = 0; j < _model->Meshes.size(); j++)
 	{
@@ -580,7 +572,7 @@ unsigned int StudioModelRenderer::DrawPoints(const bool bWireframe)
 
 		for (int i = 0; i < mesh.NumNorms; i++, ++lv, ++normals)
 		{
-			Lighting(*lv, normals->Bone->ArrayIndex, flags, normals->Vertex);
+			*lv = CalculateVertexLighting(lighting, _blightvec[normals->Bone->ArrayIndex], flags, normals->Vertex);
 
 			// FIX: move this check out of the inner loop
 			if (flags & STUDIO_NF_CHROME)
@@ -830,53 +822,6 @@ unsigned int StudioModelRenderer::InternalDrawShadows()
 	return drawnPolys;
 }
 
-void StudioModelRenderer::Lighting(glm::vec3& lv, int bone, int flags, const glm::vec3& normal)
-{
-	const float ambient = std::max(0.1f, (float)_ambientlight / 255.0f); // to avoid divison by zero
-	const float shade = _shadelight / 255.0f;
-	glm::vec3 illum{ambient};
-
-	if (flags & STUDIO_NF_FULLBRIGHT)
-	{
-		lv = glm::vec3{1, 1, 1};
-		return;
-	}
-	else if (flags & STUDIO_NF_FLATSHADE)
-	{
-		illum += 0.8f * shade;
-	}
-	else
-	{
-		auto lightcos = glm::dot(normal, _blightvec[bone]); // -1 colinear, 1 opposite
-
-		if (lightcos > 1.0f) lightcos = 1;
-
-		illum += _shadelight / 255.0f;
-
-		auto r = _lambert;
-		if (r < 1.0f) r = 1.0f;
-		lightcos = (lightcos + (r - 1.0f)) / r; // do modified hemispherical lighting
-
-		if (lightcos > 0.0f)
-		{
-			illum -= lightcos * shade;
-		}
-
-		if (illum[0] <= 0) illum[0] = 0;
-		if (illum[1] <= 0) illum[1] = 0;
-		if (illum[2] <= 0) illum[2] = 0;
-	}
-
-	float max = std::max({illum.x, illum.y, illum.z});
-
-	if (max > 1.0f)
-		lv = illum * (1.0f / max);
-	else lv = illum;
-
-	lv *= _lightcolor;
-}
-
-
 void StudioModelRenderer::Chrome(glm::vec2& chrome, int bone, const glm::vec3& normal)
 {
 	if (_chromeage[bone] != _modelsDrawnCount)
@@ -120,7 +120,6 @@ private:
 
 	unsigned int InternalDrawShadows();
 
-	void Lighting(glm::vec3& lv, int bone, int flags, const glm::vec3& normal);
 	void Chrome(glm::vec2& chrome, int bone, const glm::vec3& normal);
 
 private:
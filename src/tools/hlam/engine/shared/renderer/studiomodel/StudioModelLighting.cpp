@@ -0,0 +1,77 @@
+#include <algorithm>
+
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+
+#include "engine/shared/renderer/studiomodel/StudioModelLighting.hpp"
+
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+
+namespace studiomdl
+{
+void TransformVertices(const Model& model, const glm::mat4x4* boneTransforms, glm::vec3* vertices)
+{
+	for (const auto& vertex : model.Vertices)
+	{
+		*vertices++ = boneTransforms[vertex.Bone->ArrayIndex] * glm::vec4{vertex.Vertex, 1};
+	}
+}
+
+void CalculateBoneLightVectors(std::size_t boneCount, const glm::mat4x4* boneTransforms, const glm::vec3& lightVector, glm::vec3* boneLightVectors)
+{
+	for (std::size_t i = 0; i < boneCount; ++i)
+	{
+		auto matrix = boneTransforms[i];
+		matrix[3] = glm::vec4{0, 0, 0, 1};
+		matrix = glm::inverse(matrix);
+		boneLightVectors[i] = matrix * glm::vec4{lightVector, 1};
+	}
+}
+
+glm::vec3 CalculateVertexLighting(const StudioModelLighting& lighting, const glm::vec3& boneLightVector, int flags, const glm::vec3& normal)
+{
+	const float ambient = std::max(0.1f, (float)lighting.AmbientLight / 255.0f); // to avoid divison by zero
+	const float shade = lighting.ShadeLight / 255.0f;
+	glm::vec3 illum{ambient};
+
+	if (flags & STUDIO_NF_FULLBRIGHT)
+	{
+		return glm::vec3{1, 1, 1};
+	}
+	else if (flags & STUDIO_NF_FLATSHADE)
+	{
+		illum += 0.8f * shade;
+	}
+	else
+	{
+		auto lightcos = glm::dot(normal, boneLightVector); // -1 colinear, 1 opposite
+
+		if (lightcos > 1.0f) lightcos = 1;
+
+		illum += lighting.ShadeLight / 255.0f;
+
+		auto r = lighting.Lambert;
+		if (r < 1.0f) r = 1.0f;
+		lightcos = (lightcos + (r - 1.0f)) / r; // do modified hemispherical lighting
+
+		if (lightcos > 0.0f)
+		{
+			illum -= lightcos * shade;
+		}
+
+		if (illum[0] <= 0) illum[0] = 0;
+		if (illum[1] <= 0) illum[1] = 0;
+		if (illum[2] <= 0) illum[2] = 0;
+	}
+
+	float max = std::max({illum.x, illum.y, illum.z});
+
+	glm::vec3 lv;
+
+	if (max > 1.0f)
+		lv = illum * (1.0f / max);
+	else lv = illum;
+
+	return lv * lighting.LightColor;
+}
+}
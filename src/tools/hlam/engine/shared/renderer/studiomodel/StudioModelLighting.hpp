@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+/**
+*	@ingroup StudioModelRenderer
+*
+*	@{
+*/
+
+namespace studiomdl
+{
+struct Model;
+
+/**
+*	@brief Light values used for every vertex of a model.
+*/
+struct StudioModelLighting
+{
+	int AmbientLight = 32;
+	float ShadeLight = 192;
+
+	//Modifier for pseudo-hemispherical lighting
+	float Lambert = 1.5f;
+
+	glm::vec3 LightColor{1, 1, 1};
+};
+
+/**
+*	@brief Transforms the vertices of @p model by the transforms of the bones they are attached to.
+*	@param vertices Must have room for every vertex in @p model.
+*/
+void TransformVertices(const Model& model, const glm::mat4x4* boneTransforms, glm::vec3* vertices);
+
+/**
+*	@brief Transforms @p lightVector into the reference frame of each bone.
+*/
+void CalculateBoneLightVectors(std::size_t boneCount, const glm::mat4x4* boneTransforms, const glm::vec3& lightVector, glm::vec3* boneLightVectors);
+
+/**
+*	@brief Calculates the color of a vertex, using the texture flags of the mesh it belongs to.
+*	@param boneLightVector Light vector in the reference frame of the bone that @p normal is attached to.
+*/
+glm::vec3 CalculateVertexLighting(const StudioModelLighting& lighting, const glm::vec3& boneLightVector, int flags, const glm::vec3& normal);
+}
+
+/** @} */
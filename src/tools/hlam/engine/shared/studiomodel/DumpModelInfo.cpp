@@ -7,8 +7,16 @@
 
 #include "engine/shared/studiomodel/StudioModelUtils.hpp"
 
+#include "utility/JsonWriter.hpp"
+
 namespace studiomdl
 {
+static void WriteVector(JsonWriter& writer, std::string_view key, const glm::vec3& vector)
+{
+	writer.Key(key);
+	writer.FloatArray(&vector[0], 3);
+}
+
 void DumpModelInfo(FILE* file, const EditableStudioModel& model)
 {
 	assert(file);
@@ -301,4 +309,291 @@ void DumpModelInfo(FILE* file, const EditableStudioModel& model)
 		}
 	}
 }
+
+void WriteModelInfo(JsonWriter& writer, std::string_view fileName, const StudioModel& model, int sections)
+{
+	const studiohdr_t& header = *model.GetStudioHeader();
+	const studiohdr_t& textureHeader = *model.GetTextureHeader();
+
+	writer.BeginObject();
+
+	writer.Field("schemaVersion", ModelInfoSchemaVersion);
+	writer.Field("file", fileName);
+
+	if (sections & ModelInfoSection::Header)
+	{
+		writer.Key("header");
+		writer.BeginObject();
+
+		writer.Key("id");
+		writer.String(std::string_view{reinterpret_cast<const char*>(&header.id), 4});
+
+		writer.Field("version", header.version);
+		writer.Field("name", header.name);
+		writer.Field("length", header.length);
+		writer.Field("isDol", model.IsDol());
+		writer.Field("hasExternalTextures", model.HasSeparateTextureHeader());
+
+		WriteVector(writer, "eyePosition", header.eyeposition);
+		WriteVector(writer, "min", header.min);
+		WriteVector(writer, "max", header.max);
+		WriteVector(writer, "bbMin", header.bbmin);
+		WriteVector(writer, "bbMax", header.bbmax);
+
+		writer.Field("flags", header.flags);
+		writer.Field("transitionNodes", header.numtransitions);
+
+		writer.EndObject();
+	}
+
+	if (sections & ModelInfoSection::Bones)
+	{
+		writer.Key("bones");
+		writer.BeginArray();
+
+		for (int i = 0; i < header.numbones; ++i)
+		{
+			const auto& bone = *header.GetBone(i);
+
+			writer.BeginObject();
+			writer.Field("name", bone.name);
+			writer.Field("parent", bone.parent);
+			writer.Field("flags", bone.flags);
+			writer.Key("boneControllers");
+			writer.IntArray(bone.bonecontroller, STUDIO_NUM_COORDINATE_AXES);
+			writer.Key("value");
+			writer.FloatArray(bone.value, STUDIO_NUM_COORDINATE_AXES);
+			writer.Key("scale");
+			writer.FloatArray(bone.scale, STUDIO_NUM_COORDINATE_AXES);
+			writer.EndObject();
+		}
+
+		writer.EndArray();
+	}
+
+	if (sections & ModelInfoSection::BoneControllers)
+	{
+		writer.Key("boneControllers");
+		writer.BeginArray();
+
+		for (int i = 0; i < header.numbonecontrollers; ++i)
+		{
+			const auto& controller = *header.GetBoneController(i);
+
+			writer.BeginObject();
+			writer.Field("bone", controller.bone);
+			writer.Field("type", controller.type);
+			writer.Field("start", controller.start);
+			writer.Field("end", controller.end);
+			writer.Field("rest", controller.rest);
+			writer.Field("index", controller.index);
+			writer.EndObject();
+		}
+
+		writer.EndArray();
+	}
+
+	if (sections & ModelInfoSection::Hitboxes)
+	{
+		writer.Key("hitboxes");
+		writer.BeginArray();
+
+		for (int i = 0; i < header.numhitboxes; ++i)
+		{
+			const auto& hitbox = *header.GetHitBox(i);
+
+			writer.BeginObject();
+			writer.Field("bone", hitbox.bone);
+			writer.Field("group", hitbox.group);
+			WriteVector(writer, "bbMin", hitbox.bbmin);
+			WriteVector(writer, "bbMax", hitbox.bbmax);
+			writer.EndObject();
+		}
+
+		writer.EndArray();
+	}
+
+	if (sections & ModelInfoSection::Sequences)
+	{
+		writer.Key("sequences");
+		writer.BeginArray();
+
+		for (int i = 0; i < header.numseq; ++i)
+		{
+			const auto& sequence = *header.GetSequence(i);
+
+			writer.BeginObject();
+			writer.Field("label", sequence.label);
+			writer.Field("fps", sequence.fps);
+			writer.Field("flags", sequence.flags);
+			writer.Field("activity", sequence.activity);
+			writer.Field("activityWeight", sequence.actweight);
+			writer.Field("frames", sequence.numframes);
+			writer.Field("motionType", sequence.motiontype);
+			writer.Field("motionBone", sequence.motionbone);
+			WriteVector(writer, "linearMovement", sequence.linearmovement);
+			WriteVector(writer, "bbMin", sequence.bbmin);
+			WriteVector(writer, "bbMax", sequence.bbmax);
+			writer.Field("blends", sequence.numblends);
+			writer.Field("sequenceGroup", sequence.seqgroup);
+			writer.Field("entryNode", sequence.entrynode);
+			writer.Field("exitNode", sequence.exitnode);
+			writer.Field("nodeFlags", sequence.nodeflags);
+			writer.Field("nextSequence", sequence.nextseq);
+
+			writer.Key("events");
+			writer.BeginArray();
+
+			const auto events = reinterpret_cast<const mstudioevent_t*>(header.GetData() + sequence.eventindex);
+
+			for (int j = 0; j < sequence.numevents; ++j)
+			{
+				writer.BeginObject();
+				writer.Field("frame", events[j].frame);
+				writer.Field("event", events[j].event);
+				writer.Field("type", events[j].type);
+				writer.Field("options", events[j].options);
+				writer.EndObject();
+			}
+
+			writer.EndArray();
+			writer.EndObject();
+		}
+
+		writer.EndArray();
+	}
+
+	if (sections & ModelInfoSection::SequenceGroups)
+	{
+		writer.Key("sequenceGroups");
+		writer.BeginArray();
+
+		for (int i = 0; i < header.numseqgroups; ++i)
+		{
+			const auto& group = *header.GetSequenceGroup(i);
+
+			writer.BeginObject();
+			writer.Field("label", group.label);
+			writer.Field("name", group.name);
+			writer.EndObject();
+		}
+
+		writer.EndArray();
+	}
+
+	if (sections & ModelInfoSection::Textures)
+	{
+		writer.Key("textures");
+		writer.BeginArray();
+
+		for (int i = 0; i < textureHeader.numtextures; ++i)
+		{
+			const auto& texture = *textureHeader.GetTexture(i);
+
+			writer.BeginObject();
+			writer.Field("name", texture.name);
+			writer.Field("flags", texture.flags);
+			writer.Field("width", texture.width);
+			writer.Field("height", texture.height);
+			writer.EndObject();
+		}
+
+		writer.EndArray();
+	}
+
+	if (sections & ModelInfoSection::Skins)
+	{
+		writer.Key("skins");
+		writer.BeginObject();
+		writer.Field("references", textureHeader.numskinref);
+
+		//One array of texture indices per skin family
+		writer.Key("families");
+		writer.BeginArray();
+
+		for (int i = 0; i < textureHeader.numskinfamilies; ++i)
+		{
+			writer.IntArray(textureHeader.GetSkin(i * textureHeader.numskinref), textureHeader.numskinref);
+		}
+
+		writer.EndArray();
+		writer.EndObject();
+	}
+
+	if (sections & ModelInfoSection::Bodyparts)
+	{
+		writer.Key("bodyparts");
+		writer.BeginArray();
+
+		for (int i = 0; i < header.numbodyparts; ++i)
+		{
+			const auto& bodypart = *header.GetBodypart(i);
+
+			writer.BeginObject();
+			writer.Field("name", bodypart.name);
+			writer.Field("base", bodypart.base);
+
+			writer.Key("models");
+			writer.BeginArray();
+
+			const auto models = reinterpret_cast<const mstudiomodel_t*>(header.GetData() + bodypart.modelindex);
+
+			for (int j = 0; j < bodypart.nummodels; ++j)
+			{
+				const auto& subModel = models[j];
+
+				writer.BeginObject();
+				writer.Field("name", subModel.name);
+				writer.Field("type", subModel.type);
+				writer.Field("boundingRadius", subModel.boundingradius);
+				writer.Field("vertices", subModel.numverts);
+				writer.Field("normals", subModel.numnorms);
+
+				writer.Key("meshes");
+				writer.BeginArray();
+
+				const auto meshes = reinterpret_cast<const mstudiomesh_t*>(header.GetData() + subModel.meshindex);
+
+				for (int k = 0; k < subModel.nummesh; ++k)
+				{
+					writer.BeginObject();
+					writer.Field("triangles", meshes[k].numtris);
+					writer.Field("normals", meshes[k].numnorms);
+					writer.Field("skinReference", meshes[k].skinref);
+					writer.EndObject();
+				}
+
+				writer.EndArray();
+				writer.EndObject();
+			}
+
+			writer.EndArray();
+			writer.EndObject();
+		}
+
+		writer.EndArray();
+	}
+
+	if (sections & ModelInfoSection::Attachments)
+	{
+		writer.Key("attachments");
+		writer.BeginArray();
+
+		for (int i = 0; i < header.numattachments; ++i)
+		{
+			const auto& attachment = *header.GetAttachment(i);
+
+			writer.BeginObject();
+			writer.Field("name", attachment.name);
+			writer.Field("type", attachment.type);
+			writer.Field("bone", attachment.bone);
+			WriteVector(writer, "origin", attachment.org);
+			writer.EndObject();
+		}
+
+		writer.EndArray();
+	}
+
+	writer.EndObject();
+}
 }
@@ -1,10 +1,52 @@
 #pragma once
 
 #include <cstdio>
+#include <string_view>
+
+class JsonWriter;
 
 namespace studiomdl
 {
 class EditableStudioModel;
+class StudioModel;
 
 void DumpModelInfo(FILE* file, const EditableStudioModel& model);
+
+/**
+*	@brief Sections of a model that can be written by WriteModelInfo.
+*/
+namespace ModelInfoSection
+{
+enum ModelInfoSection
+{
+	None = 0,
+	Header = 1 << 0,
+	Bones = 1 << 1,
+	BoneControllers = 1 << 2,
+	Hitboxes = 1 << 3,
+	Sequences = 1 << 4,
+	SequenceGroups = 1 << 5,
+	Textures = 1 << 6,
+	Skins = 1 << 7,
+	Bodyparts = 1 << 8,
+	Attachments = 1 << 9,
+
+	All = Header | Bones | BoneControllers | Hitboxes | Sequences | SequenceGroups | Textures | Skins | Bodyparts | Attachments
+};
+}
+
+/**
+*	@brief Incremented whenever existing keys of the model info change meaning or are removed.
+*	Adding keys does not change the version.
+*/
+constexpr int ModelInfoSchemaVersion = 1;
+
+/**
+*	@brief Writes model info as a single JSON object. Each selected section is written as a key named after the section,
+*	with the first letter in lowercase.
+*	@param fileName Name to store in the object's file key.
+*	@param model Model to write. Must have been validated if it comes from an untrusted source.
+*	@param sections ModelInfoSection flags selecting the sections to write.
+*/
+void WriteModelInfo(JsonWriter& writer, std::string_view fileName, const StudioModel& model, int sections = ModelInfoSection::All);
 }
@@ -1,5 +1,9 @@
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <limits>
+#include <type_traits>
 
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/rotate_vector.hpp>
@@ -10,17 +14,14 @@
 #include "graphics/TextureLoader.hpp"
 
 #include "utility/mathlib.hpp"
+#include "utility/Parallel.hpp"
 
 namespace studiomdl
 {
 EditableStudioModel::~EditableStudioModel()
 {
 	//TODO: need to be sure the context is valid when this is done
-	for (auto& texture : Textures)
-	{
-		glDeleteTextures(1, &texture->TextureId);
-		texture->TextureId = 0;
-	}
+	DeleteTextures();
 }
 
 const Model* EditableStudioModel::GetModelByBodyPart(const int iBody, const int iBodyPart) const
@@ -107,6 +108,12 @@ void EditableStudioModel::CreateTextures(graphics::TextureLoader& textureLoader)
 {
 	for (auto& texture : Textures)
 	{
+		//Textures reused from a previous version of this model have already been uploaded
+		if (texture->TextureId)
+		{
+			continue;
+		}
+
 		GLuint name;
 
 		glBindTexture(GL_TEXTURE_2D, 0);
@@ -177,6 +184,19 @@ void EditableStudioModel::ReuploadTextures(graphics::TextureLoader& textureLoade
 	}
 }
 
+void EditableStudioModel::DeleteTextures()
+{
+	for (auto& texture : Textures)
+	{
+		//Models used without a graphics context never create textures and have no OpenGL functions loaded
+		if (texture->TextureId)
+		{
+			glDeleteTextures(1, &texture->TextureId);
+			texture->TextureId = 0;
+		}
+	}
+}
+
 glm::vec3 FindAverageOfRootBones(const EditableStudioModel& studioModel)
 {
 	glm::vec3 center{0};
@@ -319,39 +339,134 @@ void ApplyRotateData(EditableStudioModel& studioModel, const RotateData& data)
 	}
 }
 
-std::pair<ScaleMeshesData, ScaleMeshesData> CalculateScaledMeshesData(const EditableStudioModel& studioModel, const float scale)
+/**
+*	@brief Geometry operations only use multiple threads once there are this many vertices to process.
+*	Starting threads costs more than it saves on small models.
+*/
+constexpr std::size_t MinimumParallelVertexCount = 8192;
+
+/**
+*	@brief Runs @p task for every index in [0, count), on multiple threads if @p vertexCount is large enough.
+*	Tasks must only write to data owned by their own index so the result does not depend on the order they run in.
+*/
+static void RunGeometryTasks(std::size_t count, std::size_t vertexCount, const std::function<void(std::size_t)>& task)
+{
+	if (vertexCount < MinimumParallelVertexCount)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			task(i);
+		}
+
+		return;
+	}
+
+	RunInParallel(count, task);
+}
+
+/**
+*	@brief Gets all models in bodypart order, which is the order used by all per-model edit data.
+*/
+template<typename TStudioModel>
+static auto GetAllModels(TStudioModel& studioModel)
 {
-	std::vector<std::vector<glm::vec3>> oldVertices;
-	std::vector<std::vector<glm::vec3>> newVertices;
+	std::vector<std::conditional_t<std::is_const_v<TStudioModel>, const Model*, Model*>> models;
+
+	std::size_t count = 0;
 
-	for (int i = 0; i < studioModel.Bodyparts.size(); ++i)
+	for (const auto& bodypart : studioModel.Bodyparts)
 	{
-		const auto& bodypart = *studioModel.Bodyparts[i];
+		count += bodypart->Models.size();
+	}
 
-		oldVertices.reserve(oldVertices.size() + bodypart.Models.size());
-		newVertices.reserve(newVertices.size() + bodypart.Models.size());
+	models.reserve(count);
 
-		for (int j = 0; j < bodypart.Models.size(); ++j)
+	for (const auto& bodypart : studioModel.Bodyparts)
+	{
+		for (auto& model : bodypart->Models)
 		{
-			const auto& model = bodypart.Models[j];
+			models.push_back(&model);
+		}
+	}
 
-			std::vector<glm::vec3> oldVerticesList;
-			std::vector<glm::vec3> newVerticesList;
+	return models;
+}
+
+/**
+*	@brief A mesh that uses a texture, and the index of its first vertex in the list of all texture coordinates for that texture.
+*/
+struct TextureMesh
+{
+	Mesh* TargetMesh;
+	std::size_t FirstVertex;
+};
+
+/**
+*	@brief Gets all meshes using @p textureIndex in bodypart order and the total number of vertices in them.
+*/
+static std::vector<TextureMesh> GetTextureMeshes(const EditableStudioModel& studioModel, const int textureIndex, std::size_t& vertexCount)
+{
+	std::vector<TextureMesh> meshes;
 
-			oldVerticesList.reserve(model.Vertices.size());
-			newVerticesList.reserve(model.Vertices.size());
+	vertexCount = 0;
 
-			for (int k = 0; k < model.Vertices.size(); ++k)
+	for (const auto& bodypart : studioModel.Bodyparts)
+	{
+		for (auto& model : bodypart->Models)
+		{
+			for (auto& mesh : model.Meshes)
 			{
-				oldVerticesList.push_back(model.Vertices[k].Vertex);
-				newVerticesList.push_back(model.Vertices[k].Vertex * scale);
-			}
+				if (mesh.SkinRef == textureIndex)
+				{
+					meshes.push_back({&mesh, vertexCount});
+
+					//Only the command headers have to be read to count the vertices
+					auto cmds = mesh.Triangles.data();
 
-			oldVertices.emplace_back(std::move(oldVerticesList));
-			newVertices.emplace_back(std::move(newVerticesList));
+					for (int cmd = std::abs(*cmds++); cmd > 0; cmd = std::abs(*cmds++))
+					{
+						vertexCount += cmd;
+						cmds += cmd * 4;
+					}
+				}
+			}
 		}
 	}
 
+	return meshes;
+}
+
+std::pair<ScaleMeshesData, ScaleMeshesData> CalculateScaledMeshesData(const EditableStudioModel& studioModel, const float scale)
+{
+	const auto models = GetAllModels(studioModel);
+
+	std::size_t vertexCount = 0;
+
+	for (auto model : models)
+	{
+		vertexCount += model->Vertices.size();
+	}
+
+	std::vector<std::vector<glm::vec3>> oldVertices(models.size());
+	std::vector<std::vector<glm::vec3>> newVertices(models.size());
+
+	RunGeometryTasks(models.size(), vertexCount, [&](std::size_t index)
+		{
+			const auto& vertices = models[index]->Vertices;
+
+			auto& oldVerticesList = oldVertices[index];
+			auto& newVerticesList = newVertices[index];
+
+			oldVerticesList.resize(vertices.size());
+			newVerticesList.resize(vertices.size());
+
+			for (std::size_t k = 0; k < vertices.size(); ++k)
+			{
+				oldVerticesList[k] = vertices[k].Vertex;
+				newVerticesList[k] = vertices[k].Vertex * scale;
+			}
+		});
+
 	// TODO: maybe scale pivots
 
 	return {{std::move(oldVertices)}, {std::move(newVertices)}};
@@ -359,24 +474,25 @@ std::pair<ScaleMeshesData, ScaleMeshesData> CalculateScaledMeshesData(const Edit
 
 void ApplyScaleMeshesData(EditableStudioModel& studioModel, const ScaleMeshesData& data)
 {
-	int vertexIndex = 0;
+	const auto models = GetAllModels(studioModel);
+
+	std::size_t vertexCount = 0;
 
-	for (int i = 0; i < studioModel.Bodyparts.size(); ++i)
+	for (auto model : models)
 	{
-		auto& bodypart = *studioModel.Bodyparts[i];
+		vertexCount += model->Vertices.size();
+	}
 
-		for (int j = 0; j < bodypart.Models.size(); ++j)
+	RunGeometryTasks(models.size(), vertexCount, [&](std::size_t index)
 		{
-			auto& model = bodypart.Models[j];
+			auto& vertices = models[index]->Vertices;
+			const auto& newVertices = data.Vertices[index];
 
-			for (std::size_t k = 0; k < model.Vertices.size(); ++k)
+			for (std::size_t k = 0; k < vertices.size(); ++k)
 			{
-				model.Vertices[k].Vertex = data.Vertices[vertexIndex][k];
+				vertices[k].Vertex = newVertices[k];
 			}
-
-			++vertexIndex;
-		}
-	}
+		});
 }
 
 std::pair<ScaleHitboxesData, ScaleHitboxesData> CalculateScaledHitboxesData(const EditableStudioModel& studioModel, const float scale)
@@ -681,61 +797,48 @@ std::pair<ScaleSTCoordinatesData, ScaleSTCoordinatesData> CalculateScaledSTCoord
 		newHeightFactor = static_cast<double>(newHeight) / oldHeight;
 	}
 
-	std::vector<ScaleSTCoordinatesData::STCoordinate> originalCoordinates;
-	std::vector<ScaleSTCoordinatesData::STCoordinate> scaledCoordinates;
+	std::size_t vertexCount = 0;
 
-	for (std::size_t b = 0; b < studioModel.Bodyparts.size(); ++b)
-	{
-		auto& bodypart = *studioModel.Bodyparts[b];
+	const auto meshes = GetTextureMeshes(studioModel, textureIndex, vertexCount);
+
+	std::vector<ScaleSTCoordinatesData::STCoordinate> originalCoordinates(vertexCount);
+	std::vector<ScaleSTCoordinatesData::STCoordinate> scaledCoordinates(vertexCount);
 
-		for (std::size_t m = 0; m < bodypart.Models.size(); ++m)
+	RunGeometryTasks(meshes.size(), vertexCount, [&](std::size_t index)
 		{
-			auto& model = bodypart.Models[m];
+			const auto& mesh = meshes[index];
 
-			for (std::size_t n = 0; n < model.Meshes.size(); ++n)
-			{
-				auto& mesh = model.Meshes[n];
+			auto cmds = mesh.TargetMesh->Triangles.data();
 
-				if (mesh.SkinRef == textureIndex)
+			std::size_t coordinateIndex = mesh.FirstVertex;
+
+			for (int cmd = std::abs(*cmds++); cmd > 0; cmd = std::abs(*cmds++))
+			{
+				while (cmd-- > 0)
 				{
-					auto cmds = mesh.Triangles.data();
+					short s = cmds[2];
+					short t = cmds[3];
 
-					//Try to avoid reallocations by guessing the amount of vertices stored
-					originalCoordinates.reserve(originalCoordinates.size() + (mesh.NumTriangles * 3));
-					scaledCoordinates.reserve(scaledCoordinates.size() + (mesh.NumTriangles * 3));
+					originalCoordinates[coordinateIndex] = {s, t};
 
-					for (int cmd = std::abs(*cmds++); cmd > 0; cmd = std::abs(*cmds++))
+					//Rescale coordinates only if necessary to avoid loss of data
+					if (newWidthFactor.has_value())
 					{
-						while (cmd-- > 0)
-						{
-							short s = cmds[2];
-							short t = cmds[3];
-
-							originalCoordinates.push_back({s, t});
-
-							//Rescale coordinates only if necessary to avoid loss of data
-							if (newWidthFactor.has_value())
-							{
-								s = static_cast<short>(s * newWidthFactor.value());
-							}
+						s = static_cast<short>(s * newWidthFactor.value());
+					}
 
-							if (newHeightFactor.has_value())
-							{
-								t = static_cast<short>(t * newHeightFactor.value());
-							}
+					if (newHeightFactor.has_value())
+					{
+						t = static_cast<short>(t * newHeightFactor.value());
+					}
 
-							scaledCoordinates.push_back({s, t});
+					scaledCoordinates[coordinateIndex] = {s, t};
 
-							cmds += 4;
-						}
-					}
+					cmds += 4;
+					++coordinateIndex;
 				}
 			}
-		}
-	}
-
-	originalCoordinates.shrink_to_fit();
-	scaledCoordinates.shrink_to_fit();
+		});
 
 	return {ScaleSTCoordinatesData{std::move(originalCoordinates)}, ScaleSTCoordinatesData{std::move(scaledCoordinates)}};
 }
@@ -748,40 +851,229 @@ void ApplyScaledSTCoordinatesData(const EditableStudioModel& studioModel, const
 		return;
 	}
 
-	auto coordinates = data.Coordinates.begin();
+	std::size_t vertexCount = 0;
+
+	const auto meshes = GetTextureMeshes(studioModel, textureIndex, vertexCount);
+
+	RunGeometryTasks(meshes.size(), vertexCount, [&](std::size_t index)
+		{
+			const auto& mesh = meshes[index];
+
+			auto cmds = mesh.TargetMesh->Triangles.data();
+
+			auto coordinates = data.Coordinates.begin() + mesh.FirstVertex;
+
+			for (int cmd = std::abs(*cmds++); cmd > 0; cmd = std::abs(*cmds++))
+			{
+				while (cmd-- > 0)
+				{
+					cmds[2] = coordinates->S;
+					cmds[3] = coordinates->T;
+
+					cmds += 4;
+					++coordinates;
+				}
+			}
+		});
+}
+
+std::vector<glm::vec3> GetNormals(const EditableStudioModel& studioModel)
+{
+	const auto models = GetAllModels(studioModel);
+
+	std::vector<std::size_t> firstNormals(models.size());
+
+	std::size_t normalCount = 0;
 
-	for (std::size_t b = 0; b < studioModel.Bodyparts.size(); ++b)
+	for (std::size_t i = 0; i < models.size(); ++i)
 	{
-		auto& bodypart = *studioModel.Bodyparts[b];
+		firstNormals[i] = normalCount;
+		normalCount += models[i]->Normals.size();
+	}
+
+	std::vector<glm::vec3> normals(normalCount);
 
-		for (std::size_t m = 0; m < bodypart.Models.size(); ++m)
+	RunGeometryTasks(models.size(), normalCount, [&](std::size_t index)
 		{
-			auto& model = bodypart.Models[m];
+			const auto& modelNormals = models[index]->Normals;
 
-			for (std::size_t n = 0; n < model.Meshes.size(); ++n)
+			auto destination = normals.data() + firstNormals[index];
+
+			for (std::size_t k = 0; k < modelNormals.size(); ++k)
 			{
-				auto& mesh = model.Meshes[n];
+				destination[k] = modelNormals[k].Vertex;
+			}
+		});
 
-				if (mesh.SkinRef == textureIndex)
-				{
-					auto cmds = mesh.Triangles.data();
+	return normals;
+}
 
-					for (int cmd = std::abs(*cmds++); cmd > 0; cmd = std::abs(*cmds++))
-					{
-						while (cmd-- > 0)
-						{
-							short s = cmds[2];
-							short t = cmds[3];
+void ApplyNormals(EditableStudioModel& studioModel, const std::vector<glm::vec3>& normals)
+{
+	const auto models = GetAllModels(studioModel);
 
-							cmds[2] = coordinates->S;
-							cmds[3] = coordinates->T;
+	std::vector<std::size_t> firstNormals(models.size());
 
-							cmds += 4;
-							++coordinates;
-						}
-					}
-				}
+	std::size_t normalCount = 0;
+
+	for (std::size_t i = 0; i < models.size(); ++i)
+	{
+		firstNormals[i] = normalCount;
+		normalCount += models[i]->Normals.size();
+	}
+
+	RunGeometryTasks(models.size(), normalCount, [&](std::size_t index)
+		{
+			auto& modelNormals = models[index]->Normals;
+
+			auto source = normals.data() + firstNormals[index];
+
+			for (std::size_t k = 0; k < modelNormals.size(); ++k)
+			{
+				modelNormals[k].Vertex = source[k];
 			}
+		});
+}
+
+std::vector<std::vector<short>> GetTriangleCommands(const EditableStudioModel& studioModel)
+{
+	std::vector<std::vector<short>> commands;
+
+	for (auto model : GetAllModels(studioModel))
+	{
+		for (const auto& mesh : model->Meshes)
+		{
+			commands.push_back(mesh.Triangles);
+		}
+	}
+
+	return commands;
+}
+
+void ApplyTriangleCommands(EditableStudioModel& studioModel, const std::vector<std::vector<short>>& commands)
+{
+	auto source = commands.begin();
+
+	for (auto model : GetAllModels(studioModel))
+	{
+		for (auto& mesh : model->Meshes)
+		{
+			mesh.Triangles = *source++;
+		}
+	}
+}
+
+std::vector<std::vector<std::vector<Animation>>> GetAnimations(const EditableStudioModel& studioModel)
+{
+	std::vector<std::vector<std::vector<Animation>>> animations;
+
+	animations.reserve(studioModel.Sequences.size());
+
+	for (const auto& sequence : studioModel.Sequences)
+	{
+		animations.push_back(sequence->AnimationBlends);
+	}
+
+	return animations;
+}
+
+void ApplyAnimations(EditableStudioModel& studioModel, const std::vector<std::vector<std::vector<Animation>>>& animations)
+{
+	for (std::size_t i = 0; i < studioModel.Sequences.size(); ++i)
+	{
+		studioModel.Sequences[i]->AnimationBlends = animations[i];
+	}
+}
+
+TextureSet GetTextureSet(const EditableStudioModel& studioModel)
+{
+	TextureSet textureSet;
+
+	textureSet.Textures.reserve(studioModel.Textures.size());
+
+	for (const auto& texture : studioModel.Textures)
+	{
+		auto& copy = textureSet.Textures.emplace_back(*texture);
+		copy.TextureId = 0;
+	}
+
+	for (const auto& family : studioModel.SkinFamilies)
+	{
+		auto& indices = textureSet.SkinFamilies.emplace_back();
+
+		indices.reserve(family.size());
+
+		for (const auto texture : family)
+		{
+			indices.push_back(texture->ArrayIndex);
+		}
+	}
+
+	for (auto model : GetAllModels(studioModel))
+	{
+		for (const auto& mesh : model->Meshes)
+		{
+			textureSet.SkinRefs.push_back(mesh.SkinRef);
+		}
+	}
+
+	return textureSet;
+}
+
+void ApplyTextureSet(EditableStudioModel& studioModel, const TextureSet& textureSet)
+{
+	auto& textures = studioModel.Textures;
+
+	//Keep the existing objects so their OpenGL textures can be reused
+	for (std::size_t i = textureSet.Textures.size(); i < textures.size(); ++i)
+	{
+		if (textures[i]->TextureId)
+		{
+			glDeleteTextures(1, &textures[i]->TextureId);
+		}
+	}
+
+	textures.resize(textureSet.Textures.size());
+
+	for (std::size_t i = 0; i < textures.size(); ++i)
+	{
+		if (!textures[i])
+		{
+			textures[i] = std::make_unique<Texture>();
+		}
+
+		auto& texture = *textures[i];
+
+		const auto& source = textureSet.Textures[i];
+
+		texture.Name = source.Name;
+		texture.Flags = source.Flags;
+		texture.Data = source.Data;
+		texture.ArrayIndex = static_cast<int>(i);
+	}
+
+	studioModel.SkinFamilies.clear();
+	studioModel.SkinFamilies.reserve(textureSet.SkinFamilies.size());
+
+	for (const auto& indices : textureSet.SkinFamilies)
+	{
+		auto& family = studioModel.SkinFamilies.emplace_back();
+
+		family.reserve(indices.size());
+
+		for (const int index : indices)
+		{
+			family.push_back(textures[index].get());
+		}
+	}
+
+	auto skinRef = textureSet.SkinRefs.begin();
+
+	for (auto model : GetAllModels(studioModel))
+	{
+		for (auto& mesh : model->Meshes)
+		{
+			mesh.SkinRef = *skinRef++;
 		}
 	}
 }
@@ -794,4 +1086,38 @@ void SortEventsList(std::vector<SequenceEvent*>& events)
 			return lhs->Frame < rhs->Frame;
 		});
 }
+
+std::size_t ReuseUnchangedTextures(EditableStudioModel& oldModel, EditableStudioModel& newModel)
+{
+	std::size_t reusedCount = 0;
+
+	for (auto& newTexture : newModel.Textures)
+	{
+		if (newTexture->TextureId)
+		{
+			continue;
+		}
+
+		const auto it = std::find_if(oldModel.Textures.begin(), oldModel.Textures.end(), [&](const auto& oldTexture)
+			{
+				return oldTexture->TextureId
+					&& oldTexture->Name == newTexture->Name
+					&& oldTexture->Flags == newTexture->Flags
+					&& oldTexture->Data.Width == newTexture->Data.Width
+					&& oldTexture->Data.Height == newTexture->Data.Height
+					&& oldTexture->Data.Pixels == newTexture->Data.Pixels
+					&& std::memcmp(oldTexture->Data.Palette.AsByteArray(), newTexture->Data.Palette.AsByteArray(),
+						newTexture->Data.Palette.GetSizeInBytes()) == 0;
+			});
+
+		if (it != oldModel.Textures.end())
+		{
+			newTexture->TextureId = (*it)->TextureId;
+			(*it)->TextureId = 0;
+			++reusedCount;
+		}
+	}
+
+	return reusedCount;
+}
 }
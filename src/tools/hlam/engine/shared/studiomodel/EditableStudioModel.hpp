@@ -63,6 +63,9 @@ struct Hitbox
 struct SequenceGroup
 {
 	std::string Label;
+
+	//Name of the file containing the group's animations, relative to the game directory. Empty for the main file
+	std::string Name;
 };
 
 struct SequenceEvent
@@ -130,6 +133,9 @@ struct Sequence
 	int NodeFlags = 0;
 
 	int NextSequence = 0;
+
+	//Group whose file contains this sequence's animations
+	int SequenceGroupIndex = 0;
 };
 
 struct Attachment
@@ -236,6 +242,9 @@ public:
 	std::vector<std::unique_ptr<Texture>> Textures;
 	std::vector<std::vector<Texture*>> SkinFamilies;
 
+	//Whether textures are stored in a separate texture file
+	bool HasExternalTextures = false;
+
 	//TODO: temporary until a better system can be put into place
 	bool TexturesNeedCreating = true;
 
@@ -264,6 +273,11 @@ public:
 
 	void ReuploadTextures(graphics::TextureLoader& textureLoader);
 
+	/**
+	*	@brief Deletes the OpenGL textures of all textures. The graphics context must be current.
+	*/
+	void DeleteTextures();
+
 	std::vector<int> GetRootBoneIndices() const
 	{
 		std::vector<int> bones;
@@ -445,5 +459,67 @@ std::pair<ScaleSTCoordinatesData, ScaleSTCoordinatesData> CalculateScaledSTCoord
 
 void ApplyScaledSTCoordinatesData(const EditableStudioModel& studioModel, const int textureIndex, const ScaleSTCoordinatesData& data);
 
+/**
+*	@brief Gets the normals of all models, in bodypart order.
+*/
+std::vector<glm::vec3> GetNormals(const EditableStudioModel& studioModel);
+
+/**
+*	@brief Sets the normals of all models to @p normals, as returned by GetNormals.
+*/
+void ApplyNormals(EditableStudioModel& studioModel, const std::vector<glm::vec3>& normals);
+
+/**
+*	@brief Gets the triangle commands of all meshes, in bodypart order.
+*/
+std::vector<std::vector<short>> GetTriangleCommands(const EditableStudioModel& studioModel);
+
+/**
+*	@brief Sets the triangle commands of all meshes to @p commands, as returned by GetTriangleCommands.
+*/
+void ApplyTriangleCommands(EditableStudioModel& studioModel, const std::vector<std::vector<short>>& commands);
+
+/**
+*	@brief Gets the animations of all sequences.
+*/
+std::vector<std::vector<std::vector<Animation>>> GetAnimations(const EditableStudioModel& studioModel);
+
+/**
+*	@brief Sets the animations of all sequences to @p animations, as returned by GetAnimations.
+*/
+void ApplyAnimations(EditableStudioModel& studioModel, const std::vector<std::vector<std::vector<Animation>>>& animations);
+
+/**
+*	@brief A copy of the textures of a model and of everything that refers to them by index.
+*/
+struct TextureSet
+{
+	//Copies never have OpenGL textures
+	std::vector<Texture> Textures;
+
+	//Indices into Textures for each skin family
+	std::vector<std::vector<int>> SkinFamilies;
+
+	//Skin references of all meshes, in bodypart order
+	std::vector<int> SkinRefs;
+};
+
+TextureSet GetTextureSet(const EditableStudioModel& studioModel);
+
+/**
+*	@brief Replaces the textures, skin families and mesh skin references with those in @p textureSet.
+*	OpenGL textures that are no longer needed are deleted, so the graphics context must be current.
+*	Textures that are kept need to be uploaded again, new textures need to be created.
+*/
+void ApplyTextureSet(EditableStudioModel& studioModel, const TextureSet& textureSet);
+
 void SortEventsList(std::vector<SequenceEvent*>& events);
+
+/**
+*	@brief Moves the OpenGL textures of textures that are identical in both models from @p oldModel to @p newModel,
+*	so they don't have to be uploaded again.
+*	Textures are matched by name and must have the same flags, dimensions, pixels and palette.
+*	@return Number of textures that were reused.
+*/
+std::size_t ReuseUnchangedTextures(EditableStudioModel& oldModel, EditableStudioModel& newModel);
 }
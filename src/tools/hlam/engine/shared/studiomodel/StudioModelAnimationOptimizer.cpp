@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+#include "engine/shared/studiomodel/StudioModelAnimationOptimizer.hpp"
+
+#include "utility/Parallel.hpp"
+
+namespace studiomdl
+{
+namespace
+{
+//Both counts in a span header are stored in a byte
+constexpr int MaxSpanLength = std::numeric_limits<std::uint8_t>::max();
+
+//The first 3 axes are positions, the others are rotations
+constexpr int FirstRotationAxis = 3;
+
+std::size_t GetAnimationSize(const std::vector<std::vector<Animation>>& blends)
+{
+	std::size_t size = 0;
+
+	for (const auto& blend : blends)
+	{
+		for (const auto& animation : blend)
+		{
+			size += sizeof(mstudioanim_t);
+
+			for (const auto& values : animation.Data)
+			{
+				size += values.size() * sizeof(mstudioanimvalue_t);
+			}
+		}
+	}
+
+	return size;
+}
+
+/**
+*	@brief Replaces runs of values that stay within @p tolerance of a single value with that value,
+*	which the encoder then stores as a single repeated value.
+*/
+void SnapRuns(std::vector<short>& values, int tolerance)
+{
+	if (tolerance <= 0)
+	{
+		return;
+	}
+
+	if (std::all_of(values.begin(), values.end(), [=](short value) { return std::abs(value) <= tolerance; }))
+	{
+		std::fill(values.begin(), values.end(), 0);
+		return;
+	}
+
+	for (std::size_t start = 0; start < values.size();)
+	{
+		int low = values[start];
+		int high = values[start];
+
+		std::size_t end = start + 1;
+
+		for (; end < values.size(); ++end)
+		{
+			const int newLow = std::min<int>(low, values[end]);
+			const int newHigh = std::max<int>(high, values[end]);
+
+			//Snapping to the middle of the range keeps every value within tolerance
+			if (newHigh - newLow > tolerance * 2)
+			{
+				break;
+			}
+
+			low = newLow;
+			high = newHigh;
+		}
+
+		if (end - start > 1)
+		{
+			std::fill(values.begin() + start, values.begin() + end, static_cast<short>(low + ((high - low) / 2)));
+		}
+
+		start = end;
+	}
+}
+
+SequenceOptimizationResult OptimizeSequence(const EditableStudioModel& studioModel, const Sequence& sequence,
+	const AnimationOptimizerSettings& settings, std::vector<std::vector<Animation>>& result)
+{
+	SequenceOptimizationResult stats;
+
+	stats.Label = sequence.Label;
+
+	result = sequence.AnimationBlends;
+
+	std::vector<short> oldValues;
+	std::vector<short> newValues;
+
+	for (auto& blend : result)
+	{
+		const std::size_t boneCount = std::min(blend.size(), studioModel.Bones.size());
+
+		for (std::size_t bone = 0; bone < boneCount; ++bone)
+		{
+			for (int axis = 0; axis < STUDIO_NUM_COORDINATE_AXES; ++axis)
+			{
+				auto& data = blend[bone].Data[axis];
+
+				//Leave data that can't be decoded as it is
+				if (!DecodeAnimationValues(data, sequence.NumFrames, oldValues))
+				{
+					continue;
+				}
+
+				newValues = oldValues;
+
+				const float scale = std::abs(studioModel.Bones[bone]->Axes[axis].Scale);
+				const bool isRotation = axis >= FirstRotationAxis;
+
+				//Values have no effect when their scale is 0
+				if (scale == 0)
+				{
+					std::fill(newValues.begin(), newValues.end(), 0);
+				}
+				else
+				{
+					const float tolerance = isRotation ? settings.RotationTolerance : settings.PositionTolerance;
+
+					SnapRuns(newValues, static_cast<int>(std::min(tolerance / scale, static_cast<float>(std::numeric_limits<short>::max()))));
+				}
+
+				int maxDifference = 0;
+
+				for (std::size_t frame = 0; frame < oldValues.size(); ++frame)
+				{
+					maxDifference = std::max(maxDifference, std::abs(newValues[frame] - oldValues[frame]));
+				}
+
+				auto encoded = EncodeAnimationValues(newValues);
+
+				//Only accept changes, including lossy ones, if they make the data smaller
+				if (encoded.size() >= data.size())
+				{
+					continue;
+				}
+
+				data = std::move(encoded);
+
+				auto& maxError = isRotation ? stats.MaxRotationError : stats.MaxPositionError;
+
+				maxError = std::max(maxError, maxDifference * scale);
+			}
+		}
+	}
+
+	stats.OldSize = GetAnimationSize(sequence.AnimationBlends);
+	stats.NewSize = GetAnimationSize(result);
+
+	return stats;
+}
+}
+
+bool DecodeAnimationValues(const std::vector<mstudioanimvalue_t>& data, int frameCount, std::vector<short>& values)
+{
+	values.clear();
+
+	if (data.empty())
+	{
+		values.resize(std::max(0, frameCount), 0);
+		return true;
+	}
+
+	values.reserve(frameCount);
+
+	for (std::size_t index = 0; static_cast<int>(values.size()) < frameCount;)
+	{
+		if (index >= data.size())
+		{
+			return false;
+		}
+
+		const int valid = data[index].num.valid;
+		const int total = data[index].num.total;
+
+		if (valid == 0 || total == 0 || index + valid >= data.size())
+		{
+			return false;
+		}
+
+		//Frames past the valid values repeat the last one
+		for (int frame = 0; frame < total && static_cast<int>(values.size()) < frameCount; ++frame)
+		{
+			values.push_back(data[index + 1 + std::min(frame, valid - 1)].value);
+		}
+
+		index += valid + 1;
+	}
+
+	return true;
+}
+
+std::vector<mstudioanimvalue_t> EncodeAnimationValues(const std::vector<short>& values)
+{
+	std::vector<mstudioanimvalue_t> data;
+
+	if (std::all_of(values.begin(), values.end(), [](short value) { return value == 0; }))
+	{
+		return data;
+	}
+
+	//Each span stores distinct values followed by a number of repeats of the last one,
+	//so a repeated value ends the list of distinct values
+	std::size_t span = 0;
+
+	const auto addValue = [&](short value)
+	{
+		mstudioanimvalue_t animValue;
+		animValue.value = value;
+		data.push_back(animValue);
+	};
+
+	for (std::size_t frame = 0; frame < values.size(); ++frame)
+	{
+		const bool repeats = frame > 0 && values[frame] == values[frame - 1];
+
+		if (data.empty()
+			|| data[span].num.total == MaxSpanLength
+			|| (!repeats && data[span].num.valid != data[span].num.total))
+		{
+			span = data.size();
+
+			mstudioanimvalue_t header;
+			header.num.valid = 1;
+			header.num.total = 1;
+			data.push_back(header);
+
+			addValue(values[frame]);
+		}
+		else if (repeats)
+		{
+			++data[span].num.total;
+		}
+		else
+		{
+			++data[span].num.valid;
+			++data[span].num.total;
+
+			addValue(values[frame]);
+		}
+	}
+
+	return data;
+}
+
+AnimationOptimizationResult OptimizeAnimations(const EditableStudioModel& studioModel, const AnimationOptimizerSettings& settings)
+{
+	AnimationOptimizationResult result;
+
+	result.Animations.resize(studioModel.Sequences.size());
+	result.Sequences.resize(studioModel.Sequences.size());
+
+	RunInParallel(studioModel.Sequences.size(), [&](std::size_t index)
+		{
+			result.Sequences[index] = OptimizeSequence(studioModel, *studioModel.Sequences[index], settings, result.Animations[index]);
+		});
+
+	for (const auto& sequence : result.Sequences)
+	{
+		result.OldSize += sequence.OldSize;
+		result.NewSize += sequence.NewSize;
+	}
+
+	return result;
+}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+
+namespace studiomdl
+{
+struct AnimationOptimizerSettings
+{
+	//Largest change allowed in a bone position, in units. 0 keeps positions exact
+	float PositionTolerance = 0;
+
+	//Largest change allowed in a bone rotation, in radians. 0 keeps rotations exact
+	float RotationTolerance = 0;
+};
+
+struct SequenceOptimizationResult
+{
+	std::string Label;
+
+	std::size_t OldSize = 0;
+	std::size_t NewSize = 0;
+
+	//Largest difference in any bone position or rotation on any frame
+	float MaxPositionError = 0;
+	float MaxRotationError = 0;
+};
+
+struct AnimationOptimizationResult
+{
+	//New animations for every sequence, laid out like Sequence::AnimationBlends
+	std::vector<std::vector<std::vector<Animation>>> Animations;
+
+	std::vector<SequenceOptimizationResult> Sequences;
+
+	std::size_t OldSize = 0;
+	std::size_t NewSize = 0;
+};
+
+/**
+*	@brief Decodes the first @p frameCount values of a bone axis.
+*	@return Whether @p data is valid and covers that many frames.
+*/
+bool DecodeAnimationValues(const std::vector<mstudioanimvalue_t>& data, int frameCount, std::vector<short>& values);
+
+/**
+*	@brief Run-length encodes one value per frame as compactly as the format allows.
+*	Axes that are 0 on every frame need no data at all.
+*/
+std::vector<mstudioanimvalue_t> EncodeAnimationValues(const std::vector<short>& values);
+
+/**
+*	@brief Re-encodes the animations of all sequences, optionally changing values within the tolerances in @p settings
+*	so they compress better. Use ApplyAnimations to change the model.
+*/
+AnimationOptimizationResult OptimizeAnimations(const EditableStudioModel& studioModel, const AnimationOptimizerSettings& settings = {});
+}
@@ -0,0 +1,709 @@
+#include <algorithm>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <glm/gtx/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include "assets/AssetIO.hpp"
+
+#include "engine/shared/activity.hpp"
+
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+#include "engine/shared/studiomodel/StudioModelDecompiler.hpp"
+#include "engine/shared/studiomodel/StudioModelUtils.hpp"
+
+#include "graphics/BMPFile.hpp"
+
+#include "utility/IOUtils.hpp"
+#include "utility/mathlib.hpp"
+#include "utility/Parallel.hpp"
+#include "utility/Platform.hpp"
+
+namespace studiomdl
+{
+namespace
+{
+//Studiomdl rotates the root bones of all animations by this much unless told otherwise
+constexpr float DefaultZRotation = PI<float> / 2;
+
+/**
+*	@brief Appends formatted text to a buffer. Files are built in memory and written at once.
+*/
+void Append(std::string& buffer, const char* format, ...)
+{
+	char line[1024];
+
+	va_list list;
+
+	va_start(list, format);
+	const int length = vsnprintf(line, sizeof(line), format, list);
+	va_end(list);
+
+	if (length > 0)
+	{
+		buffer.append(line, std::min<std::size_t>(length, sizeof(line) - 1));
+	}
+}
+
+void WriteFile(const std::filesystem::path& fileName, const std::string& contents)
+{
+	const std::string utf8FileName{fileName.u8string()};
+
+	FILE* file = utf8_fopen(utf8FileName.c_str(), "wb");
+
+	if (!file)
+	{
+		throw assets::AssetException(std::string{"Could not open file \""} + utf8FileName + "\" for writing");
+	}
+
+	const bool success = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+
+	fclose(file);
+
+	if (!success)
+	{
+		throw assets::AssetException(std::string{"Error writing to file \""} + utf8FileName + "\"");
+	}
+}
+
+/**
+*	@brief Makes a name usable as a file name, and unique among the names in @p usedNames.
+*/
+std::string MakeUniqueFileName(std::string name, const char* extension, std::set<std::string>& usedNames)
+{
+	//Names of models often include the extension of the file they were compiled from
+	if (const std::string suffix{extension}; name.size() > suffix.size()
+		&& strcasecmp(name.c_str() + name.size() - suffix.size(), suffix.c_str()) == 0)
+	{
+		name.resize(name.size() - suffix.size());
+	}
+
+	for (auto& c : name)
+	{
+		if (static_cast<unsigned char>(c) < ' ' || std::string_view{"\\/:*?\"<>| "}.find(c) != std::string_view::npos)
+		{
+			c = '_';
+		}
+	}
+
+	if (name.empty())
+	{
+		name = "unnamed";
+	}
+
+	std::string uniqueName = name;
+
+	for (int suffix = 1; !usedNames.insert(uniqueName).second; ++suffix)
+	{
+		uniqueName = name + '_' + std::to_string(suffix);
+	}
+
+	return uniqueName;
+}
+
+void AppendNodes(std::string& buffer, const EditableStudioModel& model)
+{
+	buffer += "version 1\nnodes\n";
+
+	for (const auto& bone : model.Bones)
+	{
+		Append(buffer, "%d \"%s\" %d\n", bone->ArrayIndex, bone->Name.c_str(), bone->Parent ? bone->Parent->ArrayIndex : -1);
+	}
+
+	buffer += "end\n";
+}
+
+/**
+*	@brief Gets the value of an animation axis at a frame, without interpolation.
+*/
+short GetAnimationValue(const std::vector<mstudioanimvalue_t>& values, int frame)
+{
+	if (values.empty())
+	{
+		return 0;
+	}
+
+	auto animValue = values.data();
+
+	while (animValue->num.total <= frame)
+	{
+		frame -= animValue->num.total;
+		animValue += animValue->num.valid + 1;
+	}
+
+	if (animValue->num.valid > frame)
+	{
+		return animValue[frame + 1].value;
+	}
+
+	return animValue[animValue->num.valid].value;
+}
+
+/**
+*	@brief Writes the reference mesh of a model, posed using the default values of each bone.
+*/
+std::string WriteReferenceMesh(const EditableStudioModel& studioModel, const Model& model)
+{
+	std::string buffer;
+
+	buffer.reserve(model.Meshes.size() * 4096);
+
+	AppendNodes(buffer, studioModel);
+
+	buffer += "skeleton\ntime 0\n";
+
+	std::vector<glm::mat4> boneTransforms(studioModel.Bones.size());
+
+	//Bones are always ordered so parents come before children
+	for (const auto& bone : studioModel.Bones)
+	{
+		const glm::vec3 position{bone->Axes[0].Value, bone->Axes[1].Value, bone->Axes[2].Value};
+		const glm::vec3 rotation{bone->Axes[3].Value, bone->Axes[4].Value, bone->Axes[5].Value};
+
+		Append(buffer, "%d %f %f %f %f %f %f\n", bone->ArrayIndex,
+			position.x, position.y, position.z, rotation.x, rotation.y, rotation.z);
+
+		const auto transform = glm::translate(position) * glm::toMat4(glm::quat{rotation});
+
+		boneTransforms[bone->ArrayIndex] = bone->Parent ? boneTransforms[bone->Parent->ArrayIndex] * transform : transform;
+	}
+
+	buffer += "end\ntriangles\n";
+
+	struct Vertex
+	{
+		int Bone;
+		glm::vec3 Position;
+		glm::vec3 Normal;
+		float U, V;
+	};
+
+	for (const auto& mesh : model.Meshes)
+	{
+		const Texture* texture = nullptr;
+
+		const auto skinRef = static_cast<std::size_t>(mesh.SkinRef);
+
+		if (mesh.SkinRef >= 0 && !studioModel.SkinFamilies.empty() && skinRef < studioModel.SkinFamilies[0].size())
+		{
+			texture = studioModel.SkinFamilies[0][skinRef];
+		}
+		else if (mesh.SkinRef >= 0 && skinRef < studioModel.Textures.size())
+		{
+			texture = studioModel.Textures[skinRef].get();
+		}
+
+		const std::string textureName = texture ? texture->Name : "default.bmp";
+		const float width = texture ? std::max(1, texture->Data.Width) : 1;
+		const float height = texture ? std::max(1, texture->Data.Height) : 1;
+
+		const auto getVertex = [&](const short* command)
+		{
+			const auto& vertex = model.Vertices[command[0]];
+			const auto& normal = model.Normals[command[1]];
+
+			const auto& vertexTransform = boneTransforms[vertex.Bone->ArrayIndex];
+			const auto& normalTransform = boneTransforms[normal.Bone->ArrayIndex];
+
+			return Vertex{
+				vertex.Bone->ArrayIndex,
+				glm::vec3{vertexTransform * glm::vec4{vertex.Vertex, 1}},
+				glm::normalize(glm::vec3{normalTransform * glm::vec4{normal.Vertex, 0}}),
+				command[2] / width,
+				1.f - (command[3] / height)};
+		};
+
+		//Studiomdl reverses the winding order of triangles when it reads them
+		const auto appendTriangle = [&](const Vertex& first, const Vertex& second, const Vertex& third)
+		{
+			buffer += textureName;
+			buffer += '\n';
+
+			for (const auto& vertex : {third, second, first})
+			{
+				Append(buffer, "%d %f %f %f %f %f %f %f %f\n", vertex.Bone,
+					vertex.Position.x, vertex.Position.y, vertex.Position.z,
+					vertex.Normal.x, vertex.Normal.y, vertex.Normal.z,
+					vertex.U, vertex.V);
+			}
+		};
+
+		auto commands = mesh.Triangles.data();
+
+		for (int count; (count = *(commands++)) != 0;)
+		{
+			std::vector<Vertex> vertices;
+
+			const bool isFan = count < 0;
+
+			count = std::abs(count);
+
+			vertices.reserve(count);
+
+			for (; count > 0; --count, commands += 4)
+			{
+				vertices.push_back(getVertex(commands));
+			}
+
+			for (std::size_t i = 2; i < vertices.size(); ++i)
+			{
+				if (isFan)
+				{
+					appendTriangle(vertices[0], vertices[i - 1], vertices[i]);
+				}
+				else if (i % 2)
+				{
+					appendTriangle(vertices[i - 1], vertices[i - 2], vertices[i]);
+				}
+				else
+				{
+					appendTriangle(vertices[i - 2], vertices[i - 1], vertices[i]);
+				}
+			}
+		}
+	}
+
+	buffer += "end\n";
+
+	return buffer;
+}
+
+/**
+*	@brief Writes one blend of a sequence.
+*/
+std::string WriteAnimation(const EditableStudioModel& studioModel, const Sequence& sequence, const std::vector<Animation>& animations)
+{
+	std::string buffer;
+
+	buffer.reserve(static_cast<std::size_t>(sequence.NumFrames) * studioModel.Bones.size() * 64 + 1024);
+
+	AppendNodes(buffer, studioModel);
+
+	buffer += "skeleton\n";
+
+	const float cz = std::cos(-DefaultZRotation);
+	const float sz = std::sin(-DefaultZRotation);
+
+	for (int frame = 0; frame < sequence.NumFrames; ++frame)
+	{
+		Append(buffer, "time %d\n", frame);
+
+		for (const auto& bone : studioModel.Bones)
+		{
+			const auto& animation = animations[bone->ArrayIndex];
+
+			std::array<float, STUDIO_NUM_COORDINATE_AXES> values;
+
+			for (std::size_t axis = 0; axis < values.size(); ++axis)
+			{
+				values[axis] = bone->Axes[axis].Value + GetAnimationValue(animation.Data[axis], frame) * bone->Axes[axis].Scale;
+			}
+
+			glm::vec3 position{values[0], values[1], values[2]};
+			glm::vec3 rotation{values[3], values[4], values[5]};
+
+			if (!bone->Parent)
+			{
+				//Restore the movement that was extracted from the root bones
+				if (sequence.NumFrames > 1)
+				{
+					position += sequence.LinearMovement * (static_cast<float>(frame) / (sequence.NumFrames - 1));
+				}
+
+				//Undo the default rotation
+				position = glm::vec3{cz * position.x - sz * position.y, sz * position.x + cz * position.y, position.z};
+				rotation.z -= DefaultZRotation;
+			}
+
+			Append(buffer, "%d %f %f %f %f %f %f\n", bone->ArrayIndex,
+				position.x, position.y, position.z, rotation.x, rotation.y, rotation.z);
+		}
+	}
+
+	buffer += "end\n";
+
+	return buffer;
+}
+
+const char* GetActivityName(int activity)
+{
+	for (const auto& entry : activity_map)
+	{
+		if (entry.name && entry.type == activity)
+		{
+			return entry.name;
+		}
+	}
+
+	return nullptr;
+}
+
+void AppendControls(std::string& buffer, int controls)
+{
+	for (int bit = 1; bit <= STUDIO_TYPES; bit <<= 1)
+	{
+		if (const auto name = ControlToString(controls & bit); name)
+		{
+			Append(buffer, " %s", name);
+		}
+	}
+}
+
+const char* GetRenderModeName(int flag)
+{
+	switch (flag)
+	{
+	case STUDIO_NF_FLATSHADE: return "flatshade";
+	case STUDIO_NF_FULLBRIGHT: return "fullbright";
+	case STUDIO_NF_ADDITIVE: return "additive";
+	case STUDIO_NF_MASKED: return "masked";
+	default: return nullptr;
+	}
+}
+
+struct SequenceFiles
+{
+	const Sequence* SourceSequence;
+	std::vector<std::string> FileNames;
+};
+
+std::string WriteQC(const EditableStudioModel& model, const std::string& modelName,
+	const std::vector<std::string>& meshFileNames, const std::vector<SequenceFiles>& sequenceFiles)
+{
+	std::string buffer;
+
+	Append(buffer, "/*\nQC file generated by Half-Life Asset Manager\n*/\n\n");
+
+	Append(buffer, "$modelname \"%s.mdl\"\n", modelName.c_str());
+	buffer += "$cd \".\"\n";
+	buffer += "$cdtexture \".\"\n";
+	buffer += "$scale 1.0\n";
+
+	//Studiomdl rotates the eye position the same way it rotates root bones
+	Append(buffer, "$eyeposition %f %f %f\n", model.EyePosition.y, -model.EyePosition.x, model.EyePosition.z);
+
+	Append(buffer, "$bbox %f %f %f %f %f %f\n",
+		model.BoundingMin.x, model.BoundingMin.y, model.BoundingMin.z, model.BoundingMax.x, model.BoundingMax.y, model.BoundingMax.z);
+
+	Append(buffer, "$cbox %f %f %f %f %f %f\n",
+		model.ClippingMin.x, model.ClippingMin.y, model.ClippingMin.z, model.ClippingMax.x, model.ClippingMax.y, model.ClippingMax.z);
+
+	if (model.Flags != 0)
+	{
+		Append(buffer, "$flags %d\n", model.Flags);
+	}
+
+	buffer += '\n';
+
+	{
+		std::size_t meshIndex = 0;
+
+		for (const auto& bodypart : model.Bodyparts)
+		{
+			if (bodypart->Models.size() == 1 && !bodypart->Models.front().Meshes.empty())
+			{
+				Append(buffer, "$body \"%s\" \"%s\"\n", bodypart->Name.c_str(), meshFileNames[meshIndex++].c_str());
+				continue;
+			}
+
+			Append(buffer, "$bodygroup \"%s\"\n{\n", bodypart->Name.c_str());
+
+			for (const auto& submodel : bodypart->Models)
+			{
+				if (submodel.Meshes.empty())
+				{
+					buffer += "\tblank\n";
+					++meshIndex;
+				}
+				else
+				{
+					Append(buffer, "\tstudio \"%s\"\n", meshFileNames[meshIndex++].c_str());
+				}
+			}
+
+			buffer += "}\n";
+		}
+	}
+
+	buffer += '\n';
+
+	for (const auto& texture : model.Textures)
+	{
+		for (int flag = 1; flag <= STUDIO_NF_MASKED; flag <<= 1)
+		{
+			if (const auto mode = GetRenderModeName(texture->Flags & flag); mode)
+			{
+				Append(buffer, "$texrendermode \"%s\" %s\n", texture->Name.c_str(), mode);
+			}
+		}
+	}
+
+	//Only textures that differ between skin families are part of the texture group
+	if (model.SkinFamilies.size() > 1)
+	{
+		std::vector<std::size_t> columns;
+
+		for (std::size_t column = 0; column < model.SkinFamilies[0].size(); ++column)
+		{
+			for (const auto& family : model.SkinFamilies)
+			{
+				if (family[column] != model.SkinFamilies[0][column])
+				{
+					columns.push_back(column);
+					break;
+				}
+			}
+		}
+
+		if (!columns.empty())
+		{
+			buffer += "\n$texturegroup \"skinfamilies\"\n{\n";
+
+			for (const auto& family : model.SkinFamilies)
+			{
+				buffer += "\t{";
+
+				for (const auto column : columns)
+				{
+					Append(buffer, " \"%s\"", family[column]->Name.c_str());
+				}
+
+				buffer += " }\n";
+			}
+
+			buffer += "}\n";
+		}
+	}
+
+	buffer += '\n';
+
+	for (const auto& controller : model.BoneControllers)
+	{
+		const Bone* controlledBone = nullptr;
+		int type = controller->Type & STUDIO_TYPES;
+
+		for (const auto& bone : model.Bones)
+		{
+			for (const auto& axis : bone->Axes)
+			{
+				if (axis.Controller == controller.get())
+				{
+					controlledBone = bone.get();
+				}
+			}
+		}
+
+		if (!controlledBone)
+		{
+			continue;
+		}
+
+		//Studiomdl sets the looping flag itself based on the range
+		if (controller->Index == STUDIO_MOUTH_CONTROLLER)
+		{
+			Append(buffer, "$controller mouth \"%s\"", controlledBone->Name.c_str());
+		}
+		else
+		{
+			Append(buffer, "$controller %d \"%s\"", controller->Index, controlledBone->Name.c_str());
+		}
+
+		AppendControls(buffer, type);
+
+		Append(buffer, " %f %f\n", controller->Start, controller->End);
+	}
+
+	for (const auto& hitbox : model.Hitboxes)
+	{
+		Append(buffer, "$hbox %d \"%s\" %f %f %f %f %f %f\n", hitbox->Group, hitbox->Bone->Name.c_str(),
+			hitbox->Min.x, hitbox->Min.y, hitbox->Min.z, hitbox->Max.x, hitbox->Max.y, hitbox->Max.z);
+	}
+
+	for (std::size_t i = 0; i < model.Attachments.size(); ++i)
+	{
+		const auto& attachment = *model.Attachments[i];
+
+		Append(buffer, "$attachment %d \"%s\" %f %f %f\n", static_cast<int>(i), attachment.Bone->Name.c_str(),
+			attachment.Origin.x, attachment.Origin.y, attachment.Origin.z);
+	}
+
+	buffer += '\n';
+
+	for (const auto& files : sequenceFiles)
+	{
+		const auto& sequence = *files.SourceSequence;
+
+		Append(buffer, "$sequence \"%s\"", sequence.Label.c_str());
+
+		for (const auto& fileName : files.FileNames)
+		{
+			Append(buffer, " \"%s\"", fileName.c_str());
+		}
+
+		Append(buffer, " fps %g", sequence.FPS);
+
+		if (sequence.Flags & STUDIO_LOOPING)
+		{
+			buffer += " loop";
+		}
+
+		if (const auto activityName = GetActivityName(sequence.Activity); activityName)
+		{
+			Append(buffer, " %s %d", activityName, sequence.ActivityWeight);
+		}
+
+		if (files.FileNames.size() > 1)
+		{
+			for (const auto& blend : sequence.BlendData)
+			{
+				if (const auto name = ControlToString(blend.Type & STUDIO_TYPES); name)
+				{
+					Append(buffer, " blend %s %f %f", name, blend.Start, blend.End);
+				}
+			}
+		}
+
+		AppendControls(buffer, sequence.MotionType);
+
+		if (sequence.EntryNode != 0 || sequence.ExitNode != 0)
+		{
+			if (sequence.EntryNode == sequence.ExitNode)
+			{
+				Append(buffer, " node %d", sequence.EntryNode);
+			}
+			else
+			{
+				Append(buffer, " %s %d %d", (sequence.NodeFlags & 1) ? "rtransition" : "transition", sequence.EntryNode, sequence.ExitNode);
+			}
+		}
+
+		for (std::size_t i = 0; i < sequence.Pivots.size(); ++i)
+		{
+			const auto& pivot = sequence.Pivots[i];
+			Append(buffer, " pivot %d %d %d", static_cast<int>(i), pivot.Start, pivot.End);
+		}
+
+		if (!sequence.SortedEvents.empty())
+		{
+			buffer += "\n{\n";
+
+			for (const auto event : sequence.SortedEvents)
+			{
+				Append(buffer, "\t{ event %d %d", event->EventId, event->Frame);
+
+				if (!event->Options.empty())
+				{
+					Append(buffer, " \"%s\"", event->Options.c_str());
+				}
+
+				buffer += " }\n";
+			}
+
+			buffer += "}";
+		}
+
+		buffer += '\n';
+	}
+
+	return buffer;
+}
+}
+
+void DecompileStudioModel(const EditableStudioModel& model, const std::filesystem::path& directory, const std::string& modelName)
+{
+	if (std::error_code error; !std::filesystem::create_directories(directory, error) && error)
+	{
+		throw assets::AssetException(std::string{"Could not create directory \""} + directory.u8string() + "\": " + error.message());
+	}
+
+	std::set<std::string> usedFileNames;
+
+	//Assign file names up front so the files can be written in any order
+	std::vector<const Model*> meshes;
+	std::vector<std::string> meshFileNames;
+
+	for (const auto& bodypart : model.Bodyparts)
+	{
+		for (const auto& submodel : bodypart->Models)
+		{
+			meshes.push_back(&submodel);
+			meshFileNames.push_back(submodel.Meshes.empty() ? std::string{} : MakeUniqueFileName(submodel.Name, ".smd", usedFileNames));
+		}
+	}
+
+	struct AnimationFile
+	{
+		const Sequence* SourceSequence;
+		const std::vector<Animation>* Animations;
+		std::string FileName;
+	};
+
+	std::vector<AnimationFile> animationFiles;
+	std::vector<SequenceFiles> sequenceFiles;
+
+	for (const auto& sequence : model.Sequences)
+	{
+		SequenceFiles files{sequence.get(), {}};
+
+		for (std::size_t blend = 0; blend < sequence->AnimationBlends.size(); ++blend)
+		{
+			const std::string name = sequence->AnimationBlends.size() > 1
+				? sequence->Label + "_blend" + std::to_string(blend + 1) : sequence->Label;
+
+			auto fileName = MakeUniqueFileName(name, ".smd", usedFileNames);
+
+			files.FileNames.push_back(fileName);
+			animationFiles.push_back({sequence.get(), &sequence->AnimationBlends[blend], std::move(fileName)});
+		}
+
+		sequenceFiles.push_back(std::move(files));
+	}
+
+	//Every mesh, animation and texture is written by a separate task
+	const std::size_t taskCount = meshes.size() + animationFiles.size() + model.Textures.size();
+
+	RunInParallel(taskCount, [&](std::size_t index)
+		{
+			if (index < meshes.size())
+			{
+				if (!meshFileNames[index].empty())
+				{
+					WriteFile(directory / std::filesystem::u8path(meshFileNames[index] + ".smd"), WriteReferenceMesh(model, *meshes[index]));
+				}
+
+				return;
+			}
+
+			index -= meshes.size();
+
+			if (index < animationFiles.size())
+			{
+				const auto& file = animationFiles[index];
+				WriteFile(directory / std::filesystem::u8path(file.FileName + ".smd"), WriteAnimation(model, *file.SourceSequence, *file.Animations));
+				return;
+			}
+
+			index -= animationFiles.size();
+
+			const auto& texture = *model.Textures[index];
+
+			const auto fileName = (directory / std::filesystem::u8path(texture.Name)).u8string();
+
+			if (!graphics::bmpfile::SaveBMPFile(fileName.c_str(), texture.Data.Width, texture.Data.Height,
+				reinterpret_cast<const std::uint8_t*>(texture.Data.Pixels.data()),
+				reinterpret_cast<const std::uint8_t*>(texture.Data.Palette.Data.data())))
+			{
+				throw assets::AssetException(std::string{"Could not write texture \""} + fileName + "\"");
+			}
+		});
+
+	WriteFile(directory / std::filesystem::u8path(modelName + ".qc"), WriteQC(model, modelName, meshFileNames, sequenceFiles));
+}
+}
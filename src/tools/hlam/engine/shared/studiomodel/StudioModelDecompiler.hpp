@@ -0,0 +1,25 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+namespace studiomdl
+{
+class EditableStudioModel;
+
+/**
+*	@brief Writes a QC file, reference and animation SMD files and textures that compile back into @p model.
+*
+*	<pre>
+*	Studiomdl rotates root bones in animations by 90 degrees and extracts linear movement,
+*	both are undone so the animation files match what the compiler expects as input.
+*	Each animation and texture is written on its own thread, with each file built in memory and written at once.
+*	</pre>
+*
+*	@param model Model to decompile.
+*	@param directory Directory to write all files to. Created if it doesn't exist.
+*	@param modelName Name of the QC file and the model it compiles to, without extension.
+*	@exception assets::AssetException If a file could not be written.
+*/
+void DecompileStudioModel(const EditableStudioModel& model, const std::filesystem::path& directory, const std::string& modelName);
+}
@@ -447,8 +447,8 @@ struct studiohdr_t
 	int			numtransitions;		// animation node to animation node transition graph
 	int			transitionindex;
 
-	const	std::uint8_t* GetTransitions() const { return reinterpret_cast<const std::uint8_t*>(GetData() + attachmentindex); }
-	std::uint8_t* GetTransitions() { return reinterpret_cast<std::uint8_t*>(GetData() + attachmentindex); }
+	const	std::uint8_t* GetTransitions() const { return reinterpret_cast<const std::uint8_t*>(GetData() + transitionindex); }
+	std::uint8_t* GetTransitions() { return reinterpret_cast<std::uint8_t*>(GetData() + transitionindex); }
 
 	const	std::uint8_t* GetTransition(const int iIndex) const { return GetTransitions() + iIndex; }
 	std::uint8_t* GetTransition(const int iIndex) { return GetTransitions() + iIndex; }
@@ -0,0 +1,532 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "engine/shared/studiomodel/StudioModelAnimationOptimizer.hpp"
+#include "engine/shared/studiomodel/StudioModelGenerator.hpp"
+
+#include "utility/Parallel.hpp"
+#include "utility/Random.hpp"
+
+namespace studiomdl
+{
+namespace
+{
+//Space between the grids of bodyparts, so they don't overlap
+constexpr float BodypartSpacing = 8;
+
+/**
+*	@brief Gets the largest size in bytes that the encoded values of one axis can have.
+*	Every frame stores at most one value and every span but the last covers at least 2 frames.
+*/
+long long GetMaxAxisSize(int frames)
+{
+	return (static_cast<long long>(frames) + (frames / 2) + 1) * sizeof(mstudioanimvalue_t);
+}
+
+/**
+*	@brief Whether the animations of a sequence are guaranteed to fit in the file format,
+*	whose offsets to bone values are unsigned shorts relative to the mstudioanim_t that uses them.
+*/
+bool AnimationFits(int bones, int blends, int frames)
+{
+	const long long axes = static_cast<long long>(bones) * blends * STUDIO_NUM_COORDINATE_AXES;
+
+	//The values of the last axis follow the offsets of the last bone, up to 3 bytes of padding and the values of all other axes
+	const long long lastOffset = sizeof(mstudioanim_t) + 3 + ((axes - 1) * GetMaxAxisSize(frames));
+
+	return lastOffset <= std::numeric_limits<unsigned short>::max();
+}
+
+/**
+*	@brief Clamps every setting to what the file format and renderer allow.
+*/
+GeneratorSettings ClampSettings(GeneratorSettings settings)
+{
+	settings.Bones = std::clamp(settings.Bones, 1, static_cast<int>(MAXSTUDIOBONES));
+
+	//Each controller rotates a different axis of a bone
+	settings.BoneControllers = std::clamp(settings.BoneControllers, 0, std::min(ControllerCount, settings.Bones * 3));
+	settings.Attachments = std::max(0, settings.Attachments);
+	settings.Hitboxes = std::clamp(settings.Hitboxes, 0, settings.Bones);
+
+	settings.Bodyparts = std::clamp(settings.Bodyparts, 1, static_cast<int>(MAXSTUDIOBODYPARTS));
+	settings.ModelsPerBodypart = std::clamp(settings.ModelsPerBodypart, 1, static_cast<int>(MAXSTUDIOMODELS));
+	settings.VerticesPerModel = std::clamp(settings.VerticesPerModel, 4, MaxGeneratedVerticesPerModel);
+	settings.MeshesPerModel = std::clamp(settings.MeshesPerModel, 1, static_cast<int>(MAXSTUDIOMESHES));
+
+	settings.Sequences = std::clamp(settings.Sequences, 1, static_cast<int>(MAXSTUDIOSEQUENCES));
+
+	//Limit the frames so a single blend fits, then use fewer blends if they don't all fit
+	const int maxAxisValues = static_cast<int>(std::numeric_limits<unsigned short>::max()
+		/ ((settings.Bones * STUDIO_NUM_COORDINATE_AXES - 1) * sizeof(mstudioanimvalue_t)));
+	settings.FramesPerSequence = std::clamp(settings.FramesPerSequence, 1, std::max(1, (maxAxisValues * 2) / 3));
+
+	while (settings.FramesPerSequence > 1 && !AnimationFits(settings.Bones, 1, settings.FramesPerSequence))
+	{
+		--settings.FramesPerSequence;
+	}
+
+	settings.BlendsPerSequence = settings.BlendsPerSequence >= MaxGeneratedBlends ? MaxGeneratedBlends : std::clamp(settings.BlendsPerSequence, 1, 2);
+
+	if (settings.BlendsPerSequence == MaxGeneratedBlends && !AnimationFits(settings.Bones, MaxGeneratedBlends, settings.FramesPerSequence))
+	{
+		settings.BlendsPerSequence = 2;
+	}
+
+	if (settings.BlendsPerSequence == 2 && !AnimationFits(settings.Bones, 2, settings.FramesPerSequence))
+	{
+		settings.BlendsPerSequence = 1;
+	}
+
+	settings.EventsPerSequence = std::clamp(settings.EventsPerSequence, 0, static_cast<int>(MAXSTUDIOEVENTS));
+
+	//Groups without sequences would be empty files
+	settings.SequenceGroups = std::clamp(settings.SequenceGroups, 1, std::min(static_cast<int>(MAXSTUDIOGROUPS), settings.Sequences));
+
+	settings.Textures = std::clamp(settings.Textures, 1, static_cast<int>(MAXSTUDIOSKINS));
+
+	//Texture coordinates are stored as shorts
+	settings.TextureWidth = std::clamp(settings.TextureWidth, 1, static_cast<int>(std::numeric_limits<short>::max()));
+	settings.TextureHeight = std::clamp(settings.TextureHeight, 1, static_cast<int>(std::numeric_limits<short>::max()));
+	settings.SkinFamilies = std::clamp(settings.SkinFamilies, 1, static_cast<int>(MAXSTUDIOSKINS));
+
+	return settings;
+}
+
+std::vector<mstudioanimvalue_t> GenerateAxis(Random& random, int frameCount)
+{
+	//Like real animations, many axes don't move at all
+	if (random.Next(0, 1) == 0)
+	{
+		return {};
+	}
+
+	const double amplitude = random.NextDouble(100, 2000);
+	const double phase = random.NextDouble(0, 6.28);
+	const double frequency = random.NextDouble(0.05, 0.3);
+
+	std::vector<short> values(frameCount);
+
+	for (int frame = 0; frame < frameCount; ++frame)
+	{
+		values[frame] = static_cast<short>(amplitude * std::sin(phase + frame * frequency));
+	}
+
+	return EncodeAnimationValues(values);
+}
+
+std::unique_ptr<Sequence> GenerateSequence(const GeneratorSettings& settings, int index, int seed, const glm::vec3& mins, const glm::vec3& maxs)
+{
+	Random random{seed};
+
+	auto sequence = std::make_unique<Sequence>();
+
+	sequence->Label = "sequence" + std::to_string(index);
+	sequence->FPS = 30;
+	sequence->Flags = STUDIO_LOOPING;
+	sequence->NumFrames = settings.FramesPerSequence;
+	sequence->BBMin = mins;
+	sequence->BBMax = maxs;
+	sequence->SequenceGroupIndex = index % settings.SequenceGroups;
+
+	for (int blend = 0; blend < settings.BlendsPerSequence; ++blend)
+	{
+		std::vector<Animation> animations(settings.Bones);
+
+		for (auto& animation : animations)
+		{
+			for (auto& data : animation.Data)
+			{
+				data = GenerateAxis(random, settings.FramesPerSequence);
+			}
+		}
+
+		sequence->AnimationBlends.push_back(std::move(animations));
+	}
+
+	if (settings.BlendsPerSequence > 1)
+	{
+		sequence->BlendData[SequenceBlendXIndex] = {STUDIO_XR, -45, 45};
+	}
+
+	if (settings.BlendsPerSequence == MaxGeneratedBlends)
+	{
+		sequence->BlendData[SequenceBlendYIndex] = {STUDIO_YR, -45, 45};
+	}
+
+	for (int i = 0; i < settings.EventsPerSequence; ++i)
+	{
+		auto event = std::make_unique<SequenceEvent>();
+
+		event->Frame = static_cast<int>((static_cast<long long>(i) * settings.FramesPerSequence) / settings.EventsPerSequence);
+		event->EventId = 1000 + (i % 10);
+		event->Options = "event" + std::to_string(i);
+
+		sequence->SortedEvents.push_back(event.get());
+		sequence->Events.push_back(std::move(event));
+	}
+
+	SortEventsList(sequence->SortedEvents);
+
+	return sequence;
+}
+
+std::unique_ptr<Texture> GenerateTexture(const GeneratorSettings& settings, int index, int seed)
+{
+	Random random{seed};
+
+	auto texture = std::make_unique<Texture>();
+
+	texture->Name = "texture" + std::to_string(index) + ".bmp";
+	texture->ArrayIndex = index;
+	texture->Data.Width = settings.TextureWidth;
+	texture->Data.Height = settings.TextureHeight;
+	texture->Data.Pixels.resize(static_cast<std::size_t>(settings.TextureWidth) * settings.TextureHeight);
+
+	for (auto& pixel : texture->Data.Pixels)
+	{
+		pixel = static_cast<std::byte>(random.Next(0, 255));
+	}
+
+	for (auto& color : texture->Data.Palette)
+	{
+		color.R = static_cast<std::uint8_t>(random.Next(0, 255));
+		color.G = static_cast<std::uint8_t>(random.Next(0, 255));
+		color.B = static_cast<std::uint8_t>(random.Next(0, 255));
+	}
+
+	return texture;
+}
+
+/**
+*	@brief Generates a grid of vertices made of one triangle strip per row.
+*	Rows are spread evenly over the meshes and over the bones.
+*/
+Model GenerateModel(const GeneratorSettings& settings, const EditableStudioModel& studioModel, int bodypart, int modelIndex, int& meshCount)
+{
+	const int width = std::max(2, static_cast<int>(std::sqrt(static_cast<double>(settings.VerticesPerModel))));
+	const int height = std::max(2, settings.VerticesPerModel / width);
+
+	const int meshes = std::min(settings.MeshesPerModel, height - 1);
+
+	Model model;
+
+	model.Name = "bodypart" + std::to_string(bodypart) + "_model" + std::to_string(modelIndex);
+	model.BoundingRadius = std::sqrt(static_cast<float>(width * width + height * height)) / 2;
+
+	model.Vertices.reserve(static_cast<std::size_t>(width) * height);
+	model.Normals.reserve(static_cast<std::size_t>(width) * height);
+
+	const float z = bodypart * BodypartSpacing;
+
+	for (int y = 0; y < height; ++y)
+	{
+		Bone* const bone = studioModel.Bones[(static_cast<long long>(y) * studioModel.Bones.size()) / height].get();
+
+		for (int x = 0; x < width; ++x)
+		{
+			model.Vertices.push_back({{x - width / 2.f, y - height / 2.f, z}, bone});
+			model.Normals.push_back({{0, 0, 1}, bone});
+		}
+	}
+
+	const int textureWidth = settings.TextureWidth;
+	const int textureHeight = settings.TextureHeight;
+
+	for (int i = 0; i < meshes; ++i)
+	{
+		const int firstRow = (i * (height - 1)) / meshes;
+		const int lastRow = ((i + 1) * (height - 1)) / meshes;
+
+		Mesh mesh;
+
+		mesh.SkinRef = meshCount++ % settings.Textures;
+
+		//Normals are stored in mesh order, the last mesh also has the normals of the last row
+		mesh.NumNorms = (lastRow - firstRow + (i + 1 == meshes ? 1 : 0)) * width;
+
+		for (int y = firstRow; y < lastRow; ++y)
+		{
+			mesh.Triangles.push_back(static_cast<short>(width * 2));
+
+			for (int x = 0; x < width; ++x)
+			{
+				for (const int row : {y + 1, y})
+				{
+					const auto vertex = static_cast<short>(row * width + x);
+
+					mesh.Triangles.insert(mesh.Triangles.end(), {
+						vertex,
+						vertex,
+						static_cast<short>((x * (textureWidth - 1)) / (width - 1)),
+						static_cast<short>((row * (textureHeight - 1)) / (height - 1))});
+				}
+			}
+
+			mesh.NumTriangles += (width - 1) * 2;
+		}
+
+		mesh.Triangles.push_back(0);
+
+		model.Meshes.push_back(std::move(mesh));
+	}
+
+	return model;
+}
+}
+
+bool SetGeneratorSetting(GeneratorSettings& settings, std::string_view name, int value)
+{
+	if (name == "seed")
+	{
+		settings.Seed = value;
+	}
+	else if (name == "bones")
+	{
+		settings.Bones = value;
+	}
+	else if (name == "bone-controllers")
+	{
+		settings.BoneControllers = value;
+	}
+	else if (name == "attachments")
+	{
+		settings.Attachments = value;
+	}
+	else if (name == "hitboxes")
+	{
+		settings.Hitboxes = value;
+	}
+	else if (name == "bodyparts")
+	{
+		settings.Bodyparts = value;
+	}
+	else if (name == "models")
+	{
+		settings.ModelsPerBodypart = value;
+	}
+	else if (name == "vertices")
+	{
+		settings.VerticesPerModel = value;
+	}
+	else if (name == "meshes")
+	{
+		settings.MeshesPerModel = value;
+	}
+	else if (name == "sequences")
+	{
+		settings.Sequences = value;
+	}
+	else if (name == "frames")
+	{
+		settings.FramesPerSequence = value;
+	}
+	else if (name == "blends")
+	{
+		settings.BlendsPerSequence = value;
+	}
+	else if (name == "events")
+	{
+		settings.EventsPerSequence = value;
+	}
+	else if (name == "sequence-groups")
+	{
+		settings.SequenceGroups = value;
+	}
+	else if (name == "textures")
+	{
+		settings.Textures = value;
+	}
+	else if (name == "texture-width")
+	{
+		settings.TextureWidth = value;
+	}
+	else if (name == "texture-height")
+	{
+		settings.TextureHeight = value;
+	}
+	else if (name == "skin-families")
+	{
+		settings.SkinFamilies = value;
+	}
+	else if (name == "external-textures")
+	{
+		settings.ExternalTextures = value != 0;
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+EditableStudioModel GenerateStudioModel(const GeneratorSettings& unclampedSettings)
+{
+	const auto settings = ClampSettings(unclampedSettings);
+
+	Random random{settings.Seed};
+
+	EditableStudioModel studioModel;
+
+	for (int i = 0; i < settings.Bones; ++i)
+	{
+		auto bone = std::make_unique<Bone>();
+
+		bone->Name = "bone" + std::to_string(i);
+		bone->Parent = i > 0 ? studioModel.Bones[random.Next(0, i - 1)].get() : nullptr;
+		bone->ArrayIndex = i;
+
+		for (int axis = 0; axis < STUDIO_NUM_COORDINATE_AXES; ++axis)
+		{
+			const bool isPosition = axis < 3;
+
+			bone->Axes[axis].Value = isPosition && i > 0 ? static_cast<float>(random.NextDouble(-4, 4)) : 0.f;
+			bone->Axes[axis].Scale = isPosition ? 0.001f : 0.0001f;
+		}
+
+		studioModel.Bones.push_back(std::move(bone));
+	}
+
+	for (int i = 0; i < settings.BoneControllers; ++i)
+	{
+		auto controller = std::make_unique<BoneController>();
+
+		const int rotation = (i / settings.Bones) % 3;
+
+		controller->Type = STUDIO_XR << rotation;
+		controller->Start = -30;
+		controller->End = 30;
+		controller->Index = i;
+		controller->ArrayIndex = i;
+
+		studioModel.Bones[i % settings.Bones]->Axes[3 + rotation].Controller = controller.get();
+
+		studioModel.BoneControllers.push_back(std::move(controller));
+	}
+
+	for (int i = 0; i < settings.Hitboxes; ++i)
+	{
+		auto hitbox = std::make_unique<Hitbox>();
+
+		hitbox->Bone = studioModel.Bones[i].get();
+		hitbox->Min = glm::vec3{-2};
+		hitbox->Max = glm::vec3{2};
+
+		studioModel.Hitboxes.push_back(std::move(hitbox));
+	}
+
+	for (int i = 0; i < settings.Attachments; ++i)
+	{
+		auto attachment = std::make_unique<Attachment>();
+
+		attachment->Name = "attachment" + std::to_string(i);
+		attachment->Bone = studioModel.Bones[i % settings.Bones].get();
+		attachment->Origin = glm::vec3{0, 0, 1};
+
+		studioModel.Attachments.push_back(std::move(attachment));
+	}
+
+	for (int i = 0; i < settings.SequenceGroups; ++i)
+	{
+		auto group = std::make_unique<SequenceGroup>();
+
+		group->Label = i == 0 ? "default" : "group" + std::to_string(i);
+
+		if (i > 0)
+		{
+			char name[32];
+			std::snprintf(name, sizeof(name), "%02d.mdl", i);
+			group->Name = "models/" + settings.Name + name;
+		}
+
+		studioModel.SequenceGroups.push_back(std::move(group));
+	}
+
+	//Every model is about as large as it is wide
+	const float halfSize = std::sqrt(static_cast<float>(settings.VerticesPerModel)) / 2;
+
+	const glm::vec3 mins{-halfSize, -halfSize, 0};
+	const glm::vec3 maxs{halfSize, halfSize, settings.Bodyparts * BodypartSpacing};
+
+	studioModel.EyePosition = glm::vec3{0, 0, maxs.z};
+	studioModel.BoundingMin = mins;
+	studioModel.BoundingMax = maxs;
+	studioModel.ClippingMin = mins;
+	studioModel.ClippingMax = maxs;
+
+	//Seeds are taken in order so sequences and textures don't depend on the order they are generated in
+	std::vector<int> sequenceSeeds(settings.Sequences);
+
+	for (auto& seed : sequenceSeeds)
+	{
+		seed = random.Next(0, INT_MAX);
+	}
+
+	std::vector<int> textureSeeds(settings.Textures);
+
+	for (auto& seed : textureSeeds)
+	{
+		seed = random.Next(0, INT_MAX);
+	}
+
+	studioModel.Sequences.resize(settings.Sequences);
+
+	RunInParallel(studioModel.Sequences.size(), [&](std::size_t index)
+		{
+			studioModel.Sequences[index] = GenerateSequence(settings, static_cast<int>(index), sequenceSeeds[index], mins, maxs);
+		});
+
+	studioModel.Textures.resize(settings.Textures);
+
+	RunInParallel(studioModel.Textures.size(), [&](std::size_t index)
+		{
+			studioModel.Textures[index] = GenerateTexture(settings, static_cast<int>(index), textureSeeds[index]);
+		});
+
+	studioModel.HasExternalTextures = settings.ExternalTextures;
+
+	//Each skin family uses the textures in a different order
+	for (int family = 0; family < settings.SkinFamilies; ++family)
+	{
+		std::vector<Texture*> skins;
+
+		for (int reference = 0; reference < settings.Textures; ++reference)
+		{
+			skins.push_back(studioModel.Textures[(reference + family) % settings.Textures].get());
+		}
+
+		studioModel.SkinFamilies.push_back(std::move(skins));
+	}
+
+	int meshCount = 0;
+	long long base = 1;
+
+	for (int i = 0; i < settings.Bodyparts; ++i)
+	{
+		auto bodypart = std::make_unique<Bodypart>();
+
+		bodypart->Name = "bodypart" + std::to_string(i);
+		bodypart->Base = static_cast<int>(std::min<long long>(base, INT_MAX));
+
+		base = std::min<long long>(base * settings.ModelsPerBodypart, INT_MAX);
+
+		for (int model = 0; model < settings.ModelsPerBodypart; ++model)
+		{
+			bodypart->Models.push_back(GenerateModel(settings, studioModel, i, model, meshCount));
+		}
+
+		studioModel.Bodyparts.push_back(std::move(bodypart));
+	}
+
+	studioModel.Transitions = {{0}};
+
+	return studioModel;
+}
+}
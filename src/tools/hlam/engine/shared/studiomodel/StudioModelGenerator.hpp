@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+
+namespace studiomdl
+{
+/**
+*	@brief Triangle commands store vertex indices as signed shorts, so a model can't use more vertices than this.
+*/
+constexpr int MaxGeneratedVerticesPerModel = 32768;
+
+/**
+*	@brief Sequences can have 1 blend, 2 blends for a single blend axis or 9 blends for 2 axes.
+*/
+constexpr int MaxGeneratedBlends = 9;
+
+/**
+*	@brief Configures the contents of a generated model. Values are clamped to the limits of the file format.
+*/
+struct GeneratorSettings
+{
+	//Seed for the random bone hierarchy, animations and textures. The same settings always generate the same model
+	int Seed = 1;
+
+	//Base name of the model, used for the names of the sequence group files
+	std::string Name = "generated";
+
+	int Bones = 32;
+	int BoneControllers = 0;
+	int Attachments = 0;
+
+	//Hitboxes are added to the first bones
+	int Hitboxes = 0;
+
+	int Bodyparts = 1;
+	int ModelsPerBodypart = 1;
+
+	//Every model is a grid of vertices with about this many vertices
+	int VerticesPerModel = 4096;
+	int MeshesPerModel = 1;
+
+	int Sequences = 1;
+	//Frames, and blends after that, are reduced so the animations of a sequence fit in the 64 KiB that bone values must start within
+	int FramesPerSequence = 30;
+	int BlendsPerSequence = 1;
+	int EventsPerSequence = 0;
+
+	//Sequences are spread over the groups. Groups other than the first are saved to separate files
+	int SequenceGroups = 1;
+
+	int Textures = 1;
+	int TextureWidth = 256;
+	int TextureHeight = 256;
+	int SkinFamilies = 1;
+	bool ExternalTextures = false;
+};
+
+/**
+*	@brief Changes the setting named @p name, as used by the command line tools.
+*	@return Whether a setting with that name exists.
+*/
+bool SetGeneratorSetting(GeneratorSettings& settings, std::string_view name, int value);
+
+/**
+*	@brief Builds a model with the contents described by @p settings, for benchmarks and tests that can't use game content.
+*	Bones form a random hierarchy and animate along smooth curves.
+*	Models are grids of triangle strips that are skinned to all bones, with one normal per vertex.
+*	Textures contain noise and every mesh uses the next skin reference, which each skin family maps to a different texture.
+*	Use ConvertFromEditable to get a model that can be saved.
+*/
+EditableStudioModel GenerateStudioModel(const GeneratorSettings& settings);
+}
@@ -1,5 +1,9 @@
 #include <cstddef>
+#include <cstring>
 #include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
 
 #include "engine/shared/studiomodel/StudioModel.hpp"
 #include "engine/shared/studiomodel/StudioModelFileFormat.hpp"
@@ -83,6 +87,16 @@ studio_ptr<T> LoadStudioHeader(const std::filesystem::path& fileName, FILE* exis
 	const size_t size = ftell(file);
 	fseek(file, 0, SEEK_SET);
 
+	if (size < sizeof(T))
+	{
+		if (!existingFile)
+		{
+			fclose(file);
+		}
+
+		throw assets::AssetException(std::string{"File \""} + utf8FileName + "\" is too small to be a studio model file");
+	}
+
 	auto buffer = std::make_unique<std::byte[]>(size);
 
 	auto header = reinterpret_cast<T*>(buffer.get());
@@ -194,7 +208,178 @@ std::unique_ptr<StudioModel> LoadStudioModel(const std::filesystem::path& fileNa
 		std::move(sequenceHeaders), isDol);
 }
 
-void SaveStudioModel(const std::filesystem::path& fileName, StudioModel& model, bool correctSequenceGroupFileNames)
+namespace
+{
+/**
+*	@brief Writes files to temporary files next to their destinations and replaces the destinations on commit.
+*	Temporary files that were not committed are removed.
+*/
+class StudioModelFileWriter final
+{
+public:
+	StudioModelFileWriter() = default;
+
+	StudioModelFileWriter(const StudioModelFileWriter&) = delete;
+	StudioModelFileWriter& operator=(const StudioModelFileWriter&) = delete;
+
+	~StudioModelFileWriter()
+	{
+		for (const auto& file : _files)
+		{
+			std::error_code e;
+			std::filesystem::remove(file.TemporaryFileName, e);
+		}
+	}
+
+	void Write(const std::filesystem::path& fileName, const void* data, std::size_t size, const char* description)
+	{
+		auto temporaryFileName{fileName};
+
+		temporaryFileName += ".tmp";
+
+		FILE* file = utf8_fopen(temporaryFileName.u8string().c_str(), "wb");
+
+		if (!file)
+		{
+			throw assets::AssetException(std::string{"Could not open "} + description + " for writing");
+		}
+
+		auto backupFileName{fileName};
+
+		backupFileName += ".bak";
+
+		_files.push_back({fileName, std::move(temporaryFileName), std::move(backupFileName)});
+
+		//The data is already in memory, write it in one call
+		bool success = fwrite(data, sizeof(std::byte), size, file) == size;
+
+		//Closing flushes the data, which can also fail
+		success = fclose(file) == 0 && success;
+
+		if (!success)
+		{
+			throw assets::AssetException(std::string{"Error while writing to "} + description);
+		}
+	}
+
+	/**
+	*	@brief Replaces all destination files with the files written so far.
+	*	The existing files are moved aside first. If any file can't be replaced, all files are restored to how they were.
+	*/
+	void Commit()
+	{
+		for (auto& file : _files)
+		{
+			std::error_code e;
+
+			if (std::filesystem::exists(file.FileName, e))
+			{
+				std::filesystem::rename(file.FileName, file.BackupFileName, e);
+
+				if (e)
+				{
+					Rollback();
+					throw assets::AssetException(std::string{"Could not replace file \""} + file.FileName.u8string() + "\": " + e.message());
+				}
+
+				file.HasBackup = true;
+			}
+
+			std::filesystem::rename(file.TemporaryFileName, file.FileName, e);
+
+			if (e)
+			{
+				Rollback();
+				throw assets::AssetException(std::string{"Could not replace file \""} + file.FileName.u8string() + "\": " + e.message());
+			}
+
+			file.IsReplaced = true;
+		}
+
+		//Every file has been replaced, the old files are no longer needed
+		for (const auto& file : _files)
+		{
+			if (file.HasBackup)
+			{
+				std::error_code e;
+				std::filesystem::remove(file.BackupFileName, e);
+			}
+		}
+
+		_files.clear();
+	}
+
+private:
+	/**
+	*	@brief Puts back the files that were moved aside by Commit and removes the files that were new.
+	*/
+	void Rollback()
+	{
+		for (auto it = _files.rbegin(), end = _files.rend(); it != end; ++it)
+		{
+			std::error_code e;
+
+			if (it->HasBackup)
+			{
+				std::filesystem::rename(it->BackupFileName, it->FileName, e);
+			}
+			else if (it->IsReplaced)
+			{
+				std::filesystem::remove(it->FileName, e);
+			}
+
+			it->HasBackup = false;
+			it->IsReplaced = false;
+		}
+	}
+
+private:
+	struct PendingFile
+	{
+		std::filesystem::path FileName;
+		std::filesystem::path TemporaryFileName;
+		std::filesystem::path BackupFileName;
+
+		//Whether the existing file has been moved to the backup file name
+		bool HasBackup = false;
+
+		//Whether the temporary file has been moved to the file name
+		bool IsReplaced = false;
+	};
+
+	std::vector<PendingFile> _files;
+};
+
+/**
+*	@brief Whether the file @p fileName exists and contains exactly @p size bytes of @p data.
+*/
+bool FileHasContents(const std::filesystem::path& fileName, const void* data, std::size_t size)
+{
+	std::error_code e;
+
+	if (std::filesystem::file_size(fileName, e) != size || e)
+	{
+		return false;
+	}
+
+	FILE* file = utf8_fopen(fileName.u8string().c_str(), "rb");
+
+	if (!file)
+	{
+		return false;
+	}
+
+	std::vector<std::byte> contents(size);
+
+	const bool success = fread(contents.data(), sizeof(std::byte), size, file) == size;
+
+	fclose(file);
+
+	return success && std::memcmp(contents.data(), data, size) == 0;
+}
+}
+
+void SaveStudioModel(const std::filesystem::path& fileName, StudioModel& model, bool correctSequenceGroupFileNames, int files)
 {
 	if (fileName.empty())
 	{
@@ -269,20 +454,24 @@ void SaveStudioModel(const std::filesystem::path& fileName, StudioModel& model,
 		}
 	}
 
-	FILE* file = utf8_fopen(fileName.u8string().c_str(), "wb");
-
-	if (!file)
+	//Textures are stored in the main file unless the model has a texture file,
+	//and the main file stores the location of each sequence's animations in sequence group files
+	if (((files & StudioModelFile::Textures) && !model.HasSeparateTextureHeader()) || (files & StudioModelFile::SequenceGroups))
 	{
-		throw assets::AssetException("Could not open main file for writing");
+		files |= StudioModelFile::Main;
 	}
 
-	bool success = fwrite(pStudioHdr, sizeof(std::byte), pStudioHdr->length, file) == pStudioHdr->length;
+	//Correcting the names changes the main file
+	if (correctSequenceGroupFileNames && pStudioHdr->numseqgroups > 1)
+	{
+		files |= StudioModelFile::Main;
+	}
 
-	fclose(file);
+	StudioModelFileWriter writer;
 
-	if (!success)
+	if (files & StudioModelFile::Main)
 	{
-		throw assets::AssetException("Error while writing to main file");
+		writer.Write(fileName, pStudioHdr, pStudioHdr->length, "main file");
 	}
 
 	auto baseFileName{fileName};
@@ -290,7 +479,7 @@ void SaveStudioModel(const std::filesystem::path& fileName, StudioModel& model,
 	baseFileName.replace_extension();
 
 	// write texture model
-	if (model.HasSeparateTextureHeader())
+	if (model.HasSeparateTextureHeader() && (files & StudioModelFile::Textures))
 	{
 		const studiohdr_t* const pTextureHdr = model.GetTextureHeader();
 
@@ -298,24 +487,11 @@ void SaveStudioModel(const std::filesystem::path& fileName, StudioModel& model,
 
 		texturename += "T.mdl";
 
-		file = utf8_fopen(texturename.u8string().c_str(), "wb");
-
-		if (!file)
-		{
-			throw assets::AssetException("Could not open texture file for writing");
-		}
-
-		success = fwrite(pTextureHdr, sizeof(std::byte), pTextureHdr->length, file) == pTextureHdr->length;
-		fclose(file);
-
-		if (!success)
-		{
-			throw assets::AssetException("Error while writing to texture file");
-		}
+		writer.Write(texturename, pTextureHdr, pTextureHdr->length, "texture file");
 	}
 
 	// write seq groups
-	if (pStudioHdr->numseqgroups > 1)
+	if (pStudioHdr->numseqgroups > 1 && (files & StudioModelFile::SequenceGroups))
 	{
 		std::stringstream seqgroupname;
 
@@ -327,23 +503,20 @@ void SaveStudioModel(const std::filesystem::path& fileName, StudioModel& model,
 				std::setfill('0') << std::setw(2) << i <<
 				std::setw(0) << ".mdl";
 
-			file = utf8_fopen(seqgroupname.str().c_str(), "wb");
-
-			if (!file)
-			{
-				throw assets::AssetException("Could not open sequence file for writing");
-			}
-
 			const auto pAnimHdr = model.GetSeqGroupHeader(i - 1);
 
-			success = fwrite(pAnimHdr, sizeof(std::byte), pAnimHdr->length, file) == pAnimHdr->length;
-			fclose(file);
+			const auto sequenceGroupFileName = std::filesystem::u8path(seqgroupname.str());
 
-			if (!success)
+			//Most edits only change some of the groups, leave the others alone
+			if (FileHasContents(sequenceGroupFileName, pAnimHdr, pAnimHdr->length))
 			{
-				throw assets::AssetException("Error while writing to sequence file");
+				continue;
 			}
+
+			writer.Write(sequenceGroupFileName, pAnimHdr, pAnimHdr->length, "sequence file");
 		}
 	}
+
+	writer.Commit();
 }
 }
@@ -23,12 +23,35 @@ bool IsStudioModel(FILE* file);
 */
 std::unique_ptr<StudioModel> LoadStudioModel(const std::filesystem::path& fileName, FILE* mainFile);
 
+/**
+*	@brief Files that a studio model can be split into. Used to select which files are written when saving.
+*/
+namespace StudioModelFile
+{
+enum StudioModelFile
+{
+	None = 0,
+	Main = 1 << 0,
+	Textures = 1 << 1,
+	SequenceGroups = 1 << 2,
+
+	All = Main | Textures | SequenceGroups
+};
+}
+
 /**
 *	Saves a studio model.
+*	Each file is first written next to its destination and all destinations are replaced once every file has been written.
+*	The existing files are moved aside while they are replaced and are put back if any of them can't be replaced,
+*	so a failed save leaves the existing files untouched.
+*	Sequence group files whose contents haven't changed are not rewritten.
 *	@param fileName Name of the file to save the model to. This is the entire path, including the extension.
 *	@param model Model to save.
 * *	@param correctSequenceGroupFileNames Whether the sequence group filenames embedded in the main file should be corrected
+*	@param files StudioModelFile flags selecting the files to write. Files that are not selected are left as they are.
+*		Changing the textures of a model without a texture file or changing sequence group files also writes the main file.
 *	@exception assets::AssetException If an error occurs or if the given data is invalid
 */
-void SaveStudioModel(const std::filesystem::path& fileName, StudioModel& model, bool correctSequenceGroupFileNames);
+void SaveStudioModel(const std::filesystem::path& fileName, StudioModel& model, bool correctSequenceGroupFileNames,
+	int files = StudioModelFile::All);
 }
@@ -0,0 +1,588 @@
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+#include "engine/shared/studiomodel/StudioModelRenderCost.hpp"
+
+#include "utility/JsonWriter.hpp"
+
+namespace studiomdl
+{
+namespace
+{
+//Listing every combination is not useful for models with many body parts
+constexpr std::size_t MaxListedCombinations = 256;
+
+constexpr int BytesPerPixel = 4;
+
+/**
+*	@brief Cost of a single submodel, used to add up the cost of combinations.
+*/
+struct ModelCost
+{
+	int Triangles = 0;
+	int DrawCalls = 0;
+	int Meshes = 0;
+	std::vector<int> SkinReferences;
+};
+
+std::string Format(const char* format, ...)
+{
+	char buffer[512];
+
+	va_list list;
+
+	va_start(list, format);
+	vsnprintf(buffer, sizeof(buffer), format, list);
+	va_end(list);
+
+	return buffer;
+}
+
+std::string FormatSize(std::size_t size)
+{
+	if (size < 1024)
+	{
+		return Format("%zu bytes", size);
+	}
+
+	if (size < 1024 * 1024)
+	{
+		return Format("%.1f KiB", size / 1024.0);
+	}
+
+	return Format("%.1f MiB", size / (1024.0 * 1024.0));
+}
+
+int GetEngineTextureSize(int size)
+{
+	int engineSize = 1;
+
+	while (engineSize < size && engineSize < EngineMaxTextureSize)
+	{
+		engineSize <<= 1;
+	}
+
+	return engineSize;
+}
+
+MeshRenderCost AnalyzeMesh(const Model& model, const Mesh& mesh, std::size_t boneCount)
+{
+	MeshRenderCost cost;
+
+	cost.ModelName = model.Name;
+	cost.SkinReference = mesh.SkinRef;
+
+	if (mesh.Triangles.empty())
+	{
+		return cost;
+	}
+
+	std::vector<bool> usedBones(boneCount, false);
+
+	int commandVertices = 0;
+
+	for (auto command = mesh.Triangles.data(); *command != 0;)
+	{
+		const int count = std::abs(*command);
+
+		if (*command < 0)
+		{
+			++cost.Fans;
+		}
+		else
+		{
+			++cost.Strips;
+		}
+
+		++command;
+
+		cost.Triangles += std::max(0, count - 2);
+		commandVertices += count;
+
+		for (int i = 0; i < count; ++i, command += 4)
+		{
+			const auto bone = model.Vertices[command[0]].Bone;
+
+			if (bone && !usedBones[bone->ArrayIndex])
+			{
+				usedBones[bone->ArrayIndex] = true;
+				++cost.Bones;
+			}
+		}
+	}
+
+	if (const int commands = cost.Strips + cost.Fans; commands > 0)
+	{
+		cost.AverageCommandLength = static_cast<float>(commandVertices) / commands;
+	}
+
+	return cost;
+}
+
+std::size_t GetAnimationSize(const Sequence& sequence)
+{
+	std::size_t size = 0;
+
+	for (const auto& blend : sequence.AnimationBlends)
+	{
+		for (const auto& animation : blend)
+		{
+			size += sizeof(mstudioanim_t);
+
+			for (const auto& values : animation.Data)
+			{
+				size += values.size() * sizeof(mstudioanimvalue_t);
+			}
+		}
+	}
+
+	return size;
+}
+
+CombinationRenderCost GetCombinationCost(const EditableStudioModel& model, const RenderCostReport& report,
+	const std::vector<std::vector<ModelCost>>& modelCosts, const std::vector<int>& modelIndices, int skin)
+{
+	CombinationRenderCost cost;
+
+	cost.Skin = skin;
+
+	std::vector<bool> usedTextures(model.Textures.size(), false);
+
+	for (std::size_t i = 0; i < modelIndices.size(); ++i)
+	{
+		const auto& modelCost = modelCosts[i][modelIndices[i]];
+
+		cost.Body += modelIndices[i] * model.Bodyparts[i]->Base;
+		cost.Triangles += modelCost.Triangles;
+		cost.DrawCalls += modelCost.DrawCalls;
+		cost.Meshes += modelCost.Meshes;
+
+		if (skin < static_cast<int>(model.SkinFamilies.size()))
+		{
+			const auto& family = model.SkinFamilies[skin];
+
+			for (const int skinReference : modelCost.SkinReferences)
+			{
+				if (skinReference >= 0 && skinReference < static_cast<int>(family.size()))
+				{
+					const int textureIndex = family[skinReference]->ArrayIndex;
+
+					if (!usedTextures[textureIndex])
+					{
+						usedTextures[textureIndex] = true;
+						cost.TextureMemory += report.Textures[textureIndex].Memory;
+					}
+				}
+			}
+		}
+	}
+
+	return cost;
+}
+
+/**
+*	@brief Selects the model with the highest cost in each body part, as measured by @p getCost.
+*/
+template<typename Function>
+std::vector<int> GetMostExpensiveModels(const std::vector<std::vector<ModelCost>>& modelCosts, Function getCost)
+{
+	std::vector<int> modelIndices;
+
+	modelIndices.reserve(modelCosts.size());
+
+	for (const auto& bodypart : modelCosts)
+	{
+		const auto it = std::max_element(bodypart.begin(), bodypart.end(),
+			[&](const auto& lhs, const auto& rhs) { return getCost(lhs) < getCost(rhs); });
+
+		modelIndices.push_back(static_cast<int>(it - bodypart.begin()));
+	}
+
+	return modelIndices;
+}
+
+void AnalyzeCombinations(const EditableStudioModel& model, RenderCostReport& report, const std::vector<std::vector<ModelCost>>& modelCosts)
+{
+	const int skinCount = std::max<int>(1, model.SkinFamilies.size());
+
+	report.CombinationCount = skinCount;
+
+	for (const auto& bodypart : modelCosts)
+	{
+		//Saturate instead of overflowing for absurd numbers of body parts
+		if (report.CombinationCount > std::numeric_limits<std::size_t>::max() / bodypart.size())
+		{
+			report.CombinationCount = std::numeric_limits<std::size_t>::max();
+			break;
+		}
+
+		report.CombinationCount *= bodypart.size();
+	}
+
+	//Costs add up over body parts, so the most expensive combination uses the most expensive model of each body part
+	const auto mostTriangles = GetMostExpensiveModels(modelCosts, [](const auto& cost) { return cost.Triangles; });
+	const auto mostDrawCalls = GetMostExpensiveModels(modelCosts, [](const auto& cost) { return cost.DrawCalls; });
+
+	report.MaxDrawCalls = GetCombinationCost(model, report, modelCosts, mostDrawCalls, 0).DrawCalls;
+
+	for (int skin = 0; skin < skinCount; ++skin)
+	{
+		auto cost = GetCombinationCost(model, report, modelCosts, mostTriangles, skin);
+
+		if (skin == 0 || cost.TextureMemory > report.WorstCombination.TextureMemory)
+		{
+			report.WorstCombination = cost;
+		}
+	}
+
+	report.MaxTriangles = report.WorstCombination.Triangles;
+
+	if (report.CombinationCount > MaxListedCombinations)
+	{
+		return;
+	}
+
+	std::vector<int> modelIndices(modelCosts.size(), 0);
+
+	while (true)
+	{
+		for (int skin = 0; skin < skinCount; ++skin)
+		{
+			report.Combinations.push_back(GetCombinationCost(model, report, modelCosts, modelIndices, skin));
+		}
+
+		//Advance to the next combination of models
+		std::size_t bodypart = 0;
+
+		for (; bodypart < modelIndices.size(); ++bodypart)
+		{
+			if (++modelIndices[bodypart] < static_cast<int>(modelCosts[bodypart].size()))
+			{
+				break;
+			}
+
+			modelIndices[bodypart] = 0;
+		}
+
+		if (bodypart == modelIndices.size())
+		{
+			break;
+		}
+	}
+}
+
+void CheckCount(RenderCostReport& report, const std::string& what, int value, int limit)
+{
+	if (limit > 0 && value > limit)
+	{
+		report.BudgetViolations.push_back(Format("%s: %d exceeds budget of %d", what.c_str(), value, limit));
+	}
+}
+
+void CheckSize(RenderCostReport& report, const std::string& what, std::size_t value, std::size_t limit)
+{
+	if (limit > 0 && value > limit)
+	{
+		report.BudgetViolations.push_back(Format("%s: %s exceeds budget of %s",
+			what.c_str(), FormatSize(value).c_str(), FormatSize(limit).c_str()));
+	}
+}
+
+void CheckBudget(RenderCostReport& report, const RenderCostBudget& budget)
+{
+	CheckCount(report, "Triangles per combination", report.MaxTriangles, budget.MaxTrianglesPerCombination);
+	CheckCount(report, "Draw calls per combination", report.MaxDrawCalls, budget.MaxDrawCallsPerCombination);
+	CheckSize(report, "Texture memory", report.TextureMemory, budget.MaxTextureMemory);
+	CheckCount(report, "Bones", report.Bones, budget.MaxBones);
+	CheckCount(report, "Bones per mesh", report.MaxBonesPerMesh, budget.MaxBonesPerMesh);
+
+	for (const auto& sequence : report.Sequences)
+	{
+		CheckSize(report, "Animation data of sequence \"" + sequence.Label + "\"",
+			sequence.AnimationBytes, budget.MaxAnimationBytesPerSequence);
+	}
+}
+}
+
+TextureRenderCost AnalyzeTexture(const Texture& texture)
+{
+	TextureRenderCost cost;
+
+	cost.Name = texture.Name;
+	cost.Width = texture.Data.Width;
+	cost.Height = texture.Data.Height;
+	cost.EngineWidth = GetEngineTextureSize(cost.Width);
+	cost.EngineHeight = GetEngineTextureSize(cost.Height);
+
+	int width = cost.EngineWidth;
+	int height = cost.EngineHeight;
+
+	while (true)
+	{
+		cost.Memory += static_cast<std::size_t>(width) * height * BytesPerPixel;
+
+		if ((texture.Flags & STUDIO_NF_NOMIPS) || (width == 1 && height == 1))
+		{
+			break;
+		}
+
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+
+	return cost;
+}
+
+RenderCostReport AnalyzeRenderCost(const EditableStudioModel& model, const RenderCostBudget& budget)
+{
+	RenderCostReport report;
+
+	report.Bones = static_cast<int>(model.Bones.size());
+
+	for (const auto& texture : model.Textures)
+	{
+		report.Textures.push_back(AnalyzeTexture(*texture));
+		report.TextureMemory += report.Textures.back().Memory;
+	}
+
+	std::vector<std::vector<ModelCost>> modelCosts;
+
+	modelCosts.reserve(model.Bodyparts.size());
+
+	for (int i = 0; i < static_cast<int>(model.Bodyparts.size()); ++i)
+	{
+		const auto& bodypart = *model.Bodyparts[i];
+
+		auto& bodypartCosts = modelCosts.emplace_back();
+
+		//Body parts without models still take up a slot in the body value
+		bodypartCosts.resize(std::max<std::size_t>(1, bodypart.Models.size()));
+
+		for (int j = 0; j < static_cast<int>(bodypart.Models.size()); ++j)
+		{
+			const auto& subModel = bodypart.Models[j];
+			auto& modelCost = bodypartCosts[j];
+
+			for (int k = 0; k < static_cast<int>(subModel.Meshes.size()); ++k)
+			{
+				auto meshCost = AnalyzeMesh(subModel, subModel.Meshes[k], model.Bones.size());
+
+				meshCost.Bodypart = i;
+				meshCost.Model = j;
+				meshCost.Mesh = k;
+
+				modelCost.Triangles += meshCost.Triangles;
+				modelCost.DrawCalls += meshCost.Strips + meshCost.Fans;
+				++modelCost.Meshes;
+				modelCost.SkinReferences.push_back(meshCost.SkinReference);
+
+				report.MaxBonesPerMesh = std::max(report.MaxBonesPerMesh, meshCost.Bones);
+
+				report.Meshes.push_back(std::move(meshCost));
+			}
+		}
+	}
+
+	AnalyzeCombinations(model, report, modelCosts);
+
+	for (const auto& sequence : model.Sequences)
+	{
+		auto& cost = report.Sequences.emplace_back();
+
+		cost.Label = sequence->Label;
+		cost.Frames = sequence->NumFrames;
+		cost.AnimationBytes = GetAnimationSize(*sequence);
+
+		report.AnimationBytes += cost.AnimationBytes;
+	}
+
+	CheckBudget(report, budget);
+
+	return report;
+}
+
+std::string FormatRenderCostReport(const RenderCostReport& report)
+{
+	std::string text;
+
+	if (report.IsOverBudget())
+	{
+		text += "OVER BUDGET\n";
+
+		for (const auto& violation : report.BudgetViolations)
+		{
+			text += "  " + violation + "\n";
+		}
+	}
+	else
+	{
+		text += "Within budget\n";
+	}
+
+	const auto& worst = report.WorstCombination;
+
+	text += Format("\nMost expensive combination: body %d, skin %d\n", worst.Body, worst.Skin);
+	text += Format("  %d triangles, %d draw calls, %d meshes, %s of textures\n",
+		worst.Triangles, worst.DrawCalls, worst.Meshes, FormatSize(worst.TextureMemory).c_str());
+	text += Format("  Most draw calls of any combination: %d\n", report.MaxDrawCalls);
+	text += Format("\nBones: %d (at most %d per mesh)\n", report.Bones, report.MaxBonesPerMesh);
+
+	text += Format("\nTexture memory: %s\n", FormatSize(report.TextureMemory).c_str());
+
+	for (const auto& texture : report.Textures)
+	{
+		text += Format("  %s: %dx%d, %dx%d in engine, %s\n", texture.Name.c_str(),
+			texture.Width, texture.Height, texture.EngineWidth, texture.EngineHeight, FormatSize(texture.Memory).c_str());
+	}
+
+	text += "\nMeshes:\n";
+
+	for (const auto& mesh : report.Meshes)
+	{
+		text += Format("  %s mesh %d: %d triangles, %d strips, %d fans, %.1f vertices per strip or fan, %d bones\n",
+			mesh.ModelName.c_str(), mesh.Mesh + 1, mesh.Triangles, mesh.Strips, mesh.Fans, mesh.AverageCommandLength, mesh.Bones);
+	}
+
+	text += Format("\nAnimation data: %s\n", FormatSize(report.AnimationBytes).c_str());
+
+	for (const auto& sequence : report.Sequences)
+	{
+		text += Format("  %s: %d frames, %s\n", sequence.Label.c_str(), sequence.Frames, FormatSize(sequence.AnimationBytes).c_str());
+	}
+
+	text += Format("\nCombinations: %zu\n", report.CombinationCount);
+
+	if (report.Combinations.empty() && report.CombinationCount > 0)
+	{
+		text += "  Too many to list\n";
+	}
+
+	for (const auto& combination : report.Combinations)
+	{
+		text += Format("  Body %d, skin %d: %d triangles, %d draw calls, %d meshes, %s of textures\n",
+			combination.Body, combination.Skin, combination.Triangles, combination.DrawCalls, combination.Meshes,
+			FormatSize(combination.TextureMemory).c_str());
+	}
+
+	return text;
+}
+
+void WriteRenderCostReport(JsonWriter& writer, std::string_view fileName, const RenderCostReport& report)
+{
+	const auto writeCombination = [&](const CombinationRenderCost& combination)
+	{
+		writer.BeginObject();
+		writer.Field("body", combination.Body);
+		writer.Field("skin", combination.Skin);
+		writer.Field("triangles", combination.Triangles);
+		writer.Field("drawCalls", combination.DrawCalls);
+		writer.Field("meshes", combination.Meshes);
+		writer.Key("textureMemory");
+		writer.Int(combination.TextureMemory);
+		writer.EndObject();
+	};
+
+	writer.BeginObject();
+
+	writer.Field("file", fileName);
+	writer.Field("overBudget", report.IsOverBudget());
+
+	writer.Key("budgetViolations");
+	writer.BeginArray();
+
+	for (const auto& violation : report.BudgetViolations)
+	{
+		writer.String(violation);
+	}
+
+	writer.EndArray();
+
+	writer.Field("maxTriangles", report.MaxTriangles);
+	writer.Field("maxDrawCalls", report.MaxDrawCalls);
+
+	writer.Key("worstCombination");
+	writeCombination(report.WorstCombination);
+
+	writer.Key("combinationCount");
+	writer.Int(report.CombinationCount);
+
+	writer.Key("combinations");
+	writer.BeginArray();
+
+	for (const auto& combination : report.Combinations)
+	{
+		writeCombination(combination);
+	}
+
+	writer.EndArray();
+
+	writer.Field("bones", report.Bones);
+	writer.Field("maxBonesPerMesh", report.MaxBonesPerMesh);
+
+	writer.Key("meshes");
+	writer.BeginArray();
+
+	for (const auto& mesh : report.Meshes)
+	{
+		writer.BeginObject();
+		writer.Field("model", std::string_view{mesh.ModelName});
+		writer.Field("bodypartIndex", mesh.Bodypart);
+		writer.Field("modelIndex", mesh.Model);
+		writer.Field("meshIndex", mesh.Mesh);
+		writer.Field("skinReference", mesh.SkinReference);
+		writer.Field("triangles", mesh.Triangles);
+		writer.Field("strips", mesh.Strips);
+		writer.Field("fans", mesh.Fans);
+		writer.Field("averageCommandLength", mesh.AverageCommandLength);
+		writer.Field("bones", mesh.Bones);
+		writer.EndObject();
+	}
+
+	writer.EndArray();
+
+	writer.Key("textureMemory");
+	writer.Int(report.TextureMemory);
+
+	writer.Key("textures");
+	writer.BeginArray();
+
+	for (const auto& texture : report.Textures)
+	{
+		writer.BeginObject();
+		writer.Field("name", std::string_view{texture.Name});
+		writer.Field("width", texture.Width);
+		writer.Field("height", texture.Height);
+		writer.Field("engineWidth", texture.EngineWidth);
+		writer.Field("engineHeight", texture.EngineHeight);
+		writer.Key("memory");
+		writer.Int(texture.Memory);
+		writer.EndObject();
+	}
+
+	writer.EndArray();
+
+	writer.Key("animationBytes");
+	writer.Int(report.AnimationBytes);
+
+	writer.Key("sequences");
+	writer.BeginArray();
+
+	for (const auto& sequence : report.Sequences)
+	{
+		writer.BeginObject();
+		writer.Field("label", std::string_view{sequence.Label});
+		writer.Field("frames", sequence.Frames);
+		writer.Key("animationBytes");
+		writer.Int(sequence.AnimationBytes);
+		writer.EndObject();
+	}
+
+	writer.EndArray();
+
+	writer.EndObject();
+}
+}
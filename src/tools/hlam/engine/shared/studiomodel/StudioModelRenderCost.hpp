@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class JsonWriter;
+
+namespace studiomdl
+{
+class EditableStudioModel;
+struct Texture;
+
+/**
+*	@brief The engine resamples textures to a power of 2 no larger than this before uploading them.
+*/
+constexpr int EngineMaxTextureSize = 512;
+
+/**
+*	@brief Limits that a model should stay within. A limit of 0 disables that check.
+*	Limits named per combination apply to the most expensive combination of body parts and skin.
+*/
+struct RenderCostBudget
+{
+	int MaxTrianglesPerCombination = 4000;
+	int MaxDrawCallsPerCombination = 500;
+	std::size_t MaxTextureMemory = 4 * 1024 * 1024;
+	int MaxBones = 128;
+	int MaxBonesPerMesh = 32;
+	std::size_t MaxAnimationBytesPerSequence = 512 * 1024;
+};
+
+struct MeshRenderCost
+{
+	std::string ModelName;
+
+	int Bodypart = 0;
+	int Model = 0;
+	int Mesh = 0;
+
+	int SkinReference = 0;
+
+	int Triangles = 0;
+	int Strips = 0;
+	int Fans = 0;
+
+	//Average number of vertices per strip or fan
+	float AverageCommandLength = 0;
+
+	//Number of distinct bones that the mesh's vertices are attached to
+	int Bones = 0;
+};
+
+/**
+*	@brief Cost of drawing the model with a given body value and skin.
+*	Every strip and fan is drawn separately, so each counts as a draw call.
+*/
+struct CombinationRenderCost
+{
+	int Body = 0;
+	int Skin = 0;
+
+	int Triangles = 0;
+	int DrawCalls = 0;
+	int Meshes = 0;
+
+	//Memory used by the textures drawn with this combination
+	std::size_t TextureMemory = 0;
+};
+
+struct TextureRenderCost
+{
+	std::string Name;
+	int Width = 0;
+	int Height = 0;
+
+	int EngineWidth = 0;
+	int EngineHeight = 0;
+
+	//RGBA data including mipmaps
+	std::size_t Memory = 0;
+};
+
+struct SequenceRenderCost
+{
+	std::string Label;
+	int Frames = 0;
+	std::size_t AnimationBytes = 0;
+};
+
+struct RenderCostReport
+{
+	std::vector<MeshRenderCost> Meshes;
+
+	//Only filled in if there aren't too many combinations to list
+	std::vector<CombinationRenderCost> Combinations;
+	std::size_t CombinationCount = 0;
+
+	//Combination with the most triangles
+	CombinationRenderCost WorstCombination;
+
+	int MaxTriangles = 0;
+	int MaxDrawCalls = 0;
+
+	//The engine uploads all textures when the model is loaded, regardless of which ones are drawn
+	std::vector<TextureRenderCost> Textures;
+	std::size_t TextureMemory = 0;
+
+	std::vector<SequenceRenderCost> Sequences;
+	std::size_t AnimationBytes = 0;
+
+	int Bones = 0;
+	int MaxBonesPerMesh = 0;
+
+	//Description of each budget that the model exceeds
+	std::vector<std::string> BudgetViolations;
+
+	bool IsOverBudget() const { return !BudgetViolations.empty(); }
+};
+
+/**
+*	@brief Calculates how much video memory the engine uses for @p texture.
+*/
+TextureRenderCost AnalyzeTexture(const Texture& texture);
+
+/**
+*	@brief Calculates what drawing @p model costs the engine and checks it against @p budget.
+*/
+RenderCostReport AnalyzeRenderCost(const EditableStudioModel& model, const RenderCostBudget& budget = {});
+
+/**
+*	@brief Formats @p report as human readable text.
+*/
+std::string FormatRenderCostReport(const RenderCostReport& report);
+
+/**
+*	@brief Writes @p report as a single JSON object.
+*/
+void WriteRenderCostReport(JsonWriter& writer, std::string_view fileName, const RenderCostReport& report);
+}
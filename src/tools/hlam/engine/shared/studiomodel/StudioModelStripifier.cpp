@@ -0,0 +1,463 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <unordered_map>
+
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+#include "engine/shared/studiomodel/StudioModelStripifier.hpp"
+
+#include "utility/Parallel.hpp"
+
+namespace studiomdl
+{
+namespace
+{
+//Each command vertex is a vertex index, a normal index and texture coordinates
+constexpr int CommandVertexSize = 4;
+
+//The number of vertices in a command is stored in a short
+constexpr std::size_t MaxCommandVertices = std::numeric_limits<short>::max();
+
+//Stripifying small models takes less time than starting threads does
+constexpr int MinimumParallelTriangleCount = 8192;
+
+using Triangle = std::array<int, 3>;
+
+/**
+*	@brief A directed edge of a triangle, in the triangle's winding order.
+*/
+struct Edge
+{
+	std::uint64_t Key;
+	int Triangle;
+};
+
+std::uint64_t GetEdgeKey(int from, int to)
+{
+	return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(from)) << 32) | static_cast<std::uint32_t>(to);
+}
+
+/**
+*	@brief Greedily grows strips and fans, starting from the triangles with the fewest neighbors
+*	since those are the hardest to fit into a command later on.
+*	Command vertices are only shared between triangles if all of their values are identical.
+*/
+class Stripifier final
+{
+public:
+	/**
+	*	@return Whether the commands were read successfully.
+	*/
+	bool ReadTriangles(const std::vector<short>& commands)
+	{
+		const short* cmds = commands.data();
+		const short* const end = cmds + commands.size();
+
+		std::vector<int> corners;
+
+		for (int count; cmds < end && (count = *cmds++) != 0;)
+		{
+			const bool isFan = count < 0;
+
+			count = std::abs(count);
+
+			if (end - cmds < count * CommandVertexSize)
+			{
+				return false;
+			}
+
+			corners.clear();
+
+			for (; count > 0; --count, cmds += CommandVertexSize)
+			{
+				corners.push_back(AddCorner(cmds));
+			}
+
+			//Same order as the engine uses
+			for (std::size_t i = 2; i < corners.size(); ++i)
+			{
+				if (isFan)
+				{
+					_triangles.push_back({corners[0], corners[i - 1], corners[i]});
+				}
+				else if (i % 2)
+				{
+					_triangles.push_back({corners[i - 1], corners[i - 2], corners[i]});
+				}
+				else
+				{
+					_triangles.push_back({corners[i - 2], corners[i - 1], corners[i]});
+				}
+			}
+		}
+
+		return true;
+	}
+
+	std::vector<short> Run()
+	{
+		BuildEdges();
+
+		const auto order = GetStartOrder();
+
+		_used.assign(_triangles.size(), false);
+		_attempts.assign(_triangles.size(), 0);
+
+		std::vector<short> commands;
+
+		std::vector<int> bestTriangles;
+		std::vector<int> bestCorners;
+
+		for (const int start : order)
+		{
+			if (_used[start])
+			{
+				continue;
+			}
+
+			bestTriangles.clear();
+			bool bestIsFan = false;
+
+			//Strips are tried first so fans only get used if they are longer
+			for (const bool isFan : {false, true})
+			{
+				for (int rotation = 0; rotation < 3; ++rotation)
+				{
+					Grow(start, rotation, isFan);
+
+					if (_attemptTriangles.size() > bestTriangles.size())
+					{
+						std::swap(bestTriangles, _attemptTriangles);
+						std::swap(bestCorners, _attemptCorners);
+						bestIsFan = isFan;
+					}
+				}
+			}
+
+			for (const int triangle : bestTriangles)
+			{
+				_used[triangle] = true;
+			}
+
+			WriteCommand(commands, bestCorners, bestIsFan);
+		}
+
+		commands.push_back(0);
+
+		return commands;
+	}
+
+private:
+	int AddCorner(const short* vertex)
+	{
+		std::uint64_t key = 0;
+
+		for (int i = 0; i < CommandVertexSize; ++i)
+		{
+			key = (key << 16) | static_cast<std::uint16_t>(vertex[i]);
+		}
+
+		const auto [it, inserted] = _cornerIndices.emplace(key, static_cast<int>(_corners.size()));
+
+		if (inserted)
+		{
+			_corners.push_back({vertex[0], vertex[1], vertex[2], vertex[3]});
+		}
+
+		return it->second;
+	}
+
+	void BuildEdges()
+	{
+		_edges.reserve(_triangles.size() * 3);
+
+		for (std::size_t i = 0; i < _triangles.size(); ++i)
+		{
+			const auto& triangle = _triangles[i];
+
+			for (int j = 0; j < 3; ++j)
+			{
+				_edges.push_back({GetEdgeKey(triangle[j], triangle[(j + 1) % 3]), static_cast<int>(i)});
+			}
+		}
+
+		//Sorting by triangle as well keeps the result the same on every platform
+		std::sort(_edges.begin(), _edges.end(), [](const auto& lhs, const auto& rhs)
+			{
+				return lhs.Key != rhs.Key ? lhs.Key < rhs.Key : lhs.Triangle < rhs.Triangle;
+			});
+	}
+
+	std::vector<int> GetStartOrder() const
+	{
+		//A neighbor shares an edge in the opposite direction, which is what a command continues across
+		std::vector<int> neighbors(_triangles.size(), 0);
+
+		for (std::size_t i = 0; i < _triangles.size(); ++i)
+		{
+			const auto& triangle = _triangles[i];
+
+			for (int j = 0; j < 3; ++j)
+			{
+				const auto key = GetEdgeKey(triangle[(j + 1) % 3], triangle[j]);
+
+				if (std::binary_search(_edges.begin(), _edges.end(), Edge{key, 0}, [](const auto& lhs, const auto& rhs)
+					{
+						return lhs.Key < rhs.Key;
+					}))
+				{
+					++neighbors[i];
+				}
+			}
+		}
+
+		std::vector<int> order(_triangles.size());
+
+		for (std::size_t i = 0; i < order.size(); ++i)
+		{
+			order[i] = static_cast<int>(i);
+		}
+
+		std::stable_sort(order.begin(), order.end(), [&](int lhs, int rhs)
+			{
+				return neighbors[lhs] < neighbors[rhs];
+			});
+
+		return order;
+	}
+
+	/**
+	*	@brief Finds a triangle that has not been used yet with the directed edge @p from -> @p to.
+	*/
+	int FindTriangle(int from, int to) const
+	{
+		const auto key = GetEdgeKey(from, to);
+
+		auto it = std::lower_bound(_edges.begin(), _edges.end(), key, [](const auto& edge, std::uint64_t key)
+			{
+				return edge.Key < key;
+			});
+
+		for (; it != _edges.end() && it->Key == key; ++it)
+		{
+			if (!_used[it->Triangle] && _attempts[it->Triangle] != _attempt)
+			{
+				return it->Triangle;
+			}
+		}
+
+		return -1;
+	}
+
+	int GetThirdCorner(int triangle, int from, int to) const
+	{
+		const auto& corners = _triangles[triangle];
+
+		if (corners[0] == from && corners[1] == to)
+		{
+			return corners[2];
+		}
+
+		if (corners[1] == from && corners[2] == to)
+		{
+			return corners[0];
+		}
+
+		return corners[1];
+	}
+
+	/**
+	*	@brief Grows a strip or fan starting with triangle @p start, with its corners rotated by @p rotation.
+	*/
+	void Grow(int start, int rotation, bool isFan)
+	{
+		++_attempt;
+
+		_attemptTriangles.clear();
+		_attemptCorners.clear();
+
+		const auto& triangle = _triangles[start];
+
+		for (int i = 0; i < 3; ++i)
+		{
+			_attemptCorners.push_back(triangle[(rotation + i) % 3]);
+		}
+
+		_attemptTriangles.push_back(start);
+		_attempts[start] = _attempt;
+
+		while (_attemptCorners.size() < MaxCommandVertices)
+		{
+			const std::size_t i = _attemptCorners.size();
+
+			int from, to;
+
+			//Each new vertex forms a triangle with the edge it has to continue from, in that triangle's winding order
+			if (isFan)
+			{
+				from = _attemptCorners[0];
+				to = _attemptCorners[i - 1];
+			}
+			else if (i % 2)
+			{
+				from = _attemptCorners[i - 1];
+				to = _attemptCorners[i - 2];
+			}
+			else
+			{
+				from = _attemptCorners[i - 2];
+				to = _attemptCorners[i - 1];
+			}
+
+			const int next = FindTriangle(from, to);
+
+			if (next == -1)
+			{
+				break;
+			}
+
+			_attemptTriangles.push_back(next);
+			_attempts[next] = _attempt;
+			_attemptCorners.push_back(GetThirdCorner(next, from, to));
+		}
+	}
+
+	void WriteCommand(std::vector<short>& commands, const std::vector<int>& corners, bool isFan) const
+	{
+		const auto count = static_cast<short>(corners.size());
+
+		commands.push_back(isFan ? -count : count);
+
+		for (const int corner : corners)
+		{
+			commands.insert(commands.end(), _corners[corner].begin(), _corners[corner].end());
+		}
+	}
+
+private:
+	std::vector<std::array<short, CommandVertexSize>> _corners;
+	std::unordered_map<std::uint64_t, int> _cornerIndices;
+
+	std::vector<Triangle> _triangles;
+
+	//Sorted by key
+	std::vector<Edge> _edges;
+
+	std::vector<bool> _used;
+
+	//Triangles added by the current attempt are marked with its number so attempts don't need to clear anything
+	std::vector<int> _attempts;
+	int _attempt = 0;
+
+	std::vector<int> _attemptTriangles;
+	std::vector<int> _attemptCorners;
+};
+}
+
+TriangleCommandStats GetTriangleCommandStats(const std::vector<short>& commands)
+{
+	TriangleCommandStats stats;
+
+	const short* cmds = commands.data();
+	const short* const end = cmds + commands.size();
+
+	for (int count; cmds < end && (count = *cmds++) != 0;)
+	{
+		if (count < 0)
+		{
+			++stats.Fans;
+		}
+		else
+		{
+			++stats.Strips;
+		}
+
+		count = std::abs(count);
+
+		stats.Vertices += count;
+		stats.Triangles += std::max(0, count - 2);
+
+		cmds += count * CommandVertexSize;
+	}
+
+	return stats;
+}
+
+std::vector<short> StripifyTriangleCommands(const std::vector<short>& commands)
+{
+	Stripifier stripifier;
+
+	if (!stripifier.ReadTriangles(commands))
+	{
+		return commands;
+	}
+
+	auto result = stripifier.Run();
+
+	const auto before = GetTriangleCommandStats(commands);
+	const auto after = GetTriangleCommandStats(result);
+
+	//Greedy stripification is not always better than what the compiler did
+	if (after.GetCommandCount() < before.GetCommandCount()
+		|| (after.GetCommandCount() == before.GetCommandCount() && after.Vertices < before.Vertices))
+	{
+		return result;
+	}
+
+	return commands;
+}
+
+StripifyResult StripifyModel(const EditableStudioModel& studioModel)
+{
+	StripifyResult result;
+
+	result.OldCommands = GetTriangleCommands(studioModel);
+	result.NewCommands.resize(result.OldCommands.size());
+
+	std::vector<TriangleCommandStats> before(result.OldCommands.size());
+	std::vector<TriangleCommandStats> after(result.OldCommands.size());
+
+	const auto task = [&](std::size_t index)
+	{
+		result.NewCommands[index] = StripifyTriangleCommands(result.OldCommands[index]);
+
+		before[index] = GetTriangleCommandStats(result.OldCommands[index]);
+		after[index] = GetTriangleCommandStats(result.NewCommands[index]);
+	};
+
+	int triangleCount = 0;
+
+	for (const auto& bodypart : studioModel.Bodyparts)
+	{
+		for (const auto& model : bodypart->Models)
+		{
+			for (const auto& mesh : model.Meshes)
+			{
+				triangleCount += mesh.NumTriangles;
+			}
+		}
+	}
+
+	if (triangleCount < MinimumParallelTriangleCount)
+	{
+		for (std::size_t i = 0; i < result.OldCommands.size(); ++i)
+		{
+			task(i);
+		}
+	}
+	else
+	{
+		RunInParallel(result.OldCommands.size(), task);
+	}
+
+	for (std::size_t i = 0; i < before.size(); ++i)
+	{
+		result.Before += before[i];
+		result.After += after[i];
+	}
+
+	return result;
+}
+}
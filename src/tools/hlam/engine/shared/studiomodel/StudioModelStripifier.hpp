@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+namespace studiomdl
+{
+class EditableStudioModel;
+
+struct TriangleCommandStats
+{
+	int Strips = 0;
+	int Fans = 0;
+	int Vertices = 0;
+	int Triangles = 0;
+
+	int GetCommandCount() const { return Strips + Fans; }
+
+	TriangleCommandStats& operator+=(const TriangleCommandStats& other)
+	{
+		Strips += other.Strips;
+		Fans += other.Fans;
+		Vertices += other.Vertices;
+		Triangles += other.Triangles;
+		return *this;
+	}
+};
+
+TriangleCommandStats GetTriangleCommandStats(const std::vector<short>& commands);
+
+/**
+*	@brief Rebuilds a mesh's triangle commands from the triangles they draw,
+*	using as few strips and fans as possible.
+*	Every triangle is drawn with the same vertices, normals, texture coordinates and winding as before.
+*	@return The new commands, or @p commands if they could not be improved.
+*/
+std::vector<short> StripifyTriangleCommands(const std::vector<short>& commands);
+
+struct StripifyResult
+{
+	//Triangle commands of all meshes, in bodypart order
+	std::vector<std::vector<short>> OldCommands;
+	std::vector<std::vector<short>> NewCommands;
+
+	TriangleCommandStats Before;
+	TriangleCommandStats After;
+};
+
+/**
+*	@brief Calculates new triangle commands for all meshes in @p studioModel.
+*	Use ApplyTriangleCommands to change the model.
+*/
+StripifyResult StripifyModel(const EditableStudioModel& studioModel);
+}
@@ -0,0 +1,368 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+#include "engine/shared/studiomodel/StudioModelRenderCost.hpp"
+#include "engine/shared/studiomodel/StudioModelTextureOptimizer.hpp"
+
+#include "utility/Parallel.hpp"
+#include "utility/Platform.hpp"
+
+namespace studiomdl
+{
+namespace
+{
+/**
+*	@brief What the optimizer found out about a single texture.
+*/
+struct TextureAnalysis
+{
+	bool IsRemap = false;
+	bool IsCompacted = false;
+	int FreedPaletteEntries = 0;
+	std::uint64_t Hash = 0;
+};
+
+constexpr std::uint64_t HashOffsetBasis = 14695981039346656037ULL;
+constexpr std::uint64_t HashPrime = 1099511628211ULL;
+
+std::uint64_t HashBytes(std::uint64_t hash, const void* data, std::size_t size)
+{
+	const auto bytes = reinterpret_cast<const std::uint8_t*>(data);
+
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		hash = (hash ^ bytes[i]) * HashPrime;
+	}
+
+	return hash;
+}
+
+std::uint64_t HashTexture(const Texture& texture)
+{
+	auto hash = HashOffsetBasis;
+
+	hash = HashBytes(hash, &texture.Flags, sizeof(texture.Flags));
+	hash = HashBytes(hash, &texture.Data.Width, sizeof(texture.Data.Width));
+	hash = HashBytes(hash, &texture.Data.Height, sizeof(texture.Data.Height));
+	hash = HashBytes(hash, texture.Data.Pixels.data(), texture.Data.Pixels.size());
+	hash = HashBytes(hash, texture.Data.Palette.AsByteArray(), texture.Data.Palette.GetSizeInBytes());
+
+	return hash;
+}
+
+bool IsSamePalette(const graphics::RGBPalette& lhs, const graphics::RGBPalette& rhs)
+{
+	return std::memcmp(lhs.AsByteArray(), rhs.AsByteArray(), lhs.GetSizeInBytes()) == 0;
+}
+
+bool AreIdentical(const Texture& lhs, const Texture& rhs)
+{
+	return lhs.Flags == rhs.Flags
+		&& lhs.Data.Width == rhs.Data.Width
+		&& lhs.Data.Height == rhs.Data.Height
+		&& lhs.Data.Pixels == rhs.Data.Pixels
+		&& IsSamePalette(lhs.Data.Palette, rhs.Data.Palette);
+}
+
+/**
+*	@brief Whether the renderer may treat a texture named @p name as a remap texture.
+*	Any name that starts like a remap texture name counts, to be safe.
+*/
+bool IsRemapTexture(std::string_view name)
+{
+	constexpr std::string_view DmBaseName{"DM_Base"};
+	constexpr std::string_view RemapName{"Remap"};
+
+	return (name.length() >= DmBaseName.length() && !strncasecmp(name.data(), DmBaseName.data(), DmBaseName.length()))
+		|| (name.length() >= RemapName.length() && !strncasecmp(name.data(), RemapName.data(), RemapName.length()));
+}
+
+bool IsSameColor(const graphics::RGB24& lhs, const graphics::RGB24& rhs)
+{
+	return lhs.R == rhs.R && lhs.G == rhs.G && lhs.B == rhs.B;
+}
+
+/**
+*	@brief Makes pixels with the same color use the same palette entry and clears entries that aren't used,
+*	so identical looking textures have identical data.
+*	The transparent color of masked textures is never merged with other colors.
+*	@return Number of palette entries that are no longer used.
+*/
+int CompactPalette(Texture& texture)
+{
+	auto& data = texture.Data;
+	auto& palette = data.Palette;
+
+	const bool masked = (texture.Flags & STUDIO_NF_MASKED) != 0;
+
+	const auto isReserved = [&](std::size_t index)
+	{
+		return masked && index == graphics::RGBPalette::AlphaIndex;
+	};
+
+	std::array<bool, graphics::RGBPalette::EntriesCount> used{};
+
+	for (const auto pixel : data.Pixels)
+	{
+		used[std::to_integer<std::size_t>(pixel)] = true;
+	}
+
+	std::array<std::uint8_t, graphics::RGBPalette::EntriesCount> remap;
+
+	int freedEntries = 0;
+
+	for (std::size_t i = 0; i < remap.size(); ++i)
+	{
+		remap[i] = static_cast<std::uint8_t>(i);
+
+		if (!used[i] || isReserved(i))
+		{
+			continue;
+		}
+
+		for (std::size_t j = 0; j < i; ++j)
+		{
+			if (used[j] && remap[j] == j && !isReserved(j) && IsSameColor(palette[j], palette[i]))
+			{
+				remap[i] = static_cast<std::uint8_t>(j);
+				used[i] = false;
+				++freedEntries;
+				break;
+			}
+		}
+	}
+
+	if (freedEntries > 0)
+	{
+		for (auto& pixel : data.Pixels)
+		{
+			pixel = static_cast<std::byte>(remap[std::to_integer<std::size_t>(pixel)]);
+		}
+	}
+
+	for (std::size_t i = 0; i < palette.size(); ++i)
+	{
+		if (!used[i] && !isReserved(i))
+		{
+			palette[i] = {};
+		}
+	}
+
+	return freedEntries;
+}
+
+std::size_t GetFileSize(const TextureSet& textureSet)
+{
+	std::size_t size = 0;
+
+	for (const auto& texture : textureSet.Textures)
+	{
+		size += sizeof(mstudiotexture_t)
+			+ static_cast<std::size_t>(texture.Data.Width) * texture.Data.Height
+			+ texture.Data.Palette.GetSizeInBytes();
+	}
+
+	const std::size_t skinReferences = !textureSet.SkinFamilies.empty() ? textureSet.SkinFamilies[0].size() : 0;
+
+	size += textureSet.SkinFamilies.size() * skinReferences * sizeof(short);
+
+	return size;
+}
+
+std::size_t GetVideoMemory(const TextureSet& textureSet)
+{
+	std::size_t size = 0;
+
+	for (const auto& texture : textureSet.Textures)
+	{
+		size += AnalyzeTexture(texture).Memory;
+	}
+
+	return size;
+}
+
+/**
+*	@brief Removes skin references that use the same texture as an earlier one in every skin family.
+*	Skin families themselves are never removed since game code selects them by number.
+*/
+int MergeSkinReferences(TextureSet& textureSet)
+{
+	auto& families = textureSet.SkinFamilies;
+
+	if (families.empty())
+	{
+		return 0;
+	}
+
+	const int count = static_cast<int>(families[0].size());
+
+	const bool isValid = std::all_of(families.begin(), families.end(), [&](const auto& family)
+		{
+			return static_cast<int>(family.size()) == count;
+		})
+		&& std::all_of(textureSet.SkinRefs.begin(), textureSet.SkinRefs.end(), [&](int skinRef)
+			{
+				return skinRef >= 0 && skinRef < count;
+			});
+
+	if (!isValid)
+	{
+		return 0;
+	}
+
+	std::vector<int> newIndices(count);
+	std::vector<int> kept;
+
+	for (int i = 0; i < count; ++i)
+	{
+		const auto it = std::find_if(kept.begin(), kept.end(), [&](int candidate)
+			{
+				return std::all_of(families.begin(), families.end(), [&](const auto& family)
+					{
+						return family[candidate] == family[i];
+					});
+			});
+
+		if (it != kept.end())
+		{
+			newIndices[i] = newIndices[*it];
+		}
+		else
+		{
+			newIndices[i] = static_cast<int>(kept.size());
+			kept.push_back(i);
+		}
+	}
+
+	if (static_cast<int>(kept.size()) == count)
+	{
+		return 0;
+	}
+
+	for (auto& family : families)
+	{
+		std::vector<int> newFamily;
+
+		newFamily.reserve(kept.size());
+
+		for (const int index : kept)
+		{
+			newFamily.push_back(family[index]);
+		}
+
+		family = std::move(newFamily);
+	}
+
+	for (auto& skinRef : textureSet.SkinRefs)
+	{
+		skinRef = newIndices[skinRef];
+	}
+
+	return count - static_cast<int>(kept.size());
+}
+}
+
+TextureOptimizationResult OptimizeTextures(const EditableStudioModel& studioModel)
+{
+	TextureOptimizationResult result;
+
+	auto& textureSet = result.Textures;
+
+	textureSet = GetTextureSet(studioModel);
+
+	result.OldFileSize = GetFileSize(textureSet);
+	result.OldVideoMemory = GetVideoMemory(textureSet);
+
+	auto& textures = textureSet.Textures;
+
+	std::vector<TextureAnalysis> analyses(textures.size());
+
+	RunInParallel(textures.size(), [&](std::size_t index)
+		{
+			auto& texture = textures[index];
+			auto& analysis = analyses[index];
+
+			analysis.IsRemap = IsRemapTexture(texture.Name);
+
+			if (!analysis.IsRemap)
+			{
+				const auto original = texture.Data;
+
+				analysis.FreedPaletteEntries = CompactPalette(texture);
+				analysis.IsCompacted = texture.Data.Pixels != original.Pixels || !IsSamePalette(texture.Data.Palette, original.Palette);
+			}
+
+			analysis.Hash = HashTexture(texture);
+		});
+
+	for (const auto& analysis : analyses)
+	{
+		if (analysis.IsCompacted)
+		{
+			++result.CompactedPalettes;
+			result.FreedPaletteEntries += analysis.FreedPaletteEntries;
+		}
+	}
+
+	//Map each texture to the first texture that is identical to it
+	std::unordered_map<std::uint64_t, std::vector<int>> texturesByHash;
+
+	std::vector<int> newIndices(textures.size());
+	std::vector<Texture> keptTextures;
+
+	keptTextures.reserve(textures.size());
+
+	for (std::size_t i = 0; i < textures.size(); ++i)
+	{
+		auto& texture = textures[i];
+
+		if (!analyses[i].IsRemap)
+		{
+			auto& candidates = texturesByHash[analyses[i].Hash];
+
+			const auto it = std::find_if(candidates.begin(), candidates.end(), [&](int candidate)
+				{
+					return AreIdentical(keptTextures[candidate], texture);
+				});
+
+			if (it != candidates.end())
+			{
+				newIndices[i] = *it;
+				result.MergedTextures.push_back({texture.Name, keptTextures[*it].Name});
+				continue;
+			}
+
+			candidates.push_back(static_cast<int>(keptTextures.size()));
+		}
+
+		newIndices[i] = static_cast<int>(keptTextures.size());
+		keptTextures.push_back(std::move(texture));
+	}
+
+	textures = std::move(keptTextures);
+
+	for (std::size_t i = 0; i < textures.size(); ++i)
+	{
+		textures[i].ArrayIndex = static_cast<int>(i);
+	}
+
+	for (auto& family : textureSet.SkinFamilies)
+	{
+		for (auto& index : family)
+		{
+			index = newIndices[index];
+		}
+	}
+
+	result.MergedSkinReferences = MergeSkinReferences(textureSet);
+
+	result.NewFileSize = GetFileSize(textureSet);
+	result.NewVideoMemory = GetVideoMemory(textureSet);
+
+	return result;
+}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+
+namespace studiomdl
+{
+struct MergedTexture
+{
+	std::string Name;
+
+	//Name of the identical texture that is used instead
+	std::string MergedInto;
+};
+
+struct TextureOptimizationResult
+{
+	TextureSet Textures;
+
+	std::vector<MergedTexture> MergedTextures;
+
+	//Number of skin references removed because they always use the same texture as another one
+	int MergedSkinReferences = 0;
+
+	//Number of textures whose palette had duplicate or unused colors
+	int CompactedPalettes = 0;
+
+	//Number of palette entries no longer used by any pixel after merging duplicate colors
+	int FreedPaletteEntries = 0;
+
+	std::size_t OldFileSize = 0;
+	std::size_t NewFileSize = 0;
+
+	std::size_t OldVideoMemory = 0;
+	std::size_t NewVideoMemory = 0;
+
+	bool HasChanges() const
+	{
+		return !MergedTextures.empty() || MergedSkinReferences > 0 || CompactedPalettes > 0;
+	}
+};
+
+/**
+*	@brief Finds textures that are identical to another texture, skin references that use the same texture in every skin family
+*	and palettes with duplicate or unused colors, and calculates a texture set without them.
+*	Merging colors changes which palette entries are used but not how a texture looks.
+*	Remap textures are left as they are because their palette ranges are used to change colors.
+*	Use ApplyTextureSet to change the model.
+*/
+TextureOptimizationResult OptimizeTextures(const EditableStudioModel& studioModel);
+}
@@ -4,9 +4,14 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+#include "assets/AssetIO.hpp"
+
 #include "engine/shared/studiomodel/StudioModelUtils.hpp"
 
 #include "utility/Platform.hpp"
@@ -129,18 +134,16 @@ std::vector<std::unique_ptr<SequenceGroup>> ConvertSequenceGroupsToEditable(cons
 
 	std::vector<std::unique_ptr<SequenceGroup>> result;
 
-	//Only copy the first group (main file)
-	const int numseqgroups = 1; //header->numseqgroups;
-
-	result.reserve(numseqgroups);
+	result.reserve(header->numseqgroups);
 
-	for (int i = 0; i < numseqgroups; ++i)
+	for (int i = 0; i < header->numseqgroups; ++i)
 	{
 		auto source = header->GetSequenceGroup(i);
 
 		SequenceGroup group
 		{
-			source->label
+			source->label,
+			source->name
 		};
 
 		result.push_back(std::make_unique<SequenceGroup>(std::move(group)));
@@ -325,7 +328,8 @@ std::vector<std::unique_ptr<Sequence>> ConvertSequencesToEditable(const StudioMo
 			source->entrynode,
 			source->exitnode,
 			source->nodeflags,
-			source->nextseq
+			source->nextseq,
+			source->seqgroup
 		};
 
 		result.push_back(std::make_unique<Sequence>(std::move(sequence)));
@@ -674,6 +678,7 @@ EditableStudioModel ConvertToEditable(const StudioModel& studioModel)
 
 	result.Textures = ConvertTexturesToEditable(studioModel);
 	result.SkinFamilies = ConvertSkinFamiliesToEditable(studioModel, result.Textures);
+	result.HasExternalTextures = studioModel.HasSeparateTextureHeader();
 
 	result.Transitions = ConvertTransitionsToEditable(studioModel);
 
@@ -682,52 +687,280 @@ EditableStudioModel ConvertToEditable(const StudioModel& studioModel)
 
 namespace
 {
-template<typename T>
-T* AllocateBufferArray(std::vector<std::byte>& buffer, std::size_t count)
+/**
+*	@brief Rounds @p size up to a 4 byte boundary, matching the compiler's alignment of sections.
+*/
+constexpr std::size_t AlignSize(std::size_t size)
 {
-	const auto position = buffer.size();
-	buffer.resize(position + sizeof(T) * count);
+	return (size + 3) & ~static_cast<std::size_t>(3);
+}
+
+/**
+*	@brief Gets the group whose file a sequence's animations are written to.
+*	Sequences that refer to a group that doesn't exist are written to the main file.
+*/
+std::size_t GetSequenceGroupIndex(const EditableStudioModel& studioModel, const Sequence& sequence)
+{
+	if (sequence.SequenceGroupIndex > 0 && static_cast<std::size_t>(sequence.SequenceGroupIndex) < studioModel.SequenceGroups.size())
+	{
+		return sequence.SequenceGroupIndex;
+	}
 
-	return reinterpret_cast<T*>(buffer.data() + position);
+	return 0;
 }
 
-static void WriteRawBytes(std::vector<std::byte>& buffer, const std::byte* data, std::size_t sizeInBytes)
+/**
+*	@brief Offsets of each section in a studio model file and the total file size.
+*	Used for the main file, the texture file and sequence group files, which each contain a subset of the sections.
+*/
+struct StudioModelLayout
 {
-	const auto position = buffer.size();
-	buffer.resize(position + sizeInBytes);
-	std::memcpy(buffer.data() + position, data, sizeInBytes);
+	std::size_t BoneIndex = 0;
+	std::size_t BoneControllerIndex = 0;
+	std::size_t AttachmentIndex = 0;
+	std::size_t HitboxIndex = 0;
+	std::size_t AnimationIndex = 0;
+	std::size_t SequenceIndex = 0;
+	std::size_t SequenceGroupIndex = 0;
+	std::size_t TransitionIndex = 0;
+	std::size_t BodypartIndex = 0;
+	std::size_t TextureIndex = 0;
+	std::size_t SkinIndex = 0;
+	std::size_t TextureDataIndex = 0;
+	std::size_t Length = 0;
+};
+
+/**
+*	@brief Computes the size of the animations of all sequences in @p sequenceGroup, starting at offset @p size.
+*	@return Offset of the end of the animations.
+*/
+std::size_t ComputeAnimationsLayout(const EditableStudioModel& studioModel, std::size_t sequenceGroup, std::size_t size)
+{
+	for (const auto& sequence : studioModel.Sequences)
+	{
+		if (GetSequenceGroupIndex(studioModel, *sequence) != sequenceGroup)
+		{
+			continue;
+		}
+
+		size = AlignSize(size + (sizeof(mstudioanim_t) * sequence->AnimationBlends.size() * studioModel.Bones.size()));
+
+		for (const auto& blend : sequence->AnimationBlends)
+		{
+			for (std::size_t bone = 0; bone < studioModel.Bones.size(); ++bone)
+			{
+				for (const auto& values : blend[bone].Data)
+				{
+					size += sizeof(mstudioanimvalue_t) * values.size();
+				}
+			}
+		}
+
+		size = AlignSize(size);
+	}
+
+	return size;
 }
 
-template<typename T>
-static void WriteBytes(std::vector<std::byte>& buffer, const T& data)
+/**
+*	@brief Computes the offsets of the texture, skin and texture data sections, starting at offset @p size.
+*	@return Offset of the end of the texture data.
+*/
+std::size_t ComputeTexturesLayout(const EditableStudioModel& studioModel, StudioModelLayout& layout, std::size_t size)
 {
-	WriteRawBytes(buffer, reinterpret_cast<const std::byte*>(&data), sizeof(data));
+	layout.TextureIndex = size;
+	size = AlignSize(size + (sizeof(mstudiotexture_t) * studioModel.Textures.size()));
+
+	layout.SkinIndex = size;
+
+	for (const auto& family : studioModel.SkinFamilies)
+	{
+		size += sizeof(short) * family.size();
+	}
+
+	size = AlignSize(size);
+
+	layout.TextureDataIndex = size;
+
+	for (const auto& texture : studioModel.Textures)
+	{
+		size += texture->Data.Pixels.size() + sizeof(texture->Data.Palette);
+	}
+
+	return AlignSize(size);
 }
 
-static void AlignBuffer(std::vector<std::byte>& buffer)
+/**
+*	@brief Computes the layout of the main file that ConvertFromEditable writes for @p studioModel.
+*	Must be kept in sync with the Convert*FromEditable functions below.
+*/
+StudioModelLayout ComputeStudioModelLayout(const EditableStudioModel& studioModel)
 {
-	const std::size_t remainder = buffer.size() % 4;
+	StudioModelLayout layout;
+
+	std::size_t size = sizeof(studiohdr_t);
+
+	layout.BoneIndex = size;
+	size += sizeof(mstudiobone_t) * studioModel.Bones.size();
+
+	layout.BoneControllerIndex = size;
+	size = AlignSize(size + (sizeof(mstudiobonecontroller_t) * studioModel.BoneControllers.size()));
 
-	if (remainder != 0)
+	layout.AttachmentIndex = size;
+	size = AlignSize(size + (sizeof(mstudioattachment_t) * studioModel.Attachments.size()));
+
+	layout.HitboxIndex = size;
+	size = AlignSize(size + (sizeof(mstudiobbox_t) * studioModel.Hitboxes.size()));
+
+	layout.AnimationIndex = size;
+	size = ComputeAnimationsLayout(studioModel, 0, size);
+
+	layout.SequenceIndex = size;
+	size += sizeof(mstudioseqdesc_t) * studioModel.Sequences.size();
+
+	for (const auto& sequence : studioModel.Sequences)
+	{
+		size = AlignSize(size + (sizeof(mstudioevent_t) * sequence->SortedEvents.size()));
+		size = AlignSize(size + (sizeof(mstudiopivot_t) * sequence->Pivots.size()));
+	}
+
+	layout.SequenceGroupIndex = size;
+	size = AlignSize(size + (sizeof(mstudioseqgroup_t) * studioModel.SequenceGroups.size()));
+
+	layout.TransitionIndex = size;
+	size = AlignSize(size + (studioModel.Transitions.size() * studioModel.Transitions.size()));
+
+	layout.BodypartIndex = size;
+	size += sizeof(mstudiobodyparts_t) * studioModel.Bodyparts.size();
+
+	for (const auto& bodypart : studioModel.Bodyparts)
+	{
+		size += sizeof(mstudiomodel_t) * bodypart->Models.size();
+	}
+
+	for (const auto& bodypart : studioModel.Bodyparts)
 	{
-		//Align start of next data to a 4 byte boundary
-		const std::size_t bytesToAdd = 4 - remainder;
+		for (const auto& model : bodypart->Models)
+		{
+			size = AlignSize(size + model.Vertices.size());
+			size = AlignSize(size + model.Normals.size());
+			size = AlignSize(size + (sizeof(glm::vec3) * model.Vertices.size()));
+			size = AlignSize(size + (sizeof(glm::vec3) * model.Normals.size()));
+
+			size += sizeof(mstudiomesh_t) * model.Meshes.size();
+
+			for (const auto& mesh : model.Meshes)
+			{
+				size = AlignSize(size + (sizeof(short) * mesh.Triangles.size()));
+			}
+		}
+	}
+
+	size = AlignSize(size);
+
+	if (!studioModel.HasExternalTextures)
+	{
+		size = ComputeTexturesLayout(studioModel, layout, size);
+	}
+
+	layout.Length = size;
+
+	return layout;
+}
+
+StudioModelLayout ComputeTextureFileLayout(const EditableStudioModel& studioModel)
+{
+	StudioModelLayout layout;
+
+	layout.Length = ComputeTexturesLayout(studioModel, layout, sizeof(studiohdr_t));
+
+	return layout;
+}
+
+StudioModelLayout ComputeSequenceGroupFileLayout(const EditableStudioModel& studioModel, std::size_t sequenceGroup)
+{
+	StudioModelLayout layout;
+
+	layout.AnimationIndex = sizeof(studioseqhdr_t);
+	layout.Length = ComputeAnimationsLayout(studioModel, sequenceGroup, layout.AnimationIndex);
+
+	return layout;
+}
+
+/**
+*	@brief Writes sections one after the other into a zero initialized buffer whose size was computed up front.
+*/
+class StudioModelBuffer final
+{
+public:
+	StudioModelBuffer(std::byte* data, std::size_t size)
+		: _data(data)
+		, _size(size)
+	{
+	}
+
+	std::byte* GetData() const { return _data; }
+
+	std::size_t GetPosition() const { return _position; }
+
+	/**
+	*	@brief Reserves the next @p sizeInBytes bytes and returns a pointer to them.
+	*	@exception std::logic_error If the layout computed for this buffer is too small.
+	*/
+	std::byte* Allocate(std::size_t sizeInBytes)
+	{
+		if (sizeInBytes > _size - _position)
+		{
+			throw std::logic_error("Studio model data does not fit in the computed layout");
+		}
+
+		auto data = _data + _position;
+
+		_position += sizeInBytes;
 
-		const std::byte pad[3]{};
+		return data;
+	}
+
+private:
+	std::byte* const _data;
+	const std::size_t _size;
+	std::size_t _position = 0;
+};
 
-		WriteRawBytes(buffer, pad, bytesToAdd);
+template<typename T>
+T* AllocateBufferArray(StudioModelBuffer& buffer, std::size_t count)
+{
+	return reinterpret_cast<T*>(buffer.Allocate(sizeof(T) * count));
+}
+
+static void WriteRawBytes(StudioModelBuffer& buffer, const std::byte* data, std::size_t sizeInBytes)
+{
+	auto dest = buffer.Allocate(sizeInBytes);
+
+	if (sizeInBytes > 0)
+	{
+		std::memcpy(dest, data, sizeInBytes);
 	}
 }
 
-void ConvertBonesFromEditable(const EditableStudioModel& studioModel, studiohdr_t& header, std::vector<std::byte>& buffer)
+static void AlignBuffer(StudioModelBuffer& buffer)
+{
+	//Align start of next data to a 4 byte boundary
+	//The buffer is zero initialized so the padding only needs to be skipped
+	buffer.Allocate(AlignSize(buffer.GetPosition()) - buffer.GetPosition());
+}
+
+void ConvertBonesFromEditable(const EditableStudioModel& studioModel, const StudioModelLayout& layout, studiohdr_t& header, StudioModelBuffer& buffer)
 {
 	assert(MAXSTUDIOCONTROLLERS >= studioModel.BoneControllers.size());
 
 	std::array<int, MAXSTUDIOCONTROLLERS> boneControllerToBoneMap{};
 
 	{
+		assert(buffer.GetPosition() == layout.BoneIndex);
+
 		header.numbones = studioModel.Bones.size();
-		header.boneindex = buffer.size();
+		header.boneindex = buffer.GetPosition();
 
 		auto bones = AllocateBufferArray<mstudiobone_t>(buffer, studioModel.Bones.size());
 
@@ -761,8 +994,10 @@ void ConvertBonesFromEditable(const EditableStudioModel& studioModel, studiohdr_
 	}
 
 	{
+		assert(buffer.GetPosition() == layout.BoneControllerIndex);
+
 		header.numbonecontrollers = studioModel.BoneControllers.size();
-		header.bonecontrollerindex = buffer.size();
+		header.bonecontrollerindex = buffer.GetPosition();
 
 		auto boneControllers = AllocateBufferArray<mstudiobonecontroller_t>(buffer, studioModel.BoneControllers.size());
 
@@ -782,10 +1017,12 @@ void ConvertBonesFromEditable(const EditableStudioModel& studioModel, studiohdr_
 	}
 }
 
-void ConvertAttachmentsFromEditable(const EditableStudioModel& studioModel, studiohdr_t& header, std::vector<std::byte>& buffer)
+void ConvertAttachmentsFromEditable(const EditableStudioModel& studioModel, const StudioModelLayout& layout, studiohdr_t& header, StudioModelBuffer& buffer)
 {
+	assert(buffer.GetPosition() == layout.AttachmentIndex);
+
 	header.numattachments = studioModel.Attachments.size();
-	header.attachmentindex = buffer.size();
+	header.attachmentindex = buffer.GetPosition();
 
 	auto attachments = AllocateBufferArray<mstudioattachment_t>(buffer, studioModel.Attachments.size());
 
@@ -808,10 +1045,12 @@ void ConvertAttachmentsFromEditable(const EditableStudioModel& studioModel, stud
 	AlignBuffer(buffer);
 }
 
-void ConvertHitboxesFromEditable(const EditableStudioModel& studioModel, studiohdr_t& header, std::vector<std::byte>& buffer)
+void ConvertHitboxesFromEditable(const EditableStudioModel& studioModel, const StudioModelLayout& layout, studiohdr_t& header, StudioModelBuffer& buffer)
 {
+	assert(buffer.GetPosition() == layout.HitboxIndex);
+
 	header.numhitboxes = studioModel.Hitboxes.size();
-	header.hitboxindex = buffer.size();
+	header.hitboxindex = buffer.GetPosition();
 
 	auto hitboxes = AllocateBufferArray<mstudiobbox_t>(buffer, studioModel.Hitboxes.size());
 
@@ -829,24 +1068,28 @@ void ConvertHitboxesFromEditable(const EditableStudioModel& studioModel, studioh
 	AlignBuffer(buffer);
 }
 
-std::vector<std::size_t> ConvertAnimationsFromEditable(const EditableStudioModel& studioModel, studiohdr_t& header, std::vector<std::byte>& buffer)
+/**
+*	@brief Writes the animations of all sequences in @p sequenceGroup and stores their offsets in @p sequenceAnimationIndices.
+*/
+void ConvertAnimationsFromEditable(const EditableStudioModel& studioModel, std::size_t sequenceGroup, const StudioModelLayout& layout,
+	std::vector<std::size_t>& sequenceAnimationIndices, StudioModelBuffer& buffer)
 {
-	std::vector<std::size_t> sequenceAnimationIndices;
-
-	sequenceAnimationIndices.reserve(studioModel.Sequences.size());
-
-	std::vector<mstudioanim_t> animations;
+	assert(buffer.GetPosition() == layout.AnimationIndex);
 
 	for (std::size_t i = 0; i < studioModel.Sequences.size(); ++i)
 	{
 		const auto& source = *studioModel.Sequences[i];
 
-		animations.resize(source.AnimationBlends.size() * studioModel.Bones.size());
+		if (GetSequenceGroupIndex(studioModel, source) != sequenceGroup)
+		{
+			continue;
+		}
 
-		sequenceAnimationIndices.push_back(buffer.size());
-		
-		//Allocate the space for the offsets array, but don't write to it yet
-		AllocateBufferArray<mstudioanim_t>(buffer, animations.size());
+		const std::size_t animationIndex = buffer.GetPosition();
+
+		sequenceAnimationIndices[i] = animationIndex;
+
+		auto animations = AllocateBufferArray<mstudioanim_t>(buffer, source.AnimationBlends.size() * studioModel.Bones.size());
 
 		AlignBuffer(buffer);
 
@@ -854,7 +1097,9 @@ std::vector<std::size_t> ConvertAnimationsFromEditable(const EditableStudioModel
 		{
 			for (std::size_t bone = 0; bone < studioModel.Bones.size(); ++bone)
 			{
-				auto& destOffsets = animations[(blend * studioModel.Bones.size()) + bone];
+				const std::size_t offsetsIndex = (blend * studioModel.Bones.size()) + bone;
+
+				auto& destOffsets = animations[offsetsIndex];
 
 				for (int axis = 0; axis < STUDIO_NUM_COORDINATE_AXES; ++axis)
 				{
@@ -867,8 +1112,15 @@ std::vector<std::size_t> ConvertAnimationsFromEditable(const EditableStudioModel
 					else
 					{
 						//Offsets are relative to the current animation, not relative to start of the buffer
-						destOffsets.offset[axis] = (buffer.size() - sequenceAnimationIndices.back())
-							- (((blend * studioModel.Bones.size()) + bone) * sizeof(mstudioanim_t));
+						const std::size_t offset = (buffer.GetPosition() - animationIndex) - (offsetsIndex * sizeof(mstudioanim_t));
+
+						if (offset > std::numeric_limits<unsigned short>::max())
+						{
+							throw assets::AssetException("The animations of sequence \"" + source.Label
+								+ "\" are too large, bone values must start within 64 KiB of the animation that uses them");
+						}
+
+						destOffsets.offset[axis] = static_cast<unsigned short>(offset);
 
 						WriteRawBytes(buffer, reinterpret_cast<const std::byte*>(sourceOffsets.data()), sourceOffsets.size() * sizeof(mstudioanimvalue_t));
 					}
@@ -877,34 +1129,24 @@ std::vector<std::size_t> ConvertAnimationsFromEditable(const EditableStudioModel
 		}
 
 		AlignBuffer(buffer);
-
-		//Copy the finished animations array
-		std::memcpy(buffer.data() + sequenceAnimationIndices.back(), animations.data(), animations.size() * sizeof(mstudioanim_t));
 	}
-
-	return sequenceAnimationIndices;
 }
 
-void ConvertSequencesFromEditable(const EditableStudioModel& studioModel, const std::vector<std::size_t>& sequenceAnimationIndices,
-	studiohdr_t& header, std::vector<std::byte>& buffer)
+void ConvertSequencesFromEditable(const EditableStudioModel& studioModel, const StudioModelLayout& layout,
+	const std::vector<std::size_t>& sequenceAnimationIndices, studiohdr_t& header, StudioModelBuffer& buffer)
 {
-	header.numseq = studioModel.Sequences.size();
-	header.seqindex = buffer.size();
+	assert(buffer.GetPosition() == layout.SequenceIndex);
 
-	std::vector<mstudioseqdesc_t> sequences;
-
-	sequences.reserve(header.numseq);
+	header.numseq = studioModel.Sequences.size();
+	header.seqindex = buffer.GetPosition();
 
-	//Allocate the space for the sequences array, but don't write to it yet
-	AllocateBufferArray<mstudioseqdesc_t>(buffer, header.numseq);
+	auto sequences = AllocateBufferArray<mstudioseqdesc_t>(buffer, header.numseq);
 
 	for (int i = 0; i < header.numseq; ++i)
 	{
 		const auto& source = *studioModel.Sequences[i];
 
-		mstudioseqdesc_t dest{};
-
-		std::memset(&dest, 0, sizeof(dest));
+		auto& dest = sequences[i];
 
 		UTIL_CopyString(dest.label, source.Label.c_str());
 		dest.numframes = source.NumFrames;
@@ -926,8 +1168,7 @@ void ConvertSequencesFromEditable(const EditableStudioModel& studioModel, const
 		dest.motionbone = source.MotionBone;
 		dest.linearmovement = source.LinearMovement;
 
-		//Always in the main file
-		dest.seqgroup = 0;
+		dest.seqgroup = GetSequenceGroupIndex(studioModel, source);
 
 		dest.animindex = sequenceAnimationIndices[i];
 
@@ -944,7 +1185,7 @@ void ConvertSequencesFromEditable(const EditableStudioModel& studioModel, const
 		dest.nextseq = source.NextSequence;
 
 		{
-			dest.eventindex = buffer.size();
+			dest.eventindex = buffer.GetPosition();
 			dest.numevents = source.SortedEvents.size();
 
 			auto events = AllocateBufferArray<mstudioevent_t>(buffer, source.SortedEvents.size());
@@ -964,7 +1205,7 @@ void ConvertSequencesFromEditable(const EditableStudioModel& studioModel, const
 		}
 
 		{
-			dest.pivotindex = buffer.size();
+			dest.pivotindex = buffer.GetPosition();
 			dest.numpivots = source.Pivots.size();
 
 			auto pivots = AllocateBufferArray<mstudiopivot_t>(buffer, source.Pivots.size());
@@ -981,29 +1222,25 @@ void ConvertSequencesFromEditable(const EditableStudioModel& studioModel, const
 
 			AlignBuffer(buffer);
 		}
-
-		sequences.push_back(dest);
 	}
-
-	//Copy the finished sequences array
-	std::memcpy(buffer.data() + header.seqindex, sequences.data(), sequences.size() * sizeof(mstudioseqdesc_t));
 }
 
-void ConvertSequenceGroupsFromEditable(const EditableStudioModel& studioModel, studiohdr_t& header, std::vector<std::byte>& buffer)
+void ConvertSequenceGroupsFromEditable(const EditableStudioModel& studioModel, const StudioModelLayout& layout, studiohdr_t& header, StudioModelBuffer& buffer)
 {
+	assert(buffer.GetPosition() == layout.SequenceGroupIndex);
+
 	header.numseqgroups = studioModel.SequenceGroups.size();
-	header.seqgroupindex = buffer.size();
+	header.seqgroupindex = buffer.GetPosition();
 
 	auto groups = AllocateBufferArray<mstudioseqgroup_t>(buffer, studioModel.SequenceGroups.size());
 
-	//Only one group will ever exist at this point
 	for (int i = 0; i < header.numseqgroups; ++i)
 	{
 		const auto& source = *studioModel.SequenceGroups[i];
 		auto& dest = groups[i];
 
 		UTIL_CopyString(dest.label, source.Label.c_str());
-		dest.name[0] = '\0';
+		UTIL_CopyString(dest.name, source.Name.c_str());
 		dest.unused1 = 0;
 		dest.unused2 = 0;
 	}
@@ -1011,10 +1248,12 @@ void ConvertSequenceGroupsFromEditable(const EditableStudioModel& studioModel, s
 	AlignBuffer(buffer);
 }
 
-void ConvertTransitionsFromEditable(const EditableStudioModel& studioModel, studiohdr_t& header, std::vector<std::byte>& buffer)
+void ConvertTransitionsFromEditable(const EditableStudioModel& studioModel, const StudioModelLayout& layout, studiohdr_t& header, StudioModelBuffer& buffer)
 {
+	assert(buffer.GetPosition() == layout.TransitionIndex);
+
 	header.numtransitions = studioModel.Transitions.size();
-	header.transitionindex = buffer.size();
+	header.transitionindex = buffer.GetPosition();
 
 	auto transitions = AllocateBufferArray<std::byte>(buffer, studioModel.Transitions.size() * studioModel.Transitions.size());
 
@@ -1028,21 +1267,20 @@ void ConvertTransitionsFromEditable(const EditableStudioModel& studioModel, stud
 	AlignBuffer(buffer);
 }
 
-void ConvertBodypartsFromEditable(const EditableStudioModel& studioModel, studiohdr_t& header, std::vector<std::byte>& buffer)
+void ConvertBodypartsFromEditable(const EditableStudioModel& studioModel, const StudioModelLayout& layout, studiohdr_t& header, StudioModelBuffer& buffer)
 {
-	header.numbodyparts = studioModel.Bodyparts.size();
-	header.bodypartindex = buffer.size();
-
-	//Allocate the space for the sequences array, but don't write to it yet
-	AllocateBufferArray<mstudiobodyparts_t>(buffer, studioModel.Bodyparts.size());
+	assert(buffer.GetPosition() == layout.BodypartIndex);
 
-	std::vector<mstudiobodyparts_t> bodyparts;
+	header.numbodyparts = studioModel.Bodyparts.size();
+	header.bodypartindex = buffer.GetPosition();
 
-	bodyparts.reserve(header.numbodyparts);
+	auto bodyparts = AllocateBufferArray<mstudiobodyparts_t>(buffer, studioModel.Bodyparts.size());
 
-	std::size_t modelsOffset = buffer.size();
+	std::size_t modelsOffset = buffer.GetPosition();
 
 	//Allocate the entire models array upfront to match the compiler
+	mstudiomodel_t* models;
+
 	{
 		std::size_t modelsCount = 0;
 
@@ -1052,14 +1290,14 @@ void ConvertBodypartsFromEditable(const EditableStudioModel& studioModel, studio
 			modelsCount += source.Models.size();
 		}
 
-		AllocateBufferArray<mstudiomodel_t>(buffer, modelsCount);
+		models = AllocateBufferArray<mstudiomodel_t>(buffer, modelsCount);
 	}
 
 	for (int i = 0; i < header.numbodyparts; ++i)
 	{
 		const auto& source = *studioModel.Bodyparts[i];
 
-		mstudiobodyparts_t bodypart{};
+		auto& bodypart = bodyparts[i];
 
 		UTIL_CopyString(bodypart.name, source.Name.c_str());
 
@@ -1069,20 +1307,16 @@ void ConvertBodypartsFromEditable(const EditableStudioModel& studioModel, studio
 
 		modelsOffset += bodypart.nummodels * sizeof(mstudiomodel_t);
 
-		std::vector<mstudiomodel_t> models;
-
-		models.reserve(source.Models.size());
-
-		for (std::size_t m = 0; m < source.Models.size(); ++m)
+		for (std::size_t m = 0; m < source.Models.size(); ++m, ++models)
 		{
 			const auto& sourceModel = source.Models[m];
-			mstudiomodel_t destModel{};
+			auto& destModel = *models;
 
 			UTIL_CopyString(destModel.name, sourceModel.Name.c_str());
 
 			{
 				destModel.numverts = sourceModel.Vertices.size();
-				destModel.vertinfoindex = buffer.size();
+				destModel.vertinfoindex = buffer.GetPosition();
 
 				auto vertexInfo = AllocateBufferArray<std::uint8_t>(buffer, destModel.numverts);
 
@@ -1096,7 +1330,7 @@ void ConvertBodypartsFromEditable(const EditableStudioModel& studioModel, studio
 
 			{
 				destModel.numnorms = sourceModel.Normals.size();
-				destModel.norminfoindex = buffer.size();
+				destModel.norminfoindex = buffer.GetPosition();
 
 				auto normalInfo = AllocateBufferArray<std::uint8_t>(buffer, destModel.numnorms);
 
@@ -1109,7 +1343,7 @@ void ConvertBodypartsFromEditable(const EditableStudioModel& studioModel, studio
 			}
 
 			{
-				destModel.vertindex = buffer.size();
+				destModel.vertindex = buffer.GetPosition();
 
 				auto vertices = AllocateBufferArray<glm::vec3>(buffer, destModel.numverts);
 
@@ -1122,7 +1356,7 @@ void ConvertBodypartsFromEditable(const EditableStudioModel& studioModel, studio
 			}
 
 			{
-				destModel.normindex = buffer.size();
+				destModel.normindex = buffer.GetPosition();
 
 				auto normals = AllocateBufferArray<glm::vec3>(buffer, destModel.numnorms);
 
@@ -1136,65 +1370,49 @@ void ConvertBodypartsFromEditable(const EditableStudioModel& studioModel, studio
 
 			{
 				destModel.nummesh = sourceModel.Meshes.size();
-				destModel.meshindex = buffer.size();
-
-				AllocateBufferArray<mstudiomesh_t>(buffer, destModel.nummesh);
-
-				std::vector<mstudiomesh_t> meshes;
+				destModel.meshindex = buffer.GetPosition();
 
-				meshes.reserve(destModel.nummesh);
+				auto meshes = AllocateBufferArray<mstudiomesh_t>(buffer, destModel.nummesh);
 
 				for (int mesh = 0; mesh < sourceModel.Meshes.size(); ++mesh)
 				{
 					const auto& sourceMesh = sourceModel.Meshes[mesh];
 
-					mstudiomesh_t destMesh{};
+					auto& destMesh = meshes[mesh];
 
 					destMesh.numtris = sourceMesh.NumTriangles;
 					destMesh.skinref = sourceMesh.SkinRef;
 					destMesh.numnorms = sourceMesh.NumNorms;
 					destMesh.normindex = 0;
 
-					destMesh.triindex = buffer.size();
+					destMesh.triindex = buffer.GetPosition();
 
-					auto trianglesCmdBuffer = AllocateBufferArray<short>(buffer, sourceMesh.Triangles.size());
-
-					std::memcpy(trianglesCmdBuffer, sourceMesh.Triangles.data(), sourceMesh.Triangles.size() * sizeof(short));
+					WriteRawBytes(buffer, reinterpret_cast<const std::byte*>(sourceMesh.Triangles.data()), sourceMesh.Triangles.size() * sizeof(short));
 
 					AlignBuffer(buffer);
-
-					meshes.push_back(destMesh);
 				}
-
-				std::memcpy(buffer.data() + destModel.meshindex, meshes.data(), meshes.size() * sizeof(mstudiomesh_t));
 			}
-
-			models.push_back(destModel);
 		}
-
-		std::memcpy(buffer.data() + bodypart.modelindex, models.data(), models.size() * sizeof(mstudiomodel_t));
-
-		bodyparts.push_back(bodypart);
 	}
 
 	AlignBuffer(buffer);
-
-	//Copy the finished bodyparts array
-	std::memcpy(buffer.data() + header.bodypartindex, bodyparts.data(), bodyparts.size() * sizeof(mstudiobodyparts_t));
 }
 
-void ConvertTexturesFromEditable(const EditableStudioModel& studioModel, studiohdr_t& header, std::vector<std::byte>& buffer)
+void ConvertTexturesFromEditable(const EditableStudioModel& studioModel, const StudioModelLayout& layout, studiohdr_t& header, StudioModelBuffer& buffer)
 {
+	assert(buffer.GetPosition() == layout.TextureIndex);
+
 	header.numtextures = studioModel.Textures.size();
-	header.textureindex = buffer.size();
+	header.textureindex = buffer.GetPosition();
 
-	//Initialized below
-	AllocateBufferArray<mstudiotexture_t>(buffer, studioModel.Textures.size());
+	auto textures = AllocateBufferArray<mstudiotexture_t>(buffer, studioModel.Textures.size());
 	AlignBuffer(buffer);
 
+	assert(buffer.GetPosition() == layout.SkinIndex);
+
 	header.numskinfamilies = studioModel.SkinFamilies.size();
 	header.numskinref = !studioModel.SkinFamilies.empty() ? studioModel.SkinFamilies[0].size() : 0;
-	header.skinindex = buffer.size();
+	header.skinindex = buffer.GetPosition();
 
 	for (std::size_t i = 0; i < studioModel.SkinFamilies.size(); ++i)
 	{
@@ -1210,56 +1428,117 @@ void ConvertTexturesFromEditable(const EditableStudioModel& studioModel, studioh
 
 	AlignBuffer(buffer);
 
-	header.texturedataindex = buffer.size();
+	assert(buffer.GetPosition() == layout.TextureDataIndex);
+
+	header.texturedataindex = buffer.GetPosition();
 
 	for (int i = 0; i < header.numtextures; ++i)
 	{
 		const auto& source = *studioModel.Textures[i];
 
 		{
-			auto& dest = *(reinterpret_cast<mstudiotexture_t*>(buffer.data() + header.textureindex) + i);
+			auto& dest = textures[i];
 
 			UTIL_CopyString(dest.name, source.Name.c_str());
 			dest.flags = source.Flags;
 			dest.width = source.Data.Width;
 			dest.height = source.Data.Height;
-			dest.index = buffer.size();
+			dest.index = buffer.GetPosition();
 		}
 
-		auto textureData = AllocateBufferArray<std::byte>(buffer, source.Data.Pixels.size() + sizeof(source.Data.Palette));
-
-		std::memcpy(textureData, source.Data.Pixels.data(), source.Data.Pixels.size());
-		std::memcpy(textureData + source.Data.Pixels.size(), source.Data.Palette.AsByteArray(), sizeof(source.Data.Palette));
+		WriteRawBytes(buffer, reinterpret_cast<const std::byte*>(source.Data.Pixels.data()), source.Data.Pixels.size());
+		WriteRawBytes(buffer, reinterpret_cast<const std::byte*>(source.Data.Palette.AsByteArray()), sizeof(source.Data.Palette));
 	}
 
 	AlignBuffer(buffer);
 }
+
+studio_ptr<studioseqhdr_t> ConvertSequenceGroupFileFromEditable(const EditableStudioModel& studioModel, std::size_t sequenceGroup,
+	std::vector<std::size_t>& sequenceAnimationIndices)
+{
+	const auto layout = ComputeSequenceGroupFileLayout(studioModel, sequenceGroup);
+
+	auto data = std::make_unique<std::byte[]>(layout.Length);
+
+	StudioModelBuffer buffer{data.get(), layout.Length};
+
+	auto& header = *AllocateBufferArray<studioseqhdr_t>(buffer, 1);
+
+	std::memcpy(&header.id, STUDIOMDL_SEQ_ID, sizeof(header.id));
+	header.version = STUDIO_VERSION;
+	UTIL_CopyString(header.name, studioModel.SequenceGroups[sequenceGroup]->Name.c_str());
+
+	ConvertAnimationsFromEditable(studioModel, sequenceGroup, layout, sequenceAnimationIndices, buffer);
+
+	assert(buffer.GetPosition() == layout.Length);
+
+	header.length = layout.Length;
+
+	return studio_ptr<studioseqhdr_t>{reinterpret_cast<studioseqhdr_t*>(data.release())};
 }
 
-/**
-*	@brief The initial size of the buffer used for conversion. Matches the compiler, helps to avoid constant reallocations.
-*/
-constexpr std::size_t StudioModelBufferSize = 16 * 1024 * 1024;
+studio_ptr<studiohdr_t> ConvertTextureFileFromEditable(const EditableStudioModel& studioModel)
+{
+	const auto layout = ComputeTextureFileLayout(studioModel);
+
+	auto data = std::make_unique<std::byte[]>(layout.Length);
+
+	StudioModelBuffer buffer{data.get(), layout.Length};
+
+	//The texture file has no name, which is how it is told apart from a main file
+	auto& header = *AllocateBufferArray<studiohdr_t>(buffer, 1);
+
+	std::memcpy(&header.id, STUDIOMDL_HDR_ID, sizeof(header.id));
+	header.version = STUDIO_VERSION;
+
+	ConvertTexturesFromEditable(studioModel, layout, header, buffer);
+
+	assert(buffer.GetPosition() == layout.Length);
+
+	header.length = layout.Length;
+
+	return studio_ptr<studiohdr_t>{reinterpret_cast<studiohdr_t*>(data.release())};
+}
+}
 
 StudioModel ConvertFromEditable(const std::filesystem::path& fileName, const EditableStudioModel& studioModel)
 {
-	//Use a local header until all data is written, then write the header to the start of the buffer
-	//This avoids having to reacquire the header pointer every time the buffer is reallocated
-	studiohdr_t header{};
+	std::vector<std::size_t> sequenceAnimationIndices(studioModel.Sequences.size());
 
-	std::memset(&header, 0, sizeof(header));
+	//Sequence groups other than the first store their animations in their own files
+	//These are written first so the main file can refer to the animations in them
+	std::vector<studio_ptr<studioseqhdr_t>> sequenceHeaders;
 
-	std::vector<std::byte> buffer;
+	if (studioModel.SequenceGroups.size() > 1)
+	{
+		sequenceHeaders.reserve(studioModel.SequenceGroups.size() - 1);
 
-	buffer.reserve(StudioModelBufferSize);
+		for (std::size_t group = 1; group < studioModel.SequenceGroups.size(); ++group)
+		{
+			sequenceHeaders.push_back(ConvertSequenceGroupFileFromEditable(studioModel, group, sequenceAnimationIndices));
+		}
+	}
 
-	//Write dummy header
-	WriteBytes(buffer, header);
+	studio_ptr<studiohdr_t> textureHeader;
+
+	if (studioModel.HasExternalTextures)
+	{
+		textureHeader = ConvertTextureFileFromEditable(studioModel);
+	}
+
+	//Compute the size of every section first so the model can be written directly into its final, exactly sized allocation
+	const auto layout = ComputeStudioModelLayout(studioModel);
+
+	//Value initialized, so all padding and unused fields are zero
+	auto data = std::make_unique<std::byte[]>(layout.Length);
+
+	StudioModelBuffer buffer{data.get(), layout.Length};
+
+	auto& header = *AllocateBufferArray<studiohdr_t>(buffer, 1);
 
 	std::memcpy(&header.id, STUDIOMDL_HDR_ID, sizeof(header.id));
 	header.version = STUDIO_VERSION;
 
-
 	//Store only the filename itself. It's never used for file loading so it's not terribly important
 	UTIL_CopyString(header.name, fileName.filename().u8string().c_str());
 
@@ -1270,31 +1549,30 @@ StudioModel ConvertFromEditable(const std::filesystem::path& fileName, const Edi
 	header.bbmax = studioModel.ClippingMax;
 	header.flags = studioModel.Flags;
 
-	ConvertBonesFromEditable(studioModel, header, buffer);
-	ConvertAttachmentsFromEditable(studioModel, header, buffer);
-	ConvertHitboxesFromEditable(studioModel, header, buffer);
-
-	{
-		const auto animationIndices = ConvertAnimationsFromEditable(studioModel, header, buffer);
-		ConvertSequencesFromEditable(studioModel, animationIndices, header, buffer);
-	}
+	ConvertBonesFromEditable(studioModel, layout, header, buffer);
+	ConvertAttachmentsFromEditable(studioModel, layout, header, buffer);
+	ConvertHitboxesFromEditable(studioModel, layout, header, buffer);
 
-	ConvertSequenceGroupsFromEditable(studioModel, header, buffer);
-	ConvertTransitionsFromEditable(studioModel, header, buffer);
-	ConvertBodypartsFromEditable(studioModel, header, buffer);
-	ConvertTexturesFromEditable(studioModel, header, buffer);
+	ConvertAnimationsFromEditable(studioModel, 0, layout, sequenceAnimationIndices, buffer);
+	ConvertSequencesFromEditable(studioModel, layout, sequenceAnimationIndices, header, buffer);
 
-	header.length = buffer.size();
+	ConvertSequenceGroupsFromEditable(studioModel, layout, header, buffer);
+	ConvertTransitionsFromEditable(studioModel, layout, header, buffer);
+	ConvertBodypartsFromEditable(studioModel, layout, header, buffer);
 
-	//Copy completed header into buffer
-	std::memcpy(buffer.data(), &header, sizeof(header));
+	//With external textures the main file has no textures, which tells the engine to load the texture file
+	if (!studioModel.HasExternalTextures)
+	{
+		ConvertTexturesFromEditable(studioModel, layout, header, buffer);
+	}
 
-	//Create standalone copy for transfer
-	auto studioHeader = std::make_unique<std::byte[]>(buffer.size());
+	assert(buffer.GetPosition() == layout.Length);
 
-	std::memcpy(studioHeader.get(), buffer.data(), buffer.size());
+	header.length = layout.Length;
 
-	return StudioModel{studio_ptr<studiohdr_t>{reinterpret_cast<studiohdr_t*>(studioHeader.release())}, {}, {}, false};
+	//The buffers are the model's data, transfer ownership
+	return StudioModel{studio_ptr<studiohdr_t>{reinterpret_cast<studiohdr_t*>(data.release())},
+		std::move(textureHeader), std::move(sequenceHeaders), false};
 }
 
 const char* ControlToString(const int iControl)
@@ -0,0 +1,447 @@
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <glm/vec3.hpp>
+
+#include "engine/shared/studiomodel/StudioModel.hpp"
+#include "engine/shared/studiomodel/StudioModelFileFormat.hpp"
+#include "engine/shared/studiomodel/StudioModelValidator.hpp"
+
+#include "graphics/Palette.hpp"
+
+namespace studiomdl
+{
+namespace
+{
+//Problems are usually repeated for every element once a model is corrupt, so stop reporting after this many
+constexpr std::size_t MaxReportedProblems = 32;
+
+/**
+*	@brief A file that is part of a model, or the part of the main file that holds the animations of sequence group 0.
+*/
+struct ValidatedFile
+{
+	const char* Name;
+	const std::byte* Data;
+	std::int64_t Length;
+};
+
+class StudioModelValidator final
+{
+public:
+	explicit StudioModelValidator(const StudioModel& studioModel)
+		: _studioModel(studioModel)
+		, _header(*studioModel.GetStudioHeader())
+		, _textureHeader(*studioModel.GetTextureHeader())
+		, _mainFile{"main file", _header.GetData(), _header.length}
+		, _textureFile{"texture file", _textureHeader.GetData(), _textureHeader.length}
+	{
+	}
+
+	std::vector<std::string> Validate()
+	{
+		ValidateBones();
+		ValidateBoneControllers();
+		ValidateHitboxes();
+		ValidateSequences();
+		ValidateBodyparts();
+		ValidateAttachments();
+		ValidateTextures();
+
+		CheckRange(_mainFile, "Transitions", _header.transitionindex, std::int64_t{_header.numtransitions} * _header.numtransitions, 1);
+
+		return std::move(_problems);
+	}
+
+private:
+	void Report(const char* format, ...)
+	{
+		if (_problems.size() >= MaxReportedProblems)
+		{
+			return;
+		}
+
+		char message[512];
+
+		va_list list;
+
+		va_start(list, format);
+		vsnprintf(message, sizeof(message), format, list);
+		va_end(list);
+
+		_problems.emplace_back(message);
+
+		if (_problems.size() == MaxReportedProblems)
+		{
+			_problems.emplace_back("Too many problems, further problems are not reported");
+		}
+	}
+
+	/**
+	*	@brief Checks that @p count elements of @p elementSize bytes starting at @p offset are inside @p file.
+	*/
+	bool CheckRange(const ValidatedFile& file, const char* what, std::int64_t offset, std::int64_t count, std::size_t elementSize)
+	{
+		if (count < 0)
+		{
+			Report("%s: negative count %lld", what, static_cast<long long>(count));
+			return false;
+		}
+
+		if (count == 0)
+		{
+			return true;
+		}
+
+		if (offset < 0 || offset + count * static_cast<std::int64_t>(elementSize) > file.Length)
+		{
+			Report("%s: %lld entries at offset %lld extend past the end of the %s (%lld bytes)",
+				what, static_cast<long long>(count), static_cast<long long>(offset), file.Name, static_cast<long long>(file.Length));
+			return false;
+		}
+
+		return true;
+	}
+
+	bool CheckIndex(const char* what, int element, int index, int minimum, int count)
+	{
+		if (index < minimum || index >= count)
+		{
+			Report("%s %d: index %d is out of range [%d, %d)", what, element, index, minimum, count);
+			return false;
+		}
+
+		return true;
+	}
+
+	void ValidateBones()
+	{
+		if (!CheckRange(_mainFile, "Bones", _header.boneindex, _header.numbones, sizeof(mstudiobone_t)))
+		{
+			return;
+		}
+
+		for (int i = 0; i < _header.numbones; ++i)
+		{
+			const auto& bone = *_header.GetBone(i);
+
+			//Bones are transformed in order, so parents must come first
+			CheckIndex("Bone parent of bone", i, bone.parent, -1, i);
+
+			for (int j = 0; j < STUDIO_NUM_COORDINATE_AXES; ++j)
+			{
+				CheckIndex("Bone controller of bone", i, bone.bonecontroller[j], -1, _header.numbonecontrollers);
+			}
+		}
+	}
+
+	void ValidateBoneControllers()
+	{
+		if (!CheckRange(_mainFile, "Bone controllers", _header.bonecontrollerindex, _header.numbonecontrollers, sizeof(mstudiobonecontroller_t)))
+		{
+			return;
+		}
+
+		for (int i = 0; i < _header.numbonecontrollers; ++i)
+		{
+			CheckIndex("Bone of bone controller", i, _header.GetBoneController(i)->bone, -1, _header.numbones);
+		}
+	}
+
+	void ValidateHitboxes()
+	{
+		if (!CheckRange(_mainFile, "Hitboxes", _header.hitboxindex, _header.numhitboxes, sizeof(mstudiobbox_t)))
+		{
+			return;
+		}
+
+		for (int i = 0; i < _header.numhitboxes; ++i)
+		{
+			CheckIndex("Bone of hitbox", i, _header.GetHitBox(i)->bone, 0, _header.numbones);
+		}
+	}
+
+	void ValidateSequences()
+	{
+		if (!CheckRange(_mainFile, "Sequence groups", _header.seqgroupindex, _header.numseqgroups, sizeof(mstudioseqgroup_t))
+			|| !CheckRange(_mainFile, "Sequences", _header.seqindex, _header.numseq, sizeof(mstudioseqdesc_t)))
+		{
+			return;
+		}
+
+		for (int i = 0; i < _header.numseq; ++i)
+		{
+			const auto& sequence = *_header.GetSequence(i);
+
+			CheckRange(_mainFile, "Sequence events", sequence.eventindex, sequence.numevents, sizeof(mstudioevent_t));
+			CheckRange(_mainFile, "Sequence pivots", sequence.pivotindex, sequence.numpivots, sizeof(mstudiopivot_t));
+
+			if (CheckIndex("Sequence group of sequence", i, sequence.seqgroup, 0, _header.numseqgroups))
+			{
+				ValidateAnimations(i, sequence);
+			}
+		}
+	}
+
+	void ValidateAnimations(int sequenceIndex, const mstudioseqdesc_t& sequence)
+	{
+		ValidatedFile file;
+
+		if (sequence.seqgroup == 0)
+		{
+			const int groupOffset = _header.GetSequenceGroup(0)->unused2;
+
+			if (groupOffset < 0 || groupOffset > _header.length)
+			{
+				Report("Sequence group 0: data offset %d is outside of the main file", groupOffset);
+				return;
+			}
+
+			file = {"main file", _header.GetData() + groupOffset, _header.length - groupOffset};
+		}
+		else
+		{
+			const auto groupHeader = _studioModel.GetSeqGroupHeader(sequence.seqgroup - 1);
+
+			file = {"sequence group file", reinterpret_cast<const std::byte*>(groupHeader), groupHeader->length};
+		}
+
+		if (!CheckRange(file, "Sequence animations", sequence.animindex, std::int64_t{sequence.numblends} * _header.numbones, sizeof(mstudioanim_t)))
+		{
+			return;
+		}
+
+		const auto animations = reinterpret_cast<const mstudioanim_t*>(file.Data + sequence.animindex);
+
+		for (int i = 0; i < sequence.numblends * _header.numbones; ++i)
+		{
+			const std::int64_t animationOffset = sequence.animindex + static_cast<std::int64_t>(i * sizeof(mstudioanim_t));
+
+			for (int j = 0; j < STUDIO_NUM_COORDINATE_AXES; ++j)
+			{
+				if (animations[i].offset[j] != 0 && !ValidateAnimationValues(file, animationOffset + animations[i].offset[j], sequence.numframes))
+				{
+					Report("Sequence %d: animation values of bone %d, axis %d are corrupt", sequenceIndex, i % _header.numbones, j);
+					return;
+				}
+			}
+		}
+	}
+
+	/**
+	*	@brief Walks the run length encoded animation values the same way the model is converted.
+	*/
+	bool ValidateAnimationValues(const ValidatedFile& file, std::int64_t offset, int frameCount)
+	{
+		int frame = 0;
+
+		do
+		{
+			if (offset < 0 || offset + static_cast<std::int64_t>(sizeof(mstudioanimvalue_t)) > file.Length)
+			{
+				return false;
+			}
+
+			const auto& value = *reinterpret_cast<const mstudioanimvalue_t*>(file.Data + offset);
+
+			//A run without frames would never end
+			if (frameCount > 0 && value.num.total == 0)
+			{
+				return false;
+			}
+
+			frame += value.num.total;
+			offset += (1 + value.num.valid) * static_cast<std::int64_t>(sizeof(mstudioanimvalue_t));
+		}
+		while (frame < frameCount);
+
+		return offset <= file.Length;
+	}
+
+	void ValidateBodyparts()
+	{
+		if (!CheckRange(_mainFile, "Bodyparts", _header.bodypartindex, _header.numbodyparts, sizeof(mstudiobodyparts_t)))
+		{
+			return;
+		}
+
+		for (int i = 0; i < _header.numbodyparts; ++i)
+		{
+			const auto& bodypart = *_header.GetBodypart(i);
+
+			if (bodypart.nummodels > 0 && bodypart.base <= 0)
+			{
+				Report("Bodypart %d: base %d must be positive", i, bodypart.base);
+			}
+
+			if (!CheckRange(_mainFile, "Models", bodypart.modelindex, bodypart.nummodels, sizeof(mstudiomodel_t)))
+			{
+				continue;
+			}
+
+			for (int j = 0; j < bodypart.nummodels; ++j)
+			{
+				ValidateModel(*(reinterpret_cast<const mstudiomodel_t*>(_header.GetData() + bodypart.modelindex) + j));
+			}
+		}
+	}
+
+	void ValidateModel(const mstudiomodel_t& model)
+	{
+		const bool verticesValid = CheckRange(_mainFile, "Vertices", model.vertindex, model.numverts, sizeof(glm::vec3))
+			&& CheckRange(_mainFile, "Vertex bones", model.vertinfoindex, model.numverts, sizeof(std::uint8_t));
+
+		const bool normalsValid = CheckRange(_mainFile, "Normals", model.normindex, model.numnorms, sizeof(glm::vec3))
+			&& CheckRange(_mainFile, "Normal bones", model.norminfoindex, model.numnorms, sizeof(std::uint8_t));
+
+		if (verticesValid)
+		{
+			ValidateVertexBones("Bone of vertex", model.vertinfoindex, model.numverts);
+		}
+
+		if (normalsValid)
+		{
+			ValidateVertexBones("Bone of normal", model.norminfoindex, model.numnorms);
+		}
+
+		if (!CheckRange(_mainFile, "Meshes", model.meshindex, model.nummesh, sizeof(mstudiomesh_t)))
+		{
+			return;
+		}
+
+		for (int i = 0; i < model.nummesh; ++i)
+		{
+			const auto& mesh = *(reinterpret_cast<const mstudiomesh_t*>(_header.GetData() + model.meshindex) + i);
+
+			CheckIndex("Skin reference of mesh", i, mesh.skinref, 0, _textureHeader.numskinref);
+
+			if (!ValidateTriangles(mesh.triindex, model.numverts, model.numnorms))
+			{
+				Report("Mesh %d of model \"%.*s\": triangle commands are corrupt", i, static_cast<int>(sizeof(model.name)), model.name);
+			}
+		}
+	}
+
+	void ValidateVertexBones(const char* what, int offset, int count)
+	{
+		const auto bones = reinterpret_cast<const std::uint8_t*>(_header.GetData() + offset);
+
+		for (int i = 0; i < count; ++i)
+		{
+			if (!CheckIndex(what, i, bones[i], 0, _header.numbones))
+			{
+				return;
+			}
+		}
+	}
+
+	bool ValidateTriangles(std::int64_t offset, int vertexCount, int normalCount)
+	{
+		while (true)
+		{
+			if (offset < 0 || offset + static_cast<std::int64_t>(sizeof(short)) > _mainFile.Length)
+			{
+				return false;
+			}
+
+			const int count = std::abs(*reinterpret_cast<const short*>(_mainFile.Data + offset));
+
+			offset += sizeof(short);
+
+			if (count == 0)
+			{
+				return true;
+			}
+
+			if (offset + count * 4 * static_cast<std::int64_t>(sizeof(short)) > _mainFile.Length)
+			{
+				return false;
+			}
+
+			const auto vertices = reinterpret_cast<const short*>(_mainFile.Data + offset);
+
+			for (int i = 0; i < count; ++i)
+			{
+				if (vertices[i * 4] < 0 || vertices[i * 4] >= vertexCount || vertices[(i * 4) + 1] < 0 || vertices[(i * 4) + 1] >= normalCount)
+				{
+					return false;
+				}
+			}
+
+			offset += count * 4 * static_cast<std::int64_t>(sizeof(short));
+		}
+	}
+
+	void ValidateAttachments()
+	{
+		if (!CheckRange(_mainFile, "Attachments", _header.attachmentindex, _header.numattachments, sizeof(mstudioattachment_t)))
+		{
+			return;
+		}
+
+		for (int i = 0; i < _header.numattachments; ++i)
+		{
+			CheckIndex("Bone of attachment", i, _header.GetAttachment(i)->bone, 0, _header.numbones);
+		}
+	}
+
+	void ValidateTextures()
+	{
+		if (!CheckRange(_textureFile, "Textures", _textureHeader.textureindex, _textureHeader.numtextures, sizeof(mstudiotexture_t)))
+		{
+			return;
+		}
+
+		for (int i = 0; i < _textureHeader.numtextures; ++i)
+		{
+			const auto& texture = *_textureHeader.GetTexture(i);
+
+			if (texture.width <= 0 || texture.height <= 0)
+			{
+				Report("Texture %d: invalid size %dx%d", i, texture.width, texture.height);
+				continue;
+			}
+
+			const std::int64_t pixelCount = std::int64_t{texture.width} * texture.height;
+
+			//Dol textures start with the name and store an RGBA palette before the pixels
+			const std::int64_t size = _studioModel.IsDol()
+				? 32 + sizeof(graphics::RGBAPalette) + pixelCount
+				: pixelCount + sizeof(graphics::RGBPalette);
+
+			CheckRange(_textureFile, "Texture data", texture.index, size, 1);
+		}
+
+		if (CheckRange(_textureFile, "Skin families", _textureHeader.skinindex,
+			std::int64_t{_textureHeader.numskinfamilies} * _textureHeader.numskinref, sizeof(short)))
+		{
+			for (int i = 0; i < _textureHeader.numskinfamilies * _textureHeader.numskinref; ++i)
+			{
+				if (!CheckIndex("Texture of skin entry", i, *_textureHeader.GetSkin(i), 0, _textureHeader.numtextures))
+				{
+					break;
+				}
+			}
+		}
+	}
+
+private:
+	const StudioModel& _studioModel;
+
+	const studiohdr_t& _header;
+	const studiohdr_t& _textureHeader;
+
+	const ValidatedFile _mainFile;
+	const ValidatedFile _textureFile;
+
+	std::vector<std::string> _problems;
+};
+}
+
+std::vector<std::string> ValidateStudioModel(const StudioModel& studioModel)
+{
+	return StudioModelValidator{studioModel}.Validate();
+}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace studiomdl
+{
+class StudioModel;
+
+/**
+*	@brief Checks that all counts, offsets and indices in a loaded model stay within its files,
+*	so it can be converted to an editable model without reading outside of its data.
+*	@return A description of each problem found. Empty if the model is valid.
+*/
+std::vector<std::string> ValidateStudioModel(const StudioModel& studioModel);
+}
@@ -14,3 +14,13 @@ enum Event
 	SCRIPT_EVENT_SOUND_VOICE	= 1008,		// Play named wave file (on CHAN_VOICE)
 	SCRIPT_CLIENT_EVENT_SOUND	= 5004,		// Play named wave file (at a given location)
 };
+
+/**
+*	@brief Whether the event plays the sound named in its options.
+*/
+constexpr bool IsSoundEvent(int eventId)
+{
+	return eventId == SCRIPT_EVENT_SOUND
+		|| eventId == SCRIPT_EVENT_SOUND_VOICE
+		|| eventId == SCRIPT_CLIENT_EVENT_SOUND;
+}
@@ -1,10 +1,16 @@
 #include <algorithm>
 #include <cstdio>
+#include <filesystem>
+#include <mutex>
 #include <sstream>
 
 #include "filesystem/FileSystem.hpp"
+#include "filesystem/FileSystemConstants.hpp"
+#include "filesystem/PakFile.hpp"
+#include "filesystem/ZipFile.hpp"
 
 #include "utility/IOUtils.hpp"
+#include "utility/MemoryMappedFile.hpp"
 
 namespace filesystem
 {
@@ -17,31 +23,50 @@ FileSystem::~FileSystem() = default;
 
 std::string FileSystem::GetBasePath() const
 {
+	const std::lock_guard lock{_mutex};
+
 	return _basePath;
 }
 
 void FileSystem::SetBasePath(std::string&& path)
 {
+	const std::lock_guard lock{_mutex};
+
 	if (path.empty())
 	{
 		return;
 	}
 
 	_basePath = std::move(path);
+
+	//Archives are located relative to the base path
+	for (auto& searchPath : _searchPaths)
+	{
+		MountArchives(searchPath);
+	}
+
+	InvalidateResolvedFiles();
 }
 
 bool FileSystem::HasSearchPath(std::string_view path) const
 {
+	const std::lock_guard lock{_mutex};
+
 	if (path.empty())
 	{
 		return false;
 	}
 
-	return std::find(_searchPaths.begin(), _searchPaths.end(), path) != _searchPaths.end();
+	return std::find_if(_searchPaths.begin(), _searchPaths.end(), [&](const auto& searchPath)
+		{
+			return searchPath.Path == path;
+		}) != _searchPaths.end();
 }
 
 void FileSystem::AddSearchPath(std::string&& path)
 {
+	const std::lock_guard lock{_mutex};
+
 	if (path.empty())
 	{
 		return;
@@ -52,76 +77,541 @@ void FileSystem::AddSearchPath(std::string&& path)
 		return;
 	}
 
-	_searchPaths.emplace_back(std::move(path));
+	auto& searchPath = _searchPaths.emplace_back(SearchPath{std::move(path), {}, {}, {}});
+
+	MountArchives(searchPath);
+
+	InvalidateResolvedFiles();
 }
 
 void FileSystem::RemoveSearchPath(std::string_view path)
 {
+	const std::lock_guard lock{_mutex};
+
 	if (path.empty())
 	{
 		return;
 	}
 
-	if (const auto it = std::find(_searchPaths.begin(), _searchPaths.end(), path); it != _searchPaths.end())
+	if (const auto it = std::find_if(_searchPaths.begin(), _searchPaths.end(), [&](const auto& searchPath)
+		{
+			return searchPath.Path == path;
+		}); it != _searchPaths.end())
 	{
 		_searchPaths.erase(it);
+
+		InvalidateResolvedFiles();
 	}
 }
 
 void FileSystem::RemoveAllSearchPaths()
 {
+	const std::lock_guard lock{_mutex};
+
 	_searchPaths.clear();
+
+	InvalidateResolvedFiles();
 }
 
 std::string FileSystem::GetRelativePath(std::string_view fileName)
+{
+	const std::lock_guard lock{_mutex};
+
+	//Files provided by archives don't have a path on disk
+	return FindFile(fileName).LooseFileName;
+}
+
+std::string FileSystem::GetResolvedPath(std::string_view fileName)
+{
+	const std::lock_guard lock{_mutex};
+
+	const auto file = FindFile(fileName);
+
+	if (file.Archive)
+	{
+		return file.Archive->GetFileName() + '/' + file.ArchiveFileName;
+	}
+
+	return file.LooseFileName;
+}
+
+bool FileSystem::FileExists(const std::string& fileName) const
 {
 	if (fileName.empty())
 	{
-		return {};
+		return false;
+	}
+
+	if (FILE* file = utf8_fopen(fileName.c_str(), "r"); file)
+	{
+		fclose(file);
+
+		return true;
+	}
+
+	return false;
+}
+
+FileView FileSystem::OpenFile(std::string_view fileName)
+{
+	const std::lock_guard lock{_mutex};
+
+	const auto file = FindFile(fileName);
+
+	if (file.Archive)
+	{
+		return file.Archive->OpenFile(file.ArchiveFileName);
+	}
+
+	if (!file.LooseFileName.empty())
+	{
+		return OpenLooseFile(file.LooseFileName);
+	}
+
+	return {};
+}
+
+std::vector<std::string> FileSystem::GetDirectories()
+{
+	const std::lock_guard lock{_mutex};
+
+	UpdateResolvedFiles();
+
+	std::vector<std::string> directories;
+
+	for (const auto& searchPath : _searchPaths)
+	{
+		directories.insert(directories.end(), searchPath.Directories.begin(), searchPath.Directories.end());
+	}
+
+	return directories;
+}
+
+void FileSystem::RefreshDirectory(std::string_view directory)
+{
+	const std::lock_guard lock{_mutex};
+
+	//Everything will be rescanned on the next lookup anyway
+	if (!_resolvedFilesValid)
+	{
+		return;
+	}
+
+	while (!directory.empty() && (directory.back() == '/' || directory.back() == '\\'))
+	{
+		directory.remove_suffix(1);
+	}
+
+	for (auto& searchPath : _searchPaths)
+	{
+		const auto root = GetFullPath(searchPath);
+
+		if (directory == root)
+		{
+			//Archives may have been added or removed
+			RefreshSearchPath(searchPath);
+			return;
+		}
+
+		if (directory.size() <= root.size() || directory.substr(0, root.size()) != root || directory[root.size()] != '/')
+		{
+			continue;
+		}
+
+		const std::string directoryName{directory};
+		const std::string prefix{directoryName + '/'};
+
+		const auto isInDirectory = [&](const std::string& fileName)
+		{
+			return fileName == directoryName || fileName.compare(0, prefix.size(), prefix) == 0;
+		};
+
+		//Remove the old contents of the directory, then add the current contents back
+		//Every file that was removed or added is re-resolved; files elsewhere are unaffected
+		std::vector<std::string> changedFiles;
+
+		for (auto it = searchPath.LooseFiles.begin(); it != searchPath.LooseFiles.end();)
+		{
+			if (isInDirectory(it->second))
+			{
+				changedFiles.emplace_back(it->first);
+				it = searchPath.LooseFiles.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		searchPath.Directories.erase(std::remove_if(searchPath.Directories.begin(), searchPath.Directories.end(), isInDirectory),
+			searchPath.Directories.end());
+
+		ScanDirectory(searchPath, directoryName, &changedFiles);
+
+		for (const auto& fileName : changedFiles)
+		{
+			ResolveFile(fileName);
+		}
+
+		return;
+	}
+}
+
+bool FileSystem::MountArchive(std::string&& fileName)
+{
+	const std::lock_guard lock{_mutex};
+
+	if (fileName.empty())
+	{
+		return false;
+	}
+
+	if (std::find_if(_mountedArchives.begin(), _mountedArchives.end(), [&](const auto& archive)
+		{
+			return archive->GetFileName() == fileName;
+		}) != _mountedArchives.end())
+	{
+		return true;
+	}
+
+	auto archive = TryOpenArchive(fileName);
+
+	if (!archive)
+	{
+		return false;
+	}
+
+	_mountedArchives.emplace_back(std::move(archive));
+
+	InvalidateResolvedFiles();
+
+	return true;
+}
+
+void FileSystem::UnmountArchive(std::string_view fileName)
+{
+	const std::lock_guard lock{_mutex};
+
+	if (const auto it = std::find_if(_mountedArchives.begin(), _mountedArchives.end(), [&](const auto& archive)
+		{
+			return archive->GetFileName() == fileName;
+		}); it != _mountedArchives.end())
+	{
+		_mountedArchives.erase(it);
+
+		InvalidateResolvedFiles();
 	}
+}
+
+std::unique_ptr<IArchive> FileSystem::TryOpenArchive(const std::string& fileName)
+{
+	const auto extension = NormalizeArchiveFileName(std::filesystem::u8path(fileName).extension().u8string());
+
+	if (extension == ".pak")
+	{
+		return PakFile::TryOpen(fileName);
+	}
+
+	if (extension == ".zip" || extension == ".pk3")
+	{
+		return ZipFile::TryOpen(fileName);
+	}
+
+	return {};
+}
+
+std::string FileSystem::GetFullPath(const SearchPath& searchPath) const
+{
+	return _basePath + '/' + searchPath.Path;
+}
+
+void FileSystem::MountArchives(SearchPath& searchPath)
+{
+	searchPath.Archives.clear();
 
 	std::ostringstream stream;
 
-	for (const auto& path : _searchPaths)
+	//Pak files are numbered sequentially, stop at the first one that doesn't exist
+	for (int i = 0;; ++i)
 	{
 		stream.str({});
-		stream << _basePath << '/' << path << '/' << fileName;
+		stream << _basePath << '/' << searchPath.Path << "/pak" << i << ".pak";
 
-		auto result = stream.str();
+		auto pakFile = PakFile::TryOpen(stream.str());
 
-		if (FileExists(result))
+		if (!pakFile)
 		{
-			return result;
+			break;
 		}
+
+		searchPath.Archives.emplace_back(std::move(pakFile));
 	}
 
-	stream.str({});
-	stream << _basePath << '/' << fileName;
+	std::vector<std::string> zipFileNames;
 
-	auto result = stream.str();
+	std::error_code error;
 
-	if (FileExists(result))
+	for (const auto& entry : std::filesystem::directory_iterator{std::filesystem::u8path(GetFullPath(searchPath)), error})
 	{
-		return result;
+		if (entry.is_regular_file(error) && NormalizeArchiveFileName(entry.path().extension().u8string()) == ".pk3")
+		{
+			zipFileNames.emplace_back(entry.path().u8string());
+		}
 	}
 
-	return {};
+	std::sort(zipFileNames.begin(), zipFileNames.end());
+
+	for (const auto& fileName : zipFileNames)
+	{
+		if (auto zipFile = ZipFile::TryOpen(fileName); zipFile)
+		{
+			searchPath.Archives.emplace_back(std::move(zipFile));
+		}
+	}
 }
 
-bool FileSystem::FileExists(const std::string& fileName) const
+void FileSystem::ScanDirectory(SearchPath& searchPath, const std::string& directory, std::vector<std::string>* addedFiles)
 {
-	if (fileName.empty())
+	std::error_code error;
+
+	if (!std::filesystem::is_directory(std::filesystem::u8path(directory), error))
 	{
-		return false;
+		return;
 	}
 
-	if (FILE* file = utf8_fopen(fileName.c_str(), "r"); file)
+	if (IsWatchedDirectory(searchPath, directory))
 	{
-		fclose(file);
+		searchPath.Directories.emplace_back(directory);
+	}
+
+	//Paths are formed by appending to the directory name, so the search path itself is always a prefix
+	const auto rootLength = GetFullPath(searchPath).size() + 1;
+
+	for (std::filesystem::recursive_directory_iterator it{std::filesystem::u8path(directory), error}, end; !error && it != end; it.increment(error))
+	{
+		std::error_code entryError;
+
+		if (it->is_directory(entryError))
+		{
+			if (auto subdirectory = it->path().generic_u8string(); IsWatchedDirectory(searchPath, subdirectory))
+			{
+				searchPath.Directories.emplace_back(std::move(subdirectory));
+			}
+		}
+		else if (it->is_regular_file(entryError))
+		{
+			auto fullPath = it->path().generic_u8string();
+			auto fileName = NormalizeArchiveFileName(std::string_view{fullPath}.substr(rootLength));
+
+			if (searchPath.LooseFiles.try_emplace(fileName, std::move(fullPath)).second && addedFiles)
+			{
+				addedFiles->emplace_back(std::move(fileName));
+			}
+		}
+	}
+}
+
+void FileSystem::ScanSearchPath(SearchPath& searchPath)
+{
+	searchPath.LooseFiles.clear();
+	searchPath.Directories.clear();
+
+	ScanDirectory(searchPath, GetFullPath(searchPath), nullptr);
+}
+
+bool FileSystem::IsWatchedDirectory(const SearchPath& searchPath, std::string_view directory) const
+{
+	const auto root = GetFullPath(searchPath);
 
+	if (directory == root)
+	{
 		return true;
 	}
 
-	return false;
+	if (directory.size() <= root.size() || directory.substr(0, root.size()) != root || directory[root.size()] != '/')
+	{
+		return false;
+	}
+
+	directory.remove_prefix(root.size() + 1);
+
+	//Only the first component of the path needs to be a content directory, subdirectories of content directories are watched as well
+	const auto contentDirectory = NormalizeArchiveFileName(directory.substr(0, directory.find('/')));
+
+	const auto contentDirectories = GetContentDirectories();
+
+	return std::find(contentDirectories.begin(), contentDirectories.end(), contentDirectory) != contentDirectories.end();
+}
+
+void FileSystem::RefreshSearchPath(SearchPath& searchPath)
+{
+	std::vector<std::string> changedFiles;
+
+	const auto addFileNames = [&]()
+	{
+		for (const auto& file : searchPath.LooseFiles)
+		{
+			changedFiles.emplace_back(file.first);
+		}
+
+		for (const auto& archive : searchPath.Archives)
+		{
+			for (const auto fileName : archive->GetFileNames())
+			{
+				changedFiles.emplace_back(fileName);
+			}
+		}
+	};
+
+	//Entries in the resolution table point into the old contents, so every file they provided has to be re-resolved
+	addFileNames();
+
+	MountArchives(searchPath);
+	ScanSearchPath(searchPath);
+
+	addFileNames();
+
+	std::sort(changedFiles.begin(), changedFiles.end());
+	changedFiles.erase(std::unique(changedFiles.begin(), changedFiles.end()), changedFiles.end());
+
+	for (const auto& fileName : changedFiles)
+	{
+		ResolveFile(fileName);
+	}
+}
+
+void FileSystem::InvalidateResolvedFiles()
+{
+	_resolvedFiles.clear();
+	_resolvedFilesValid = false;
+}
+
+void FileSystem::UpdateResolvedFiles()
+{
+	if (_resolvedFilesValid)
+	{
+		return;
+	}
+
+	_resolvedFiles.clear();
+
+	for (auto& searchPath : _searchPaths)
+	{
+		ScanSearchPath(searchPath);
+	}
+
+	//Add files from the highest priority locations first so lower priority locations don't replace them
+	const auto addArchives = [this](const std::vector<std::unique_ptr<IArchive>>& archives)
+	{
+		for (auto it = archives.rbegin(), end = archives.rend(); it != end; ++it)
+		{
+			for (const auto fileName : (*it)->GetFileNames())
+			{
+				_resolvedFiles.try_emplace(std::string{fileName}, ResolvedFile{it->get(), nullptr});
+			}
+		}
+	};
+
+	addArchives(_mountedArchives);
+
+	for (const auto& searchPath : _searchPaths)
+	{
+		for (const auto& file : searchPath.LooseFiles)
+		{
+			_resolvedFiles.try_emplace(file.first, ResolvedFile{nullptr, &file.second});
+		}
+
+		addArchives(searchPath.Archives);
+	}
+
+	_resolvedFilesValid = true;
+}
+
+void FileSystem::ResolveFile(const std::string& normalizedFileName)
+{
+	const auto findInArchives = [&](const std::vector<std::unique_ptr<IArchive>>& archives) -> const IArchive*
+	{
+		for (auto it = archives.rbegin(), end = archives.rend(); it != end; ++it)
+		{
+			if ((*it)->HasFile(normalizedFileName))
+			{
+				return it->get();
+			}
+		}
+
+		return nullptr;
+	};
+
+	if (const auto archive = findInArchives(_mountedArchives); archive)
+	{
+		_resolvedFiles.insert_or_assign(normalizedFileName, ResolvedFile{archive, nullptr});
+		return;
+	}
+
+	for (const auto& searchPath : _searchPaths)
+	{
+		if (const auto it = searchPath.LooseFiles.find(normalizedFileName); it != searchPath.LooseFiles.end())
+		{
+			_resolvedFiles.insert_or_assign(normalizedFileName, ResolvedFile{nullptr, &it->second});
+			return;
+		}
+
+		if (const auto archive = findInArchives(searchPath.Archives); archive)
+		{
+			_resolvedFiles.insert_or_assign(normalizedFileName, ResolvedFile{archive, nullptr});
+			return;
+		}
+	}
+
+	_resolvedFiles.erase(normalizedFileName);
+}
+
+FileSystem::FoundFile FileSystem::FindFile(std::string_view fileName)
+{
+	if (fileName.empty())
+	{
+		return {};
+	}
+
+	UpdateResolvedFiles();
+
+	auto normalizedFileName = NormalizeArchiveFileName(fileName);
+
+	if (const auto it = _resolvedFiles.find(normalizedFileName); it != _resolvedFiles.end())
+	{
+		if (it->second.Archive)
+		{
+			return FoundFile{it->second.Archive, std::move(normalizedFileName), {}};
+		}
+
+		return FoundFile{nullptr, {}, *it->second.LooseFileName};
+	}
+
+	//Files that aren't in any search path can still be found relative to the base path
+	std::ostringstream stream;
+
+	stream << _basePath << '/' << fileName;
+
+	if (auto result = stream.str(); FileExists(result))
+	{
+		return FoundFile{nullptr, {}, std::move(result)};
+	}
+
+	return {};
+}
+
+FileView FileSystem::OpenLooseFile(const std::string& fileName) const
+{
+	auto mapping = MemoryMappedFile::TryMap(fileName.c_str());
+
+	if (!mapping)
+	{
+		return {};
+	}
+
+	const auto data = mapping->GetData();
+	const auto size = mapping->GetSize();
+
+	return FileView{std::move(mapping), data, size};
+}
 }
-}
\ No newline at end of file
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "filesystem/IArchive.hpp"
 #include "filesystem/IFileSystem.hpp"
 
 /**
@@ -35,11 +40,121 @@ public:
 
 	std::string GetRelativePath(std::string_view fileName) override final;
 
+	std::string GetResolvedPath(std::string_view fileName) override final;
+
 	bool FileExists(const std::string& fileName) const override final;
 
+	FileView OpenFile(std::string_view fileName) override final;
+
+	std::vector<std::string> GetDirectories() override final;
+
+	void RefreshDirectory(std::string_view directory) override final;
+
+	bool MountArchive(std::string&& fileName) override final;
+
+	void UnmountArchive(std::string_view fileName) override final;
+
+	/**
+	*	@brief Opens an archive, choosing the archive type based on the file extension.
+	*	@return The archive, or nullptr if the file is not an archive or could not be opened.
+	*/
+	static std::unique_ptr<IArchive> TryOpenArchive(const std::string& fileName);
+
+private:
+	struct SearchPath
+	{
+		std::string Path;
+
+		//Ordered by priority, lowest first
+		std::vector<std::unique_ptr<IArchive>> Archives;
+
+		//Normalized file name => full path of the loose file on disk
+		std::unordered_map<std::string, std::string> LooseFiles;
+
+		//Full paths of this search path and of the content directories in it, including their subdirectories
+		std::vector<std::string> Directories;
+	};
+
+	struct ResolvedFile
+	{
+		//Archive that provides the file, or nullptr if it's a loose file
+		const IArchive* Archive = nullptr;
+
+		//Full path of the loose file on disk. Points into SearchPath::LooseFiles
+		const std::string* LooseFileName = nullptr;
+	};
+
+	/**
+	*	@brief The file that is opened for a given name.
+	*	If neither member is set the file doesn't exist.
+	*/
+	struct FoundFile
+	{
+		//Archive that provides the file, and the normalized name of the file in it
+		const IArchive* Archive = nullptr;
+		std::string ArchiveFileName;
+
+		//Full path of the loose file on disk if it's not in an archive
+		std::string LooseFileName;
+	};
+
+	std::string GetFullPath(const SearchPath& searchPath) const;
+
+	void MountArchives(SearchPath& searchPath);
+
+	/**
+	*	@brief Recursively adds all loose files and directories in @p directory to the search path.
+	*	@param directory Full path of a directory in the search path.
+	*	@param addedFiles If not null, the normalized names of the added files are appended to this list.
+	*/
+	void ScanDirectory(SearchPath& searchPath, const std::string& directory, std::vector<std::string>* addedFiles);
+
+	void ScanSearchPath(SearchPath& searchPath);
+
+	/**
+	*	@brief Whether changes to @p directory should be watched. These are the search path itself and the content directories in it.
+	*	@param directory Full path of a directory in the search path.
+	*/
+	bool IsWatchedDirectory(const SearchPath& searchPath, std::string_view directory) const;
+
+	/**
+	*	@brief Remounts the archives and rescans the loose files of a single search path,
+	*	then re-resolves only the files that this search path provided before or provides now.
+	*/
+	void RefreshSearchPath(SearchPath& searchPath);
+
+	void InvalidateResolvedFiles();
+
+	/**
+	*	@brief Rebuilds the resolution table if the search paths or mounted archives have changed since it was last built.
+	*/
+	void UpdateResolvedFiles();
+
+	/**
+	*	@brief Finds the highest priority location that provides the given file and updates its entry in the resolution table.
+	*/
+	void ResolveFile(const std::string& normalizedFileName);
+
+	/**
+	*	@brief Looks up the file with the given name.
+	*	Every public member that takes a file name uses this so they all agree on which file a name refers to.
+	*/
+	FoundFile FindFile(std::string_view fileName);
+
+	FileView OpenLooseFile(const std::string& fileName) const;
+
 private:
 	std::string _basePath;
-	std::vector<std::string> _searchPaths;
+	std::vector<SearchPath> _searchPaths;
+
+	//Ordered by priority, lowest first
+	std::vector<std::unique_ptr<IArchive>> _mountedArchives;
+
+	std::unordered_map<std::string, ResolvedFile> _resolvedFiles;
+	bool _resolvedFilesValid = false;
+
+	//Recursive because public members call each other
+	mutable std::recursive_mutex _mutex;
 };
 }
 
@@ -6,10 +6,45 @@ std::vector<std::string> GetSteamPipeDirectoryExtensions()
 {
 	return
 	{
-		"",
-		"_downloads",
 		"_addon",
-		"_hd"
+		"_hd",
+		"",
+		"_downloads"
+	};
+}
+
+std::vector<std::string> GetGameDirectoryLayers(const std::string& modDirectory, const std::string& gameDirectory)
+{
+	const auto directoryExtensions{GetSteamPipeDirectoryExtensions()};
+
+	std::vector<std::string> layers;
+
+	layers.reserve(directoryExtensions.size() * 2);
+
+	//Mod directories override game directories
+	if (modDirectory != gameDirectory)
+	{
+		for (const auto& extension : directoryExtensions)
+		{
+			layers.emplace_back(modDirectory + extension);
+		}
+	}
+
+	for (const auto& extension : directoryExtensions)
+	{
+		layers.emplace_back(gameDirectory + extension);
+	}
+
+	return layers;
+}
+
+std::vector<std::string> GetContentDirectories()
+{
+	return
+	{
+		"models",
+		"sound",
+		"sprites"
 	};
 }
 }
\ No newline at end of file
@@ -10,7 +10,24 @@
 */
 namespace filesystem
 {
+/**
+*	@brief Gets the extensions that are appended to a game directory name to form its SteamPipe directories, highest priority first.
+*/
 std::vector<std::string> GetSteamPipeDirectoryExtensions();
+
+/**
+*	@brief Gets the directories to use as search paths for a mod, highest priority first.
+*	This matches the engine: all of the mod's SteamPipe directories, followed by those of the game it's based on.
+*	@param modDirectory Directory of the mod. May be the same as @p gameDirectory.
+*	@param gameDirectory Directory of the game the mod is based on, like "valve".
+*/
+std::vector<std::string> GetGameDirectoryLayers(const std::string& modDirectory, const std::string& gameDirectory);
+
+/**
+*	@brief Gets the directories in a game directory that contain the assets the tools load, like "models".
+*	Only these directories are watched for changes.
+*/
+std::vector<std::string> GetContentDirectories();
 }
 
 /** @} */
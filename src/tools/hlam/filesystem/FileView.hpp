@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+*	@ingroup FileSystem
+*
+*	@{
+*/
+
+namespace filesystem
+{
+/**
+*	@brief Read-only view of a file's contents.
+*	Keeps the storage backing the view (a mapped file or archive) alive for as long as the view exists.
+*/
+class FileView final
+{
+public:
+	FileView() = default;
+
+	FileView(std::shared_ptr<const void>&& storage, const std::byte* data, std::size_t size)
+		: _storage(std::move(storage))
+		, _data(data)
+		, _size(size)
+	{
+	}
+
+	FileView(const FileView&) = default;
+	FileView& operator=(const FileView&) = default;
+
+	FileView(FileView&&) = default;
+	FileView& operator=(FileView&&) = default;
+
+	/**
+	*	@brief Whether this view refers to a file. Empty files are valid views with no data.
+	*/
+	bool IsValid() const { return !!_storage; }
+
+	explicit operator bool() const { return IsValid(); }
+
+	const std::byte* GetData() const { return _data; }
+
+	std::size_t GetSize() const { return _size; }
+
+private:
+	std::shared_ptr<const void> _storage;
+	const std::byte* _data{};
+	std::size_t _size{};
+};
+}
+
+/** @} */
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "filesystem/FileView.hpp"
+
+/**
+*	@ingroup FileSystem
+*
+*	@{
+*/
+
+namespace filesystem
+{
+/**
+*	@brief Read-only archive of files that can be mounted in the filesystem.
+*/
+class IArchive
+{
+public:
+	virtual ~IArchive() {}
+
+	/**
+	*	@brief Gets the name of the archive file on disk.
+	*/
+	virtual const std::string& GetFileName() const = 0;
+
+	virtual std::size_t GetEntryCount() const = 0;
+
+	/**
+	*	@brief Gets the normalized names of all files in the archive.
+	*	The names remain valid for as long as the archive exists.
+	*/
+	virtual std::vector<std::string_view> GetFileNames() const = 0;
+
+	/**
+	*	@brief Returns whether the archive contains the given file.
+	*	@param fileName Name of the file relative to the root of the archive. Case insensitive, both slash types are accepted.
+	*/
+	virtual bool HasFile(std::string_view fileName) const = 0;
+
+	/**
+	*	@brief Gets a view of the contents of the given file.
+	*	@param fileName Name of the file relative to the root of the archive. Case insensitive, both slash types are accepted.
+	*	@return A view of the file, or an invalid view if the archive does not contain the file or it could not be read.
+	*/
+	virtual FileView OpenFile(std::string_view fileName) const = 0;
+};
+
+/**
+*	@brief Converts a file name to the form used as the key in archive directories.
+*/
+inline std::string NormalizeArchiveFileName(std::string_view fileName)
+{
+	std::string result{fileName};
+
+	std::transform(result.begin(), result.end(), result.begin(), [](char c)
+		{
+			return c == '\\' ? '/' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		});
+
+	return result;
+}
+}
+
+/** @} */
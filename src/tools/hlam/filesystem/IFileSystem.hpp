@@ -2,6 +2,9 @@
 
 #include <string>
 #include <string_view>
+#include <vector>
+
+#include "filesystem/FileView.hpp"
 
 /** @file */
 
@@ -19,6 +22,18 @@ namespace filesystem
 *	<pre>
 *	The filesystem has a concept of a base path: this is the path to the game directory, like "common/Half-Life"
 *	All search paths are relative to this base path.
+*
+*	Each search path can have archives mounted in it: pak files (pak0.pak, pak1.pak, ...) followed by zip files with the pk3 extension in alphabetical order.
+*	Within a search path loose files take priority over archived files, and archives mounted later take priority over archives mounted earlier.
+*	Search paths are searched in the order in which they were added.
+*
+*	Archives can also be mounted explicitly. These are searched before all search paths, most recently mounted first.
+*
+*	The contents of all search paths and archives are merged into a single table that maps each file name to the location that provides it.
+*	The table is built the first time a file is looked up after the search paths change,
+*	and is updated incrementally when RefreshDirectory is called for a directory whose contents changed.
+*
+*	All members can be called from any thread.
 *	</pre>
 */
 class IFileSystem
@@ -68,12 +83,54 @@ public:
 	*/
 	virtual std::string GetRelativePath(std::string_view fileName) = 0;
 
+	/**
+	*	@brief Gets a path that uniquely identifies the file that is opened for the given name.
+	*	For loose files this is the path on disk; for archived files it is the path of the archive followed by the name of the file in it.
+	*	@param fileName File to resolve.
+	*	@return The resolved path, or an empty string if the file could not be found.
+	*/
+	virtual std::string GetResolvedPath(std::string_view fileName) = 0;
+
 	/**
 	*	@brief Returns whether the given file exists.
 	*	@param fileName Name of the file to check for.
 	*	@return true if the file exists, false otherwise.
 	*/
 	virtual bool FileExists(const std::string& fileName) const = 0;
+
+	/**
+	*	@brief Opens a file for reading, searching both loose files and mounted archives.
+	*	The file is memory mapped; archived files are views into the archive's mapping so only the requested file is ever read.
+	*	@param fileName Name of the file to open, relative to the search paths.
+	*	@return A view of the file's contents, or an invalid view if the file could not be found.
+	*/
+	virtual FileView OpenFile(std::string_view fileName) = 0;
+
+	/**
+	*	@brief Gets the paths of the directories whose changes should be passed to RefreshDirectory.
+	*	These are the search paths themselves and the content directories in them (see GetContentDirectories), including their subdirectories.
+	*/
+	virtual std::vector<std::string> GetDirectories() = 0;
+
+	/**
+	*	@brief Rescans the given directory and updates the resolution of the files in it.
+	*	If the directory is a search path, that search path's archives and loose files are rescanned; other search paths are unaffected.
+	*	@param directory Path to the directory, as returned by GetDirectories.
+	*/
+	virtual void RefreshDirectory(std::string_view directory) = 0;
+
+	/**
+	*	@brief Mounts an archive (pak, zip or pk3) so its files can be opened. No duplicates.
+	*	@param fileName Name of the archive file on disk. This is not relative to the base path.
+	*	@return true if the archive was mounted or was already mounted, false if it could not be opened.
+	*/
+	virtual bool MountArchive(std::string&& fileName) = 0;
+
+	/**
+	*	@brief Unmounts an archive that was mounted using MountArchive.
+	*	@param fileName Name of the archive file, as passed to MountArchive.
+	*/
+	virtual void UnmountArchive(std::string_view fileName) = 0;
 };
 }
 
@@ -0,0 +1,112 @@
+#include <cstring>
+
+#include "filesystem/PakFile.hpp"
+
+#include "utility/ByteSwap.hpp"
+#include "utility/MemoryMappedFile.hpp"
+
+namespace filesystem
+{
+PakFile::PakFile(std::string&& fileName, std::shared_ptr<MemoryMappedFile>&& mapping, std::unordered_map<std::string, Entry>&& entries)
+	: _fileName(std::move(fileName))
+	, _mapping(std::move(mapping))
+	, _entries(std::move(entries))
+{
+}
+
+PakFile::~PakFile() = default;
+
+std::unique_ptr<PakFile> PakFile::TryOpen(const std::string& fileName)
+{
+	auto mapping = MemoryMappedFile::TryMap(fileName.c_str());
+
+	if (!mapping)
+	{
+		return {};
+	}
+
+	const std::size_t size = mapping->GetSize();
+
+	if (size < sizeof(dpackheader_t))
+	{
+		return {};
+	}
+
+	dpackheader_t header;
+
+	std::memcpy(&header, mapping->GetData(), sizeof(header));
+
+	if (std::strncmp(header.id, PakFileId, sizeof(header.id)) != 0)
+	{
+		return {};
+	}
+
+	const auto directoryOffset = LittleValue(header.dirofs);
+	const auto directoryLength = LittleValue(header.dirlen);
+
+	if (directoryOffset < 0 || directoryLength < 0
+		|| (directoryLength % sizeof(dpackfile_t)) != 0
+		|| static_cast<std::size_t>(directoryOffset) + static_cast<std::size_t>(directoryLength) > size)
+	{
+		return {};
+	}
+
+	const std::size_t count = directoryLength / sizeof(dpackfile_t);
+
+	std::unordered_map<std::string, Entry> entries;
+
+	entries.reserve(count);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		dpackfile_t file;
+
+		std::memcpy(&file, mapping->GetData() + directoryOffset + (i * sizeof(dpackfile_t)), sizeof(file));
+
+		const auto position = LittleValue(file.filepos);
+		const auto length = LittleValue(file.filelen);
+
+		//Skip entries that point outside the archive instead of rejecting the whole archive
+		if (position < 0 || length < 0 || static_cast<std::size_t>(position) + static_cast<std::size_t>(length) > size)
+		{
+			continue;
+		}
+
+		const std::string_view name{file.name, strnlen(file.name, sizeof(file.name))};
+
+		//The first entry for a given name wins, as in the engine
+		entries.try_emplace(NormalizeArchiveFileName(name), Entry{static_cast<std::size_t>(position), static_cast<std::size_t>(length)});
+	}
+
+	return std::make_unique<PakFile>(std::string{fileName}, std::move(mapping), std::move(entries));
+}
+
+std::vector<std::string_view> PakFile::GetFileNames() const
+{
+	std::vector<std::string_view> fileNames;
+
+	fileNames.reserve(_entries.size());
+
+	for (const auto& entry : _entries)
+	{
+		fileNames.emplace_back(entry.first);
+	}
+
+	return fileNames;
+}
+
+bool PakFile::HasFile(std::string_view fileName) const
+{
+	return _entries.find(NormalizeArchiveFileName(fileName)) != _entries.end();
+}
+
+FileView PakFile::OpenFile(std::string_view fileName) const
+{
+	if (auto it = _entries.find(NormalizeArchiveFileName(fileName)); it != _entries.end())
+	{
+		return FileView{_mapping, _mapping->GetData() + it->second.Offset, it->second.Size};
+	}
+
+	return {};
+}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "filesystem/IArchive.hpp"
+
+class MemoryMappedFile;
+
+/**
+*	@ingroup FileSystem
+*
+*	@{
+*/
+
+namespace filesystem
+{
+constexpr char PakFileId[] = "PACK";
+
+/**
+*	@brief Maximum length of a file name in a pak directory entry, including the null terminator
+*/
+constexpr std::size_t PakFileNameLength = 56;
+
+struct dpackheader_t
+{
+	char id[4];
+	std::int32_t dirofs;
+	std::int32_t dirlen;
+};
+
+struct dpackfile_t
+{
+	char name[PakFileNameLength];
+	std::int32_t filepos;
+	std::int32_t filelen;
+};
+
+/**
+*	@brief Read-only Quake/Half-Life pak archive.
+*	The archive is memory mapped and its directory is hashed when it is opened.
+*	Files are returned as views into the mapping, so no data is copied.
+*/
+class PakFile final : public IArchive
+{
+public:
+	struct Entry
+	{
+		std::size_t Offset;
+		std::size_t Size;
+	};
+
+	PakFile(std::string&& fileName, std::shared_ptr<MemoryMappedFile>&& mapping, std::unordered_map<std::string, Entry>&& entries);
+	~PakFile();
+	PakFile(const PakFile&) = delete;
+	PakFile& operator=(const PakFile&) = delete;
+
+	/**
+	*	@brief Opens and indexes the given pak file.
+	*	@return The pak file, or nullptr if the file does not exist or is not a valid pak file.
+	*/
+	static std::unique_ptr<PakFile> TryOpen(const std::string& fileName);
+
+	const std::string& GetFileName() const override { return _fileName; }
+
+	std::size_t GetEntryCount() const override { return _entries.size(); }
+
+	std::vector<std::string_view> GetFileNames() const override;
+
+	bool HasFile(std::string_view fileName) const override;
+
+	FileView OpenFile(std::string_view fileName) const override;
+
+private:
+	const std::string _fileName;
+	const std::shared_ptr<MemoryMappedFile> _mapping;
+	const std::unordered_map<std::string, Entry> _entries;
+};
+}
+
+/** @} */
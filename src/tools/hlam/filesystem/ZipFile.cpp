@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <cstring>
+
+#include "filesystem/ZipFile.hpp"
+
+#include "utility/ByteSwap.hpp"
+#include "utility/Inflate.hpp"
+#include "utility/MemoryMappedFile.hpp"
+
+namespace filesystem
+{
+namespace
+{
+constexpr std::uint32_t LocalHeaderSignature = 0x04034b50;
+constexpr std::uint32_t CentralDirectoryHeaderSignature = 0x02014b50;
+constexpr std::uint32_t EndOfCentralDirectorySignature = 0x06054b50;
+
+constexpr std::size_t LocalHeaderSize = 30;
+constexpr std::size_t CentralDirectoryHeaderSize = 46;
+constexpr std::size_t EndOfCentralDirectorySize = 22;
+constexpr std::size_t MaxCommentLength = 0xFFFF;
+
+constexpr std::uint16_t EncryptedFlag = 1 << 0;
+constexpr std::uint32_t Zip64Marker = 0xFFFFFFFF;
+
+std::uint16_t ReadUInt16(const std::byte* data)
+{
+	std::uint16_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return static_cast<std::uint16_t>(LittleValue(static_cast<std::int16_t>(value)));
+}
+
+std::uint32_t ReadUInt32(const std::byte* data)
+{
+	std::uint32_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return static_cast<std::uint32_t>(LittleValue(static_cast<std::int32_t>(value)));
+}
+}
+
+ZipFile::ZipFile(std::string&& fileName, std::shared_ptr<MemoryMappedFile>&& mapping, std::unordered_map<std::string, Entry>&& entries)
+	: _fileName(std::move(fileName))
+	, _mapping(std::move(mapping))
+	, _entries(std::move(entries))
+{
+}
+
+ZipFile::~ZipFile() = default;
+
+std::unique_ptr<ZipFile> ZipFile::TryOpen(const std::string& fileName)
+{
+	auto mapping = MemoryMappedFile::TryMap(fileName.c_str());
+
+	if (!mapping)
+	{
+		return {};
+	}
+
+	const std::byte* const data = mapping->GetData();
+	const std::size_t size = mapping->GetSize();
+
+	if (size < EndOfCentralDirectorySize)
+	{
+		return {};
+	}
+
+	//The end of central directory record is followed by a variable length comment, so search backwards for it
+	const std::byte* endOfCentralDirectory = nullptr;
+
+	{
+		const std::size_t lastCandidate = size - EndOfCentralDirectorySize;
+		const std::size_t firstCandidate = lastCandidate > MaxCommentLength ? lastCandidate - MaxCommentLength : 0;
+
+		for (std::size_t offset = lastCandidate + 1; offset-- > firstCandidate;)
+		{
+			if (ReadUInt32(data + offset) == EndOfCentralDirectorySignature)
+			{
+				endOfCentralDirectory = data + offset;
+				break;
+			}
+		}
+	}
+
+	if (!endOfCentralDirectory)
+	{
+		return {};
+	}
+
+	const std::size_t entryCount = ReadUInt16(endOfCentralDirectory + 10);
+	const std::size_t directorySize = ReadUInt32(endOfCentralDirectory + 12);
+	const std::size_t directoryOffset = ReadUInt32(endOfCentralDirectory + 16);
+
+	if (directoryOffset + directorySize > size)
+	{
+		return {};
+	}
+
+	std::unordered_map<std::string, Entry> entries;
+
+	entries.reserve(entryCount);
+
+	const std::byte* header = data + directoryOffset;
+	const std::byte* const directoryEnd = header + directorySize;
+
+	for (std::size_t i = 0; i < entryCount; ++i)
+	{
+		if (header + CentralDirectoryHeaderSize > directoryEnd || ReadUInt32(header) != CentralDirectoryHeaderSignature)
+		{
+			return {};
+		}
+
+		const std::uint16_t flags = ReadUInt16(header + 8);
+		const std::uint16_t method = ReadUInt16(header + 10);
+		const std::uint32_t crc32 = ReadUInt32(header + 16);
+		const std::uint32_t compressedSize = ReadUInt32(header + 20);
+		const std::uint32_t uncompressedSize = ReadUInt32(header + 24);
+		const std::size_t nameLength = ReadUInt16(header + 28);
+		const std::size_t extraLength = ReadUInt16(header + 30);
+		const std::size_t commentLength = ReadUInt16(header + 32);
+		const std::uint32_t localHeaderOffset = ReadUInt32(header + 42);
+
+		const std::byte* const name = header + CentralDirectoryHeaderSize;
+
+		header = name + nameLength + extraLength + commentLength;
+
+		if (header > directoryEnd)
+		{
+			return {};
+		}
+
+		const std::string_view entryName{reinterpret_cast<const char*>(name), nameLength};
+
+		//Skip directories and entries that can't be read
+		if (entryName.empty() || entryName.back() == '/'
+			|| (flags & EncryptedFlag) != 0
+			|| (method != static_cast<std::uint16_t>(CompressionMethod::Stored) && method != static_cast<std::uint16_t>(CompressionMethod::Deflated))
+			|| compressedSize == Zip64Marker || uncompressedSize == Zip64Marker || localHeaderOffset == Zip64Marker
+			|| localHeaderOffset + LocalHeaderSize > directoryOffset)
+		{
+			continue;
+		}
+
+		entries.try_emplace(NormalizeArchiveFileName(entryName),
+			Entry{localHeaderOffset, compressedSize, uncompressedSize, crc32, static_cast<CompressionMethod>(method)});
+	}
+
+	return std::make_unique<ZipFile>(std::string{fileName}, std::move(mapping), std::move(entries));
+}
+
+std::vector<std::string_view> ZipFile::GetFileNames() const
+{
+	std::vector<std::string_view> fileNames;
+
+	fileNames.reserve(_entries.size());
+
+	for (const auto& entry : _entries)
+	{
+		fileNames.emplace_back(entry.first);
+	}
+
+	return fileNames;
+}
+
+bool ZipFile::HasFile(std::string_view fileName) const
+{
+	return _entries.find(NormalizeArchiveFileName(fileName)) != _entries.end();
+}
+
+FileView ZipFile::OpenFile(std::string_view fileName) const
+{
+	auto normalizedFileName = NormalizeArchiveFileName(fileName);
+
+	const auto it = _entries.find(normalizedFileName);
+
+	if (it == _entries.end())
+	{
+		return {};
+	}
+
+	const auto& entry = it->second;
+
+	const std::byte* const data = GetEntryData(entry);
+
+	if (!data)
+	{
+		return {};
+	}
+
+	if (entry.Method == CompressionMethod::Stored)
+	{
+		if (entry.CompressedSize != entry.Size)
+		{
+			return {};
+		}
+
+		return FileView{_mapping, data, entry.Size};
+	}
+
+	std::shared_ptr<std::vector<std::byte>> buffer;
+
+	{
+		const std::lock_guard lock{_cacheMutex};
+
+		if (auto cached = _cacheLookup.find(normalizedFileName); cached != _cacheLookup.end())
+		{
+			//Move to the front of the LRU list
+			_cache.splice(_cache.begin(), _cache, cached->second);
+
+			buffer = cached->second->Data;
+
+			return FileView{buffer, buffer->data(), buffer->size()};
+		}
+
+		buffer = AcquireBuffer(entry.Size);
+	}
+
+	//Decompress without holding the lock so other entries can be opened in the meantime
+	if (!Inflate(data, entry.CompressedSize, buffer->data(), buffer->size())
+		|| ComputeCrc32(buffer->data(), buffer->size()) != entry.Crc32)
+	{
+		return {};
+	}
+
+	{
+		const std::lock_guard lock{_cacheMutex};
+
+		//Another thread may have decompressed the same entry in the meantime
+		if (_cacheLookup.find(normalizedFileName) == _cacheLookup.end() && entry.Size <= _maxCacheSizeInBytes)
+		{
+			EvictEntries(_maxCacheSizeInBytes - entry.Size);
+
+			_cache.push_front(CachedEntry{std::move(normalizedFileName), buffer});
+			_cacheLookup.emplace(_cache.front().FileName, _cache.begin());
+			_cacheSizeInBytes += entry.Size;
+		}
+	}
+
+	return FileView{buffer, buffer->data(), buffer->size()};
+}
+
+void ZipFile::SetMaxCacheSizeInBytes(std::size_t value)
+{
+	const std::lock_guard lock{_cacheMutex};
+
+	_maxCacheSizeInBytes = value;
+
+	EvictEntries(_maxCacheSizeInBytes);
+}
+
+const std::byte* ZipFile::GetEntryData(const Entry& entry) const
+{
+	const std::byte* const data = _mapping->GetData();
+	const std::size_t size = _mapping->GetSize();
+
+	const std::byte* const header = data + entry.LocalHeaderOffset;
+
+	if (ReadUInt32(header) != LocalHeaderSignature)
+	{
+		return nullptr;
+	}
+
+	//The local header can have different extra data than the central directory header
+	const std::size_t dataOffset = entry.LocalHeaderOffset + LocalHeaderSize + ReadUInt16(header + 26) + ReadUInt16(header + 28);
+
+	if (dataOffset + entry.CompressedSize > size)
+	{
+		return nullptr;
+	}
+
+	return data + dataOffset;
+}
+
+std::shared_ptr<std::vector<std::byte>> ZipFile::AcquireBuffer(std::size_t size) const
+{
+	//Use the smallest pooled buffer that's large enough
+	auto best = _bufferPool.end();
+
+	for (auto it = _bufferPool.begin(); it != _bufferPool.end(); ++it)
+	{
+		if ((*it)->capacity() >= size && (best == _bufferPool.end() || (*it)->capacity() < (*best)->capacity()))
+		{
+			best = it;
+		}
+	}
+
+	std::shared_ptr<std::vector<std::byte>> buffer;
+
+	if (best != _bufferPool.end())
+	{
+		buffer = std::move(*best);
+		_bufferPool.erase(best);
+	}
+	else
+	{
+		buffer = std::make_shared<std::vector<std::byte>>();
+	}
+
+	buffer->resize(size);
+
+	return buffer;
+}
+
+void ZipFile::EvictEntries(std::size_t maxSizeInBytes) const
+{
+	while (_cacheSizeInBytes > maxSizeInBytes && !_cache.empty())
+	{
+		auto& entry = _cache.back();
+
+		_cacheSizeInBytes -= entry.Data->size();
+		_cacheLookup.erase(entry.FileName);
+
+		//Buffers still referenced by file views are freed when the last view is destroyed
+		if (entry.Data.use_count() == 1 && _bufferPool.size() < MaxPooledBuffers)
+		{
+			_bufferPool.push_back(std::move(entry.Data));
+		}
+
+		_cache.pop_back();
+	}
+}
+}
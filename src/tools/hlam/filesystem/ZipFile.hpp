@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "filesystem/IArchive.hpp"
+
+class MemoryMappedFile;
+
+/**
+*	@ingroup FileSystem
+*
+*	@{
+*/
+
+namespace filesystem
+{
+/**
+*	@brief Read-only zip (pk3) archive.
+*	The archive is memory mapped and its central directory is indexed when it is opened.
+*	Stored entries are returned as views into the mapping.
+*	Deflated entries are decompressed on demand into pooled buffers,
+*	and the most recently used decompressed entries are cached so repeated loads don't decompress again.
+*/
+class ZipFile final : public IArchive
+{
+public:
+	/**
+	*	@brief Default maximum size of the decompressed entry cache, in bytes.
+	*/
+	static constexpr std::size_t DefaultCacheSizeInBytes = 32 * 1024 * 1024;
+
+	/**
+	*	@brief Maximum number of unused decompression buffers kept around for reuse.
+	*/
+	static constexpr std::size_t MaxPooledBuffers = 8;
+
+	enum class CompressionMethod : std::uint16_t
+	{
+		Stored = 0,
+		Deflated = 8
+	};
+
+	struct Entry
+	{
+		std::size_t LocalHeaderOffset;
+		std::size_t CompressedSize;
+		std::size_t Size;
+		std::uint32_t Crc32;
+		CompressionMethod Method;
+	};
+
+	ZipFile(std::string&& fileName, std::shared_ptr<MemoryMappedFile>&& mapping, std::unordered_map<std::string, Entry>&& entries);
+	~ZipFile();
+	ZipFile(const ZipFile&) = delete;
+	ZipFile& operator=(const ZipFile&) = delete;
+
+	/**
+	*	@brief Opens and indexes the given zip file.
+	*	Encrypted entries, zip64 entries and entries using compression methods other than store and deflate are ignored.
+	*	@return The zip file, or nullptr if the file does not exist or is not a valid zip file.
+	*/
+	static std::unique_ptr<ZipFile> TryOpen(const std::string& fileName);
+
+	const std::string& GetFileName() const override { return _fileName; }
+
+	std::size_t GetEntryCount() const override { return _entries.size(); }
+
+	std::vector<std::string_view> GetFileNames() const override;
+
+	bool HasFile(std::string_view fileName) const override;
+
+	/**
+	*	@copydoc IArchive::OpenFile
+	*	Thread safe.
+	*/
+	FileView OpenFile(std::string_view fileName) const override;
+
+	std::size_t GetMaxCacheSizeInBytes() const { return _maxCacheSizeInBytes; }
+
+	/**
+	*	@brief Sets the maximum size of the decompressed entry cache. Evicts entries if needed.
+	*/
+	void SetMaxCacheSizeInBytes(std::size_t value);
+
+private:
+	struct CachedEntry
+	{
+		std::string FileName;
+		std::shared_ptr<std::vector<std::byte>> Data;
+	};
+
+	/**
+	*	@brief Gets the start of an entry's data by parsing its local header.
+	*	@return Pointer to the data, or nullptr if the header is invalid.
+	*/
+	const std::byte* GetEntryData(const Entry& entry) const;
+
+	std::shared_ptr<std::vector<std::byte>> AcquireBuffer(std::size_t size) const;
+
+	void EvictEntries(std::size_t maxSizeInBytes) const;
+
+private:
+	const std::string _fileName;
+	const std::shared_ptr<MemoryMappedFile> _mapping;
+	const std::unordered_map<std::string, Entry> _entries;
+
+	mutable std::mutex _cacheMutex;
+
+	std::size_t _maxCacheSizeInBytes = DefaultCacheSizeInBytes;
+
+	//Most recently used entries are at the front
+	mutable std::list<CachedEntry> _cache;
+	mutable std::unordered_map<std::string_view, std::list<CachedEntry>::iterator> _cacheLookup;
+	mutable std::size_t _cacheSizeInBytes = 0;
+
+	mutable std::vector<std::shared_ptr<std::vector<std::byte>>> _bufferPool;
+};
+}
+
+/** @} */
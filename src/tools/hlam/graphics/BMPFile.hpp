@@ -6,10 +6,8 @@ namespace graphics
 {
 namespace bmpfile
 {
-//Required because the header is not aligned to > 2 bytes. TODO: figure out if other platforms need anything.
-#ifdef WIN32
-#include <pshpack2.h>
-#endif
+//Required because the header is not aligned to > 2 bytes.
+#pragma pack(push, 2)
 
 struct Header final
 {
@@ -43,9 +41,7 @@ struct RGBQuad final
 	uint8_t rgbReserved;
 };
 
-#ifdef WIN32
-#include <poppack.h>
-#endif
+#pragma pack(pop)
 
 #define BMP_TYPE_ID 0x4D42
 
@@ -74,64 +74,102 @@ void TextureLoader::SetTextureFilters(TextureFilter minFilter, TextureFilter mag
 	}
 }
 
-void TextureLoader::UploadRGBA8888(GLuint texture, int width, int height, const std::byte* rgbaPixels, bool generateMipmaps, bool masked)
+void ConvertIndexed8ToRGBA8888(int width, int height, const std::byte* pixels, const RGBPalette& palette, bool masked,
+	std::vector<std::byte>& rgbaPixels)
 {
-	const auto [newWidth, newHeight] = AdjustImageDimensions(width, height);
-
-	std::vector<std::byte> pixels;
+	//TODO: total size can be too large
+	RGBPalette localPalette{palette};
 
-	if (newWidth != width || newHeight != height)
+	//Sets the mask color to black. This helps limit the bleedover effect caused by resizing and filtering
+	if (masked)
 	{
-		std::vector<int> col1, col2;
-		std::vector<int> row1, row2;
-		
-		col1.resize(newWidth);
-		col2.resize(newWidth);
+		localPalette.GetAlpha() = {0, 0, 0};
+	}
+
+	rgbaPixels.resize(width * height * 4);
 
-		row1.resize(newHeight);
-		row2.resize(newHeight);
+	for (int i = 0; i < (width * height); ++i)
+	{
+		rgbaPixels[(i * 4) + 0] = std::byte{localPalette[std::to_integer<int>(pixels[i])].R};
+		rgbaPixels[(i * 4) + 1] = std::byte{localPalette[std::to_integer<int>(pixels[i])].G};
+		rgbaPixels[(i * 4) + 2] = std::byte{localPalette[std::to_integer<int>(pixels[i])].B};
 
-		for (int i = 0; i < newWidth; ++i)
+		//For masked textures the last color in the table is the transparent color
+		//Pixels with that color have their alpha value set to 0 to appear transparent
+		if (masked && pixels[i] == std::byte{RGBPalette::AlphaIndex})
 		{
-			col1[i] = (int)((i + 0.25) * (width / (float)newWidth));
-			col2[i] = (int)((i + 0.75) * (width / (float)newWidth));
+			rgbaPixels[(i * 4) + 3] = std::byte{0x00};
 		}
-
-		for (int i = 0; i < newHeight; ++i)
+		else
 		{
-			row1[i] = (int)((i + 0.25) * (height / (float)newHeight)) * width;
-			row2[i] = (int)((i + 0.75) * (height / (float)newHeight)) * width;
+			rgbaPixels[(i * 4) + 3] = std::byte{0xFF};
 		}
+	}
+}
+
+void ResampleRGBA8888(int width, int height, const std::byte* rgbaPixels, int newWidth, int newHeight, bool masked,
+	std::vector<std::byte>& pixels)
+{
+	std::vector<int> col1, col2;
+	std::vector<int> row1, row2;
+	
+	col1.resize(newWidth);
+	col2.resize(newWidth);
+
+	row1.resize(newHeight);
+	row2.resize(newHeight);
 
-		pixels.resize(newWidth * newHeight * 4);
+	for (int i = 0; i < newWidth; ++i)
+	{
+		col1[i] = (int)((i + 0.25) * (width / (float)newWidth));
+		col2[i] = (int)((i + 0.75) * (width / (float)newWidth));
+	}
+
+	for (int i = 0; i < newHeight; ++i)
+	{
+		row1[i] = (int)((i + 0.25) * (height / (float)newHeight)) * width;
+		row2[i] = (int)((i + 0.75) * (height / (float)newHeight)) * width;
+	}
 
-		for (int i = 0; i < newHeight; ++i)
+	pixels.resize(newWidth * newHeight * 4);
+
+	for (int i = 0; i < newHeight; ++i)
+	{
+		for (int j = 0; j < newWidth; ++j)
 		{
-			for (int j = 0; j < newWidth; ++j)
+			const auto pix1 = &rgbaPixels[(row1[i] + col1[j]) * 4];
+			const auto pix2 = &rgbaPixels[(row1[i] + col2[j]) * 4];
+			const auto pix3 = &rgbaPixels[(row2[i] + col1[j]) * 4];
+			const auto pix4 = &rgbaPixels[(row2[i] + col2[j]) * 4];
+
+			std::byte* const pixel = &pixels[((newWidth * i) + j) * 4];
+
+			for (int p = 0; p < 4; ++p)
+			{
+				pixel[p] = std::byte((std::to_integer<int>(pix1[p])
+					+ std::to_integer<int>(pix2[p])
+					+ std::to_integer<int>(pix3[p])
+					+ std::to_integer<int>(pix4[p])) / 4);
+			}
+
+			//If any of the sampled pixels are transparent the destination pixel is also transparent
+			if (masked && pixel[3] != std::byte{0xFF})
 			{
-				const auto pix1 = &rgbaPixels[(row1[i] + col1[j]) * 4];
-				const auto pix2 = &rgbaPixels[(row1[i] + col2[j]) * 4];
-				const auto pix3 = &rgbaPixels[(row2[i] + col1[j]) * 4];
-				const auto pix4 = &rgbaPixels[(row2[i] + col2[j]) * 4];
-
-				std::byte* const pixel = &pixels[((newWidth * i) + j) * 4];
-
-				for (int p = 0; p < 4; ++p)
-				{
-					pixel[p] = std::byte((std::to_integer<int>(pix1[p])
-						+ std::to_integer<int>(pix2[p])
-						+ std::to_integer<int>(pix3[p])
-						+ std::to_integer<int>(pix4[p])) / 4);
-				}
-
-				//If any of the sampled pixels are transparent the destination pixel is also transparent
-				if (masked && pixel[3] != std::byte{0xFF})
-				{
-					pixel[3] = std::byte{0x00};
-				}
+				pixel[3] = std::byte{0x00};
 			}
 		}
+	}
+}
+
+void TextureLoader::UploadRGBA8888(GLuint texture, int width, int height, const std::byte* rgbaPixels, bool generateMipmaps, bool masked)
+{
+	const auto [newWidth, newHeight] = AdjustImageDimensions(width, height);
+
+	std::vector<std::byte> pixels;
 
+	if (newWidth != width || newHeight != height)
+	{
+		ResampleRGBA8888(width, height, rgbaPixels, newWidth, newHeight, masked, pixels);
 		rgbaPixels = pixels.data();
 	}
 
@@ -147,36 +185,9 @@ void TextureLoader::UploadRGBA8888(GLuint texture, int width, int height, const
 
 void TextureLoader::UploadIndexed8(GLuint texture, int width, int height, const std::byte* pixels, const RGBPalette& palette, bool generateMipmaps, bool masked)
 {
-	//TODO: total size can be too large
-	RGBPalette localPalette{palette};
-
-	//Sets the mask color to black. This helps limit the bleedover effect caused by resizing and filtering
-	if (masked)
-	{
-		localPalette.GetAlpha() = {0, 0, 0};
-	}
-
 	std::vector<std::byte> rgbaPixels;
 
-	rgbaPixels.resize(width * height * 4);
-
-	for (int i = 0; i < (width * height); ++i)
-	{
-		rgbaPixels[(i * 4) + 0] = std::byte{localPalette[std::to_integer<int>(pixels[i])].R};
-		rgbaPixels[(i * 4) + 1] = std::byte{localPalette[std::to_integer<int>(pixels[i])].G};
-		rgbaPixels[(i * 4) + 2] = std::byte{localPalette[std::to_integer<int>(pixels[i])].B};
-
-		//For masked textures the last color in the table is the transparent color
-		//Pixels with that color have their alpha value set to 0 to appear transparent
-		if (masked && pixels[i] == std::byte{RGBPalette::AlphaIndex})
-		{
-			rgbaPixels[(i * 4) + 3] = std::byte{0x00};
-		}
-		else
-		{
-			rgbaPixels[(i * 4) + 3] = std::byte{0xFF};
-		}
-	}
+	ConvertIndexed8ToRGBA8888(width, height, pixels, palette, masked, rgbaPixels);
 
 	UploadRGBA8888(texture, width, height, rgbaPixels.data(), generateMipmaps, masked);
 }
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <utility>
+#include <vector>
 
 #include <GL/glew.h>
 
@@ -28,6 +29,20 @@ enum class MipmapFilter
 	Last = Linear
 };
 
+/**
+*	@brief Converts 8 bit indexed pixels to RGBA.
+*	For masked textures the last color in the palette is transparent and black.
+*/
+void ConvertIndexed8ToRGBA8888(int width, int height, const std::byte* pixels, const RGBPalette& palette, bool masked,
+	std::vector<std::byte>& rgbaPixels);
+
+/**
+*	@brief Resamples RGBA pixels to a different size by averaging 4 samples per pixel.
+*	For masked textures pixels are transparent if any of their samples is.
+*/
+void ResampleRGBA8888(int width, int height, const std::byte* rgbaPixels, int newWidth, int newHeight, bool masked,
+	std::vector<std::byte>& pixels);
+
 class TextureLoader final
 {
 public:
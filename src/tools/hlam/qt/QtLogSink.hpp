@@ -3,6 +3,7 @@
 #include <cassert>
 #include <limits>
 #include <memory>
+#include <mutex>
 
 #include <QDebug>
 #include <QLoggingCategory>
@@ -101,3 +102,10 @@ inline std::shared_ptr<spdlog::logger> CreateQtLoggerSt(const QLoggingCategory&
 
 	return std::make_shared<spdlog::logger>(category.categoryName(), std::move(sink));
 }
+
+inline std::shared_ptr<spdlog::logger> CreateQtLoggerMt(const QLoggingCategory& category)
+{
+	auto sink = std::make_shared<QtLogSink<std::mutex>>(category);
+
+	return std::make_shared<spdlog::logger>(category.categoryName(), std::move(sink));
+}
@@ -18,5 +18,11 @@ public:
 	void PlaySound(std::string_view, float, int) override {}
 
 	void StopAllSounds() override {}
+
+	void PrefetchSounds(const std::vector<std::string>&) override {}
+
+	SoundLoadStatus GetSoundLoadStatus(std::string_view) const override { return SoundLoadStatus::NotRequested; }
+
+	SoundLatencyStats GetLatencyStats() const override { return {}; }
 };
 }
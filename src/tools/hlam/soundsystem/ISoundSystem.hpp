@@ -1,6 +1,10 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #undef PlaySound
 
@@ -17,6 +21,43 @@ class IFileSystem;
 
 namespace soundsystem
 {
+/**
+*	@brief Statistics about the time between a request to play a sound and the sound starting to play.
+*/
+struct SoundLatencyStats
+{
+	std::size_t PlayedCount = 0;
+
+	/**
+	*	@brief Number of requests that were dropped because the sound could not be started in time.
+	*/
+	std::size_t DroppedCount = 0;
+
+	std::chrono::microseconds TotalLatency{0};
+	std::chrono::microseconds MaxLatency{0};
+
+	std::chrono::microseconds GetAverageLatency() const
+	{
+		return PlayedCount > 0 ? TotalLatency / static_cast<std::chrono::microseconds::rep>(PlayedCount) : std::chrono::microseconds{0};
+	}
+};
+
+/**
+*	@brief Result of loading a sound ahead of time.
+*/
+enum class SoundLoadStatus
+{
+	NotRequested,
+	Pending,
+	Loaded,
+	Missing,
+
+	/**
+	*	@brief The file exists but is not a supported sound format.
+	*/
+	Failed
+};
+
 /**
 *	A sound system that can be used to play back sounds. Sounds are non-looping.
 */
@@ -48,6 +89,7 @@ public:
 
 	/**
 	*	@brief Plays a sound by name. The filename is relative to the game's sound directory, and is looked up using the filesystem.
+	*	The sound is loaded asynchronously, so it may start playing after this returns, or not at all if loading takes too long.
 	*	@param fileName Sound filename.
 	*	@param volume Volume. Expressed as a range between [0, 1].
 	*	@param pitch Pitch amount. Expressed as a range between [0, 255].
@@ -58,6 +100,21 @@ public:
 	*	Stops all sounds that are currently playing.
 	*/
 	virtual void StopAllSounds() = 0;
+
+	/**
+	*	@brief Loads sounds into the cache in the background so they can be played without having to wait for them to load.
+	*	Sounds that were passed to a previous call and haven't been loaded yet are no longer loaded.
+	*	Sounds that need to be played are loaded first.
+	*	@param fileNames Sound filenames, in the same format as passed to PlaySound.
+	*/
+	virtual void PrefetchSounds(const std::vector<std::string>& fileNames) = 0;
+
+	/**
+	*	@brief Gets the status of a sound passed to PrefetchSounds.
+	*/
+	virtual SoundLoadStatus GetSoundLoadStatus(std::string_view fileName) const = 0;
+
+	virtual SoundLatencyStats GetLatencyStats() const = 0;
 };
 }
 
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include "vorbis/vorbisfile.h"
+
+#include "filesystem/FileView.hpp"
+
+/**
+*	@ingroup SoundSystem
+*
+*	@{
+*/
+
+namespace soundsystem
+{
+struct OggVorbisCleanup
+{
+	void operator()(OggVorbis_File* pointer) const
+	{
+		ov_clear(pointer);
+	}
+};
+
+/**
+*	@brief Lets libvorbisfile decode directly from a file view instead of opening the file itself.
+*/
+struct OggVorbisMemoryStream
+{
+	const filesystem::FileView* File;
+	std::size_t Position = 0;
+
+	static std::size_t Read(void* ptr, std::size_t size, std::size_t nmemb, void* datasource)
+	{
+		auto stream = static_cast<OggVorbisMemoryStream*>(datasource);
+
+		if (size == 0)
+		{
+			return 0;
+		}
+
+		const std::size_t count = std::min(nmemb, (stream->File->GetSize() - stream->Position) / size);
+
+		std::memcpy(ptr, stream->File->GetData() + stream->Position, count * size);
+
+		stream->Position += count * size;
+
+		return count;
+	}
+
+	static int Seek(void* datasource, ogg_int64_t offset, int whence)
+	{
+		auto stream = static_cast<OggVorbisMemoryStream*>(datasource);
+
+		ogg_int64_t position;
+
+		switch (whence)
+		{
+		case SEEK_SET: position = offset; break;
+		case SEEK_CUR: position = static_cast<ogg_int64_t>(stream->Position) + offset; break;
+		case SEEK_END: position = static_cast<ogg_int64_t>(stream->File->GetSize()) + offset; break;
+		default: return -1;
+		}
+
+		if (position < 0 || position > static_cast<ogg_int64_t>(stream->File->GetSize()))
+		{
+			return -1;
+		}
+
+		stream->Position = static_cast<std::size_t>(position);
+
+		return 0;
+	}
+
+	static long Tell(void* datasource)
+	{
+		return static_cast<long>(static_cast<OggVorbisMemoryStream*>(datasource)->Position);
+	}
+
+	static constexpr ov_callbacks Callbacks{&Read, &Seek, nullptr, &Tell};
+};
+}
+
+/** @} */
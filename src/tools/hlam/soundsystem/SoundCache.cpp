@@ -0,0 +1,80 @@
+#include <iterator>
+
+#include "soundsystem/SoundCache.hpp"
+
+namespace soundsystem
+{
+SoundCache::SoundCache(std::size_t maxSizeInBytes)
+	: _maxSizeInBytes(maxSizeInBytes)
+{
+}
+
+SoundCache::~SoundCache() = default;
+
+void SoundCache::SetMaxSizeInBytes(std::size_t value)
+{
+	_maxSizeInBytes = value;
+
+	EvictEntries(_maxSizeInBytes);
+}
+
+std::shared_ptr<SoundBuffer> SoundCache::Find(std::string_view key)
+{
+	const auto it = _lookup.find(key);
+
+	if (it == _lookup.end())
+	{
+		return {};
+	}
+
+	_entries.splice(_entries.begin(), _entries, it->second);
+
+	return it->second->Buffer;
+}
+
+void SoundCache::Add(std::string&& key, const std::shared_ptr<SoundBuffer>& buffer)
+{
+	if (!buffer)
+	{
+		return;
+	}
+
+	if (const auto it = _lookup.find(key); it != _lookup.end())
+	{
+		Remove(it->second);
+	}
+
+	if (buffer->SizeInBytes > _maxSizeInBytes)
+	{
+		return;
+	}
+
+	EvictEntries(_maxSizeInBytes - buffer->SizeInBytes);
+
+	_entries.push_front(Entry{std::move(key), buffer});
+	_lookup.emplace(_entries.front().Key, _entries.begin());
+	_sizeInBytes += buffer->SizeInBytes;
+}
+
+void SoundCache::Clear()
+{
+	_lookup.clear();
+	_entries.clear();
+	_sizeInBytes = 0;
+}
+
+void SoundCache::Remove(std::list<Entry>::iterator it)
+{
+	_sizeInBytes -= it->Buffer->SizeInBytes;
+	_lookup.erase(it->Key);
+	_entries.erase(it);
+}
+
+void SoundCache::EvictEntries(std::size_t maxSizeInBytes)
+{
+	while (_sizeInBytes > maxSizeInBytes && !_entries.empty())
+	{
+		Remove(std::prev(_entries.end()));
+	}
+}
+}
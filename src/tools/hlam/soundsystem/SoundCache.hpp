@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <al.h>
+
+/**
+*	@ingroup SoundSystem
+*
+*	@{
+*/
+
+namespace soundsystem
+{
+/**
+*	@brief Default maximum size of the decoded sound cache, in bytes.
+*/
+constexpr std::size_t DefaultSoundCacheSizeInBytes = 32 * 1024 * 1024;
+
+/**
+*	@brief OpenAL buffer containing a decoded sound.
+*	Sources that are playing the buffer hold a reference to it so it isn't deleted while in use.
+*/
+struct SoundBuffer
+{
+	SoundBuffer()
+	{
+		alGenBuffers(1, &Buffer);
+	}
+
+	~SoundBuffer()
+	{
+		alDeleteBuffers(1, &Buffer);
+	}
+
+	SoundBuffer(const SoundBuffer&) = delete;
+	SoundBuffer& operator=(const SoundBuffer&) = delete;
+
+	ALuint Buffer = 0;
+
+	/**
+	*	@brief Size of the decoded data in the buffer, in bytes.
+	*/
+	std::size_t SizeInBytes = 0;
+
+	/**
+	*	@brief Sample at which the sound starts looping, or -1 if it doesn't loop.
+	*/
+	int LoopStart = -1;
+};
+
+/**
+*	@brief Least recently used cache of decoded sounds, limited by the total size of the decoded data.
+*	All operations are constant time, except for evictions.
+*/
+class SoundCache final
+{
+public:
+	explicit SoundCache(std::size_t maxSizeInBytes = DefaultSoundCacheSizeInBytes);
+	~SoundCache();
+
+	SoundCache(const SoundCache&) = delete;
+	SoundCache& operator=(const SoundCache&) = delete;
+
+	std::size_t GetCount() const { return _entries.size(); }
+
+	std::size_t GetSizeInBytes() const { return _sizeInBytes; }
+
+	std::size_t GetMaxSizeInBytes() const { return _maxSizeInBytes; }
+
+	/**
+	*	@brief Sets the maximum size of the cache. Evicts sounds if needed.
+	*/
+	void SetMaxSizeInBytes(std::size_t value);
+
+	/**
+	*	@brief Finds a sound and marks it as the most recently used one.
+	*	@return The sound, or nullptr if it isn't cached.
+	*/
+	std::shared_ptr<SoundBuffer> Find(std::string_view key);
+
+	/**
+	*	@brief Adds a sound, evicting the least recently used sounds to make room for it.
+	*	Sounds that are larger than the cache are not added. If a sound with the same key is already cached it is replaced.
+	*/
+	void Add(std::string&& key, const std::shared_ptr<SoundBuffer>& buffer);
+
+	/**
+	*	@brief Removes all sounds. Buffers that are still being played are deleted once playback ends.
+	*/
+	void Clear();
+
+private:
+	struct Entry
+	{
+		std::string Key;
+		std::shared_ptr<SoundBuffer> Buffer;
+	};
+
+	void Remove(std::list<Entry>::iterator it);
+
+	void EvictEntries(std::size_t maxSizeInBytes);
+
+private:
+	std::size_t _maxSizeInBytes;
+	std::size_t _sizeInBytes = 0;
+
+	//Most recently used sounds are at the front
+	std::list<Entry> _entries;
+	std::unordered_map<std::string_view, std::list<Entry>::iterator> _lookup;
+};
+}
+
+/** @} */
@@ -0,0 +1,225 @@
+#include <algorithm>
+
+#include "soundsystem/SoundStream.hpp"
+
+namespace soundsystem
+{
+SoundStream::SoundStream(filesystem::FileView&& file)
+	: _file(std::move(file))
+	, _stream{&_file}
+{
+}
+
+SoundStream::~SoundStream()
+{
+	//The buffers have been detached from the source by Stop or by playing to the end,
+	//so it's safe to delete them even if the last reference is released on the streaming thread
+	if (_buffers[0])
+	{
+		alDeleteBuffers(static_cast<ALsizei>(_buffers.size()), _buffers.data());
+	}
+
+	if (_isOpen)
+	{
+		ov_clear(&_vorbisFile);
+	}
+}
+
+std::shared_ptr<SoundStream> SoundStream::TryOpen(filesystem::FileView&& file)
+{
+	auto stream = std::make_shared<SoundStream>(std::move(file));
+
+	if (ov_open_callbacks(&stream->_stream, &stream->_vorbisFile, nullptr, 0, OggVorbisMemoryStream::Callbacks))
+	{
+		return {};
+	}
+
+	stream->_isOpen = true;
+
+	const auto info = ov_info(&stream->_vorbisFile, -1);
+
+	if (!info || (info->channels != 1 && info->channels != 2))
+	{
+		return {};
+	}
+
+	stream->_format = info->channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+	stream->_sampleRate = static_cast<int>(info->rate);
+	stream->_decodedSizeInBytes = ov_pcm_total(&stream->_vorbisFile, -1) * info->channels * 2;
+
+	stream->_decodeBuffer.resize(BufferSizeInBytes);
+
+	return stream;
+}
+
+bool SoundStream::DecodeAll(std::vector<std::uint8_t>& data)
+{
+	const std::lock_guard lock{_mutex};
+
+	data.resize(static_cast<std::size_t>(_decodedSizeInBytes));
+
+	std::size_t size = 0;
+	int bitStream = 0;
+
+	while (size < data.size())
+	{
+		const long result = ov_read(&_vorbisFile, reinterpret_cast<char*>(data.data()) + size,
+			static_cast<int>(std::min<std::size_t>(data.size() - size, BufferSizeInBytes)), 0, 2, 1, &bitStream);
+
+		if (result < 0)
+		{
+			return false;
+		}
+
+		if (result == 0)
+		{
+			break;
+		}
+
+		size += static_cast<std::size_t>(result);
+	}
+
+	//The total reported by the file is an upper bound if the last page is truncated
+	data.resize(size);
+
+	_endOfStream = true;
+	_finished = true;
+
+	return true;
+}
+
+bool SoundStream::Start(ALuint source)
+{
+	const std::lock_guard lock{_mutex};
+
+	if (_finished)
+	{
+		return false;
+	}
+
+	if (!_buffers[0])
+	{
+		alGenBuffers(static_cast<ALsizei>(_buffers.size()), _buffers.data());
+	}
+
+	_source = source;
+
+	//Only decode one buffer here so playback starts right away
+	if (!QueueBuffer(_buffers[0]))
+	{
+		_finished = true;
+		return false;
+	}
+
+	_usedBufferCount = 1;
+
+	alSourcePlay(_source);
+
+	return alGetError() == AL_NONE;
+}
+
+void SoundStream::Stop()
+{
+	const std::lock_guard lock{_mutex};
+
+	if (_source)
+	{
+		alSourceStop(_source);
+		alSourcei(_source, AL_BUFFER, 0);
+		_source = 0;
+	}
+
+	_finished = true;
+}
+
+bool SoundStream::Update()
+{
+	const std::lock_guard lock{_mutex};
+
+	if (_finished)
+	{
+		return false;
+	}
+
+	ALint queued = 0;
+	ALint processed = 0;
+
+	alGetSourcei(_source, AL_BUFFERS_QUEUED, &queued);
+	alGetSourcei(_source, AL_BUFFERS_PROCESSED, &processed);
+
+	std::array<ALuint, BufferCount> freeBuffers;
+	std::size_t freeCount = 0;
+
+	if (processed > 0)
+	{
+		alSourceUnqueueBuffers(_source, processed, freeBuffers.data());
+		freeCount = static_cast<std::size_t>(processed);
+		queued -= processed;
+	}
+
+	//Buffers that have never been queued
+	for (; _usedBufferCount < _buffers.size(); ++_usedBufferCount)
+	{
+		freeBuffers[freeCount++] = _buffers[_usedBufferCount];
+	}
+
+	for (std::size_t i = 0; i < freeCount && !_endOfStream; ++i)
+	{
+		if (QueueBuffer(freeBuffers[i]))
+		{
+			++queued;
+		}
+	}
+
+	if (queued == 0)
+	{
+		//Everything has been played
+		alSourcei(_source, AL_BUFFER, 0);
+		_source = 0;
+		_finished = true;
+		return false;
+	}
+
+	ALint state = AL_STOPPED;
+
+	alGetSourcei(_source, AL_SOURCE_STATE, &state);
+
+	//The source stops if it plays all queued buffers before they could be refilled
+	if (state != AL_PLAYING && state != AL_PAUSED)
+	{
+		alSourcePlay(_source);
+	}
+
+	return true;
+}
+
+bool SoundStream::QueueBuffer(ALuint buffer)
+{
+	std::size_t size = 0;
+	int bitStream = 0;
+
+	while (size < _decodeBuffer.size())
+	{
+		const long result = ov_read(&_vorbisFile, _decodeBuffer.data() + size, static_cast<int>(_decodeBuffer.size() - size), 0, 2, 1, &bitStream);
+
+		//Stop at the end of the stream, and also if an error occurs since the rest of the file can't be relied on
+		if (result <= 0)
+		{
+			_endOfStream = true;
+			break;
+		}
+
+		size += static_cast<std::size_t>(result);
+	}
+
+	if (size == 0)
+	{
+		return false;
+	}
+
+	alBufferData(buffer, _format, _decodeBuffer.data(), static_cast<ALsizei>(size), _sampleRate);
+	alSourceQueueBuffers(_source, 1, &buffer);
+
+	return true;
+}
+}
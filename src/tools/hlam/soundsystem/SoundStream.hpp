@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <al.h>
+
+#include "filesystem/FileView.hpp"
+
+#include "soundsystem/OggVorbisMemoryStream.hpp"
+
+/**
+*	@ingroup SoundSystem
+*
+*	@{
+*/
+
+namespace soundsystem
+{
+/**
+*	@brief Ogg Vorbis sound that is decoded while it plays, using a small ring of queued OpenAL buffers.
+*	Memory usage is constant regardless of the length of the sound.
+*	The OpenAL buffers are only created when the stream is started, so opening a stream to inspect a sound is cheap.
+*
+*	Start is called from the decoding thread.
+*	Stop is called from whichever thread releases the voice that plays the stream, which is either the main thread or the decoding thread.
+*	Update is called from the streaming thread to refill processed buffers.
+*/
+class SoundStream final
+{
+public:
+	static constexpr std::size_t BufferCount = 4;
+	static constexpr std::size_t BufferSizeInBytes = 64 * 1024;
+
+	/**
+	*	@brief Sounds whose decoded size is larger than this are streamed instead of being decoded up front.
+	*/
+	static constexpr std::int64_t StreamingThresholdInBytes = 1024 * 1024;
+
+	explicit SoundStream(filesystem::FileView&& file);
+	~SoundStream();
+
+	SoundStream(const SoundStream&) = delete;
+	SoundStream& operator=(const SoundStream&) = delete;
+
+	/**
+	*	@brief Opens an Ogg Vorbis file for streaming.
+	*	@return The stream, or nullptr if the file is not a valid Ogg Vorbis file.
+	*/
+	static std::shared_ptr<SoundStream> TryOpen(filesystem::FileView&& file);
+
+	/**
+	*	@brief Gets the size of the sound when fully decoded, in bytes.
+	*/
+	std::int64_t GetDecodedSizeInBytes() const { return _decodedSizeInBytes; }
+
+	ALenum GetFormat() const { return _format; }
+
+	int GetSampleRate() const { return _sampleRate; }
+
+	/**
+	*	@brief Decodes the entire sound, for sounds that are short enough to be played from a single buffer.
+	*	The stream can't be started afterwards.
+	*	@param data Receives the decoded 16 bit samples.
+	*	@return Whether the sound was decoded without errors.
+	*/
+	bool DecodeAll(std::vector<std::uint8_t>& data);
+
+	/**
+	*	@brief Creates the buffers, decodes the first one and starts playing it on the given source. The remaining buffers are filled by Update.
+	*	@return Whether playback started.
+	*/
+	bool Start(ALuint source);
+
+	/**
+	*	@brief Stops playback and detaches the buffers from the source.
+	*/
+	void Stop();
+
+	/**
+	*	@brief Refills and queues buffers that the source has finished playing, and restarts the source if it ran out of data.
+	*	@return Whether the stream is still playing.
+	*/
+	bool Update();
+
+	/**
+	*	@brief Whether the entire sound has been played, or playback was stopped.
+	*/
+	bool IsFinished() const { return _finished; }
+
+private:
+	/**
+	*	@brief Decodes the next block of the sound into the given buffer and queues it.
+	*	@return Whether any data was queued.
+	*/
+	bool QueueBuffer(ALuint buffer);
+
+private:
+	//Must be declared before the vorbis stream that reads from it
+	const filesystem::FileView _file;
+
+	OggVorbisMemoryStream _stream;
+	OggVorbis_File _vorbisFile{};
+	bool _isOpen = false;
+
+	ALenum _format = AL_NONE;
+	int _sampleRate = 0;
+	std::int64_t _decodedSizeInBytes = 0;
+
+	std::array<ALuint, BufferCount> _buffers{};
+	std::size_t _usedBufferCount = 0;
+	std::vector<char> _decodeBuffer;
+
+	std::mutex _mutex;
+	ALuint _source = 0;
+	bool _endOfStream = false;
+	std::atomic<bool> _finished{false};
+};
+}
+
+/** @} */
@@ -7,13 +7,14 @@
 
 #include <spdlog/spdlog.h>
 
-#include "AudioFile/AudioFile.h"
-
-#include "vorbis/vorbisfile.h"
-
+#include "filesystem/FileView.hpp"
 #include "filesystem/IFileSystem.hpp"
 
+#include "soundsystem/SoundStream.hpp"
 #include "soundsystem/SoundSystem.hpp"
+#include "soundsystem/WaveFile.hpp"
+
+#include "utility/ByteSwap.hpp"
 
 namespace soundsystem
 {
@@ -36,167 +37,81 @@ bool SoundSystem::CheckALErrorsCore(const char* file, int line)
 
 #define CheckALErrors() CheckALErrorsCore(__FILE__, __LINE__)
 
-static ALenum BufferFormat(const AudioFile<double>& file)
+std::shared_ptr<SoundBuffer> SoundSystem::TryLoadWaveFile(const std::string& fileName, const filesystem::FileView& file)
 {
-	switch (file.getBitDepth())
-	{
-	case 8: return file.isStereo() ? AL_FORMAT_STEREO8 : AL_FORMAT_MONO8;
-	case 16: return file.isStereo() ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
-	default: return AL_INVALID;
-	}
-}
-
-struct DataConverter8Bit
-{
-	using Type = std::int8_t;
+	const auto waveFile = TryParseWaveFile(file.GetData(), file.GetSize());
 
-	static Type Convert(double value)
+	if (!waveFile)
 	{
-		value = (value + 1.) / 2.;
-		return static_cast<uint8_t> (value * 255.);
+		return {};
 	}
-};
 
-struct DataConverter16Bit
-{
-	using Type = std::int16_t;
-
-	static Type Convert(double value)
-	{
-		value = std::clamp(value, -1., 1.);
-		return static_cast<int16_t> (value * 32767.);
-	}
-};
+	const ALenum format = waveFile->BitsPerSample == 8
+		? (waveFile->Channels == 1 ? AL_FORMAT_MONO8 : AL_FORMAT_STEREO8)
+		: (waveFile->Channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16);
 
-template<typename T>
-void ConvertToAL(const AudioFile<double>& file, std::vector<std::uint8_t>& data)
-{
-	std::size_t byteIndex = 0;
+	auto sound = std::make_shared<SoundBuffer>();
 
-	for (int i = 0; i < file.getNumSamplesPerChannel(); ++i)
+	//OpenAL copies the data, so it can be passed directly from the file
+	//16 bit samples are little endian in the file but OpenAL expects native byte order
+	if (waveFile->BitsPerSample == 16 && !ByteSwap<>::IsLittleEndian())
 	{
-		for (int channel = 0; channel < file.getNumChannels(); ++channel)
-		{
-			auto& dest = *reinterpret_cast<typename T::Type*>(&data[byteIndex]);
+		std::vector<std::int16_t> samples(waveFile->DataSize / sizeof(std::int16_t));
 
-			auto value = file.samples[channel][i];
+		std::memcpy(samples.data(), waveFile->Data, samples.size() * sizeof(std::int16_t));
 
-			dest = T::Convert(value);
-
-			byteIndex += sizeof(typename T::Type);
+		for (auto& sample : samples)
+		{
+			sample = LittleValue(sample);
 		}
-	}
-}
 
-std::unique_ptr<SoundSystem::Sound> SoundSystem::TryLoadWaveFile(const std::string& fileName)
-{
-	AudioFile<double> file;
-
-	if (!file.load(fileName))
-	{
-		return {};
+		alBufferData(sound->Buffer, format, samples.data(), static_cast<ALsizei>(waveFile->DataSize), waveFile->SampleRate);
 	}
-
-	if (file.getBitDepth() != 8 && file.getBitDepth() != 16)
+	else
 	{
-		return {};
+		alBufferData(sound->Buffer, format, waveFile->Data, static_cast<ALsizei>(waveFile->DataSize), waveFile->SampleRate);
 	}
 
-	std::vector<std::uint8_t> data;
-
-	data.resize(file.getNumChannels() * file.getNumSamplesPerChannel() * (file.getBitDepth() / 8));
-
-	switch (file.getBitDepth())
-	{
-	case 8:
-		ConvertToAL<DataConverter8Bit>(file, data);
-		break;
-
-	case 16:
-		ConvertToAL<DataConverter16Bit>(file, data);
-		break;
-
-	default: return {};
-	}
-
-	const auto format = BufferFormat(file);
-
-	auto sound = std::make_unique<SoundSystem::Sound>();
-
-	alBufferData(sound->buffer, format, data.data(), data.size(), file.getSampleRate());
-
 	if (CheckALErrors())
 	{
+		SPDLOG_LOGGER_CALL(_logger, spdlog::level::err, "Error uploading file \"{}\"", fileName);
 		return {};
 	}
 
+	sound->SizeInBytes = waveFile->DataSize;
+	sound->LoopStart = waveFile->LoopStart;
+
 	return sound;
 }
 
-struct OggVorbisCleanup
+std::shared_ptr<SoundBuffer> SoundSystem::TryLoadOggVorbis(const std::string& fileName, SoundStream& stream)
 {
-	void operator()(OggVorbis_File* pointer) const
-	{
-		ov_clear(pointer);
-	}
-};
-
-std::unique_ptr<SoundSystem::Sound> SoundSystem::TryLoadOggVorbis(const std::string& fileName)
-{
-	OggVorbis_File vorbisData{};
-
-	auto result = ov_fopen(fileName.c_str(), &vorbisData);
-
-	if (result)
-	{
-		return {};
-	}
-
-	const std::unique_ptr<OggVorbis_File, OggVorbisCleanup> cleanup(&vorbisData);
-
-	const auto info = ov_info(&vorbisData, -1);
-
-	const ALenum format = info->channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
-
-	const auto pcmTotal = ov_pcm_total(&vorbisData, -1);
-
-	const ogg_int64_t sizeInBytes = pcmTotal * info->channels * 2;
-
 	std::vector<std::uint8_t> data;
 
-	if (sizeInBytes > data.max_size())
+	if (static_cast<std::uint64_t>(stream.GetDecodedSizeInBytes()) > data.max_size())
 	{
-		SPDLOG_LOGGER_CALL(_logger, spdlog::level::err, "File \"{}\" is too large to read ({} > {})", fileName, sizeInBytes, data.max_size());
+		SPDLOG_LOGGER_CALL(_logger, spdlog::level::err, "File \"{}\" is too large to read ({} > {})",
+			fileName, stream.GetDecodedSizeInBytes(), data.max_size());
 		return {};
 	}
 
-	data.resize(static_cast<std::size_t>(sizeInBytes));
-
-	long size = 0;
-	int bitStream = 0;
-
-	for (std::size_t offset = 0;
-		(size = ov_read(&vorbisData, (char*)data.data() + offset, 4096, 0, 2, 1, &bitStream)) > 0;
-		offset += size)
+	if (!stream.DecodeAll(data))
 	{
-	}
-
-	//An error occurred while reading
-	if (size < 0)
-	{
-		SPDLOG_LOGGER_CALL(_logger, spdlog::level::err, "Error while reading file \"{}\" ({})\n", fileName, size);
+		SPDLOG_LOGGER_CALL(_logger, spdlog::level::err, "Error while reading file \"{}\"", fileName);
 		return {};
 	}
 
-	auto sound = std::make_unique<SoundSystem::Sound>();
+	auto sound = std::make_shared<SoundBuffer>();
 
-	alBufferData(sound->buffer, format, data.data(), data.size(), info->rate);
+	alBufferData(sound->Buffer, stream.GetFormat(), data.data(), static_cast<ALsizei>(data.size()), stream.GetSampleRate());
 
 	if (CheckALErrors())
 	{
 		return {};
 	}
 
+	sound->SizeInBytes = data.size();
+
 	return sound;
 }
 
@@ -230,6 +145,19 @@ bool SoundSystem::Initialize(filesystem::IFileSystem* filesystem)
 		alcMakeContextCurrent(_context);
 
 		CheckALErrors();
+
+		_freeVoices.reserve(_voices.size());
+
+		//Free voices are taken from the back, so add them in reverse to use them in order
+		for (std::size_t i = _voices.size(); i-- > 0;)
+		{
+			alGenSources(1, &_voices[i].Source);
+			_freeVoices.push_back(i);
+		}
+
+		CheckALErrors();
+
+		StartThreads();
 	}
 
 	return true;
@@ -237,10 +165,30 @@ bool SoundSystem::Initialize(filesystem::IFileSystem* filesystem)
 
 void SoundSystem::Shutdown()
 {
+	//Stop loading sounds first so nothing starts playing after this
+	StopThreads();
+
 	StopAllSounds();
 
+	if (_latencyStats.PlayedCount > 0 || _latencyStats.DroppedCount > 0)
+	{
+		SPDLOG_LOGGER_CALL(_logger, spdlog::level::debug, "Sound latency: {} played (average {} us, max {} us), {} dropped",
+			_latencyStats.PlayedCount, _latencyStats.GetAverageLatency().count(), _latencyStats.MaxLatency.count(), _latencyStats.DroppedCount);
+	}
+
+	//Buffers and sources must be deleted while the context still exists
+	_soundCache.Clear();
+
 	if (_context)
 	{
+		for (auto& voice : _voices)
+		{
+			alDeleteSources(1, &voice.Source);
+			voice.Source = 0;
+		}
+
+		_freeVoices.clear();
+
 		alcMakeContextCurrent(nullptr);
 		alcDestroyContext(_context);
 		_context = nullptr;
@@ -255,25 +203,32 @@ void SoundSystem::Shutdown()
 
 void SoundSystem::RunFrame()
 {
-	size_t uiIndex = 0;
+	const std::lock_guard lock{_voiceMutex};
 
-	ALint isPlaying;
+	ALint state;
 
-	for (auto& sound : _sounds)
+	for (auto it = _activeVoices.begin(); it != _activeVoices.end();)
 	{
-		++uiIndex;
+		const auto index = *it++;
+
+		auto& voice = _voices[index];
 
-		if (!sound)
+		//Streamed sounds can stop briefly if the streaming thread falls behind, so rely on the stream to know when it's done
+		if (voice.Stream)
 		{
+			if (voice.Stream->IsFinished())
+			{
+				ReleaseVoice(index);
+			}
+
 			continue;
 		}
 
-		alGetSourcei(sound->source, AL_SOURCE_STATE, &isPlaying);
+		alGetSourcei(voice.Source, AL_SOURCE_STATE, &state);
 
-		if (isPlaying != AL_PLAYING)
+		if (state != AL_PLAYING)
 		{
-			sound.reset();
-			_soundsLRU.erase(std::find(_soundsLRU.begin(), _soundsLRU.end(), uiIndex - 1));
+			ReleaseVoice(index);
 		}
 	}
 }
@@ -290,133 +245,475 @@ void SoundSystem::PlaySound(std::string_view fileName, float volume, int pitch)
 		return;
 	}
 
-	if (fileName[0] == '*')
+	//Looking up and decoding the sound can take long enough to cause a visible hitch, so do it on the decoding thread
 	{
-		fileName = fileName.substr(1);
+		const std::lock_guard lock{_requestMutex};
+		_requests.push_back(SoundRequest{GetSoundFileName(fileName), volume, pitch, std::chrono::steady_clock::now(), _requestGeneration});
 	}
 
-	std::ostringstream stream;
+	_requestCondition.notify_one();
+}
 
-	stream << "sound/" << fileName;
+void SoundSystem::PrefetchSounds(const std::vector<std::string>& fileNames)
+{
+	if (!_context)
+	{
+		return;
+	}
 
-	const auto actualFileName{stream.str()};
+	{
+		const std::lock_guard lock{_requestMutex};
+
+		//Forget about sounds that were still waiting to be prefetched, they're not needed anymore
+		_prefetchRequests.clear();
+
+		for (auto it = _soundLoadStatuses.begin(); it != _soundLoadStatuses.end();)
+		{
+			if (it->second == SoundLoadStatus::Pending)
+			{
+				it = _soundLoadStatuses.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		for (const auto& fileName : fileNames)
+		{
+			if (fileName.empty())
+			{
+				continue;
+			}
+
+			auto actualFileName = GetSoundFileName(fileName);
+
+			//Sounds that were loaded before are checked again since they may have been evicted or changed on disk
+			if (auto [it, inserted] = _soundLoadStatuses.emplace(actualFileName, SoundLoadStatus::Pending); !inserted)
+			{
+				if (it->second == SoundLoadStatus::Pending)
+				{
+					continue;
+				}
 
-	const auto fullFileName{_fileSystem->GetRelativePath(actualFileName)};
+				it->second = SoundLoadStatus::Pending;
+			}
 
-	if (fullFileName.empty())
+			_prefetchRequests.push_back(std::move(actualFileName));
+		}
+	}
+
+	_requestCondition.notify_one();
+}
+
+SoundLoadStatus SoundSystem::GetSoundLoadStatus(std::string_view fileName) const
+{
+	if (fileName.empty())
 	{
-		SPDLOG_LOGGER_CALL(_logger, spdlog::level::warn, "Unable to find sound file '{}'", actualFileName);
-		return;
+		return SoundLoadStatus::NotRequested;
 	}
 
-	if (CheckALErrors())
+	const std::lock_guard lock{_requestMutex};
+
+	if (const auto it = _soundLoadStatuses.find(GetSoundFileName(fileName)); it != _soundLoadStatuses.end())
+	{
+		return it->second;
+	}
+
+	return SoundLoadStatus::NotRequested;
+}
+
+void SoundSystem::StopAllSounds()
+{
+	if (!_context)
 	{
 		return;
 	}
 
-	volume = std::clamp(volume, 0.0f, 1.0f);
-	pitch = std::clamp(pitch, 0, 255);
+	//Sounds that are still being loaded were requested before this call, so they shouldn't play either
+	{
+		const std::lock_guard lock{_requestMutex};
+		_requests.clear();
+	}
+
+	const std::lock_guard lock{_voiceMutex};
+
+	++_requestGeneration;
+
+	while (!_activeVoices.empty())
+	{
+		ReleaseVoice(_activeVoices.front());
+	}
+}
+
+SoundLatencyStats SoundSystem::GetLatencyStats() const
+{
+	const std::lock_guard lock{_voiceMutex};
+	return _latencyStats;
+}
 
-	std::unique_ptr<Sound> sound = TryLoadWaveFile(fullFileName);
+std::size_t SoundSystem::AcquireVoice()
+{
+	std::size_t index;
 
-	if (!sound)
+	if (!_freeVoices.empty())
 	{
-		sound = TryLoadOggVorbis(fullFileName);
+		index = _freeVoices.back();
+		_freeVoices.pop_back();
 	}
+	else
+	{
+		//All voices are in use, stop the oldest sound
+		index = _activeVoices.back();
+		ReleaseVoice(index);
+		_freeVoices.pop_back();
+	}
+
+	auto& voice = _voices[index];
+
+	_activeVoices.push_front(index);
 
-	if (!sound)
+	voice.IsActive = true;
+	voice.ActiveIterator = _activeVoices.begin();
+
+	return index;
+}
+
+void SoundSystem::ReleaseVoice(std::size_t index)
+{
+	auto& voice = _voices[index];
+
+	if (!voice.IsActive)
 	{
 		return;
 	}
 
-	alSourcei(sound->source, AL_BUFFER, sound->buffer);
+	if (voice.Stream)
+	{
+		//Detaches the stream's buffers so they can be deleted on either thread
+		voice.Stream->Stop();
 
-	if (CheckALErrors())
+		{
+			const std::lock_guard lock{_streamMutex};
+			_streams.erase(std::remove(_streams.begin(), _streams.end(), voice.Stream), _streams.end());
+		}
+
+		voice.Stream.reset();
+	}
+	else
+	{
+		alSourceStop(voice.Source);
+
+		//Detach the buffer so it can be deleted once it's evicted from the cache
+		alSourcei(voice.Source, AL_BUFFER, 0);
+		voice.Buffer.reset();
+	}
+
+	_activeVoices.erase(voice.ActiveIterator);
+	voice.IsActive = false;
+
+	_freeVoices.push_back(index);
+}
+
+SoundSystem::LoadedSound SoundSystem::LoadSound(const std::string& fileName)
+{
+	//Key on the resolved path so a different file is loaded if the filesystem now resolves the name to another location
+	auto resolvedPath = _fileSystem->GetResolvedPath(fileName);
+
+	if (resolvedPath.empty())
+	{
+		SPDLOG_LOGGER_CALL(_logger, spdlog::level::warn, "Unable to find sound file '{}'", fileName);
+		return {};
+	}
+
+	if (auto buffer = _soundCache.Find(resolvedPath); buffer)
+	{
+		return {std::move(buffer), {}};
+	}
+
+	auto file{_fileSystem->OpenFile(fileName)};
+
+	if (!file)
+	{
+		SPDLOG_LOGGER_CALL(_logger, spdlog::level::warn, "Unable to open sound file '{}'", fileName);
+		return {};
+	}
+
+	auto buffer = TryLoadWaveFile(fileName, file);
+
+	if (!buffer)
+	{
+		auto stream = SoundStream::TryOpen(std::move(file));
+
+		if (!stream)
+		{
+			return {};
+		}
+
+		//Long music tracks would take too long to decode and use too much memory, so play those while decoding them
+		if (stream->GetDecodedSizeInBytes() > SoundStream::StreamingThresholdInBytes)
+		{
+			return {{}, std::move(stream)};
+		}
+
+		//Short sounds are decoded up front with the decoder that was opened to get the size
+		buffer = TryLoadOggVorbis(fileName, *stream);
+	}
+
+	if (!buffer)
+	{
+		return {};
+	}
+
+	_soundCache.Add(std::move(resolvedPath), buffer);
+
+	return {std::move(buffer), {}};
+}
+
+std::string SoundSystem::GetSoundFileName(std::string_view fileName)
+{
+	if (!fileName.empty() && fileName[0] == '*')
+	{
+		fileName = fileName.substr(1);
+	}
+
+	std::ostringstream stream;
+
+	stream << "sound/" << fileName;
+
+	return stream.str();
+}
+
+bool SoundSystem::IsRequestExpired(const SoundRequest& request)
+{
+	if (std::chrono::steady_clock::now() - request.RequestTime <= MaxSoundLatency)
+	{
+		return false;
+	}
+
+	SPDLOG_LOGGER_CALL(_logger, spdlog::level::debug, "Dropping sound \"{}\": could not be started within {} ms",
+		request.FileName, MaxSoundLatency.count());
+
+	const std::lock_guard lock{_voiceMutex};
+	++_latencyStats.DroppedCount;
+
+	return true;
+}
+
+void SoundSystem::StartSound(const SoundRequest& request)
+{
+	//Don't bother loading sounds that have been waiting in the queue for too long
+	if (IsRequestExpired(request))
 	{
 		return;
 	}
 
-	alSourcePlay(sound->source);
+	CheckALErrors();
 
-	if (CheckALErrors())
+	auto sound = LoadSound(request.FileName);
+
+	if (!sound.Buffer && !sound.Stream)
 	{
 		return;
 	}
 
-	alSourcef(sound->source, AL_GAIN, volume);
+	if (IsRequestExpired(request))
+	{
+		return;
+	}
 
-	if (CheckALErrors())
+	const float volume = std::clamp(request.Volume, 0.0f, 1.0f);
+	const int pitch = std::clamp(request.Pitch, 0, 255);
+
+	const std::lock_guard lock{_voiceMutex};
+
+	if (request.Generation != _requestGeneration)
 	{
 		return;
 	}
 
-	const auto pitchMultiplier = pitch / (static_cast<float>(PITCH_NORM));
+	const auto index = AcquireVoice();
+
+	auto& voice = _voices[index];
+
+	voice.Buffer = std::move(sound.Buffer);
+	voice.Stream = std::move(sound.Stream);
+
+	alSourcei(voice.Source, AL_BUFFER, voice.Buffer ? voice.Buffer->Buffer : 0);
+	alSourcef(voice.Source, AL_GAIN, volume);
+	alSourcef(voice.Source, AL_PITCH, pitch / (static_cast<float>(PITCH_NORM)));
 
 	if (CheckALErrors())
 	{
+		ReleaseVoice(index);
 		return;
 	}
 
-	alSourcef(sound->source, AL_PITCH, pitchMultiplier);
+	if (voice.Stream)
+	{
+		if (!voice.Stream->Start(voice.Source))
+		{
+			SPDLOG_LOGGER_CALL(_logger, spdlog::level::err, "Error starting stream for file \"{}\"", request.FileName);
+			ReleaseVoice(index);
+			return;
+		}
+
+		{
+			const std::lock_guard streamLock{_streamMutex};
+			_streams.push_back(voice.Stream);
+		}
+
+		_streamCondition.notify_one();
+	}
+	else
+	{
+		alSourcePlay(voice.Source);
+	}
 
 	if (CheckALErrors())
 	{
+		ReleaseVoice(index);
 		return;
 	}
 
-	const size_t uiIndex = GetSoundForPlayback();
+	const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - request.RequestTime);
 
-	_sounds[uiIndex] = std::move(sound);
+	++_latencyStats.PlayedCount;
+	_latencyStats.TotalLatency += latency;
+	_latencyStats.MaxLatency = std::max(_latencyStats.MaxLatency, latency);
+}
+
+SoundLoadStatus SoundSystem::PrefetchSound(const std::string& fileName)
+{
+	if (_fileSystem->GetResolvedPath(fileName).empty())
+	{
+		return SoundLoadStatus::Missing;
+	}
+
+	const auto sound = LoadSound(fileName);
+
+	if (!sound.Buffer && !sound.Stream)
+	{
+		return SoundLoadStatus::Failed;
+	}
 
-	_soundsLRU.push_front(uiIndex);
+	//Long sounds are streamed when they're played, so there's nothing to cache
+	return SoundLoadStatus::Loaded;
 }
 
-void SoundSystem::StopAllSounds()
+void SoundSystem::DecodeSounds()
 {
-	if (!_context)
+	std::unique_lock lock{_requestMutex};
+
+	while (true)
 	{
-		return;
+		_requestCondition.wait(lock, [this] { return _stopDecoding || !_requests.empty() || !_prefetchRequests.empty(); });
+
+		if (_stopDecoding)
+		{
+			break;
+		}
+
+		if (!_requests.empty())
+		{
+			const auto request = std::move(_requests.front());
+			_requests.pop_front();
+
+			lock.unlock();
+
+			StartSound(request);
+
+			lock.lock();
+		}
+		else
+		{
+			const auto fileName = std::move(_prefetchRequests.front());
+			_prefetchRequests.pop_front();
+
+			lock.unlock();
+
+			const auto status = PrefetchSound(fileName);
+
+			lock.lock();
+
+			//Only update the status if it wasn't requested again in the meantime
+			if (auto it = _soundLoadStatuses.find(fileName); it != _soundLoadStatuses.end()
+				&& it->second == SoundLoadStatus::Pending
+				&& std::find(_prefetchRequests.begin(), _prefetchRequests.end(), fileName) == _prefetchRequests.end())
+			{
+				it->second = status;
+			}
+		}
 	}
+}
+
+void SoundSystem::StreamSounds()
+{
+	std::vector<std::shared_ptr<SoundStream>> streams;
+
+	std::unique_lock lock{_streamMutex};
 
-	for (auto& sound : _sounds)
+	while (!_stopStreaming)
 	{
-		if (!sound)
+		if (_streams.empty())
 		{
+			_streamCondition.wait(lock, [this] { return _stopStreaming || !_streams.empty(); });
 			continue;
 		}
 
-		sound.reset();
+		//Update outside the lock so the main thread can start and stop sounds in the meantime
+		streams = _streams;
+
+		lock.unlock();
+
+		for (const auto& stream : streams)
+		{
+			stream->Update();
+		}
+
+		streams.clear();
+
+		lock.lock();
+
+		_streamCondition.wait_for(lock, StreamUpdateInterval, [this] { return _stopStreaming; });
 	}
+}
+
+void SoundSystem::StartThreads()
+{
+	_stopDecoding = false;
+	_decodeThread = std::thread{&SoundSystem::DecodeSounds, this};
 
-	_soundsLRU.clear();
+	_stopStreaming = false;
+	_streamThread = std::thread{&SoundSystem::StreamSounds, this};
 }
 
-size_t SoundSystem::GetSoundForPlayback()
+void SoundSystem::StopThreads()
 {
-	for (size_t uiIndex = 0; uiIndex < MAX_SOUNDS; ++uiIndex)
+	if (_decodeThread.joinable())
 	{
-		if (!_sounds[uiIndex])
 		{
-			return uiIndex;
+			const std::lock_guard lock{_requestMutex};
+			_stopDecoding = true;
+			_requests.clear();
+			_prefetchRequests.clear();
 		}
-	}
 
-	//Shouldn't happen; LRU is only empty if no sounds are playing.
-	if (_soundsLRU.empty())
-	{
-		return 0;
+		_requestCondition.notify_one();
+		_decodeThread.join();
 	}
 
-	//get from LRU.
-	const size_t uiIndex = _soundsLRU.back();
-
-	_soundsLRU.pop_back();
-
-	auto& sound = _sounds[uiIndex];
+	if (_streamThread.joinable())
+	{
+		{
+			const std::lock_guard lock{_streamMutex};
+			_stopStreaming = true;
+		}
 
-	//Reset the sound data. Must be done after the above actions so it doesn't try to access null pointers.
-	_sounds[uiIndex].reset();
+		_streamCondition.notify_one();
+		_streamThread.join();
 
-	return uiIndex;
+		_streams.clear();
+	}
 }
 }
@@ -1,20 +1,33 @@
 #pragma once
 
 #include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <spdlog/logger.h>
 
 #include <al.h>
 #include <alc.h>
 
+#include "soundsystem/SoundCache.hpp"
 #include "soundsystem/SoundConstants.hpp"
+#include "soundsystem/SoundStream.hpp"
 
 #include "soundsystem/ISoundSystem.hpp"
 
 namespace filesystem
 {
+class FileView;
 class IFileSystem;
 }
 
@@ -32,24 +45,12 @@ public:
 	//Maximum number of sounds to play simultaneously.
 	static const size_t MAX_SOUNDS = 16;
 
-public:
-	struct Sound
-	{
-		Sound()
-		{
-			alGenBuffers(1, &buffer);
-			alGenSources(1, &source);
-		}
-
-		~Sound()
-		{
-			alDeleteSources(1, &source);
-			alDeleteBuffers(1, &buffer);
-		}
-
-		ALuint buffer = 0;
-		ALuint source = 0;
-	};
+	//Sounds that can't be started within this time after they were requested are dropped,
+	//since a sound that plays too long after the animation event is worse than no sound at all.
+	static constexpr std::chrono::milliseconds MaxSoundLatency{200};
+
+	//How often streamed sounds are refilled. Must be well below the duration of SoundStream's queued buffers.
+	static constexpr std::chrono::milliseconds StreamUpdateInterval{10};
 
 public:
 	SoundSystem(const std::shared_ptr<spdlog::logger>& logger);
@@ -69,12 +70,97 @@ public:
 
 	void StopAllSounds() override final;
 
+	void PrefetchSounds(const std::vector<std::string>& fileNames) override final;
+
+	SoundLoadStatus GetSoundLoadStatus(std::string_view fileName) const override final;
+
+	SoundLatencyStats GetLatencyStats() const override final;
+
 private:
-	size_t GetSoundForPlayback();
+	/**
+	*	@brief A pooled source used to play a sound.
+	*/
+	struct Voice
+	{
+		ALuint Source = 0;
+
+		//Keeps the buffer alive while it's playing, even if it's evicted from the cache
+		std::shared_ptr<SoundBuffer> Buffer;
+
+		//Set instead of Buffer if the sound is streamed
+		std::shared_ptr<SoundStream> Stream;
+
+		bool IsActive = false;
+		std::list<std::size_t>::iterator ActiveIterator;
+	};
+
+	struct SoundRequest
+	{
+		std::string FileName;
+		float Volume;
+		int Pitch;
+		std::chrono::steady_clock::time_point RequestTime;
+
+		//Value of _requestGeneration when the sound was requested
+		std::uint64_t Generation;
+	};
+
+	/**
+	*	@brief Gets the index of a voice to play a sound with.
+	*	If all voices are in use the one that has been playing the longest is stopped.
+	*/
+	std::size_t AcquireVoice();
+
+	void ReleaseVoice(std::size_t index);
+
+	struct LoadedSound
+	{
+		std::shared_ptr<SoundBuffer> Buffer;
+		std::shared_ptr<SoundStream> Stream;
+	};
+
+	/**
+	*	@brief Gets the decoded sound for the given file from the cache, loading it if needed.
+	*	Long Ogg Vorbis files are opened as a stream instead, and are not cached.
+	*/
+	LoadedSound LoadSound(const std::string& fileName);
+
+	/**
+	*	@brief Gets the name of a sound file relative to the game directory.
+	*/
+	static std::string GetSoundFileName(std::string_view fileName);
+
+	/**
+	*	@brief Checks whether a request has waited too long to be played, and counts it as dropped if so.
+	*/
+	bool IsRequestExpired(const SoundRequest& request);
+
+	/**
+	*	@brief Loads a requested sound and starts playing it. Runs on the decoding thread.
+	*/
+	void StartSound(const SoundRequest& request);
+
+	/**
+	*	@brief Loads a sound into the cache. Runs on the decoding thread.
+	*/
+	SoundLoadStatus PrefetchSound(const std::string& fileName);
+
+	/**
+	*	@brief Plays and prefetches requested sounds until decoding is stopped. Runs on the decoding thread.
+	*/
+	void DecodeSounds();
+
+	/**
+	*	@brief Refills the buffers of streamed sounds until streaming is stopped. Runs on the streaming thread.
+	*/
+	void StreamSounds();
+
+	void StartThreads();
+	void StopThreads();
 
 	bool CheckALErrorsCore(const char* file, int line);
-	std::unique_ptr<SoundSystem::Sound> TryLoadWaveFile(const std::string& fileName);
-	std::unique_ptr<SoundSystem::Sound> TryLoadOggVorbis(const std::string& fileName);
+	std::shared_ptr<SoundBuffer> TryLoadWaveFile(const std::string& fileName, const filesystem::FileView& file);
+	std::shared_ptr<SoundBuffer> TryLoadOggVorbis(const std::string& fileName, SoundStream& stream);
 
 private:
 	std::shared_ptr<spdlog::logger> _logger;
@@ -84,9 +170,43 @@ private:
 	ALCdevice* _device{};
 	ALCcontext* _context{};
 
-	std::array<std::unique_ptr<Sound>, MAX_SOUNDS> _sounds;
+	//Only used by the decoding thread while it's running
+	SoundCache _soundCache;
+
+	//Guards the voices and latency statistics
+	mutable std::mutex _voiceMutex;
+
+	std::array<Voice, MAX_SOUNDS> _voices;
+
+	std::vector<std::size_t> _freeVoices;
+
+	//Voices that are playing, most recently started first
+	std::list<std::size_t> _activeVoices;
+
+	//Incremented when all sounds are stopped so requests made before then are discarded. Only changed on the main thread
+	std::uint64_t _requestGeneration = 0;
+
+	SoundLatencyStats _latencyStats;
+
+	std::thread _decodeThread;
+	mutable std::mutex _requestMutex;
+	std::condition_variable _requestCondition;
+	bool _stopDecoding = false;
+	std::deque<SoundRequest> _requests;
+
+	//Sounds to prefetch once all sounds to play have been started
+	std::deque<std::string> _prefetchRequests;
+
+	//Status of every sound passed to PrefetchSounds, guarded by _requestMutex
+	std::unordered_map<std::string, SoundLoadStatus> _soundLoadStatuses;
+
+	std::thread _streamThread;
+	std::mutex _streamMutex;
+	std::condition_variable _streamCondition;
+	bool _stopStreaming = false;
 
-	std::list<size_t> _soundsLRU;
+	//Streams that are playing, guarded by _streamMutex
+	std::vector<std::shared_ptr<SoundStream>> _streams;
 };
 }
 
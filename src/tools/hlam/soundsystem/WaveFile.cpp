@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "soundsystem/WaveFile.hpp"
+
+#include "utility/ByteSwap.hpp"
+
+namespace soundsystem
+{
+namespace
+{
+constexpr std::uint16_t WaveFormatPCM = 1;
+
+constexpr std::size_t ChunkHeaderSize = 8;
+constexpr std::size_t FormatChunkMinimumSize = 16;
+constexpr std::size_t CueChunkMinimumSize = 4 + 24;
+constexpr std::size_t LabeledTextChunkMinimumSize = 20;
+constexpr std::size_t SamplerChunkMinimumSize = 36 + 24;
+
+std::uint16_t ReadUInt16(const std::byte* data)
+{
+	std::uint16_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return static_cast<std::uint16_t>(LittleValue(static_cast<std::int16_t>(value)));
+}
+
+std::uint32_t ReadUInt32(const std::byte* data)
+{
+	std::uint32_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return static_cast<std::uint32_t>(LittleValue(static_cast<std::int32_t>(value)));
+}
+
+bool IsChunkId(const std::byte* data, std::string_view id)
+{
+	return std::memcmp(data, id.data(), 4) == 0;
+}
+
+struct Chunk
+{
+	const std::byte* Data = nullptr;
+	std::size_t Size = 0;
+};
+
+/**
+*	@brief Finds the first chunk with the given id in a list of chunks.
+*/
+Chunk FindChunk(const std::byte* begin, const std::byte* end, std::string_view id)
+{
+	while (static_cast<std::size_t>(end - begin) >= ChunkHeaderSize)
+	{
+		const std::size_t size = ReadUInt32(begin + 4);
+		const std::byte* const data = begin + ChunkHeaderSize;
+
+		//Some writers produce truncated files, so clamp the last chunk to the end of the file
+		const std::size_t available = std::min<std::size_t>(size, end - data);
+
+		if (IsChunkId(begin, id))
+		{
+			return {data, available};
+		}
+
+		if (size > available)
+		{
+			break;
+		}
+
+		//Chunks are padded to an even size
+		const std::size_t paddedSize = size + (size & 1);
+
+		if (paddedSize > static_cast<std::size_t>(end - data))
+		{
+			break;
+		}
+
+		begin = data + paddedSize;
+	}
+
+	return {};
+}
+}
+
+std::optional<WaveFile> TryParseWaveFile(const std::byte* data, std::size_t size)
+{
+	if (!data || size < 12 || !IsChunkId(data, "RIFF") || !IsChunkId(data + 8, "WAVE"))
+	{
+		return {};
+	}
+
+	const std::byte* const chunksBegin = data + 12;
+	const std::byte* const chunksEnd = data + size;
+
+	const auto format = FindChunk(chunksBegin, chunksEnd, "fmt ");
+
+	if (format.Size < FormatChunkMinimumSize || ReadUInt16(format.Data) != WaveFormatPCM)
+	{
+		return {};
+	}
+
+	WaveFile file;
+
+	file.Channels = ReadUInt16(format.Data + 2);
+	file.SampleRate = static_cast<int>(ReadUInt32(format.Data + 4));
+	file.BitsPerSample = ReadUInt16(format.Data + 14);
+
+	if ((file.Channels != 1 && file.Channels != 2)
+		|| (file.BitsPerSample != 8 && file.BitsPerSample != 16)
+		|| file.SampleRate <= 0)
+	{
+		return {};
+	}
+
+	const auto samples = FindChunk(chunksBegin, chunksEnd, "data");
+
+	if (!samples.Data)
+	{
+		return {};
+	}
+
+	const std::size_t bytesPerFrame = file.GetBytesPerFrame();
+
+	file.Data = samples.Data;
+	//Ignore trailing partial frames
+	file.DataSize = samples.Size - (samples.Size % bytesPerFrame);
+
+	//Offsets are unsigned in the file, so only accept them once they are known to be within the sound
+	std::optional<std::uint32_t> loopStart;
+
+	if (const auto cue = FindChunk(chunksBegin, chunksEnd, "cue "); cue.Size >= CueChunkMinimumSize && ReadUInt32(cue.Data) > 0)
+	{
+		//Sample offset of the first cue point
+		loopStart = ReadUInt32(cue.Data + 4 + 20);
+
+		//The engine uses the length of the first labeled text as the loop length, and doesn't play anything after it
+		if (const auto list = FindChunk(chunksBegin, chunksEnd, "LIST"); list.Size >= 4 + ChunkHeaderSize + LabeledTextChunkMinimumSize
+			&& IsChunkId(list.Data, "adtl"))
+		{
+			if (const auto labeledText = FindChunk(list.Data + 4, list.Data + list.Size, "ltxt");
+				labeledText.Size >= LabeledTextChunkMinimumSize && IsChunkId(labeledText.Data + 8, "mark"))
+			{
+				const std::uint64_t loopEnd = std::uint64_t{*loopStart} + ReadUInt32(labeledText.Data + 4);
+
+				file.DataSize = static_cast<std::size_t>(std::min<std::uint64_t>(file.DataSize, loopEnd * bytesPerFrame));
+			}
+		}
+	}
+	else if (const auto sampler = FindChunk(chunksBegin, chunksEnd, "smpl"); sampler.Size >= SamplerChunkMinimumSize && ReadUInt32(sampler.Data + 28) > 0)
+	{
+		//Start of the first sample loop
+		loopStart = ReadUInt32(sampler.Data + 36 + 8);
+	}
+
+	if (loopStart && *loopStart < file.GetSampleCount())
+	{
+		file.LoopStart = static_cast<int>(*loopStart);
+	}
+
+	return file;
+}
+}
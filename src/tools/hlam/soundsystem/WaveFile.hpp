@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+
+/**
+*	@ingroup SoundSystem
+*
+*	@{
+*/
+
+namespace soundsystem
+{
+/**
+*	@brief Format and sample data of an 8 or 16 bit PCM RIFF/WAVE file.
+*	The sample data points into the memory that the file was parsed from and is in the file's byte order (little endian).
+*/
+struct WaveFile
+{
+	int Channels = 0;
+	int SampleRate = 0;
+	int BitsPerSample = 0;
+
+	const std::byte* Data = nullptr;
+	std::size_t DataSize = 0;
+
+	/**
+	*	@brief Sample at which the sound starts looping, or -1 if it doesn't have a loop point.
+	*	Read from the first cue point, or from the first loop in the sampler chunk.
+	*/
+	int LoopStart = -1;
+
+	std::size_t GetBytesPerFrame() const
+	{
+		return static_cast<std::size_t>(Channels) * (BitsPerSample / 8);
+	}
+
+	std::size_t GetSampleCount() const
+	{
+		return DataSize / GetBytesPerFrame();
+	}
+};
+
+/**
+*	@brief Parses a RIFF/WAVE file without copying or converting its sample data.
+*	Only uncompressed 8 and 16 bit mono and stereo files are supported.
+*	Like the engine, if a cue point has a labeled text chunk ("mark") the sound is truncated to the end of the loop.
+*	@return The file, or an empty optional if the data is not a valid or supported wave file.
+*/
+std::optional<WaveFile> TryParseWaveFile(const std::byte* data, std::size_t size);
+}
+
+/** @} */
@@ -0,0 +1,166 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "tests/Tests.hpp"
+
+namespace tests
+{
+namespace
+{
+struct RegisteredTest
+{
+	std::string Name;
+	TestFunction Function;
+};
+
+std::vector<RegisteredTest>& GetTests()
+{
+	//Function local so tests in other files can register themselves during static initialization
+	static std::vector<RegisteredTest> registeredTests;
+	return registeredTests;
+}
+}
+
+bool RegisterTest(std::string name, TestFunction function)
+{
+	GetTests().push_back({std::move(name), std::move(function)});
+	return true;
+}
+}
+
+namespace
+{
+void PrintUsage()
+{
+	std::fprintf(stderr,
+		"Usage: hlam_tests [options]\n"
+		"\n"
+		"Options:\n"
+		"  --filter <text>      Only run tests whose name contains this text\n"
+		"  --list               List the tests instead of running them\n"
+		"  --studiomdl <file>   Model compiler to use for tests that compile models. Those tests are skipped without one\n"
+		"  -h, --help           Show this help\n");
+}
+
+/**
+*	@brief Creates an empty directory for a single test.
+*/
+std::filesystem::path CreateTestDirectory(const std::string& testName)
+{
+	const auto ticks = std::chrono::steady_clock::now().time_since_epoch().count();
+
+	auto directory = std::filesystem::temp_directory_path() / "hlam_tests" / (testName + "_" + std::to_string(ticks));
+
+	std::filesystem::create_directories(directory);
+
+	return directory;
+}
+}
+
+int main(int argc, char* argv[])
+{
+	std::string filter;
+	bool list = false;
+
+	tests::TestContext context;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view argument{argv[i]};
+
+		if (argument == "-h" || argument == "--help")
+		{
+			PrintUsage();
+			return EXIT_SUCCESS;
+		}
+		else if (argument == "--list")
+		{
+			list = true;
+		}
+		else if ((argument == "--filter" || argument == "--studiomdl") && i + 1 < argc)
+		{
+			if (argument == "--filter")
+			{
+				filter = argv[++i];
+			}
+			else
+			{
+				context.StudioMdl = std::filesystem::u8path(argv[++i]);
+			}
+		}
+		else
+		{
+			std::fprintf(stderr, "Unknown or incomplete option \"%s\"\n\n", argv[i]);
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	int passed = 0;
+	int failed = 0;
+	int skipped = 0;
+
+	for (const auto& test : tests::GetTests())
+	{
+		if (test.Name.find(filter) == std::string::npos)
+		{
+			continue;
+		}
+
+		if (list)
+		{
+			std::printf("%s\n", test.Name.c_str());
+			continue;
+		}
+
+		std::printf("%-48s ", test.Name.c_str());
+		std::fflush(stdout);
+
+		bool succeeded = true;
+
+		try
+		{
+			context.Directory = CreateTestDirectory(test.Name);
+
+			test.Function(context);
+
+			std::printf("passed\n");
+			++passed;
+		}
+		catch (const tests::TestSkipped& e)
+		{
+			std::printf("skipped: %s\n", e.what());
+			++skipped;
+		}
+		catch (const std::exception& e)
+		{
+			std::printf("FAILED: %s\n", e.what());
+			++failed;
+			succeeded = false;
+		}
+
+		//Keep the files of failed tests around to look at
+		if (!context.Directory.empty() && succeeded)
+		{
+			std::error_code error;
+			std::filesystem::remove_all(context.Directory, error);
+		}
+
+		context.Directory.clear();
+	}
+
+	if (!list)
+	{
+		std::printf("\n%d passed, %d failed, %d skipped\n", passed, failed, skipped);
+	}
+
+	return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,230 @@
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+#include "engine/shared/studiomodel/StudioModel.hpp"
+#include "engine/shared/studiomodel/StudioModelDecompiler.hpp"
+#include "engine/shared/studiomodel/StudioModelGenerator.hpp"
+#include "engine/shared/studiomodel/StudioModelIO.hpp"
+#include "engine/shared/studiomodel/StudioModelUtils.hpp"
+
+#include "tests/Tests.hpp"
+
+namespace
+{
+//Sequence group files are named after the model, so every saved copy uses this name
+const std::string ModelName{"generated"};
+
+studiomdl::GeneratorSettings GetTestModelSettings()
+{
+	studiomdl::GeneratorSettings settings;
+
+	settings.Name = ModelName;
+	settings.Bones = 12;
+	settings.BoneControllers = 2;
+	settings.Attachments = 2;
+	settings.Hitboxes = 12;
+	settings.Bodyparts = 2;
+	settings.ModelsPerBodypart = 2;
+	settings.VerticesPerModel = 256;
+	settings.MeshesPerModel = 2;
+	settings.Sequences = 3;
+	settings.FramesPerSequence = 10;
+	settings.BlendsPerSequence = 2;
+	settings.EventsPerSequence = 2;
+	settings.Textures = 3;
+	settings.TextureWidth = 32;
+	settings.TextureHeight = 32;
+	settings.SkinFamilies = 2;
+
+	return settings;
+}
+
+/**
+*	@brief Saves the model to @p directory and loads it back, the same way the editor does.
+*/
+studiomdl::EditableStudioModel SaveAndLoad(const studiomdl::EditableStudioModel& model, const std::filesystem::path& directory)
+{
+	std::filesystem::create_directories(directory);
+
+	const auto fileName = directory / (ModelName + ".mdl");
+
+	auto converted = studiomdl::ConvertFromEditable(fileName, model);
+
+	studiomdl::SaveStudioModel(fileName, converted, false);
+
+	const auto loaded = studiomdl::LoadStudioModel(fileName, nullptr);
+
+	return studiomdl::ConvertToEditable(*loaded);
+}
+
+/**
+*	@brief Reads all files in a directory.
+*	@return Map of file name => file contents.
+*/
+std::map<std::string, std::string> ReadFiles(const std::filesystem::path& directory)
+{
+	std::map<std::string, std::string> files;
+
+	for (const auto& entry : std::filesystem::directory_iterator{directory})
+	{
+		std::ifstream stream{entry.path(), std::ios::binary};
+
+		files.emplace(entry.path().filename().u8string(), std::string{std::istreambuf_iterator<char>{stream}, {}});
+	}
+
+	return files;
+}
+
+/**
+*	@brief Describes the parts of a model that a compiler must reproduce from the decompiled files.
+*/
+std::string Summarize(const studiomdl::EditableStudioModel& model)
+{
+	std::ostringstream stream;
+
+	for (const auto& bone : model.Bones)
+	{
+		stream << "bone " << bone->Name << " parent " << (bone->Parent ? bone->Parent->Name : "none") << '\n';
+	}
+
+	stream << "bone controllers " << model.BoneControllers.size() << '\n';
+	stream << "hitboxes " << model.Hitboxes.size() << '\n';
+	stream << "attachments " << model.Attachments.size() << '\n';
+
+	for (const auto& sequence : model.Sequences)
+	{
+		stream << "sequence " << sequence->Label << " frames " << sequence->NumFrames
+			<< " blends " << sequence->AnimationBlends.size() << " events " << sequence->Events.size() << '\n';
+	}
+
+	for (const auto& bodypart : model.Bodyparts)
+	{
+		stream << "bodypart " << bodypart->Name << '\n';
+
+		for (const auto& submodel : bodypart->Models)
+		{
+			stream << "model vertices " << submodel.Vertices.size() << " meshes " << submodel.Meshes.size() << '\n';
+		}
+	}
+
+	for (const auto& texture : model.Textures)
+	{
+		stream << "texture " << texture->Name << ' ' << texture->Data.Width << 'x' << texture->Data.Height << '\n';
+	}
+
+	stream << "skin families " << model.SkinFamilies.size() << '\n';
+
+	return stream.str();
+}
+
+int CountOccurrences(const std::string& text, const std::string& pattern)
+{
+	int count = 0;
+
+	for (auto index = text.find(pattern); index != std::string::npos; index = text.find(pattern, index + pattern.size()))
+	{
+		++count;
+	}
+
+	return count;
+}
+}
+
+/**
+*	@brief Decompiling a model and a copy of it that went through ConvertFromEditable must produce identical files,
+*	so nothing the decompiler reads is lost or changed when a model is saved.
+*/
+HLAM_TEST(StudioModelDecompilerRoundTrip)
+{
+	const auto settings = GetTestModelSettings();
+
+	const auto original = SaveAndLoad(studiomdl::GenerateStudioModel(settings), context.Directory / "original");
+
+	studiomdl::DecompileStudioModel(original, context.Directory / "first", ModelName);
+
+	const auto roundTripped = SaveAndLoad(original, context.Directory / "roundtrip");
+
+	tests::Check(Summarize(original) == Summarize(roundTripped), "Model changed after saving it and loading it back");
+
+	studiomdl::DecompileStudioModel(roundTripped, context.Directory / "second", ModelName);
+
+	const auto firstFiles = ReadFiles(context.Directory / "first");
+	const auto secondFiles = ReadFiles(context.Directory / "second");
+
+	const auto qcFile = firstFiles.find(ModelName + ".qc");
+
+	tests::Check(qcFile != firstFiles.end(), "No QC file was written");
+
+	tests::Check(CountOccurrences(qcFile->second, "$sequence ") == settings.Sequences, "QC file doesn't have a $sequence for every sequence");
+
+	//One reference SMD per model, one animation SMD per blend and one bitmap per texture
+	const std::size_t expectedFileCount = 1
+		+ static_cast<std::size_t>(settings.Bodyparts * settings.ModelsPerBodypart)
+		+ static_cast<std::size_t>(settings.Sequences * settings.BlendsPerSequence)
+		+ static_cast<std::size_t>(settings.Textures);
+
+	tests::Check(firstFiles.size() == expectedFileCount,
+		"Expected " + std::to_string(expectedFileCount) + " decompiled files, got " + std::to_string(firstFiles.size()));
+
+	tests::Check(firstFiles.size() == secondFiles.size(), "Decompiling the saved model produced a different number of files");
+
+	for (const auto& [name, contents] : firstFiles)
+	{
+		const auto other = secondFiles.find(name);
+
+		tests::Check(other != secondFiles.end(), "File \"" + name + "\" is missing after the round trip");
+		tests::Check(other->second == contents, "File \"" + name + "\" differs after the round trip");
+	}
+}
+
+/**
+*	@brief Compiles the decompiled files with studiomdl and checks that the result has the same structure as the original.
+*	Skipped if no compiler was passed on the command line.
+*/
+HLAM_TEST(StudioModelDecompilerRecompile)
+{
+	if (context.StudioMdl.empty())
+	{
+		throw tests::TestSkipped{"no studiomdl compiler available"};
+	}
+
+	auto settings = GetTestModelSettings();
+
+	//The compiler writes sequence groups next to the QC file, keep everything in one file so only one file needs to be found
+	settings.SequenceGroups = 1;
+
+	const auto original = SaveAndLoad(studiomdl::GenerateStudioModel(settings), context.Directory / "original");
+
+	const auto decompiledDirectory = context.Directory / "decompiled";
+
+	studiomdl::DecompileStudioModel(original, decompiledDirectory, ModelName);
+
+	//The QC file refers to the other files relative to the working directory
+	const auto previousDirectory = std::filesystem::current_path();
+
+	std::filesystem::current_path(decompiledDirectory);
+
+	const std::string command{"\"" + context.StudioMdl.u8string() + "\" " + ModelName + ".qc"};
+
+	const int exitCode = std::system(command.c_str());
+
+	std::filesystem::current_path(previousDirectory);
+
+	tests::Check(exitCode == 0, "studiomdl failed with exit code " + std::to_string(exitCode));
+
+	const auto compiledFileName = decompiledDirectory / (ModelName + ".mdl");
+
+	tests::Check(std::filesystem::exists(compiledFileName), "studiomdl did not write the model");
+
+	const auto compiled = studiomdl::ConvertToEditable(*studiomdl::LoadStudioModel(compiledFileName, nullptr));
+
+	tests::Check(Summarize(original) == Summarize(compiled), "Compiled model differs from the original:\n"
+		+ Summarize(original) + "\nCompiled:\n" + Summarize(compiled));
+}
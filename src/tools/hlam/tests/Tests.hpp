@@ -0,0 +1,69 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+namespace tests
+{
+/**
+*	@brief Thrown by a test to report a failed check.
+*/
+class TestFailure : public std::runtime_error
+{
+public:
+	using std::runtime_error::runtime_error;
+};
+
+/**
+*	@brief Thrown by a test that can't run in this environment, like when a required tool is missing.
+*/
+class TestSkipped : public std::runtime_error
+{
+public:
+	using std::runtime_error::runtime_error;
+};
+
+/**
+*	@brief Settings from the command line that tests can use.
+*/
+struct TestContext
+{
+	//Directory that tests can write files to. It's empty when the test starts and is removed afterwards
+	std::filesystem::path Directory;
+
+	//Model compiler to use for tests that compile models, or empty if none is available
+	std::filesystem::path StudioMdl;
+};
+
+using TestFunction = std::function<void(const TestContext&)>;
+
+/**
+*	@brief Adds a test to the list of tests that the test runner runs.
+*	@return Always true, so tests can register themselves when a static variable is initialized.
+*/
+bool RegisterTest(std::string name, TestFunction function);
+
+/**
+*	@brief Throws TestFailure with @p message if @p condition is false.
+*/
+inline void Check(bool condition, const std::string& message)
+{
+	if (!condition)
+	{
+		throw TestFailure{message};
+	}
+}
+}
+
+#define HLAM_TEST_CONCAT_INNER(a, b) a##b
+#define HLAM_TEST_CONCAT(a, b) HLAM_TEST_CONCAT_INNER(a, b)
+
+/**
+*	@brief Defines and registers a test. The test body has access to a @c const tests::TestContext& named @c context.
+*/
+#define HLAM_TEST(name)																	\
+static void name(const tests::TestContext& context);									\
+static const bool HLAM_TEST_CONCAT(name, Registered) = tests::RegisterTest(#name, &name);	\
+static void name([[maybe_unused]] const tests::TestContext& context)
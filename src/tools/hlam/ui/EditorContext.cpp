@@ -54,7 +54,7 @@ EditorContext::EditorContext(
 	, _optionsPageRegistry(std::move(optionsPageRegistry))
 	, _fileSystem(std::make_unique<filesystem::FileSystem>())
 	, _soundSystem(_generalSettings->ShouldEnableAudioPlayback()
-		? std::unique_ptr<soundsystem::ISoundSystem>(std::make_unique<soundsystem::SoundSystem>(CreateQtLoggerSt(logging::HLAMSoundSystem())))
+		? std::unique_ptr<soundsystem::ISoundSystem>(std::make_unique<soundsystem::SoundSystem>(CreateQtLoggerMt(logging::HLAMSoundSystem())))
 		: std::make_unique<soundsystem::DummySoundSystem>())
 	, _worldTime(std::make_unique<WorldTime>())
 	, _assetProviderRegistry(std::move(assetProviderRegistry))
@@ -137,6 +137,9 @@ void EditorContext::OnTimerTick()
 	_worldTime->TimeChanged(currentTime);
 
 	emit Tick();
+
+	//Frees the voices of sounds that have finished playing
+	_soundSystem->RunFrame();
 }
 
 void EditorContext::OnTickRateChanged(int value)
@@ -12,6 +12,7 @@
 #include <QMessageBox>
 #include <QMimeData>
 #include <QScreen>
+#include <QSet>
 #include <QWindow>
 
 #include "version.hpp"
@@ -142,6 +143,7 @@ MainWindow::MainWindow(EditorContext* editorContext)
 	connect(_assetTabs, &QTabWidget::tabCloseRequested, this, &MainWindow::OnAssetTabCloseRequested);
 
 	connect(_editorContext, &EditorContext::TryingToLoadAsset, this, &MainWindow::TryLoadAsset);
+	connect(_gameDirectoryWatcher, &QFileSystemWatcher::directoryChanged, this, &MainWindow::OnGameDirectoryContentsChanged);
 	connect(_editorContext->GetGameConfigurations(), &settings::GameConfigurationsSettings::ActiveConfigurationChanged,
 		this, &MainWindow::OnActiveConfigurationChanged);
 
@@ -385,6 +387,15 @@ bool MainWindow::TryLoadAsset(QString fileName)
 
 	qCDebug(logging::HLAM) << "Trying to load asset" << fileName;
 
+	//Allow game relative file names like "models/barney.mdl"
+	if (!QFile::exists(fileName))
+	{
+		if (const auto fullFileName = _editorContext->GetFileSystem()->GetRelativePath(fileName.toStdString()); !fullFileName.empty())
+		{
+			fileName = QDir::cleanPath(QString::fromStdString(fullFileName));
+		}
+	}
+
 	if (!QFile::exists(fileName))
 	{
 		qCDebug(logging::HLAM) << "Asset" << fileName << "does not exist";
@@ -685,23 +696,45 @@ void MainWindow::SetupFileSystem(std::pair<settings::GameEnvironment*, settings:
 
 	fileSystem->SetBasePath(environment->GetInstallationPath().toStdString().c_str());
 
-	const auto directoryExtensions{filesystem::GetSteamPipeDirectoryExtensions()};
-
 	const auto gameDir{defaultGameConfiguration->GetDirectory().toStdString()};
 	const auto modDir{configuration->GetDirectory().toStdString()};
 
-	//Add mod dirs first since they override game dirs
-	if (gameDir != modDir)
+	for (auto& layer : filesystem::GetGameDirectoryLayers(modDir, gameDir))
+	{
+		fileSystem->AddSearchPath(std::move(layer));
+	}
+
+	UpdateWatchedGameDirectories();
+}
+
+void MainWindow::UpdateWatchedGameDirectories()
+{
+	QSet<QString> directories;
+
+	for (const auto& directory : _editorContext->GetFileSystem()->GetDirectories())
 	{
-		for (const auto& extension : directoryExtensions)
+		directories.insert(QString::fromStdString(directory));
+	}
+
+	QStringList removedDirectories;
+
+	for (const auto& directory : _gameDirectoryWatcher->directories())
+	{
+		if (!directories.remove(directory))
 		{
-			fileSystem->AddSearchPath((modDir + extension).c_str());
+			removedDirectories.append(directory);
 		}
 	}
 
-	for (const auto& extension : directoryExtensions)
+	if (!removedDirectories.isEmpty())
 	{
-		fileSystem->AddSearchPath((gameDir + extension).c_str());
+		_gameDirectoryWatcher->removePaths(removedDirectories);
+	}
+
+	//Only directories that aren't being watched yet are left
+	if (!directories.isEmpty())
+	{
+		_gameDirectoryWatcher->addPaths(directories.values());
 	}
 }
 
@@ -724,6 +757,8 @@ void MainWindow::OnActiveConfigurationChanged(std::pair<settings::GameEnvironmen
 		auto fileSystem = _editorContext->GetFileSystem();
 
 		fileSystem->RemoveAllSearchPaths();
+
+		UpdateWatchedGameDirectories();
 	}
 }
 
@@ -731,4 +766,12 @@ void MainWindow::OnGameConfigurationDirectoryChanged()
 {
 	SetupFileSystem(_editorContext->GetGameConfigurations()->GetActiveConfiguration());
 }
+
+void MainWindow::OnGameDirectoryContentsChanged(const QString& path)
+{
+	_editorContext->GetFileSystem()->RefreshDirectory(path.toStdString());
+
+	//Subdirectories may have been added or removed
+	UpdateWatchedGameDirectories();
+}
 }
@@ -3,6 +3,7 @@
 #include <memory>
 #include <utility>
 
+#include <QFileSystemWatcher>
 #include <QMainWindow>
 #include <QPointer>
 #include <QString>
@@ -53,6 +54,11 @@ private:
 
 	void SetupFileSystem(std::pair<settings::GameEnvironment*, settings::GameConfiguration*> activeConfiguration);
 
+	/**
+	*	@brief Watches the directories that are currently in the filesystem's search paths, and stops watching any others.
+	*/
+	void UpdateWatchedGameDirectories();
+
 private slots:
 	bool TryLoadAsset(QString fileName);
 
@@ -93,6 +99,8 @@ private slots:
 
 	void OnGameConfigurationDirectoryChanged();
 
+	void OnGameDirectoryContentsChanged(const QString& path);
+
 private:
 	Ui_MainWindow _ui;
 
@@ -100,6 +108,8 @@ private:
 
 	QUndoGroup* const _undoGroup = new QUndoGroup(this);
 
+	QFileSystemWatcher* const _gameDirectoryWatcher = new QFileSystemWatcher(this);
+
 	QPointer<QTabWidget> _assetTabs;
 
 	QString _loadFileFilter;
@@ -11,6 +11,8 @@
 #include <QUndoStack>
 #include <QWidget>
 
+#include "ui/assets/UndoDeltaStore.hpp"
+
 class QMenu;
 
 namespace ui
@@ -61,6 +63,11 @@ public:
 
 	QUndoStack* GetUndoStack() const { return _undoStack; }
 
+	/**
+	*	@brief Gets the store that holds the history of undo commands that store their data as deltas.
+	*/
+	const std::shared_ptr<UndoDeltaStore>& GetUndoDeltaStore() const { return _undoDeltaStore; }
+
 	bool IsActive() const { return _isActive; }
 
 	void SetActive(bool value)
@@ -96,6 +103,7 @@ signals:
 private:
 	QString _fileName;
 	QUndoStack* const _undoStack = new QUndoStack(this);
+	const std::shared_ptr<UndoDeltaStore> _undoDeltaStore = std::make_shared<UndoDeltaStore>();
 	bool _isActive{false};
 };
 
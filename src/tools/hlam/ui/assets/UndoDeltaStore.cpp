@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cassert>
+
+#include "qt/QtLogging.hpp"
+
+#include "ui/assets/UndoDeltaStore.hpp"
+
+namespace ui::assets
+{
+static QString FormatDataSize(std::size_t size)
+{
+	if (size < 1024)
+	{
+		return QString{"%1 bytes"}.arg(size);
+	}
+
+	if (size < 1024 * 1024)
+	{
+		return QString{"%1 KiB"}.arg(size / 1024.0, 0, 'f', 1);
+	}
+
+	return QString{"%1 MiB"}.arg(size / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+UndoDelta::UndoDelta(const std::shared_ptr<UndoDeltaStore>& store, const QByteArray& oldState, const QByteArray& newState)
+	: _store(store)
+	, _oldSize(oldState.size())
+	, _newSize(newState.size())
+{
+	assert(_store);
+
+	//Bytes that didn't change are zero, which compresses to almost nothing
+	QByteArray delta{std::max(_oldSize, _newSize), '\0'};
+
+	std::copy(oldState.begin(), oldState.end(), delta.begin());
+
+	for (int i = 0; i < _newSize; ++i)
+	{
+		delta[i] = delta[i] ^ newState[i];
+	}
+
+	_data = qCompress(delta);
+	_compressedSize = _data.size();
+
+	_store->Add(this);
+}
+
+UndoDelta::~UndoDelta()
+{
+	_store->Remove(this);
+}
+
+std::optional<QByteArray> UndoDelta::Apply(const QByteArray& currentState, int resultSize) const
+{
+	assert(resultSize == _oldSize || resultSize == _newSize);
+	assert(currentState.size() == (resultSize == _oldSize ? _newSize : _oldSize));
+
+	const auto delta = _store->Read(*this);
+
+	if (!delta)
+	{
+		return {};
+	}
+
+	QByteArray result{currentState};
+
+	result.resize(std::max(_oldSize, _newSize));
+	std::fill(result.begin() + currentState.size(), result.end(), '\0');
+
+	for (int i = 0; i < result.size(); ++i)
+	{
+		result[i] = result[i] ^ (*delta)[i];
+	}
+
+	result.resize(resultSize);
+
+	return result;
+}
+
+void UndoDeltaStore::SetMemoryBudget(std::size_t value)
+{
+	_memoryBudget = value;
+	EnforceBudget();
+}
+
+QString UndoDeltaStore::GetFootprintDescription() const
+{
+	QString description{QString{"%1 in memory"}.arg(FormatDataSize(_memoryUsage))};
+
+	if (_diskUsage > 0)
+	{
+		description += QString{", %1 on disk"}.arg(FormatDataSize(_diskUsage));
+	}
+
+	return description;
+}
+
+void UndoDeltaStore::Add(UndoDelta* delta)
+{
+	_deltas.push_back(delta);
+	_memoryUsage += delta->_compressedSize;
+
+	EnforceBudget();
+}
+
+void UndoDeltaStore::Remove(UndoDelta* delta)
+{
+	_deltas.erase(std::find(_deltas.begin(), _deltas.end(), delta));
+
+	if (delta->_fileOffset != -1)
+	{
+		_diskUsage -= delta->_compressedSize;
+
+		//Space in the file is only reused once every delta stored in it is gone
+		if (_diskUsage == 0 && _spillFile)
+		{
+			_spillFile->resize(0);
+		}
+	}
+	else
+	{
+		_memoryUsage -= delta->_compressedSize;
+	}
+}
+
+std::optional<QByteArray> UndoDeltaStore::Read(const UndoDelta& delta)
+{
+	QByteArray data;
+
+	if (delta._fileOffset == -1)
+	{
+		data = delta._data;
+	}
+	else
+	{
+		if (_spillFile->seek(delta._fileOffset))
+		{
+			data = _spillFile->read(delta._compressedSize);
+		}
+
+		if (data.size() != delta._compressedSize)
+		{
+			qCCritical(HLAM) << "Could not read undo history from" << _spillFile->fileName() << ":" << _spillFile->errorString();
+			return {};
+		}
+	}
+
+	auto uncompressed = qUncompress(data);
+
+	//Applying a short delta would silently produce a corrupt state
+	if (uncompressed.size() != std::max(delta._oldSize, delta._newSize))
+	{
+		qCCritical(HLAM) << "Undo history is corrupt: expected" << std::max(delta._oldSize, delta._newSize)
+			<< "bytes, got" << uncompressed.size();
+		return {};
+	}
+
+	return uncompressed;
+}
+
+void UndoDeltaStore::EnforceBudget()
+{
+	for (auto it = _deltas.begin(); _memoryUsage > _memoryBudget && it != _deltas.end(); ++it)
+	{
+		if ((*it)->_fileOffset == -1 && !Spill(**it))
+		{
+			break;
+		}
+	}
+}
+
+bool UndoDeltaStore::Spill(UndoDelta& delta)
+{
+	if (_spillFileFailed)
+	{
+		return false;
+	}
+
+	if (!_spillFile)
+	{
+		_spillFile = std::make_unique<QTemporaryFile>();
+
+		if (!_spillFile->open())
+		{
+			qCWarning(HLAM) << "Could not create undo history file, keeping all undo history in memory:" << _spillFile->errorString();
+			_spillFile.reset();
+			_spillFileFailed = true;
+			return false;
+		}
+	}
+
+	const qint64 offset = _spillFile->size();
+
+	if (!_spillFile->seek(offset) || _spillFile->write(delta._data) != delta._data.size())
+	{
+		qCWarning(HLAM) << "Could not write undo history to" << _spillFile->fileName() << ", keeping it in memory:" << _spillFile->errorString();
+		_spillFile->resize(offset);
+		_spillFileFailed = true;
+		return false;
+	}
+
+	delta._fileOffset = offset;
+	delta._data = QByteArray{};
+
+	_memoryUsage -= delta._compressedSize;
+	_diskUsage += delta._compressedSize;
+
+	return true;
+}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <optional>
+
+#include <QByteArray>
+#include <QString>
+#include <QTemporaryFile>
+
+namespace ui::assets
+{
+class UndoDeltaStore;
+
+/**
+*	@brief Compressed difference between two states of an object, used by undo commands instead of storing both states.
+*	Applying the delta to either state produces the other one.
+*/
+class UndoDelta final
+{
+public:
+	UndoDelta(const std::shared_ptr<UndoDeltaStore>& store, const QByteArray& oldState, const QByteArray& newState);
+	~UndoDelta();
+
+	UndoDelta(const UndoDelta&) = delete;
+	UndoDelta& operator=(const UndoDelta&) = delete;
+
+	int GetOldSize() const { return _oldSize; }
+
+	int GetNewSize() const { return _newSize; }
+
+	/**
+	*	@brief Applies the delta to @p currentState.
+	*	@param currentState The old or new state, as it currently exists.
+	*	@param resultSize Size of the state to produce, either GetOldSize() or GetNewSize().
+	*	@return The other state, or an empty optional if the delta could not be read back from disk or is corrupt.
+	*/
+	std::optional<QByteArray> Apply(const QByteArray& currentState, int resultSize) const;
+
+private:
+	friend class UndoDeltaStore;
+
+	const std::shared_ptr<UndoDeltaStore> _store;
+
+	const int _oldSize;
+	const int _newSize;
+
+	//Compressed delta, empty if it has been moved to the spill file
+	QByteArray _data;
+
+	int _compressedSize = 0;
+	qint64 _fileOffset = -1;
+};
+
+/**
+*	@brief Keeps track of all undo deltas of an undo stack and keeps their memory usage within a budget.
+*	Once the budget is exceeded the oldest deltas are moved to a temporary file and read back when needed.
+*/
+class UndoDeltaStore final
+{
+public:
+	static constexpr std::size_t DefaultMemoryBudget = 64 * 1024 * 1024;
+
+	UndoDeltaStore() = default;
+	~UndoDeltaStore() = default;
+
+	UndoDeltaStore(const UndoDeltaStore&) = delete;
+	UndoDeltaStore& operator=(const UndoDeltaStore&) = delete;
+
+	std::size_t GetMemoryBudget() const { return _memoryBudget; }
+
+	void SetMemoryBudget(std::size_t value);
+
+	std::size_t GetDeltaCount() const { return _deltas.size(); }
+
+	/**
+	*	@brief Number of bytes used by deltas kept in memory.
+	*/
+	std::size_t GetMemoryUsage() const { return _memoryUsage; }
+
+	/**
+	*	@brief Number of bytes used by deltas that have been moved to disk.
+	*/
+	std::size_t GetDiskUsage() const { return _diskUsage; }
+
+	/**
+	*	@brief Gets a human readable description of the memory and disk usage.
+	*/
+	QString GetFootprintDescription() const;
+
+private:
+	friend class UndoDelta;
+
+	void Add(UndoDelta* delta);
+	void Remove(UndoDelta* delta);
+
+	/**
+	*	@brief Gets the uncompressed delta, reading it from the spill file if needed.
+	*	@return The delta, or an empty optional if it could not be read or decompressed.
+	*/
+	std::optional<QByteArray> Read(const UndoDelta& delta);
+
+	void EnforceBudget();
+
+	bool Spill(UndoDelta& delta);
+
+private:
+	//Oldest first
+	std::list<UndoDelta*> _deltas;
+
+	std::size_t _memoryBudget = DefaultMemoryBudget;
+	std::size_t _memoryUsage = 0;
+	std::size_t _diskUsage = 0;
+
+	std::unique_ptr<QTemporaryFile> _spillFile;
+	bool _spillFileFailed = false;
+};
+}
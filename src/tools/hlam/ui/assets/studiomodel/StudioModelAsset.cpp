@@ -1,25 +1,30 @@
 #include <algorithm>
 #include <cstdio>
+#include <filesystem>
 #include <stdexcept>
+#include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include <QAction>
 #include <QColor>
 #include <QDir>
 #include <QDockWidget>
+#include <QFile>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QImage>
 #include <QMenu>
 #include <QMessageBox>
 
-#include <GL/glew.h>
-
 #include "assets/AssetIO.hpp"
 
 #include "engine/shared/studiomodel/DumpModelInfo.hpp"
+#include "engine/shared/studiomodel/StudioModelDecompiler.hpp"
 #include "engine/shared/studiomodel/StudioModelIO.hpp"
+#include "engine/shared/studiomodel/StudioModelStripifier.hpp"
+#include "engine/shared/studiomodel/StudioModelTextureOptimizer.hpp"
 #include "engine/shared/studiomodel/StudioModelUtils.hpp"
 
 #include "entity/BaseEntity.hpp"
@@ -39,6 +44,7 @@
 #include "ui/assets/studiomodel/StudioModelAsset.hpp"
 #include "ui/assets/studiomodel/StudioModelColors.hpp"
 #include "ui/assets/studiomodel/StudioModelEditWidget.hpp"
+#include "ui/assets/studiomodel/StudioModelOptimizeAnimationsDialog.hpp"
 #include "ui/assets/studiomodel/StudioModelUndoCommands.hpp"
 #include "ui/assets/studiomodel/compiler/StudioModelCompilerFrontEnd.hpp"
 #include "ui/assets/studiomodel/compiler/StudioModelDecompilerFrontEnd.hpp"
@@ -50,6 +56,7 @@
 #include "ui/camera_operators/FreeLookCameraOperator.hpp"
 
 #include "ui/settings/ColorSettings.hpp"
+#include "ui/settings/GeneralSettings.hpp"
 #include "ui/settings/StudioModelSettings.hpp"
 
 #include "utility/IOUtils.hpp"
@@ -59,6 +66,72 @@ namespace ui::assets::studiomodel
 {
 Q_LOGGING_CATEGORY(HLAMStudioModel, "hlam.studiomodel")
 
+/**
+*	@brief Gets the studiomdl::StudioModelFile flags for the files that a change affects.
+*/
+static int GetChangedFiles(ModelChangeId id)
+{
+	switch (id)
+	{
+	case ModelChangeId::ChangeTextureName:
+	case ModelChangeId::ChangeTextureFlags:
+		return studiomdl::StudioModelFile::Textures;
+
+	//Importing a texture can also rescale texture coordinates in the meshes
+	case ModelChangeId::ImportTexture:
+		return studiomdl::StudioModelFile::Textures | studiomdl::StudioModelFile::Main;
+
+	case ModelChangeId::OptimizeAnimations:
+		return studiomdl::StudioModelFile::Main | studiomdl::StudioModelFile::SequenceGroups;
+
+	//Meshes refer to skin references by index
+	case ModelChangeId::OptimizeTextures:
+		return studiomdl::StudioModelFile::Textures | studiomdl::StudioModelFile::Main;
+
+	//Other edits don't change animations in sequence group files, everything else is in the main file
+	default:
+		return studiomdl::StudioModelFile::Main;
+	}
+}
+
+/**
+*	@brief Gets the name of sequence group file @p index of a model saved to @p fileName.
+*	Names are relative to the game directory, which contains the models directory.
+*	If the model isn't in a models directory the directory of the old name @p oldName is kept.
+*/
+static std::string GetSequenceGroupFileName(const std::filesystem::path& fileName, const std::string& oldName, std::size_t index)
+{
+	std::filesystem::path baseFileName;
+
+	for (auto directory = fileName.parent_path(); directory.has_relative_path(); directory = directory.parent_path())
+	{
+		if (directory.filename() == "models")
+		{
+			baseFileName = fileName.lexically_relative(directory.parent_path());
+			break;
+		}
+	}
+
+	if (baseFileName.empty())
+	{
+		baseFileName = std::filesystem::u8path(oldName).parent_path() / fileName.filename();
+	}
+
+	baseFileName.replace_extension();
+
+	char suffix[16];
+	std::snprintf(suffix, sizeof(suffix), "%02zu.mdl", index);
+
+	auto name = baseFileName.generic_u8string() + suffix;
+
+	if (name.length() >= sizeof(mstudioseqgroup_t::name))
+	{
+		throw ::assets::AssetException("Sequence group filename \"" + name + "\" is too long");
+	}
+
+	return name;
+}
+
 static std::tuple<glm::vec3, glm::vec3, float, float> GetCenteredValues(const HLMVStudioModelEntity& entity, Axis axis, bool positive)
 {
 	glm::vec3 min, max;
@@ -121,6 +194,7 @@ StudioModelAsset::StudioModelAsset(QString&& fileName,
 	, _textureLoader(std::make_unique<graphics::TextureLoader>())
 	, _scene(std::make_unique<graphics::Scene>(_textureLoader.get(), editorContext->GetSoundSystem(), editorContext->GetWorldTime()))
 	, _cameraOperators(new camera_operators::CameraOperators(this))
+	, _savedFileName(GetFileName())
 {
 	PushInputSink(this);
 
@@ -130,6 +204,8 @@ StudioModelAsset::StudioModelAsset(QString&& fileName,
 
 	_scene->FloorLength = _provider->GetStudioModelSettings()->GetFloorLength();
 
+	OnUndoMemoryBudgetChanged(_editorContext->GetGeneralSettings()->GetUndoMemoryBudget());
+
 	auto entity = _scene->GetEntityContext()->EntityList->Create<HLMVStudioModelEntity>()([this](auto entity)
 		{
 			entity->SetEntityContext(_scene->GetEntityContext());
@@ -170,9 +246,22 @@ StudioModelAsset::StudioModelAsset(QString&& fileName,
 		_cameraOperators->SetCurrent(arcBallCamera);
 	}
 
+	_reloadTimer->setSingleShot(true);
+	_reloadTimer->setInterval(StudioModelReloadDelay);
+
+	//Watch the directory as well so files that are deleted and recreated by the compiler are picked up
+	connect(_fileWatcher, &QFileSystemWatcher::fileChanged, this, &StudioModelAsset::OnBackingFileChanged);
+	connect(_fileWatcher, &QFileSystemWatcher::directoryChanged, this, &StudioModelAsset::OnBackingFileChanged);
+	connect(_reloadTimer, &QTimer::timeout, this, &StudioModelAsset::OnReloadTimerExpired);
+	connect(this, &StudioModelAsset::FileNameChanged, this, &StudioModelAsset::UpdateWatchedFiles);
+
+	UpdateWatchedFiles();
+
 	connect(_editorContext, &EditorContext::Tick, this, &StudioModelAsset::OnTick);
 	connect(_editorContext->GetColorSettings(), &settings::ColorSettings::ColorsChanged, this, &StudioModelAsset::UpdateColors);
 	connect(_provider->GetStudioModelSettings(), &settings::StudioModelSettings::FloorLengthChanged, this, &StudioModelAsset::OnFloorLengthChanged);
+	connect(_editorContext->GetGeneralSettings(), &settings::GeneralSettings::UndoMemoryBudgetChanged,
+		this, &StudioModelAsset::OnUndoMemoryBudgetChanged);
 }
 
 StudioModelAsset::~StudioModelAsset()
@@ -218,10 +307,14 @@ void StudioModelAsset::PopulateAssetMenu(QMenu* menu)
 	menu->addSeparator();
 
 	menu->addAction("Flip Normals", this, &StudioModelAsset::OnFlipNormals);
+	menu->addAction("Optimize Triangle Strips", this, &StudioModelAsset::OnOptimizeTriangleStrips);
+	menu->addAction("Optimize Animations...", this, &StudioModelAsset::OnOptimizeAnimations);
+	menu->addAction("Optimize Textures", this, &StudioModelAsset::OnOptimizeTextures);
 
 	menu->addSeparator();
 
 	menu->addAction("Dump Model Info...", this, &StudioModelAsset::OnDumpModelInfo);
+	menu->addAction("Decompile To QC...", this, &StudioModelAsset::OnDecompileModel);
 
 	menu->addSeparator();
 
@@ -259,12 +352,99 @@ void StudioModelAsset::SetupFullscreenWidget(FullscreenWidget* fullscreenWidget)
 void StudioModelAsset::Save()
 {
 	const auto filePath = std::filesystem::u8path(GetFileName().toStdString());
-	auto result = studiomdl::ConvertFromEditable(filePath, *_editableStudioModel);
+	const bool savedElsewhere = GetFileName() != _savedFileName;
+
+	auto& sequenceGroups = _editableStudioModel->SequenceGroups;
+
+	std::vector<std::string> oldGroupNames;
+
+	//The main file refers to the sequence group files by name, so point it to the files written next to the new file
+	//Group 0 is the main file and has no name
+	if (savedElsewhere)
+	{
+		std::vector<std::string> newGroupNames;
+
+		for (std::size_t i = 1; i < sequenceGroups.size(); ++i)
+		{
+			newGroupNames.push_back(GetSequenceGroupFileName(filePath, sequenceGroups[i]->Name, i));
+		}
+
+		for (std::size_t i = 1; i < sequenceGroups.size(); ++i)
+		{
+			oldGroupNames.push_back(std::exchange(sequenceGroups[i]->Name, std::move(newGroupNames[i - 1])));
+		}
+	}
+
+	try
+	{
+		auto result = studiomdl::ConvertFromEditable(filePath, *_editableStudioModel);
+
+		//Only files that changed need to be rewritten, unless the model is saved somewhere else
+		const int files = savedElsewhere ? studiomdl::StudioModelFile::All : _changedFiles;
+
+		studiomdl::SaveStudioModel(filePath, result, false, files);
+	}
+	catch (const ::assets::AssetException&)
+	{
+		//Keep referring to the files that were last saved
+		for (std::size_t i = 0; i < oldGroupNames.size(); ++i)
+		{
+			sequenceGroups[i + 1]->Name = std::move(oldGroupNames[i]);
+		}
+
+		throw;
+	}
+
+	_changedFiles = studiomdl::StudioModelFile::None;
+	_savedFileName = GetFileName();
+
+	//Don't reload the model because of our own changes
+	UpdateWatchedFiles();
+}
+
+void StudioModelAsset::EmitModelChanged(const ModelChangeEvent& event)
+{
+	_changedFiles |= GetChangedFiles(event.GetId());
+
+	emit ModelChanged(event);
+}
 
-	studiomdl::SaveStudioModel(filePath, result, false);
+void StudioModelAsset::MarkAllFilesChanged()
+{
+	_changedFiles = studiomdl::StudioModelFile::All;
+}
+
+void StudioModelAsset::OnUndoHistoryLost()
+{
+	if (_undoHistoryLost)
+	{
+		return;
+	}
+
+	_undoHistoryLost = true;
+
+	//The stack is still executing the failed command, so clear it once control returns to the event loop
+	QTimer::singleShot(0, this, [this]
+		{
+			_undoHistoryLost = false;
+
+			GetUndoStack()->clear();
+
+			//The model no longer matches the files and which parts changed is no longer known
+			GetUndoStack()->resetClean();
+			MarkAllFilesChanged();
+
+			QMessageBox::warning(nullptr, "Undo history lost",
+				QString{"The undo history of \"%1\" could not be read and has been cleared.\nThe model has been kept as it is."}.arg(GetFileName()));
+		});
 }
 
 void StudioModelAsset::TryRefresh()
+{
+	Reload(true);
+}
+
+bool StudioModelAsset::Reload(bool showErrors)
 {
 	auto snapshot = std::make_unique<StateSnapshot>();
 
@@ -279,30 +459,90 @@ void StudioModelAsset::TryRefresh()
 
 		auto newModel = std::make_unique<studiomdl::EditableStudioModel>(studiomdl::ConvertToEditable(*studioModel));
 
-		//Clean up old model resources
-		//TODO: needs to be handled better
-		for (auto& texture : _editableStudioModel->Textures)
-		{
-			glDeleteTextures(1, &texture->TextureId);
-		}
+		//Textures that didn't change are moved to the new model; the rest are deleted along with the old model
+		const auto reusedTextureCount = studiomdl::ReuseUnchangedTextures(*_editableStudioModel, *newModel);
+
+		qCDebug(HLAMStudioModel) << "Reloading model" << GetFileName() << "reused" << reusedTextureCount
+			<< "of" << newModel->Textures.size() << "textures";
 
 		_editableStudioModel = std::move(newModel);
 
 		GetUndoStack()->clear();
 
+		_changedFiles = studiomdl::StudioModelFile::None;
+		_savedFileName = GetFileName();
+
 		auto entity = _scene->GetEntity();
 		entity->SetEditableModel(GetEditableStudioModel());
 		entity->Spawn();
 	}
 	catch (const ::assets::AssetException& e)
 	{
-		QMessageBox::critical(nullptr, "Error", QString{"An error occurred while reloading the model \"%1\":\n%2"}.arg(GetFileName()).arg(e.what()));
-		return;
+		if (showErrors)
+		{
+			QMessageBox::critical(nullptr, "Error", QString{"An error occurred while reloading the model \"%1\":\n%2"}.arg(GetFileName()).arg(e.what()));
+		}
+		else
+		{
+			qCWarning(HLAMStudioModel) << "Error reloading model" << GetFileName() << ":" << e.what();
+		}
+
+		return false;
 	}
 
 	LoadEntityFromSnapshot(snapshot.get());
 
 	emit LoadSnapshot(snapshot.get());
+
+	UpdateWatchedFiles();
+
+	return true;
+}
+
+QStringList StudioModelAsset::GetBackingFileNames() const
+{
+	const QFileInfo fileInfo{GetFileName()};
+
+	const auto baseFileName = fileInfo.path() + '/' + fileInfo.completeBaseName();
+	const auto suffix = '.' + fileInfo.suffix();
+
+	QStringList fileNames{GetFileName()};
+
+	if (const auto textureFileName = baseFileName + 'T' + suffix; QFile::exists(textureFileName))
+	{
+		fileNames.append(textureFileName);
+	}
+
+	//The first sequence group is the main file
+	for (std::size_t i = 1; i < _editableStudioModel->SequenceGroups.size(); ++i)
+	{
+		fileNames.append(QString{"%1%2%3"}.arg(baseFileName).arg(i, 2, 10, QChar{'0'}).arg(suffix));
+	}
+
+	return fileNames;
+}
+
+void StudioModelAsset::UpdateWatchedFiles()
+{
+	if (const auto watched = _fileWatcher->files() + _fileWatcher->directories(); !watched.isEmpty())
+	{
+		_fileWatcher->removePaths(watched);
+	}
+
+	_backingFileTimes.clear();
+
+	const auto fileNames = GetBackingFileNames();
+
+	for (const auto& fileName : fileNames)
+	{
+		if (const QFileInfo fileInfo{fileName}; fileInfo.exists())
+		{
+			_fileWatcher->addPath(fileName);
+			_backingFileTimes.insert(fileName, fileInfo.lastModified());
+		}
+	}
+
+	_fileWatcher->addPath(QFileInfo{GetFileName()}.path());
 }
 
 void StudioModelAsset::SaveEntityToSnapshot(StateSnapshot* snapshot)
@@ -383,6 +623,57 @@ void StudioModelAsset::LoadEntityFromSnapshot(StateSnapshot* snapshot)
 	}
 }
 
+void StudioModelAsset::OnBackingFileChanged()
+{
+	//Restart the timer so the model is only reloaded once the files stop changing
+	_reloadTimer->start();
+}
+
+void StudioModelAsset::OnReloadTimerExpired()
+{
+	const auto fileNames = GetBackingFileNames();
+
+	//Ignore changes to other files in the directory, and changes made by saving this model
+	const bool changed = std::any_of(fileNames.begin(), fileNames.end(), [this](const auto& fileName)
+		{
+			return QFileInfo{fileName}.lastModified() != _backingFileTimes.value(fileName);
+		});
+
+	if (!changed)
+	{
+		return;
+	}
+
+	//The compiler may not have finished writing the model yet, the directory watcher will trigger another attempt
+	if (!QFile::exists(GetFileName()))
+	{
+		return;
+	}
+
+	if (!GetUndoStack()->isClean())
+	{
+		const auto action = QMessageBox::question(nullptr, "Model changed on disk",
+			QString{"The model \"%1\" has been changed by another program.\nReload it and discard your changes?"}.arg(GetFileName()),
+			QMessageBox::StandardButton::Yes | QMessageBox::StandardButton::No,
+			QMessageBox::StandardButton::No);
+
+		if (action != QMessageBox::StandardButton::Yes)
+		{
+			//Don't ask again until the files change again
+			UpdateWatchedFiles();
+			return;
+		}
+	}
+
+	qCDebug(HLAMStudioModel) << "Model" << GetFileName() << "changed on disk, reloading";
+
+	if (!Reload(false))
+	{
+		//Keep watching so the next write triggers another attempt
+		UpdateWatchedFiles();
+	}
+}
+
 void StudioModelAsset::OnTick()
 {
 	//TODO: update asset-local world time
@@ -450,6 +741,11 @@ void StudioModelAsset::OnFloorLengthChanged(int length)
 	_scene->FloorLength = length;
 }
 
+void StudioModelAsset::OnUndoMemoryBudgetChanged(int megabytes)
+{
+	GetUndoDeltaStore()->SetMemoryBudget(static_cast<std::size_t>(megabytes) * 1024 * 1024);
+}
+
 void StudioModelAsset::OnPreviousCamera()
 {
 	_cameraOperators->PreviousCamera();
@@ -488,27 +784,93 @@ void StudioModelAsset::OnRestoreView()
 
 void StudioModelAsset::OnFlipNormals()
 {
-	std::vector<glm::vec3> oldNormals;
-	std::vector<glm::vec3> newNormals;
+	auto oldNormals = studiomdl::GetNormals(*GetScene()->GetEntity()->GetEditableModel());
 
-	auto model = GetScene()->GetEntity()->GetEditableModel();
+	std::vector<glm::vec3> newNormals(oldNormals.size());
 
-	for (auto& bodypart : model->Bodyparts)
-	{
-		for (auto& model : bodypart->Models)
+	std::transform(oldNormals.begin(), oldNormals.end(), newNormals.begin(), [](const auto& normal)
 		{
-			oldNormals.reserve(oldNormals.size() + model.Normals.size());
-			newNormals.reserve(newNormals.size() + model.Normals.size());
+			return -normal;
+		});
 
-			for (auto& normal : model.Normals)
-			{
-				oldNormals.push_back(normal.Vertex);
-				newNormals.push_back(-normal.Vertex);
-			}
-		}
+	AddUndoCommand(new FlipNormalsCommand(this, std::move(oldNormals), std::move(newNormals)));
+}
+
+void StudioModelAsset::OnOptimizeTriangleStrips()
+{
+	const auto result = studiomdl::StripifyModel(*GetScene()->GetEntity()->GetEditableModel());
+
+	if (result.NewCommands == result.OldCommands)
+	{
+		QMessageBox::information(nullptr, "Optimize Triangle Strips", "The triangle strips could not be improved");
+		return;
 	}
 
-	AddUndoCommand(new FlipNormalsCommand(this, std::move(oldNormals), std::move(newNormals)));
+	AddUndoCommand(new OptimizeTriangleCommandsCommand(this, result.OldCommands, result.NewCommands));
+
+	QMessageBox::information(nullptr, "Optimize Triangle Strips",
+		QString{"Strips and fans: %1 -> %2\nVertices drawn: %3 -> %4\nTriangles: %5"}
+			.arg(result.Before.GetCommandCount())
+			.arg(result.After.GetCommandCount())
+			.arg(result.Before.Vertices)
+			.arg(result.After.Vertices)
+			.arg(result.After.Triangles));
+}
+
+void StudioModelAsset::OnOptimizeAnimations()
+{
+	const auto model = GetScene()->GetEntity()->GetEditableModel();
+
+	StudioModelOptimizeAnimationsDialog dialog{*model, GetEditWidget()};
+
+	if (dialog.exec() != QDialog::DialogCode::Accepted)
+	{
+		return;
+	}
+
+	const auto& result = dialog.GetResult();
+
+	if (result.NewSize == result.OldSize)
+	{
+		return;
+	}
+
+	AddUndoCommand(new OptimizeAnimationsCommand(this, studiomdl::GetAnimations(*model), result.Animations));
+}
+
+void StudioModelAsset::OnOptimizeTextures()
+{
+	const auto model = GetScene()->GetEntity()->GetEditableModel();
+
+	const auto result = studiomdl::OptimizeTextures(*model);
+
+	if (!result.HasChanges())
+	{
+		QMessageBox::information(nullptr, "Optimize Textures", "The textures could not be improved");
+		return;
+	}
+
+	AddUndoCommand(new OptimizeTexturesCommand(this, studiomdl::GetTextureSet(*model), result.Textures));
+
+	QString mergedTextures;
+
+	for (const auto& merged : result.MergedTextures)
+	{
+		mergedTextures += QString{"\n%1 -> %2"}.arg(merged.Name.c_str()).arg(merged.MergedInto.c_str());
+	}
+
+	QMessageBox::information(nullptr, "Optimize Textures",
+		QString{"Textures merged: %1%2\nSkin references merged: %3\nPalettes compacted: %4 (%5 colors merged)\n"
+			"Texture data in file: %6 -> %7 bytes\nVideo memory: %8 -> %9 bytes"}
+			.arg(result.MergedTextures.size())
+			.arg(mergedTextures)
+			.arg(result.MergedSkinReferences)
+			.arg(result.CompactedPalettes)
+			.arg(result.FreedPaletteEntries)
+			.arg(result.OldFileSize)
+			.arg(result.NewFileSize)
+			.arg(result.OldVideoMemory)
+			.arg(result.NewVideoMemory));
 }
 
 void StudioModelAsset::OnDumpModelInfo()
@@ -536,6 +898,32 @@ void StudioModelAsset::OnDumpModelInfo()
 	}
 }
 
+void StudioModelAsset::OnDecompileModel()
+{
+	const QFileInfo fileInfo{GetFileName()};
+
+	const QString directory{QFileDialog::getExistingDirectory(nullptr, "Select Output Directory", fileInfo.path())};
+
+	if (directory.isEmpty())
+	{
+		return;
+	}
+
+	try
+	{
+		studiomdl::DecompileStudioModel(*_editableStudioModel,
+			std::filesystem::u8path(directory.toStdString()), fileInfo.completeBaseName().toStdString());
+	}
+	catch (const ::assets::AssetException& e)
+	{
+		QMessageBox::critical(nullptr, "Error", QString{"An error occurred while decompiling the model:\n%1"}.arg(e.what()));
+		return;
+	}
+
+	QMessageBox::information(nullptr, "Decompile Model", QString{"Decompiled model to \"%1\""}
+		.arg(QDir::toNativeSeparators(QDir{directory}.absoluteFilePath(fileInfo.completeBaseName() + ".qc"))));
+}
+
 void StudioModelAsset::OnTakeScreenshot()
 {
 	//Ensure the edit widget exists
@@ -612,7 +1000,17 @@ std::unique_ptr<Asset> StudioModelAssetProvider::Load(EditorContext* editorConte
 
 	qCDebug(HLAMStudioModel) << "Loaded model" << fileName << "as" << updatedFileName;
 
-	return std::make_unique<StudioModelAsset>(std::move(updatedFileName), editorContext, this,
+	const bool converted = updatedFileName != fileName;
+
+	auto asset = std::make_unique<StudioModelAsset>(std::move(updatedFileName), editorContext, this,
 		std::make_unique<studiomdl::EditableStudioModel>(std::move(editableStudioModel)));
+
+	//The converted model has never been written to the new file
+	if (converted)
+	{
+		asset->MarkAllFilesChanged();
+	}
+
+	return asset;
 }
 }
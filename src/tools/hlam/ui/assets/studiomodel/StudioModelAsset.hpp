@@ -5,8 +5,12 @@
 #include <stack>
 #include <vector>
 
+#include <QDateTime>
+#include <QFileSystemWatcher>
 #include <QLoggingCategory>
+#include <QMap>
 #include <QObject>
+#include <QTimer>
 
 #include "engine/shared/studiomodel/EditableStudioModel.hpp"
 
@@ -46,6 +50,12 @@ class StudioModelEditWidget;
 inline const QString StudioModelExtension{QStringLiteral("mdl")};
 inline const QString StudioModelPS2Extension{QStringLiteral("dol")};
 
+/**
+*	@brief How long to wait after the last change to a model's files before reloading it, in milliseconds.
+*	Compilers write the files in several steps, so this avoids reloading partially written models.
+*/
+constexpr int StudioModelReloadDelay = 500;
+
 Q_DECLARE_LOGGING_CATEGORY(HLAMStudioModel)
 
 class StudioModelAssetProvider final : public AssetProvider
@@ -179,10 +189,22 @@ public:
 		GetUndoStack()->push(command);
 	}
 
-	void EmitModelChanged(const ModelChangeEvent& event)
-	{
-		emit ModelChanged(event);
-	}
+	/**
+	*	@brief Notifies listeners of a change to the model and remembers which files must be written on the next save.
+	*/
+	void EmitModelChanged(const ModelChangeEvent& event);
+
+	/**
+	*	@brief Marks all files as changed, for models that don't match the files they were loaded from.
+	*/
+	void MarkAllFilesChanged();
+
+	/**
+	*	@brief Called by undo commands whose stored delta could not be read.
+	*	The model is left in its current state and the undo history is discarded,
+	*	since older commands assume the state the failed command would have restored.
+	*/
+	void OnUndoHistoryLost();
 
 	Pose GetPose() const { return _pose; }
 
@@ -190,6 +212,23 @@ private:
 	void SaveEntityToSnapshot(StateSnapshot* snapshot);
 	void LoadEntityFromSnapshot(StateSnapshot* snapshot);
 
+	/**
+	*	@brief Reloads the model from disk, keeping the entity state, camera and unchanged textures.
+	*	@param showErrors Whether to show a message box if the model could not be loaded.
+	*	@return Whether the model was reloaded.
+	*/
+	bool Reload(bool showErrors);
+
+	/**
+	*	@brief Gets the names of the files that the model is loaded from: the main file, texture file and sequence group files.
+	*/
+	QStringList GetBackingFileNames() const;
+
+	/**
+	*	@brief Watches the files backing this model and remembers their current modification times.
+	*/
+	void UpdateWatchedFiles();
+
 signals:
 	void Tick();
 
@@ -221,6 +260,8 @@ private slots:
 
 	void OnFloorLengthChanged(int length);
 
+	void OnUndoMemoryBudgetChanged(int megabytes);
+
 	void OnPreviousCamera();
 	void OnNextCamera();
 
@@ -230,10 +271,22 @@ private slots:
 
 	void OnFlipNormals();
 
+	void OnOptimizeTriangleStrips();
+
+	void OnOptimizeAnimations();
+
+	void OnOptimizeTextures();
+
 	void OnDumpModelInfo();
 
+	void OnDecompileModel();
+
 	void OnTakeScreenshot();
 
+	void OnBackingFileChanged();
+
+	void OnReloadTimerExpired();
+
 private:
 	EditorContext* const _editorContext;
 	const StudioModelAssetProvider* const _provider;
@@ -249,6 +302,21 @@ private:
 
 	StudioModelEditWidget* _editWidget{};
 
+	QFileSystemWatcher* const _fileWatcher = new QFileSystemWatcher(this);
+	QTimer* const _reloadTimer = new QTimer(this);
+
+	//Modification times of the backing files when the model was last loaded or saved
+	QMap<QString, QDateTime> _backingFileTimes;
+
+	//studiomdl::StudioModelFile flags for the files that changed since the model was last loaded or saved
+	int _changedFiles = 0;
+
+	//Whether clearing the undo stack after a failed undo or redo is pending
+	bool _undoHistoryLost = false;
+
+	//Name of the file the model was last loaded from or saved to
+	QString _savedFileName;
+
 	//TODO: this is temporarily put here, but needs to be put somewhere else eventually
 	Pose _pose = Pose::Sequences;
 };
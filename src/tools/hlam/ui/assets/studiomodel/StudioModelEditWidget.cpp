@@ -29,6 +29,7 @@
 #include "ui/assets/studiomodel/dockpanels/StudioModelModelDataPanel.hpp"
 #include "ui/assets/studiomodel/dockpanels/StudioModelModelDisplayPanel.hpp"
 #include "ui/assets/studiomodel/dockpanels/StudioModelModelInfoPanel.hpp"
+#include "ui/assets/studiomodel/dockpanels/StudioModelRenderCostPanel.hpp"
 #include "ui/assets/studiomodel/dockpanels/StudioModelScenePanel.hpp"
 #include "ui/assets/studiomodel/dockpanels/StudioModelSequencesPanel.hpp"
 #include "ui/assets/studiomodel/dockpanels/StudioModelTexturesPanel.hpp"
@@ -136,6 +137,7 @@ StudioModelEditWidget::StudioModelEditWidget(
 	addDockPanel(new StudioModelBonesPanel(_asset), "Bones");
 	addDockPanel(new StudioModelAttachmentsPanel(_asset), "Attachments");
 	addDockPanel(new StudioModelHitboxesPanel(_asset), "Hitboxes");
+	addDockPanel(new StudioModelRenderCostPanel(_asset), "Render Cost");
 	auto transformDock = addDockPanel(transformPanel, "Transformation", Qt::DockWidgetArea::LeftDockWidgetArea);
 
 	//Tabify all dock widgets except floating ones
@@ -0,0 +1,59 @@
+#include <QHeaderView>
+#include <QTableWidgetItem>
+
+#include "ui/assets/studiomodel/StudioModelOptimizeAnimationsDialog.hpp"
+
+namespace ui::assets::studiomodel
+{
+static QString FormatSize(std::size_t size)
+{
+	return QString{"%1 KiB"}.arg(size / 1024., 0, 'f', 1);
+}
+
+StudioModelOptimizeAnimationsDialog::StudioModelOptimizeAnimationsDialog(const studiomdl::EditableStudioModel& studioModel, QWidget* parent)
+	: QDialog(parent)
+	, _studioModel(studioModel)
+{
+	_ui.setupUi(this);
+
+	_ui.Sequences->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeMode::ResizeToContents);
+
+	connect(_ui.PositionTolerance, qOverload<double>(&QDoubleSpinBox::valueChanged), this, &StudioModelOptimizeAnimationsDialog::UpdateResult);
+	connect(_ui.RotationTolerance, qOverload<double>(&QDoubleSpinBox::valueChanged), this, &StudioModelOptimizeAnimationsDialog::UpdateResult);
+
+	UpdateResult();
+}
+
+StudioModelOptimizeAnimationsDialog::~StudioModelOptimizeAnimationsDialog() = default;
+
+void StudioModelOptimizeAnimationsDialog::UpdateResult()
+{
+	studiomdl::AnimationOptimizerSettings settings;
+
+	settings.PositionTolerance = static_cast<float>(_ui.PositionTolerance->value());
+	settings.RotationTolerance = static_cast<float>(_ui.RotationTolerance->value());
+
+	_result = studiomdl::OptimizeAnimations(_studioModel, settings);
+
+	_ui.Sequences->setRowCount(static_cast<int>(_result.Sequences.size()));
+
+	for (int row = 0; row < _ui.Sequences->rowCount(); ++row)
+	{
+		const auto& sequence = _result.Sequences[row];
+
+		const auto setColumn = [&](int column, const QString& text)
+		{
+			_ui.Sequences->setItem(row, column, new QTableWidgetItem(text));
+		};
+
+		setColumn(0, QString::fromStdString(sequence.Label));
+		setColumn(1, FormatSize(sequence.OldSize));
+		setColumn(2, FormatSize(sequence.NewSize));
+		setColumn(3, FormatSize(sequence.OldSize - sequence.NewSize));
+		setColumn(4, QString::number(sequence.MaxPositionError, 'f', 3));
+		setColumn(5, QString::number(sequence.MaxRotationError, 'f', 4));
+	}
+
+	_ui.Summary->setText(QString{"Animation data: %1 -> %2"}.arg(FormatSize(_result.OldSize)).arg(FormatSize(_result.NewSize)));
+}
+}
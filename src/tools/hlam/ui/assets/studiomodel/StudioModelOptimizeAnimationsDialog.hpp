@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QDialog>
+
+#include "ui_StudioModelOptimizeAnimationsDialog.h"
+
+#include "engine/shared/studiomodel/StudioModelAnimationOptimizer.hpp"
+
+namespace ui::assets::studiomodel
+{
+/**
+*	@brief Lets the user pick error tolerances for animation optimization and shows what each sequence saves.
+*/
+class StudioModelOptimizeAnimationsDialog final : public QDialog
+{
+public:
+	StudioModelOptimizeAnimationsDialog(const studiomdl::EditableStudioModel& studioModel, QWidget* parent = nullptr);
+	~StudioModelOptimizeAnimationsDialog();
+
+	const studiomdl::AnimationOptimizationResult& GetResult() const { return _result; }
+
+private slots:
+	void UpdateResult();
+
+private:
+	Ui_StudioModelOptimizeAnimationsDialog _ui;
+
+	const studiomdl::EditableStudioModel& _studioModel;
+
+	studiomdl::AnimationOptimizationResult _result;
+};
+}
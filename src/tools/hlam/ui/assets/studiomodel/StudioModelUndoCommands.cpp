@@ -1,11 +1,138 @@
+#include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 #include "entity/HLMVStudioModelEntity.hpp"
+
+#include "graphics/IGraphicsContext.hpp"
+
 #include "ui/assets/studiomodel/StudioModelAsset.hpp"
 #include "ui/assets/studiomodel/StudioModelUndoCommands.hpp"
 
 namespace ui::assets::studiomodel
 {
+template<typename T>
+static void WriteValues(QByteArray& state, const T* values, std::size_t count)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	state.append(reinterpret_cast<const char*>(values), static_cast<int>(count * sizeof(T)));
+}
+
+template<typename T>
+static void WriteList(QByteArray& state, const std::vector<T>& values)
+{
+	const auto count = static_cast<std::uint32_t>(values.size());
+
+	WriteValues(state, &count, 1);
+	WriteValues(state, values.data(), values.size());
+}
+
+static void WriteList(QByteArray& state, const std::vector<std::pair<glm::vec3, glm::vec3>>& values)
+{
+	const auto count = static_cast<std::uint32_t>(values.size());
+
+	WriteValues(state, &count, 1);
+
+	for (const auto& value : values)
+	{
+		WriteValues(state, &value.first, 1);
+		WriteValues(state, &value.second, 1);
+	}
+}
+
+/**
+*	@brief Reads values written by WriteValues and WriteList back in the same order.
+*/
+class StateReader final
+{
+public:
+	explicit StateReader(const QByteArray& state)
+		: _state(state)
+	{
+	}
+
+	template<typename T>
+	void ReadValues(T* values, std::size_t count)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		const std::size_t size = count * sizeof(T);
+
+		assert(_position + size <= static_cast<std::size_t>(_state.size()));
+
+		if (size > 0)
+		{
+			std::memcpy(values, _state.constData() + _position, size);
+			_position += size;
+		}
+	}
+
+	template<typename T>
+	T ReadValue()
+	{
+		T value;
+		ReadValues(&value, 1);
+		return value;
+	}
+
+	template<typename T>
+	std::vector<T> ReadList()
+	{
+		std::vector<T> values(ReadValue<std::uint32_t>());
+		ReadValues(values.data(), values.size());
+		return values;
+	}
+
+	std::vector<std::pair<glm::vec3, glm::vec3>> ReadBoundsList()
+	{
+		std::vector<std::pair<glm::vec3, glm::vec3>> values(ReadValue<std::uint32_t>());
+
+		for (auto& value : values)
+		{
+			ReadValues(&value.first, 1);
+			ReadValues(&value.second, 1);
+		}
+
+		return values;
+	}
+
+private:
+	const QByteArray& _state;
+	std::size_t _position = 0;
+};
+
+static std::vector<studiomdl::ScaleSTCoordinatesData::STCoordinate> GetSTCoordinates(
+	const studiomdl::EditableStudioModel& studioModel, const int textureIndex)
+{
+	std::vector<studiomdl::ScaleSTCoordinatesData::STCoordinate> coordinates;
+
+	for (const auto& bodypart : studioModel.Bodyparts)
+	{
+		for (const auto& model : bodypart->Models)
+		{
+			for (const auto& mesh : model.Meshes)
+			{
+				if (mesh.SkinRef == textureIndex)
+				{
+					auto cmds = mesh.Triangles.data();
+
+					for (int cmd = std::abs(*cmds++); cmd > 0; cmd = std::abs(*cmds++))
+					{
+						for (; cmd > 0; --cmd, cmds += 4)
+						{
+							coordinates.push_back({cmds[2], cmds[3]});
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return coordinates;
+}
+
 void ChangeEyePositionCommand::Apply(const glm::vec3& oldValue, const glm::vec3& newValue)
 {
 	auto model = _asset->GetScene()->GetEntity()->GetEditableModel();
@@ -202,9 +329,136 @@ void ChangeModelOriginCommand::Apply(const studiomdl::MoveData& oldValue, const
 	ApplyMoveData(*_asset->GetScene()->GetEntity()->GetEditableModel(), newValue);
 }
 
-void ChangeModelScaleCommand::Apply(const studiomdl::ScaleData& oldValue, const studiomdl::ScaleData& newValue)
+QByteArray ChangeModelScaleCommand::Capture()
 {
-	ApplyScaleData(*_asset->GetScene()->GetEntity()->GetEditableModel(), newValue);
+	return Serialize(CalculateScaleData(*_asset->GetScene()->GetEntity()->GetEditableModel(), 1.f, _flags).first);
+}
+
+void ChangeModelScaleCommand::Restore(const QByteArray& state)
+{
+	StateReader reader{state};
+
+	studiomdl::ScaleData data;
+
+	if (_flags & studiomdl::ScaleFlags::ScaleMeshes)
+	{
+		std::vector<std::vector<glm::vec3>> vertices(reader.ReadValue<std::uint32_t>());
+
+		for (auto& list : vertices)
+		{
+			list = reader.ReadList<glm::vec3>();
+		}
+
+		data.Meshes = studiomdl::ScaleMeshesData{std::move(vertices)};
+	}
+
+	if (_flags & studiomdl::ScaleFlags::ScaleHitboxes)
+	{
+		data.Hitboxes = studiomdl::ScaleHitboxesData{reader.ReadBoundsList()};
+	}
+
+	if (_flags & studiomdl::ScaleFlags::ScaleSequenceBBoxes)
+	{
+		data.SequenceBBoxes = studiomdl::ScaleSequenceBBoxesData{reader.ReadBoundsList()};
+	}
+
+	if (_flags & studiomdl::ScaleFlags::ScaleBones)
+	{
+		data.Bones = studiomdl::ScaleBonesData{reader.ReadList<studiomdl::ScaleBonesBoneData>()};
+	}
+
+	if (_flags & studiomdl::ScaleFlags::ScaleEyePosition)
+	{
+		data.EyePosition = reader.ReadValue<glm::vec3>();
+	}
+
+	if (_flags & studiomdl::ScaleFlags::ScaleAttachments)
+	{
+		data.Attachments = studiomdl::ScaleAttachmentsData{reader.ReadList<glm::vec3>()};
+	}
+
+	ApplyScaleData(*_asset->GetScene()->GetEntity()->GetEditableModel(), data);
+}
+
+int ChangeModelScaleCommand::GetScaleFlags(const studiomdl::ScaleData& data)
+{
+	int flags = studiomdl::ScaleFlags::None;
+
+	if (data.Meshes.has_value())
+	{
+		flags |= studiomdl::ScaleFlags::ScaleMeshes;
+	}
+
+	if (data.Hitboxes.has_value())
+	{
+		flags |= studiomdl::ScaleFlags::ScaleHitboxes;
+	}
+
+	if (data.SequenceBBoxes.has_value())
+	{
+		flags |= studiomdl::ScaleFlags::ScaleSequenceBBoxes;
+	}
+
+	if (data.Bones.has_value())
+	{
+		flags |= studiomdl::ScaleFlags::ScaleBones;
+	}
+
+	if (data.EyePosition.has_value())
+	{
+		flags |= studiomdl::ScaleFlags::ScaleEyePosition;
+	}
+
+	if (data.Attachments.has_value())
+	{
+		flags |= studiomdl::ScaleFlags::ScaleAttachments;
+	}
+
+	return flags;
+}
+
+QByteArray ChangeModelScaleCommand::Serialize(const studiomdl::ScaleData& data)
+{
+	QByteArray state;
+
+	if (data.Meshes.has_value())
+	{
+		const auto count = static_cast<std::uint32_t>(data.Meshes->Vertices.size());
+
+		WriteValues(state, &count, 1);
+
+		for (const auto& list : data.Meshes->Vertices)
+		{
+			WriteList(state, list);
+		}
+	}
+
+	if (data.Hitboxes.has_value())
+	{
+		WriteList(state, data.Hitboxes->Hitboxes);
+	}
+
+	if (data.SequenceBBoxes.has_value())
+	{
+		WriteList(state, data.SequenceBBoxes->SequenceBBoxes);
+	}
+
+	if (data.Bones.has_value())
+	{
+		WriteList(state, data.Bones->Bones);
+	}
+
+	if (data.EyePosition.has_value())
+	{
+		WriteValues(state, &data.EyePosition.value(), 1);
+	}
+
+	if (data.Attachments.has_value())
+	{
+		WriteList(state, data.Attachments->Attachments);
+	}
+
+	return state;
 }
 
 void ChangeModelRotationCommand::Apply(const studiomdl::RotateData& oldValue, const studiomdl::RotateData& newValue)
@@ -253,16 +507,58 @@ void ChangeTextureFlagsCommand::Apply(int index, const int& oldValue, const int&
 	texture.Flags = newValue;
 }
 
-void ImportTextureCommand::Apply(int index, const ImportTextureData& oldValue, const ImportTextureData& newValue)
+QByteArray ImportTextureCommand::Capture()
+{
+	const auto model = _asset->GetScene()->GetEntity()->GetEditableModel();
+
+	ImportTextureData data;
+
+	data.Data = model->Textures[_index]->Data;
+
+	if (_hasSTCoordinates)
+	{
+		data.ScaledSTCoordinates = studiomdl::ScaleSTCoordinatesData{GetSTCoordinates(*model, _index)};
+	}
+
+	return Serialize(data);
+}
+
+void ImportTextureCommand::Restore(const QByteArray& state)
 {
 	auto model = _asset->GetScene()->GetEntity()->GetEditableModel();
-	auto& texture = *model->Textures[index];
+	auto& texture = *model->Textures[_index];
+
+	StateReader reader{state};
 
-	texture.Data = newValue.Data;
+	texture.Data.Width = reader.ReadValue<int>();
+	texture.Data.Height = reader.ReadValue<int>();
+	texture.Data.Pixels = reader.ReadList<std::byte>();
+	texture.Data.Palette = reader.ReadValue<graphics::RGBPalette>();
 
-	model->ReplaceTexture(*_asset->GetTextureLoader(), &texture, newValue.Data.Pixels.data(), newValue.Data.Palette);
+	model->ReplaceTexture(*_asset->GetTextureLoader(), &texture, texture.Data.Pixels.data(), texture.Data.Palette);
 
-	studiomdl::ApplyScaledSTCoordinatesData(*model, index, newValue.ScaledSTCoordinates);
+	if (_hasSTCoordinates)
+	{
+		studiomdl::ApplyScaledSTCoordinatesData(*model, _index,
+			studiomdl::ScaleSTCoordinatesData{reader.ReadList<studiomdl::ScaleSTCoordinatesData::STCoordinate>()});
+	}
+}
+
+QByteArray ImportTextureCommand::Serialize(const ImportTextureData& data)
+{
+	QByteArray state;
+
+	WriteValues(state, &data.Data.Width, 1);
+	WriteValues(state, &data.Data.Height, 1);
+	WriteList(state, data.Data.Pixels);
+	WriteValues(state, &data.Data.Palette, 1);
+
+	if (!data.ScaledSTCoordinates.Coordinates.empty())
+	{
+		WriteList(state, data.ScaledSTCoordinates.Coordinates);
+	}
+
+	return state;
 }
 
 void ChangeEventCommand::Apply(int index, const studiomdl::SequenceEvent& oldValue, const studiomdl::SequenceEvent& newValue)
@@ -309,21 +605,205 @@ void ChangeModelNameCommand::Apply(int index, const QString& oldValue, const QSt
 	subModel.Name = newValue.toStdString();
 }
 
-void FlipNormalsCommand::Apply(int index, const std::vector<glm::vec3>& oldValue, const std::vector<glm::vec3>& newValue)
+QByteArray FlipNormalsCommand::Capture()
 {
-	auto model = _asset->GetScene()->GetEntity()->GetEditableModel();
+	return Serialize(studiomdl::GetNormals(*_asset->GetScene()->GetEntity()->GetEditableModel()));
+}
 
-	std::size_t normalIndex = 0;
-	
-	for (auto& bodypart : model->Bodyparts)
+void FlipNormalsCommand::Restore(const QByteArray& state)
+{
+	std::vector<glm::vec3> normals(state.size() / sizeof(glm::vec3));
+
+	StateReader reader{state};
+	reader.ReadValues(normals.data(), normals.size());
+
+	studiomdl::ApplyNormals(*_asset->GetScene()->GetEntity()->GetEditableModel(), normals);
+}
+
+QByteArray FlipNormalsCommand::Serialize(const std::vector<glm::vec3>& normals)
+{
+	QByteArray state;
+	WriteValues(state, normals.data(), normals.size());
+	return state;
+}
+
+QByteArray OptimizeTriangleCommandsCommand::Capture()
+{
+	return Serialize(studiomdl::GetTriangleCommands(*_asset->GetScene()->GetEntity()->GetEditableModel()));
+}
+
+void OptimizeTriangleCommandsCommand::Restore(const QByteArray& state)
+{
+	StateReader reader{state};
+
+	std::vector<std::vector<short>> commands(reader.ReadValue<std::uint32_t>());
+
+	for (auto& meshCommands : commands)
+	{
+		meshCommands = reader.ReadList<short>();
+	}
+
+	studiomdl::ApplyTriangleCommands(*_asset->GetScene()->GetEntity()->GetEditableModel(), commands);
+}
+
+QByteArray OptimizeAnimationsCommand::Capture()
+{
+	return Serialize(studiomdl::GetAnimations(*_asset->GetScene()->GetEntity()->GetEditableModel()));
+}
+
+void OptimizeAnimationsCommand::Restore(const QByteArray& state)
+{
+	StateReader reader{state};
+
+	std::vector<std::vector<std::vector<studiomdl::Animation>>> animations(reader.ReadValue<std::uint32_t>());
+
+	for (auto& blends : animations)
+	{
+		blends.resize(reader.ReadValue<std::uint32_t>());
+
+		for (auto& blend : blends)
+		{
+			blend.resize(reader.ReadValue<std::uint32_t>());
+
+			for (auto& animation : blend)
+			{
+				for (auto& values : animation.Data)
+				{
+					values = reader.ReadList<mstudioanimvalue_t>();
+				}
+			}
+		}
+	}
+
+	studiomdl::ApplyAnimations(*_asset->GetScene()->GetEntity()->GetEditableModel(), animations);
+}
+
+QByteArray OptimizeAnimationsCommand::Serialize(const std::vector<std::vector<std::vector<studiomdl::Animation>>>& animations)
+{
+	QByteArray state;
+
+	const auto writeCount = [&](std::size_t count)
+	{
+		const auto value = static_cast<std::uint32_t>(count);
+		WriteValues(state, &value, 1);
+	};
+
+	writeCount(animations.size());
+
+	for (const auto& blends : animations)
 	{
-		for (auto& model : bodypart->Models)
+		writeCount(blends.size());
+
+		for (const auto& blend : blends)
 		{
-			for (auto& normal : model.Normals)
+			writeCount(blend.size());
+
+			for (const auto& animation : blend)
 			{
-				normal.Vertex = newValue[normalIndex++];
+				for (const auto& values : animation.Data)
+				{
+					WriteList(state, values);
+				}
 			}
 		}
 	}
+
+	return state;
+}
+
+QByteArray OptimizeTriangleCommandsCommand::Serialize(const std::vector<std::vector<short>>& commands)
+{
+	QByteArray state;
+
+	const auto count = static_cast<std::uint32_t>(commands.size());
+
+	WriteValues(state, &count, 1);
+
+	for (const auto& meshCommands : commands)
+	{
+		WriteList(state, meshCommands);
+	}
+
+	return state;
+}
+
+QByteArray OptimizeTexturesCommand::Capture()
+{
+	return Serialize(studiomdl::GetTextureSet(*_asset->GetScene()->GetEntity()->GetEditableModel()));
+}
+
+void OptimizeTexturesCommand::Restore(const QByteArray& state)
+{
+	StateReader reader{state};
+
+	studiomdl::TextureSet textures;
+
+	textures.Textures.resize(reader.ReadValue<std::uint32_t>());
+
+	for (auto& texture : textures.Textures)
+	{
+		const auto name = reader.ReadList<char>();
+		texture.Name.assign(name.begin(), name.end());
+
+		texture.Flags = reader.ReadValue<int>();
+		texture.Data.Width = reader.ReadValue<int>();
+		texture.Data.Height = reader.ReadValue<int>();
+		texture.Data.Pixels = reader.ReadList<std::byte>();
+		texture.Data.Palette = reader.ReadValue<graphics::RGBPalette>();
+	}
+
+	textures.SkinFamilies.resize(reader.ReadValue<std::uint32_t>());
+
+	for (auto& family : textures.SkinFamilies)
+	{
+		family = reader.ReadList<int>();
+	}
+
+	textures.SkinRefs = reader.ReadList<int>();
+
+	auto model = _asset->GetScene()->GetEntity()->GetEditableModel();
+	auto graphicsContext = _asset->GetScene()->GetGraphicsContext();
+
+	graphicsContext->Begin();
+	studiomdl::ApplyTextureSet(*model, textures);
+	model->ReuploadTextures(*_asset->GetTextureLoader());
+	model->CreateTextures(*_asset->GetTextureLoader());
+	graphicsContext->End();
+}
+
+QByteArray OptimizeTexturesCommand::Serialize(const studiomdl::TextureSet& textures)
+{
+	QByteArray state;
+
+	const auto writeCount = [&](std::size_t count)
+	{
+		const auto value = static_cast<std::uint32_t>(count);
+		WriteValues(state, &value, 1);
+	};
+
+	writeCount(textures.Textures.size());
+
+	for (const auto& texture : textures.Textures)
+	{
+		writeCount(texture.Name.size());
+		WriteValues(state, texture.Name.data(), texture.Name.size());
+
+		WriteValues(state, &texture.Flags, 1);
+		WriteValues(state, &texture.Data.Width, 1);
+		WriteValues(state, &texture.Data.Height, 1);
+		WriteList(state, texture.Data.Pixels);
+		WriteValues(state, &texture.Data.Palette, 1);
+	}
+
+	writeCount(textures.SkinFamilies.size());
+
+	for (const auto& family : textures.SkinFamilies)
+	{
+		WriteList(state, family);
+	}
+
+	WriteList(state, textures.SkinRefs);
+
+	return state;
 }
 }
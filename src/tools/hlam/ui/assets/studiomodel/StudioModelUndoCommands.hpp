@@ -6,6 +6,7 @@
 #include <memory>
 #include <vector>
 
+#include <QByteArray>
 #include <QString>
 #include <QUndoStack>
 
@@ -14,6 +15,7 @@
 #include "engine/shared/studiomodel/StudioModelFileFormat.hpp"
 #include "graphics/Palette.hpp"
 
+#include "ui/assets/UndoDeltaStore.hpp"
 #include "ui/assets/studiomodel/StudioModelAsset.hpp"
 
 namespace studiomdl
@@ -65,6 +67,9 @@ enum class ModelChangeId
 	ChangeModelName,
 
 	FlipNormals,
+	OptimizeTriangleCommands,
+	OptimizeAnimations,
+	OptimizeTextures,
 };
 
 enum class AddRemoveType
@@ -501,6 +506,69 @@ protected:
 	const T _value;
 };
 
+/**
+*	@brief Base class for undo commands that change large parts of the model.
+*	Instead of keeping both values only a compressed delta between them is kept,
+*	the value to restore is computed from the current state of the model.
+*/
+class ModelDeltaUndoCommand : public BaseModelUndoCommand
+{
+protected:
+	ModelDeltaUndoCommand(StudioModelAsset* asset, ModelChangeId id, const QByteArray& oldState, const QByteArray& newState)
+		: BaseModelUndoCommand(asset, id)
+		, _delta(asset->GetUndoDeltaStore(), oldState, newState)
+	{
+	}
+
+public:
+	void undo() override
+	{
+		ApplyDelta(_delta.GetOldSize());
+	}
+
+	void redo() override
+	{
+		ApplyDelta(_delta.GetNewSize());
+	}
+
+protected:
+	/**
+	*	@brief Serializes the current state of the data changed by this command.
+	*	Must produce the same bytes as the states passed to the constructor.
+	*/
+	virtual QByteArray Capture() = 0;
+
+	virtual void Restore(const QByteArray& state) = 0;
+
+	virtual void EmitEvent()
+	{
+		_asset->EmitModelChanged(ModelChangeEvent{_id});
+	}
+
+private:
+	/**
+	*	@brief Changes the model to the old or new state.
+	*	If the delta can't be read the model is left unchanged and the undo history is discarded,
+	*	since older commands changing the same data rely on this command's result.
+	*/
+	void ApplyDelta(int resultSize)
+	{
+		auto state = _delta.Apply(Capture(), resultSize);
+
+		if (!state)
+		{
+			_asset->OnUndoHistoryLost();
+			return;
+		}
+
+		Restore(*state);
+		EmitEvent();
+	}
+
+private:
+	const UndoDelta _delta;
+};
+
 class ChangeEyePositionCommand : public ModelUndoCommand<glm::vec3>
 {
 public:
@@ -868,18 +936,29 @@ protected:
 	void Apply(const studiomdl::MoveData& oldValue, const studiomdl::MoveData& newValue) override;
 };
 
-class ChangeModelScaleCommand : public ModelUndoCommand<studiomdl::ScaleData>
+class ChangeModelScaleCommand : public ModelDeltaUndoCommand
 {
 public:
 	ChangeModelScaleCommand(
 		StudioModelAsset* asset, studiomdl::ScaleData&& oldData, studiomdl::ScaleData&& newData)
-		: ModelUndoCommand(asset, ModelChangeId::ChangeModelScale, std::move(oldData), std::move(newData))
+		: ModelDeltaUndoCommand(asset, ModelChangeId::ChangeModelScale, Serialize(oldData), Serialize(newData))
+		, _flags(GetScaleFlags(oldData))
 	{
 		setText("Scale model");
 	}
 
 protected:
-	void Apply(const studiomdl::ScaleData& oldValue, const studiomdl::ScaleData& newValue) override;
+	QByteArray Capture() override;
+
+	void Restore(const QByteArray& state) override;
+
+private:
+	static int GetScaleFlags(const studiomdl::ScaleData& data);
+
+	static QByteArray Serialize(const studiomdl::ScaleData& data);
+
+	//studiomdl::ScaleFlags for the parts of the model that are scaled
+	const int _flags;
 };
 
 class ChangeModelRotationCommand : public ModelUndoCommand<studiomdl::RotateData>
@@ -998,17 +1077,34 @@ struct ImportTextureData
 	ImportTextureData& operator=(ImportTextureData&& other) = default;
 };
 
-class ImportTextureCommand : public ModelListUndoCommand<ImportTextureData>
+class ImportTextureCommand : public ModelDeltaUndoCommand
 {
 public:
 	ImportTextureCommand(StudioModelAsset* asset, int textureIndex, ImportTextureData&& oldTexture, ImportTextureData&& newTexture)
-		: ModelListUndoCommand(asset, ModelChangeId::ImportTexture, textureIndex, std::move(oldTexture), std::move(newTexture))
+		: ModelDeltaUndoCommand(asset, ModelChangeId::ImportTexture, Serialize(oldTexture), Serialize(newTexture))
+		, _index(textureIndex)
+		, _hasSTCoordinates(!newTexture.ScaledSTCoordinates.Coordinates.empty())
 	{
 		setText("Import texture");
 	}
 
 protected:
-	void Apply(int index, const ImportTextureData& oldValue, const ImportTextureData& newValue) override;
+	QByteArray Capture() override;
+
+	void Restore(const QByteArray& state) override;
+
+	void EmitEvent() override
+	{
+		_asset->EmitModelChanged(ModelListChangeEvent{_id, _index});
+	}
+
+private:
+	static QByteArray Serialize(const ImportTextureData& data);
+
+	const int _index;
+
+	//Whether the texture size changed and texture coordinates had to be rescaled
+	const bool _hasSTCoordinates;
 };
 
 class ChangeEventCommand : public ModelListUndoCommand<studiomdl::SequenceEvent>
@@ -1091,26 +1187,78 @@ protected:
 	const int _modelIndex;
 };
 
-class FlipNormalsCommand : public ModelListUndoCommand<std::vector<glm::vec3>>
+class FlipNormalsCommand : public ModelDeltaUndoCommand
 {
 public:
 	FlipNormalsCommand(StudioModelAsset* asset, std::vector<glm::vec3>&& oldNormals, std::vector<glm::vec3>&& newNormals)
-		: ModelListUndoCommand(asset, ModelChangeId::FlipNormals, -1, std::move(oldNormals), std::move(newNormals))
+		: ModelDeltaUndoCommand(asset, ModelChangeId::FlipNormals, Serialize(oldNormals), Serialize(newNormals))
 	{
 		setText("Flip normals");
 	}
 
 protected:
-	bool CanMerge(const ModelListUndoCommand<std::vector<glm::vec3>>* other) override
+	QByteArray Capture() override;
+
+	void Restore(const QByteArray& state) override;
+
+private:
+	static QByteArray Serialize(const std::vector<glm::vec3>& normals);
+};
+
+class OptimizeTriangleCommandsCommand : public ModelDeltaUndoCommand
+{
+public:
+	OptimizeTriangleCommandsCommand(StudioModelAsset* asset,
+		const std::vector<std::vector<short>>& oldCommands, const std::vector<std::vector<short>>& newCommands)
+		: ModelDeltaUndoCommand(asset, ModelChangeId::OptimizeTriangleCommands, Serialize(oldCommands), Serialize(newCommands))
 	{
-		return _oldValue != other->GetNewValue();
+		setText("Optimize triangle strips");
+	}
+
+protected:
+	QByteArray Capture() override;
+
+	void Restore(const QByteArray& state) override;
+
+private:
+	static QByteArray Serialize(const std::vector<std::vector<short>>& commands);
+};
+
+class OptimizeAnimationsCommand : public ModelDeltaUndoCommand
+{
+public:
+	OptimizeAnimationsCommand(StudioModelAsset* asset,
+		const std::vector<std::vector<std::vector<studiomdl::Animation>>>& oldAnimations,
+		const std::vector<std::vector<std::vector<studiomdl::Animation>>>& newAnimations)
+		: ModelDeltaUndoCommand(asset, ModelChangeId::OptimizeAnimations, Serialize(oldAnimations), Serialize(newAnimations))
+	{
+		setText("Optimize animations");
 	}
 
-	void Apply(int index, const std::vector<glm::vec3>& oldValue, const std::vector<glm::vec3>& newValue) override;
+protected:
+	QByteArray Capture() override;
+
+	void Restore(const QByteArray& state) override;
 
-	void EmitEvent(const std::vector<glm::vec3>& oldValue, const std::vector<glm::vec3>& newValue) override
+private:
+	static QByteArray Serialize(const std::vector<std::vector<std::vector<studiomdl::Animation>>>& animations);
+};
+
+class OptimizeTexturesCommand : public ModelDeltaUndoCommand
+{
+public:
+	OptimizeTexturesCommand(StudioModelAsset* asset, const studiomdl::TextureSet& oldTextures, const studiomdl::TextureSet& newTextures)
+		: ModelDeltaUndoCommand(asset, ModelChangeId::OptimizeTextures, Serialize(oldTextures), Serialize(newTextures))
 	{
-		_asset->EmitModelChanged(ModelValueChangeEvent{_id, newValue});
+		setText("Optimize textures");
 	}
+
+protected:
+	QByteArray Capture() override;
+
+	void Restore(const QByteArray& state) override;
+
+private:
+	static QByteArray Serialize(const studiomdl::TextureSet& textures);
 };
 }
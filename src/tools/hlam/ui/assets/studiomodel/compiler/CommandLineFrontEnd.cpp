@@ -1,22 +1,64 @@
+#include <algorithm>
 #include <cmath>
 
 #include <QApplication>
 #include <QBoxLayout>
+#include <QClipboard>
+#include <QDateTime>
+#include <QDesktopServices>
 #include <QDesktopWidget>
+#include <QDir>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QHeaderView>
+#include <QRegularExpression>
 #include <QScrollBar>
+#include <QShortcut>
 #include <QSignalBlocker>
+#include <QStandardPaths>
 #include <QString>
+#include <QTableWidgetItem>
+#include <QThread>
+#include <QUrl>
 
 #include "ui/EditorContext.hpp"
 #include "ui/assets/studiomodel/compiler/CommandLineFrontEnd.hpp"
 
 namespace ui::assets::studiomodel
 {
+namespace
+{
+//Number of log files to keep, including the one being created
+constexpr int MaxCompilerLogFiles = 10;
+
+/**
+*	@brief Creates a unique log file name, and removes the oldest log files.
+*/
+QString CreateLogFileName()
+{
+	QDir directory{QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/compiler-logs"};
+
+	if (!directory.mkpath("."))
+	{
+		return {};
+	}
+
+	const auto existingFiles = directory.entryList({"*.log"}, QDir::Files, QDir::Time);
+
+	for (int i = MaxCompilerLogFiles - 1; i < existingFiles.size(); ++i)
+	{
+		directory.remove(existingFiles[i]);
+	}
+
+	return directory.absoluteFilePath(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz") + ".log");
+}
+}
+
 CommandLineFrontEnd::CommandLineFrontEnd(EditorContext* editorContext, QWidget* parent)
 	: QDialog(parent)
 	, _editorContext(editorContext)
+	, _outputModel(new CompilerOutputModel(this))
+	, _outputFilterModel(new CompilerOutputFilterModel(this))
 {
 	_ui.setupUi(this);
 
@@ -29,6 +71,20 @@ CommandLineFrontEnd::CommandLineFrontEnd(EditorContext* editorContext, QWidget*
 	_ui.Compile->setEnabled(false);
 	_ui.Terminate->setEnabled(false);
 
+	//Each compiler process is mostly single threaded, so run as many as there are cores by default
+	const int idealThreadCount = std::max(1, QThread::idealThreadCount());
+
+	_ui.ParallelJobs->setRange(1, std::max(64, idealThreadCount));
+	_ui.ParallelJobs->setValue(idealThreadCount);
+
+	_ui.JobSummary->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+
+	_outputFilterModel->setSourceModel(_outputModel);
+	_ui.Output->setModel(_outputFilterModel);
+
+	_ui.OutputFilter->addItem("All Files", -1);
+	_ui.OpenFullLog->setEnabled(false);
+
 	connect(_ui.ProgramPath, &QLineEdit::textChanged, this, &CommandLineFrontEnd::UpdateCompileSettings);
 	connect(_ui.BrowseProgramPath, &QPushButton::clicked, this, &CommandLineFrontEnd::OnBrowseCompiler);
 
@@ -45,10 +101,18 @@ CommandLineFrontEnd::CommandLineFrontEnd(EditorContext* editorContext, QWidget*
 	connect(_ui.Terminate, &QPushButton::clicked, this, &CommandLineFrontEnd::OnTerminate);
 	connect(_ui.Clear, &QPushButton::clicked, this, &CommandLineFrontEnd::OnClear);
 
-	connect(_process, &QProcess::readyReadStandardOutput, this, &CommandLineFrontEnd::OnReadyReadOutput);
-	connect(_process, &QProcess::readyReadStandardError, this, &CommandLineFrontEnd::OnReadyReadError);
-	connect(_process, &QProcess::errorOccurred, this, &CommandLineFrontEnd::OnErrorOccurred);
-	connect(_process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, &CommandLineFrontEnd::OnCompilationFinished);
+	connect(_ui.OutputFilter, qOverload<int>(&QComboBox::currentIndexChanged), this, &CommandLineFrontEnd::OnOutputFilterChanged);
+	connect(_ui.OpenFullLog, &QPushButton::clicked, this, &CommandLineFrontEnd::OnOpenFullLog);
+
+	//The output view doesn't support selecting text, so allow copying selected lines instead
+	const auto copyShortcut = new QShortcut(QKeySequence::Copy, _ui.Output);
+	copyShortcut->setContext(Qt::WidgetShortcut);
+	connect(copyShortcut, &QShortcut::activated, this, &CommandLineFrontEnd::OnCopyOutput);
+
+	connect(_ui.JobSummary, &QTableWidget::cellDoubleClicked, this, [this](int row) { _ui.OutputFilter->setCurrentIndex(row + 1); });
+
+	connect(_outputFilterModel, &QAbstractItemModel::rowsAboutToBeInserted, this, &CommandLineFrontEnd::OnOutputRowsAboutToBeInserted);
+	connect(_outputFilterModel, &QAbstractItemModel::rowsInserted, this, &CommandLineFrontEnd::OnOutputRowsInserted);
 }
 
 CommandLineFrontEnd::~CommandLineFrontEnd() = default;
@@ -56,7 +120,7 @@ CommandLineFrontEnd::~CommandLineFrontEnd() = default;
 void CommandLineFrontEnd::closeEvent(QCloseEvent* event)
 {
 	//Don't allow closing while a process is running
-	if (_currentFile != -1)
+	if (_isCompiling)
 	{
 		return;
 	}
@@ -218,209 +282,527 @@ void CommandLineFrontEnd::UpdateCompleteCommandLine()
 	_ui.CompleteCommandLine->setPlainText(QString{"\"%1\" %2"}.arg(_ui.ProgramPath->text()).arg(arguments.join(' ')));
 }
 
-void CommandLineFrontEnd::StartNextCompilation()
+void CommandLineFrontEnd::OnBrowseWorkingDirectory()
+{
+	const QString path{QFileDialog::getExistingDirectory(this, {}, _ui.WorkingDirectory->text())};
+
+	if (!path.isEmpty())
+	{
+		_ui.WorkingDirectory->setText(path);
+	}
+}
+
+void CommandLineFrontEnd::OnCompile()
+{
+	//Freeze the settings during compilation
+	_ui.CommandLinePathWidget->setEnabled(false);
+	_ui.CommandLineSettingsWidget->setEnabled(false);
+	_ui.ParallelJobs->setEnabled(false);
+	_ui.StopOnFirstError->setEnabled(false);
+
+	_ui.Compile->setEnabled(false);
+	_ui.Terminate->setEnabled(true);
+
+	_isCompiling = true;
+
+	_maxParallelJobs = _ui.ParallelJobs->value();
+	_stopOnFirstError = _ui.StopOnFirstError->isChecked();
+
+	_jobs.clear();
+	_nextJob = 0;
+	_runningJobCount = 0;
+
+	_ui.JobSummary->setRowCount(0);
+	_ui.JobSummary->setRowCount(_ui.Files->count());
+
+	{
+		const QSignalBlocker blocker{_ui.OutputFilter};
+
+		while (_ui.OutputFilter->count() > 1)
+		{
+			_ui.OutputFilter->removeItem(_ui.OutputFilter->count() - 1);
+		}
+
+		_ui.OutputFilter->setCurrentIndex(0);
+		_outputFilterModel->SetSource(-1);
+	}
+
+	if (!_outputModel->StartLog(CreateLogFileName()))
+	{
+		AppendOutput("Could not create log file, output that no longer fits in the output window will be lost", CompilerOutputType::Warning);
+	}
+
+	_ui.OpenFullLog->setEnabled(false);
+
+	for (int i = 0; i < _ui.Files->count(); ++i)
+	{
+		auto job = std::make_unique<Job>();
+
+		job->FileName = _ui.Files->item(i)->text();
+		job->Row = i;
+
+		_ui.JobSummary->setItem(i, 0, new QTableWidgetItem(job->FileName));
+		_ui.OutputFilter->addItem(QFileInfo{job->FileName}.fileName(), i);
+
+		for (int column = 1; column < _ui.JobSummary->columnCount(); ++column)
+		{
+			_ui.JobSummary->setItem(i, column, new QTableWidgetItem());
+		}
+
+		UpdateJobSummary(*job);
+
+		_jobs.push_back(std::move(job));
+	}
+
+	_compilationTimer.start();
+
+	StartPendingJobs();
+}
+
+void CommandLineFrontEnd::StartPendingJobs()
 {
-	_outputIsError = false;
+	//Cancelling jobs finishes them, which can end the compilation before the job that caused the cancellation has finished
+	if (!_isCompiling)
+	{
+		return;
+	}
+
+	while (_runningJobCount < _maxParallelJobs && _nextJob < _jobs.size())
+	{
+		StartJob(*_jobs[_nextJob++]);
+	}
+
+	//Starting a process can fail immediately, in which case the compilation may already have been finished
+	if (!_isCompiling || _runningJobCount > 0 || _nextJob < _jobs.size())
+	{
+		return;
+	}
+
+	//All jobs are done
+	int succeeded = 0;
+	int upToDate = 0;
+	int failed = 0;
+	int cancelled = 0;
+	int warnings = 0;
+
+	for (const auto& job : _jobs)
+	{
+		switch (job->State)
+		{
+		case JobState::Succeeded: ++succeeded; break;
+		case JobState::UpToDate: ++upToDate; break;
+		case JobState::Failed: ++failed; break;
+		default: ++cancelled; break;
+		}
 
-	QString fileName{_ui.Files->item(_currentFile)->text()};
+		warnings += job->WarningCount;
+	}
+
+	const QString summary{QString{"Compiled %1 file(s) in %2 seconds: %3 succeeded, %4 up to date, %5 failed, %6 cancelled, %7 warning(s)"}
+		.arg(_jobs.size())
+		.arg(_compilationTimer.elapsed() / 1000.0, 0, 'f', 2)
+		.arg(succeeded)
+		.arg(upToDate)
+		.arg(failed)
+		.arg(cancelled)
+		.arg(warnings)};
 
-	const QFileInfo fileInfo{fileName};
+	AppendOutput({}, CompilerOutputType::Regular);
+	AppendOutput(summary, failed > 0 ? CompilerOutputType::Error : CompilerOutputType::Header);
+
+	if (const QString logFileName = _outputModel->GetLogFileName(); !logFileName.isEmpty())
+	{
+		AppendOutput(QString{"Full output written to %1"}.arg(QDir::toNativeSeparators(logFileName)), CompilerOutputType::Regular);
+	}
+
+	Reset();
+}
 
-	QString workingDirectory;
+void CommandLineFrontEnd::StartJob(Job& job)
+{
+	const QFileInfo fileInfo{job.FileName};
 
 	//Default the working directory to the qc file directory
 	if (_ui.OverrideWorkingDirectory->isChecked())
 	{
-		workingDirectory = _ui.WorkingDirectory->text();
+		job.WorkingDirectory = _ui.WorkingDirectory->text();
 	}
 	else
 	{
-		workingDirectory = fileInfo.absolutePath();
+		job.WorkingDirectory = fileInfo.absolutePath();
 	}
 
-	_process->setWorkingDirectory(workingDirectory);
+	job.Arguments = GetArguments();
+	job.Arguments.append(job.FileName);
 
-	auto arguments{GetArguments()};
+	AppendJobOutput(job, QString{"Command line parameters: %1 \"%2\"\n"}.arg(_ui.CompleteCommandLine->toPlainText()).arg(job.FileName), false);
+
+	job.Timer.start();
+
+	job.CacheKey = GetOutputCacheKey(job.FileName, job.WorkingDirectory, job.Arguments);
+
+	if (QStringList restoredFiles; !job.CacheKey.isEmpty() && TryRestoreOutput(job.CacheKey, restoredFiles))
+	{
+		AppendJobOutput(job, QString{"Inputs are unchanged, restored previous output:\n%1\n"}.arg(restoredFiles.join('\n')), false);
 
-	arguments.append(fileName);
+		job.State = JobState::UpToDate;
+		job.ElapsedMilliseconds = job.Timer.elapsed();
 
-	AppendRegularText(QString{"Command line parameters: %1 \"%2\"<br/>"}.arg(_ui.CompleteCommandLine->toPlainText()).arg(fileName));
+		UpdateJobSummary(job);
+		PrintJobOutput(job);
+		return;
+	}
+
+	job.Process = new QProcess(this);
+
+	job.Process->setWorkingDirectory(job.WorkingDirectory);
+
+	connect(job.Process, &QProcess::readyReadStandardOutput, this, [this, &job] { OnReadyReadOutput(job); });
+	connect(job.Process, &QProcess::readyReadStandardError, this, [this, &job] { OnReadyReadError(job); });
+	connect(job.Process, &QProcess::errorOccurred, this, [this, &job](QProcess::ProcessError error) { OnErrorOccurred(job, error); });
+	connect(job.Process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+		[this, &job](int exitCode, QProcess::ExitStatus exitStatus) { OnCompilationFinished(job, exitCode, exitStatus); });
+
+	job.State = JobState::Running;
+	job.StartTime = QDateTime::currentDateTime();
+
+	++_runningJobCount;
 
-	_process->start(_ui.ProgramPath->text(), arguments, QIODevice::ReadOnly);
+	UpdateJobSummary(job);
+
+	job.Process->start(_ui.ProgramPath->text(), job.Arguments, QIODevice::ReadOnly);
 }
 
-void CommandLineFrontEnd::OnBrowseWorkingDirectory()
+void CommandLineFrontEnd::FinishJob(Job& job, JobState state)
 {
-	const QString path{QFileDialog::getExistingDirectory(this, {}, _ui.WorkingDirectory->text())};
+	if (job.State != JobState::Running)
+	{
+		return;
+	}
 
-	if (!path.isEmpty())
+	job.State = state;
+	job.ElapsedMilliseconds = job.Timer.elapsed();
+
+	//Add the last line if the output didn't end with a newline
+	if (!job.PartialLine.isEmpty())
 	{
-		_ui.WorkingDirectory->setText(path);
+		AddJobLine(job, job.PartialLine, job.PartialLineIsError);
+		job.PartialLine.clear();
+	}
+
+	job.Process->disconnect(this);
+	job.Process->deleteLater();
+	job.Process = nullptr;
+
+	--_runningJobCount;
+
+	if (state == JobState::Succeeded && !job.CacheKey.isEmpty())
+	{
+		StoreOutput(job.FileName, job.WorkingDirectory, job.Arguments, job.CacheKey, job.StartTime);
 	}
+
+	UpdateJobSummary(job);
+	PrintJobOutput(job);
+
+	if (state == JobState::Failed && _stopOnFirstError)
+	{
+		CancelJobs();
+	}
+
+	StartPendingJobs();
 }
 
-void CommandLineFrontEnd::OnCompile()
+void CommandLineFrontEnd::PrintJobOutput(Job& job)
 {
-	//Freeze the settings during compilation
-	_ui.CommandLinePathWidget->setEnabled(false);
-	_ui.CommandLineSettingsWidget->setEnabled(false);
+	//Print each file's output in one block so output from parallel jobs isn't interleaved
+	if (_maxParallelJobs > 1)
+	{
+		_outputModel->Append(job.Row, job.FileName, CompilerOutputType::Header);
 
-	_ui.Terminate->setEnabled(true);
+		for (const auto& line : job.Output)
+		{
+			_outputModel->Append(job.Row, line.Text, line.Type);
+		}
+	}
+
+	job.Output.clear();
+	job.Output.shrink_to_fit();
+}
+
+void CommandLineFrontEnd::CancelJobs()
+{
+	for (; _nextJob < _jobs.size(); ++_nextJob)
+	{
+		_jobs[_nextJob]->State = JobState::Cancelled;
+		UpdateJobSummary(*_jobs[_nextJob]);
+	}
+
+	for (auto& job : _jobs)
+	{
+		if (job->State == JobState::Running)
+		{
+			AppendJobOutput(*job, "\nCompilation cancelled\n", true);
+			job->Process->kill();
+			FinishJob(*job, JobState::Cancelled);
+		}
+	}
+}
+
+void CommandLineFrontEnd::AppendJobOutput(Job& job, const QString& text, bool isError)
+{
+	if (text.isEmpty())
+	{
+		return;
+	}
+
+	QString output = job.PartialLine + text;
+
+	output.remove('\r');
+
+	bool lineIsError = job.PartialLineIsError || isError;
+
+	int start = 0;
+
+	for (int end = output.indexOf('\n'); end != -1; start = end + 1, end = output.indexOf('\n', start))
+	{
+		AddJobLine(job, output.mid(start, end - start), lineIsError);
+		lineIsError = isError;
+	}
+
+	job.PartialLine = output.mid(start);
+	job.PartialLineIsError = lineIsError;
+}
+
+void CommandLineFrontEnd::AddJobLine(Job& job, const QString& line, bool isError)
+{
+	static const QRegularExpression warningExpression{"\\bwarning\\b", QRegularExpression::CaseInsensitiveOption};
+
+	auto type = isError ? CompilerOutputType::Error : CompilerOutputType::Regular;
+
+	if (warningExpression.match(line).hasMatch())
+	{
+		++job.WarningCount;
+
+		if (!isError)
+		{
+			type = CompilerOutputType::Warning;
+		}
+	}
 
-	_currentFile = 0;
+	//Only one job runs at a time so show its output as it comes in
+	if (_maxParallelJobs == 1)
+	{
+		_outputModel->Append(job.Row, line, type);
+	}
+	else
+	{
+		job.Output.push_back({line, type});
+	}
+}
+
+void CommandLineFrontEnd::UpdateJobSummary(const Job& job)
+{
+	QString status;
+
+	switch (job.State)
+	{
+	case JobState::Pending: status = "Pending"; break;
+	case JobState::Running: status = "Running"; break;
+	case JobState::Succeeded: status = "Succeeded"; break;
+	case JobState::UpToDate: status = "Up to date"; break;
+	case JobState::Failed: status = "Failed"; break;
+	case JobState::Cancelled: status = "Cancelled"; break;
+	}
 
-	StartNextCompilation();
+	const bool isFinished = job.State == JobState::Succeeded || job.State == JobState::Failed;
+
+	_ui.JobSummary->item(job.Row, 1)->setText(status);
+	_ui.JobSummary->item(job.Row, 2)->setText(isFinished ? QString::number(job.ExitCode) : QString{});
+	_ui.JobSummary->item(job.Row, 3)->setText(isFinished ? QString::number(job.WarningCount) : QString{});
+	_ui.JobSummary->item(job.Row, 4)->setText(job.State != JobState::Pending && job.State != JobState::Running
+		? QString{"%1 s"}.arg(job.ElapsedMilliseconds / 1000.0, 0, 'f', 2) : QString{});
+
+	if (job.State == JobState::Failed)
+	{
+		for (int column = 0; column < _ui.JobSummary->columnCount(); ++column)
+		{
+			_ui.JobSummary->item(job.Row, column)->setForeground(Qt::red);
+		}
+	}
 }
 
 void CommandLineFrontEnd::OnTerminate()
 {
-	_process->kill();
+	CancelJobs();
 }
 
 void CommandLineFrontEnd::OnClear()
 {
-	_ui.Output->clear();
+	_outputModel->Clear();
+}
+
+void CommandLineFrontEnd::OnOutputFilterChanged(int index)
+{
+	_outputFilterModel->SetSource(_ui.OutputFilter->itemData(index).toInt());
+	_ui.Output->scrollToBottom();
+}
+
+void CommandLineFrontEnd::OnCopyOutput()
+{
+	auto indices = _ui.Output->selectionModel()->selectedIndexes();
+
+	std::sort(indices.begin(), indices.end(), [](const auto& lhs, const auto& rhs) { return lhs.row() < rhs.row(); });
+
+	QStringList lines;
+
+	lines.reserve(indices.size());
+
+	for (const auto& index : indices)
+	{
+		lines.append(index.data().toString());
+	}
+
+	QApplication::clipboard()->setText(lines.join('\n'));
 }
 
-void CommandLineFrontEnd::ScrollOutputToBottom()
+void CommandLineFrontEnd::OnOpenFullLog()
 {
-	_ui.Output->verticalScrollBar()->setValue(_ui.Output->verticalScrollBar()->maximum());
+	_outputModel->Flush();
+	QDesktopServices::openUrl(QUrl::fromLocalFile(_outputModel->GetLogFileName()));
 }
 
-void CommandLineFrontEnd::AppendRegularText(const QString& text)
+void CommandLineFrontEnd::OnOutputRowsAboutToBeInserted()
 {
-	_ui.Output->append(text);
-	ScrollOutputToBottom();
+	//Only follow new output if the user hasn't scrolled up
+	const auto scrollBar = _ui.Output->verticalScrollBar();
+	_scrollOutputToBottom = scrollBar->value() == scrollBar->maximum();
 }
 
-void CommandLineFrontEnd::AppendErrorText(QString text)
+void CommandLineFrontEnd::OnOutputRowsInserted()
 {
-	//Convert newlines to HTML
-	text.replace("\n", "<br/>");
+	if (_scrollOutputToBottom)
+	{
+		_ui.Output->scrollToBottom();
+	}
+}
 
-	_ui.Output->insertHtml(QString{"<font color=\"red\">%1</font>"}.arg(text));
-	ScrollOutputToBottom();
+void CommandLineFrontEnd::AppendOutput(const QString& text, CompilerOutputType type)
+{
+	for (const auto& line : text.split('\n'))
+	{
+		_outputModel->Append(-1, line, type);
+	}
 }
 
 void CommandLineFrontEnd::Reset()
 {
-	_currentFile = -1;
+	_isCompiling = false;
+	_outputModel->Flush();
+	_outputModel->StopLog();
+	_ui.OpenFullLog->setEnabled(!_outputModel->GetLogFileName().isEmpty());
 	_ui.CommandLinePathWidget->setEnabled(true);
+	_ui.ParallelJobs->setEnabled(true);
+	_ui.StopOnFirstError->setEnabled(true);
 	UpdateCompileSettings();
+	_ui.Compile->setEnabled(_ui.Files->count() > 0);
 	_ui.Terminate->setEnabled(false);
 }
 
-void CommandLineFrontEnd::OnReadyReadOutput()
+void CommandLineFrontEnd::OnReadyReadOutput(Job& job)
 {
-	const QString output{_process->readAllStandardOutput()};
+	const QString output{job.Process->readAllStandardOutput()};
 
 	//Studiomdl's Error function doesn't use stderr so we have to detect error output manually
 	const int errorIndex = output.indexOf("************ ERROR ************");
 
 	if (errorIndex != -1)
 	{
-		_outputIsError = true;
-		AppendRegularText(output.left(errorIndex));
-		AppendErrorText(output.right(output.size() - errorIndex));
+		job.OutputIsError = true;
+		AppendJobOutput(job, output.left(errorIndex), false);
+		AppendJobOutput(job, output.right(output.size() - errorIndex), true);
 		return;
 	}
 
-	if (_outputIsError)
-	{
-		AppendErrorText(output);
-	}
-	else
-	{
-		AppendRegularText(output);
-	}
+	AppendJobOutput(job, output, job.OutputIsError);
 }
 
-void CommandLineFrontEnd::OnReadyReadError()
+void CommandLineFrontEnd::OnReadyReadError(Job& job)
 {
-	AppendErrorText(_process->readAllStandardError());
+	AppendJobOutput(job, job.Process->readAllStandardError(), true);
 }
 
-void CommandLineFrontEnd::OnErrorOccurred(QProcess::ProcessError error)
+void CommandLineFrontEnd::OnErrorOccurred(Job& job, QProcess::ProcessError error)
 {
-	Reset();
-
 	switch (error)
 	{
 	case QProcess::ProcessError::FailedToStart:
 	{
-		AppendErrorText("<br/>Process failed to start<br/>");
+		AppendJobOutput(job, "\nProcess failed to start\n", true);
 		break;
 	}
 	case QProcess::ProcessError::Crashed:
 	{
-		AppendErrorText("<br/>Process crashed<br/>");
-		break;
+		//Also happens when a job is cancelled, the finished signal reports the crash
+		return;
 	}
 
 	case QProcess::ProcessError::Timedout:
 	{
 		//Technically not a fatal error but since we don't use waitFor* methods it will be treated as such
-		AppendErrorText("<br/>Timed out<br/>");
+		AppendJobOutput(job, "\nTimed out\n", true);
 		break;
 	}
 
 	case QProcess::ProcessError::ReadError:
 	{
-		AppendErrorText("<br/>Read error<br/>");
+		AppendJobOutput(job, "\nRead error\n", true);
 		break;
 	}
 
 	case QProcess::ProcessError::WriteError:
 	{
-		AppendErrorText("<br/>Write error<br/>");
+		AppendJobOutput(job, "\nWrite error\n", true);
 		break;
 	}
 
 	case QProcess::ProcessError::UnknownError:
 	{
-		AppendErrorText("<br/>Unknown error<br/>");
+		AppendJobOutput(job, "\nUnknown error\n", true);
 		break;
 	}
 	}
 
 	//Kill the process if it's still running
-	if (_process->state() != QProcess::ProcessState::NotRunning)
+	if (job.Process->state() != QProcess::ProcessState::NotRunning)
 	{
-		_process->kill();
+		job.Process->kill();
 	}
+
+	job.ExitCode = -1;
+
+	FinishJob(job, JobState::Failed);
 }
 
-void CommandLineFrontEnd::OnCompilationFinished(int exitCode, QProcess::ExitStatus exitStatus)
+void CommandLineFrontEnd::OnCompilationFinished(Job& job, int exitCode, QProcess::ExitStatus exitStatus)
 {
-	//If this is true then an error occurred and we're wrapping up execution of the process without continuing
-	if (_currentFile == -1)
-	{
-		return;
-	}
-
 	switch (exitStatus)
 	{
 	case QProcess::ExitStatus::NormalExit:
 	{
-		AppendRegularText(QString{"<br/>The program exited normally with exit code %1<br/>"}.arg(exitCode));
+		AppendJobOutput(job, QString{"\nThe program exited normally with exit code %1\n"}.arg(exitCode), false);
 		break;
 	}
 
 	case QProcess::ExitStatus::CrashExit:
 	{
-		AppendRegularText("<br/>The program crashed<br/>");
+		AppendJobOutput(job, "\nThe program crashed\n", true);
 		break;
 	}
 	}
 
-	++_currentFile;
-
-	if (_currentFile >= _ui.Files->count())
-	{
-		Reset();
-		return;
-	}
+	job.ExitCode = exitCode;
 
-	StartNextCompilation();
+	//Studiomdl exits with a non-zero exit code on errors
+	FinishJob(job, exitStatus == QProcess::ExitStatus::NormalExit && exitCode == 0 && !job.OutputIsError ? JobState::Succeeded : JobState::Failed);
 }
 }
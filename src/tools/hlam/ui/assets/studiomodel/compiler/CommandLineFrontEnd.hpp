@@ -1,11 +1,18 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
+#include <QDateTime>
 #include <QDialog>
+#include <QElapsedTimer>
 #include <QProcess>
 #include <QStringList>
 
 #include "ui_CommandLineFrontEnd.h"
 
+#include "ui/assets/studiomodel/compiler/CompilerOutputModel.hpp"
+
 class QListWidgetItem;
 class QWidget;
 
@@ -34,18 +41,120 @@ protected:
 
 	virtual void GetArgumentsCore(QStringList& arguments) {}
 
+	/**
+	*	@brief Gets a key that identifies the output of compiling @p fileName with the given settings.
+	*	@return The key, or an empty string if the output can't be reused.
+	*/
+	virtual QString GetOutputCacheKey(const QString& fileName, const QString& workingDirectory, const QStringList& arguments)
+	{
+		return {};
+	}
+
+	/**
+	*	@brief Restores the output stored for @p cacheKey so the compilation can be skipped.
+	*	@param[out] restoredFiles Files that were restored.
+	*/
+	virtual bool TryRestoreOutput(const QString& cacheKey, QStringList& restoredFiles) { return false; }
+
+	/**
+	*	@brief Stores the output of a successful compilation that started at @p startTime.
+	*/
+	virtual void StoreOutput(const QString& fileName, const QString& workingDirectory, const QStringList& arguments,
+		const QString& cacheKey, const QDateTime& startTime) {}
+
 private:
+	enum class JobState
+	{
+		Pending,
+		Running,
+		Succeeded,
+		UpToDate,
+		Failed,
+		Cancelled
+	};
+
+	struct OutputLine
+	{
+		QString Text;
+		CompilerOutputType Type;
+	};
+
+	/**
+	*	@brief Compilation of a single input file, with its own process and output.
+	*/
+	struct Job
+	{
+		QString FileName;
+		QString WorkingDirectory;
+		QStringList Arguments;
+
+		QString CacheKey;
+		QDateTime StartTime;
+
+		//Row in the job summary table
+		int Row = 0;
+
+		JobState State = JobState::Pending;
+
+		QProcess* Process{};
+
+		QElapsedTimer Timer;
+		qint64 ElapsedMilliseconds = 0;
+
+		int ExitCode = 0;
+		int WarningCount = 0;
+
+		bool OutputIsError = false;
+
+		//Output can be split in the middle of a line
+		QString PartialLine;
+		bool PartialLineIsError = false;
+
+		//Complete lines that haven't been added to the output yet
+		std::vector<OutputLine> Output;
+	};
+
 	QStringList GetArguments();
 
-	void StartNextCompilation();
+	/**
+	*	@brief Starts pending jobs until the maximum number of parallel jobs is reached, and finishes up once all jobs are done.
+	*/
+	void StartPendingJobs();
 
-	void ScrollOutputToBottom();
+	void StartJob(Job& job);
 
-	void AppendRegularText(const QString& text);
-	void AppendErrorText(QString text);
+	void FinishJob(Job& job, JobState state);
+
+	/**
+	*	@brief Prints a job's output if it wasn't shown while the job was running.
+	*/
+	void PrintJobOutput(Job& job);
+
+	/**
+	*	@brief Kills all running jobs and cancels all pending jobs.
+	*/
+	void CancelJobs();
+
+	/**
+	*	@brief Adds output from a job. Lines are added to the output once they are complete.
+	*/
+	void AppendJobOutput(Job& job, const QString& text, bool isError);
+
+	void AddJobLine(Job& job, const QString& line, bool isError);
+
+	void UpdateJobSummary(const Job& job);
+
+	void AppendOutput(const QString& text, CompilerOutputType type);
 
 	void Reset();
 
+	void OnReadyReadOutput(Job& job);
+	void OnReadyReadError(Job& job);
+
+	void OnErrorOccurred(Job& job, QProcess::ProcessError error);
+
+	void OnCompilationFinished(Job& job, int exitCode, QProcess::ExitStatus exitStatus);
+
 protected slots:
 	void UpdateCompleteCommandLine();
 
@@ -65,12 +174,14 @@ private slots:
 	void OnTerminate();
 	void OnClear();
 
-	void OnReadyReadOutput();
-	void OnReadyReadError();
+	void OnOutputFilterChanged(int index);
+
+	void OnCopyOutput();
 
-	void OnErrorOccurred(QProcess::ProcessError error);
+	void OnOpenFullLog();
 
-	void OnCompilationFinished(int exitCode, QProcess::ExitStatus exitStatus);
+	void OnOutputRowsAboutToBeInserted();
+	void OnOutputRowsInserted();
 
 protected:
 	EditorContext* const _editorContext;
@@ -78,16 +189,27 @@ protected:
 private:
 	Ui_CommandLineFrontEnd _ui;
 
-	QProcess* const _process = new QProcess(this);
-
 	QString _programFilter;
 	QString _inputFileFilter;
 
 	QWidget* _settingsWidget{};
 
-	int _currentFile{-1};
+	CompilerOutputModel* const _outputModel;
+	CompilerOutputFilterModel* const _outputFilterModel;
+
+	bool _scrollOutputToBottom{false};
+
+	bool _isCompiling{false};
+
+	std::vector<std::unique_ptr<Job>> _jobs;
+	std::size_t _nextJob{0};
+	int _runningJobCount{0};
+
+	//Settings frozen for the duration of a compilation
+	int _maxParallelJobs{1};
+	bool _stopOnFirstError{false};
 
-	bool _outputIsError{false};
+	QElapsedTimer _compilationTimer;
 };
 }
 }
@@ -0,0 +1,283 @@
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include "ui/assets/studiomodel/compiler/CompilationCache.hpp"
+#include "ui/assets/studiomodel/compiler/QCDependencies.hpp"
+
+namespace ui::assets::studiomodel
+{
+namespace
+{
+const QString ManifestFileName{"manifest.txt"};
+
+//Increment this when the key or the layout of an entry changes to invalidate existing entries
+const QByteArray CacheVersion{"hlam-compilation-cache-1"};
+
+/**
+*	@brief Finds the models that studiomdl writes for a model: the model itself, the texture model and the sequence group models.
+*/
+QStringList FindModelFiles(const QString& modelFileName)
+{
+	const QFileInfo modelInfo{modelFileName};
+
+	const QString baseName = modelInfo.completeBaseName();
+
+	const QRegularExpression expression{
+		QString{"^%1(T|\\d\\d)?\\.mdl$"}.arg(QRegularExpression::escape(baseName)),
+		QRegularExpression::CaseInsensitiveOption};
+
+	QStringList fileNames;
+
+	const QDir directory{modelInfo.absolutePath()};
+
+	for (const auto& fileName : directory.entryList({baseName + "*.mdl"}, QDir::Files))
+	{
+		if (expression.match(fileName).hasMatch())
+		{
+			fileNames.append(directory.absoluteFilePath(fileName));
+		}
+	}
+
+	return fileNames;
+}
+}
+
+CompilationCache::CompilationCache(const QString& directory)
+	: _directory(directory)
+{
+}
+
+QString CompilationCache::ComputeKey(const QString& program, const QStringList& arguments, const QString& workingDirectory,
+	const QCDependencies& dependencies)
+{
+	if (!dependencies.MissingFiles.isEmpty() || dependencies.ModelFileName.isEmpty())
+	{
+		return {};
+	}
+
+	QCryptographicHash hash{QCryptographicHash::Sha256};
+
+	const auto addString = [&](const QString& value)
+	{
+		hash.addData(value.toUtf8());
+		//Separate strings so that different lists of strings can't produce the same data
+		hash.addData("\0", 1);
+	};
+
+	hash.addData(CacheVersion);
+
+	const QByteArray programHash = HashFile(program);
+
+	if (programHash.isEmpty())
+	{
+		return {};
+	}
+
+	addString(QFileInfo{program}.absoluteFilePath());
+	hash.addData(programHash);
+
+	for (const auto& argument : arguments)
+	{
+		addString(argument);
+	}
+
+	addString(QDir{workingDirectory}.absolutePath());
+	addString(dependencies.ModelFileName);
+
+	for (const auto& fileName : dependencies.InputFiles)
+	{
+		const QByteArray fileHash = HashFile(fileName);
+
+		if (fileHash.isEmpty())
+		{
+			return {};
+		}
+
+		addString(fileName);
+		hash.addData(fileHash);
+	}
+
+	return QString::fromLatin1(hash.result().toHex());
+}
+
+bool CompilationCache::TryRestore(const QString& key, QStringList& restoredFiles)
+{
+	restoredFiles.clear();
+
+	if (key.isEmpty())
+	{
+		return false;
+	}
+
+	const QDir entryDirectory{QDir{_directory}.absoluteFilePath(key)};
+
+	QFile manifest{entryDirectory.absoluteFilePath(ManifestFileName)};
+
+	if (!manifest.open(QFile::ReadOnly | QFile::Text))
+	{
+		return false;
+	}
+
+	QTextStream stream{&manifest};
+
+	stream.setCodec("UTF-8");
+
+	QString destination;
+
+	for (int index = 0; stream.readLineInto(&destination); ++index)
+	{
+		if (destination.isEmpty())
+		{
+			continue;
+		}
+
+		const QString source = entryDirectory.absoluteFilePath(QString::number(index) + ".mdl");
+
+		//QFile::copy doesn't overwrite existing files
+		QFile::remove(destination);
+
+		if (!QFile::copy(source, destination))
+		{
+			return false;
+		}
+
+		restoredFiles.append(destination);
+	}
+
+	return !restoredFiles.isEmpty();
+}
+
+bool CompilationCache::Store(const QString& key, const QCDependencies& dependencies, const QDateTime& startTime)
+{
+	if (key.isEmpty())
+	{
+		return false;
+	}
+
+	//Some filesystems only store modification times with a precision of 2 seconds
+	const QDateTime earliestTime = startTime.addSecs(-2);
+
+	QStringList modelFileNames;
+
+	for (const auto& fileName : FindModelFiles(dependencies.ModelFileName))
+	{
+		if (QFileInfo{fileName}.lastModified() >= earliestTime)
+		{
+			modelFileNames.append(fileName);
+		}
+	}
+
+	if (modelFileNames.isEmpty())
+	{
+		return false;
+	}
+
+	//Write the entry to a temporary directory first so incomplete entries are never used
+	QDir cacheDirectory{_directory};
+
+	const QString temporaryName = key + ".tmp";
+
+	if (!cacheDirectory.mkpath(temporaryName))
+	{
+		return false;
+	}
+
+	QDir temporaryDirectory{cacheDirectory.absoluteFilePath(temporaryName)};
+
+	QSaveFile manifest{temporaryDirectory.absoluteFilePath(ManifestFileName)};
+
+	if (!manifest.open(QFile::WriteOnly | QFile::Text))
+	{
+		temporaryDirectory.removeRecursively();
+		return false;
+	}
+
+	QTextStream stream{&manifest};
+
+	stream.setCodec("UTF-8");
+
+	for (int index = 0; index < modelFileNames.size(); ++index)
+	{
+		const QString destination = temporaryDirectory.absoluteFilePath(QString::number(index) + ".mdl");
+
+		QFile::remove(destination);
+
+		if (!QFile::copy(modelFileNames[index], destination))
+		{
+			manifest.cancelWriting();
+			temporaryDirectory.removeRecursively();
+			return false;
+		}
+
+		stream << modelFileNames[index] << '\n';
+	}
+
+	stream.flush();
+
+	if (!manifest.commit())
+	{
+		temporaryDirectory.removeRecursively();
+		return false;
+	}
+
+	//Replace any existing entry
+	QDir{cacheDirectory.absoluteFilePath(key)}.removeRecursively();
+
+	if (!cacheDirectory.rename(temporaryName, key))
+	{
+		temporaryDirectory.removeRecursively();
+		return false;
+	}
+
+	return true;
+}
+
+void CompilationCache::Clear()
+{
+	QDir{_directory}.removeRecursively();
+	_fileHashes.clear();
+}
+
+QByteArray CompilationCache::HashFile(const QString& fileName)
+{
+	const QFileInfo info{fileName};
+
+	if (!info.isFile())
+	{
+		return {};
+	}
+
+	const QString absoluteFileName = info.absoluteFilePath();
+
+	if (const auto it = _fileHashes.constFind(absoluteFileName);
+		it != _fileHashes.constEnd() && it->Size == info.size() && it->LastModified == info.lastModified())
+	{
+		return it->Hash;
+	}
+
+	QFile file{absoluteFileName};
+
+	if (!file.open(QFile::ReadOnly))
+	{
+		return {};
+	}
+
+	QCryptographicHash hash{QCryptographicHash::Sha256};
+
+	if (!hash.addData(&file))
+	{
+		return {};
+	}
+
+	const QByteArray result = hash.result();
+
+	_fileHashes.insert(absoluteFileName, FileHash{info.size(), info.lastModified(), result});
+
+	return result;
+}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+namespace ui::assets::studiomodel
+{
+struct QCDependencies;
+
+/**
+*	@brief Stores the models produced by compiling QC files, keyed by a hash of everything that affects the result.
+*	Compiling a QC file whose inputs haven't changed since it was last compiled can then be skipped by restoring the cached models.
+*
+*	<pre>
+*	The key is a hash of the compiler executable, the arguments, the working directory, the QC file's path,
+*	and the names and contents of all of the QC file's dependencies.
+*	Each entry is a directory named after the key, containing the models and a manifest that lists where each model goes.
+*	</pre>
+*/
+class CompilationCache final
+{
+public:
+	explicit CompilationCache(const QString& directory);
+
+	QString GetDirectory() const { return _directory; }
+
+	/**
+	*	@brief Computes the key for a compilation.
+	*	@return The key, or an empty string if the compilation can't be cached because not all of its inputs could be found.
+	*/
+	QString ComputeKey(const QString& program, const QStringList& arguments, const QString& workingDirectory,
+		const QCDependencies& dependencies);
+
+	/**
+	*	@brief Copies the models stored for the given key to where the compiler would have written them.
+	*	@param[out] restoredFiles Absolute paths of the restored models.
+	*	@return Whether an entry exists for the key and all of its models were restored.
+	*/
+	bool TryRestore(const QString& key, QStringList& restoredFiles);
+
+	/**
+	*	@brief Stores the models produced by a compilation that started at @p startTime.
+	*	Only models that were written after the compilation started are stored.
+	*	@return Whether any models were stored.
+	*/
+	bool Store(const QString& key, const QCDependencies& dependencies, const QDateTime& startTime);
+
+	/**
+	*	@brief Removes all entries from the cache.
+	*/
+	void Clear();
+
+private:
+	/**
+	*	@brief Hashes the contents of a file. Hashes are remembered until the file's size or modification time change.
+	*/
+	QByteArray HashFile(const QString& fileName);
+
+private:
+	const QString _directory;
+
+	struct FileHash
+	{
+		qint64 Size;
+		QDateTime LastModified;
+		QByteArray Hash;
+	};
+
+	QHash<QString, FileHash> _fileHashes;
+};
+}
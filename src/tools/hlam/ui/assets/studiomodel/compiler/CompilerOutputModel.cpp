@@ -0,0 +1,215 @@
+#include <QColor>
+#include <QFont>
+#include <QTimer>
+
+#include "ui/assets/studiomodel/compiler/CompilerOutputModel.hpp"
+
+namespace ui::assets::studiomodel
+{
+CompilerOutputModel::CompilerOutputModel(QObject* parent)
+	: QAbstractListModel(parent)
+	, _flushTimer(new QTimer(this))
+{
+	_flushTimer->setSingleShot(true);
+	_flushTimer->setInterval(CompilerOutputFlushInterval);
+
+	connect(_flushTimer, &QTimer::timeout, this, &CompilerOutputModel::Flush);
+}
+
+CompilerOutputModel::~CompilerOutputModel()
+{
+	StopLog();
+}
+
+int CompilerOutputModel::rowCount(const QModelIndex& parent) const
+{
+	if (parent.isValid())
+	{
+		return 0;
+	}
+
+	return static_cast<int>(_lineCount);
+}
+
+QVariant CompilerOutputModel::data(const QModelIndex& index, int role) const
+{
+	if (!index.isValid() || index.row() < 0 || static_cast<std::size_t>(index.row()) >= _lineCount)
+	{
+		return {};
+	}
+
+	const auto& line = GetLine(index.row());
+
+	switch (role)
+	{
+	case Qt::DisplayRole: return line.Text;
+
+	case Qt::ForegroundRole:
+	{
+		switch (line.Type)
+		{
+		case CompilerOutputType::Warning: return QColor{200, 120, 0};
+		case CompilerOutputType::Error: return QColor{Qt::red};
+		default: return {};
+		}
+	}
+
+	case Qt::FontRole:
+	{
+		if (line.Type == CompilerOutputType::Header)
+		{
+			QFont font;
+			font.setBold(true);
+			return font;
+		}
+
+		return {};
+	}
+
+	case SourceRole: return line.Source;
+	}
+
+	return {};
+}
+
+void CompilerOutputModel::Append(int source, const QString& text, CompilerOutputType type)
+{
+	if (_logStream)
+	{
+		*_logStream << text << '\n';
+	}
+
+	_pendingLines.push_back({text, source, type});
+
+	if (!_flushTimer->isActive())
+	{
+		_flushTimer->start();
+	}
+}
+
+void CompilerOutputModel::Flush()
+{
+	_flushTimer->stop();
+
+	if (_logStream)
+	{
+		_logStream->flush();
+	}
+
+	if (_pendingLines.empty())
+	{
+		return;
+	}
+
+	if (_lines.empty())
+	{
+		_lines.resize(MaxCompilerOutputLines);
+	}
+
+	//Lines that would be removed again in the same batch never need to be added
+	const std::size_t skippedCount = _pendingLines.size() > _lines.size() ? _pendingLines.size() - _lines.size() : 0;
+	const std::size_t addedCount = _pendingLines.size() - skippedCount;
+
+	//Remove the oldest lines to make room
+	if (const std::size_t available = _lines.size() - _lineCount; addedCount > available)
+	{
+		const std::size_t removedCount = addedCount - available;
+
+		beginRemoveRows({}, 0, static_cast<int>(removedCount) - 1);
+
+		for (std::size_t i = 0; i < removedCount; ++i)
+		{
+			//Free the memory used by the text now
+			_lines[(_firstLine + i) % _lines.size()] = {};
+		}
+
+		_firstLine = (_firstLine + removedCount) % _lines.size();
+		_lineCount -= removedCount;
+
+		endRemoveRows();
+	}
+
+	beginInsertRows({}, static_cast<int>(_lineCount), static_cast<int>(_lineCount + addedCount) - 1);
+
+	for (std::size_t i = skippedCount; i < _pendingLines.size(); ++i)
+	{
+		_lines[(_firstLine + _lineCount) % _lines.size()] = std::move(_pendingLines[i]);
+		++_lineCount;
+	}
+
+	endInsertRows();
+
+	_pendingLines.clear();
+}
+
+void CompilerOutputModel::Clear()
+{
+	_flushTimer->stop();
+
+	beginResetModel();
+
+	_lines.clear();
+	_lines.shrink_to_fit();
+	_firstLine = 0;
+	_lineCount = 0;
+
+	_pendingLines.clear();
+
+	endResetModel();
+
+	if (_logStream)
+	{
+		_logStream->flush();
+	}
+}
+
+bool CompilerOutputModel::StartLog(const QString& fileName)
+{
+	StopLog();
+
+	_logFile.setFileName(fileName);
+
+	if (fileName.isEmpty() || !_logFile.open(QFile::WriteOnly | QFile::Truncate | QFile::Text))
+	{
+		_logFile.setFileName({});
+		return false;
+	}
+
+	_logStream = std::make_unique<QTextStream>(&_logFile);
+	_logStream->setCodec("UTF-8");
+
+	return true;
+}
+
+void CompilerOutputModel::StopLog()
+{
+	if (_logStream)
+	{
+		_logStream->flush();
+		_logStream.reset();
+	}
+
+	_logFile.close();
+}
+
+void CompilerOutputFilterModel::SetSource(int source)
+{
+	if (_source == source)
+	{
+		return;
+	}
+
+	_source = source;
+	invalidateFilter();
+}
+
+bool CompilerOutputFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+	if (_source == -1)
+	{
+		return true;
+	}
+
+	return sourceModel()->index(sourceRow, 0, sourceParent).data(CompilerOutputModel::SourceRole).toInt() == _source;
+}
+}
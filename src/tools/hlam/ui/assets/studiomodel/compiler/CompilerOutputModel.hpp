@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <QAbstractListModel>
+#include <QFile>
+#include <QSortFilterProxyModel>
+#include <QString>
+#include <QTextStream>
+
+class QTimer;
+
+namespace ui::assets::studiomodel
+{
+/**
+*	@brief Maximum number of lines kept in memory. Older lines are only available in the log file.
+*/
+constexpr std::size_t MaxCompilerOutputLines = 100000;
+
+/**
+*	@brief Time in milliseconds between adding batches of lines to the model, about once per frame.
+*/
+constexpr int CompilerOutputFlushInterval = 16;
+
+enum class CompilerOutputType
+{
+	Regular,
+	Header,
+	Warning,
+	Error
+};
+
+/**
+*	@brief Bounded list of compiler output lines.
+*	Lines are added in batches to keep views responsive when a lot of output is produced,
+*	and are also written to a log file so the full output remains available.
+*/
+class CompilerOutputModel final : public QAbstractListModel
+{
+public:
+	/**
+	*	@brief Role that returns the source of a line, or -1 if it isn't associated with a source.
+	*/
+	static constexpr int SourceRole = Qt::UserRole;
+
+	explicit CompilerOutputModel(QObject* parent = nullptr);
+	~CompilerOutputModel();
+
+	int rowCount(const QModelIndex& parent = {}) const override;
+
+	QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+	/**
+	*	@brief Adds a line. The line is added to the model on the next flush.
+	*/
+	void Append(int source, const QString& text, CompilerOutputType type);
+
+	/**
+	*	@brief Adds all pending lines to the model.
+	*/
+	void Flush();
+
+	/**
+	*	@brief Removes all lines from the model. Lines already written to the log file are kept.
+	*/
+	void Clear();
+
+	/**
+	*	@brief Starts writing all lines to the given file.
+	*/
+	bool StartLog(const QString& fileName);
+
+	void StopLog();
+
+	QString GetLogFileName() const { return _logFile.fileName(); }
+
+private:
+	struct Line
+	{
+		QString Text;
+		int Source;
+		CompilerOutputType Type;
+	};
+
+	const Line& GetLine(int row) const
+	{
+		return _lines[(_firstLine + row) % _lines.size()];
+	}
+
+private:
+	QTimer* const _flushTimer;
+
+	//Ring buffer of lines, allocated when the first line is added
+	std::vector<Line> _lines;
+	std::size_t _firstLine{0};
+	std::size_t _lineCount{0};
+
+	std::vector<Line> _pendingLines;
+
+	QFile _logFile;
+	std::unique_ptr<QTextStream> _logStream;
+};
+
+/**
+*	@brief Filters compiler output to show the lines from a single source.
+*/
+class CompilerOutputFilterModel final : public QSortFilterProxyModel
+{
+public:
+	using QSortFilterProxyModel::QSortFilterProxyModel;
+
+	/**
+	*	@brief Sets the source to show, or -1 to show all lines.
+	*/
+	void SetSource(int source);
+
+protected:
+	bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+	int _source{-1};
+};
+}
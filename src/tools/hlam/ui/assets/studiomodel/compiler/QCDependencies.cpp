@@ -0,0 +1,460 @@
+#include <cstddef>
+#include <vector>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QTextStream>
+
+#include "ui/assets/studiomodel/compiler/QCDependencies.hpp"
+
+namespace ui::assets::studiomodel
+{
+namespace
+{
+//Guards against files that include themselves
+constexpr int MaxIncludeDepth = 16;
+
+struct Token
+{
+	QString Text;
+	int Line;
+};
+
+/**
+*	@brief Splits a QC file into tokens the same way studiomdl's script parser does.
+*/
+std::vector<Token> Tokenize(const QString& text)
+{
+	std::vector<Token> tokens;
+
+	int line = 1;
+
+	for (int i = 0; i < text.size();)
+	{
+		const QChar c = text[i];
+
+		if (c == '\n')
+		{
+			++line;
+			++i;
+			continue;
+		}
+
+		if (c.isSpace())
+		{
+			++i;
+			continue;
+		}
+
+		//Comments run until the end of the line
+		if (c == ';' || c == '#' || (c == '/' && i + 1 < text.size() && text[i + 1] == '/'))
+		{
+			while (i < text.size() && text[i] != '\n')
+			{
+				++i;
+			}
+
+			continue;
+		}
+
+		const int start = i;
+
+		if (c == '\"')
+		{
+			++i;
+
+			while (i < text.size() && text[i] != '\"')
+			{
+				if (text[i] == '\n')
+				{
+					++line;
+				}
+
+				++i;
+			}
+
+			tokens.push_back({text.mid(start + 1, i - start - 1), line});
+
+			//Skip the closing quote
+			++i;
+			continue;
+		}
+
+		while (i < text.size() && !text[i].isSpace())
+		{
+			++i;
+		}
+
+		tokens.push_back({text.mid(start, i - start), line});
+	}
+
+	return tokens;
+}
+
+bool IsMotionControl(const QString& token)
+{
+	static const QSet<QString> controls{
+		"X", "Y", "Z", "XR", "YR", "ZR",
+		"LX", "LY", "LZ", "AX", "AY", "AZ", "AXR", "AYR", "AZR"};
+
+	return controls.contains(token.toUpper());
+}
+
+class QCParser final
+{
+public:
+	QCParser(const QString& workingDirectory, QCDependencies& dependencies)
+		: _workingDirectory(workingDirectory)
+		, _dependencies(dependencies)
+		, _cdDirectory(workingDirectory)
+	{
+	}
+
+	void ParseFile(const QString& fileName, int depth)
+	{
+		QFile file{fileName};
+
+		if (depth > MaxIncludeDepth || !file.open(QFile::ReadOnly | QFile::Text))
+		{
+			_dependencies.MissingFiles.append(fileName);
+			return;
+		}
+
+		AddInputFile(fileName);
+
+		const auto tokens = Tokenize(QTextStream{&file}.readAll());
+
+		const QString directory = QFileInfo{fileName}.absolutePath();
+
+		for (std::size_t i = 0; i < tokens.size();)
+		{
+			const QString command = tokens[i].Text.toLower();
+			const int line = tokens[i].Line;
+
+			++i;
+
+			const auto nextOnLine = [&](QString& token)
+			{
+				if (i < tokens.size() && tokens[i].Line == line)
+				{
+					token = tokens[i++].Text;
+					return true;
+				}
+
+				return false;
+			};
+
+			QString argument;
+
+			if (command == "$include")
+			{
+				if (nextOnLine(argument))
+				{
+					//Try the directory of the including file first, then the working directory
+					const QString relativeToFile = QDir{directory}.absoluteFilePath(argument);
+
+					ParseFile(QFileInfo::exists(relativeToFile) ? relativeToFile : ResolvePath(argument), depth + 1);
+				}
+			}
+			else if (command == "$cd")
+			{
+				if (nextOnLine(argument))
+				{
+					_cdDirectory = ResolvePath(argument);
+				}
+			}
+			else if (command == "$cdtexture")
+			{
+				while (nextOnLine(argument))
+				{
+					_textureDirectories.append(ResolvePath(argument));
+				}
+			}
+			else if (command == "$modelname")
+			{
+				if (nextOnLine(argument))
+				{
+					_dependencies.ModelFileName = ResolvePath(argument);
+				}
+			}
+			else if (command == "$body")
+			{
+				//$body <name> <reference mesh>
+				if (nextOnLine(argument) && nextOnLine(argument))
+				{
+					AddMesh(argument, true);
+				}
+			}
+			else if (command == "$bodygroup")
+			{
+				//$bodygroup <name> { studio <reference mesh> ... blank }
+				i = ParseBlock(tokens, i, [&](const std::vector<Token>& blockTokens, std::size_t& index)
+					{
+						if (blockTokens[index].Text.compare("studio", Qt::CaseInsensitive) == 0 && index + 1 < blockTokens.size())
+						{
+							AddMesh(blockTokens[++index].Text, true);
+						}
+					});
+			}
+			else if (command == "$sequence")
+			{
+				i = ParseSequence(tokens, i, line);
+			}
+		}
+	}
+
+	/**
+	*	@brief Adds the textures used by reference meshes. Done after parsing so all texture directories are known.
+	*/
+	void AddTextures()
+	{
+		QStringList textureDirectories = _textureDirectories;
+
+		textureDirectories.append(_cdDirectory);
+
+		for (const auto& texture : _textures)
+		{
+			bool found = false;
+
+			for (const auto& textureDirectory : textureDirectories)
+			{
+				if (const QString fileName = QDir{textureDirectory}.absoluteFilePath(texture); QFileInfo::exists(fileName))
+				{
+					AddInputFile(fileName);
+					found = true;
+					break;
+				}
+			}
+
+			if (!found)
+			{
+				_dependencies.MissingFiles.append(texture);
+			}
+		}
+	}
+
+private:
+	QString ResolvePath(const QString& path) const
+	{
+		return QDir::cleanPath(QDir{_workingDirectory}.absoluteFilePath(path));
+	}
+
+	void AddInputFile(const QString& fileName)
+	{
+		const QString cleanFileName = QDir::cleanPath(fileName);
+
+		if (!_dependencies.InputFiles.contains(cleanFileName))
+		{
+			_dependencies.InputFiles.append(cleanFileName);
+		}
+	}
+
+	/**
+	*	@brief Skips a block enclosed in braces that starts at @p index, passing each token in it to @p callback.
+	*	@return Index of the token after the block, or @p index if there is no block.
+	*/
+	template<typename Callback>
+	std::size_t ParseBlock(const std::vector<Token>& tokens, std::size_t index, Callback&& callback)
+	{
+		//The block may start on the next line
+		if (index >= tokens.size() || tokens[index].Text != "{")
+		{
+			return index;
+		}
+
+		int depth = 0;
+
+		for (; index < tokens.size(); ++index)
+		{
+			if (tokens[index].Text == "{")
+			{
+				++depth;
+			}
+			else if (tokens[index].Text == "}")
+			{
+				if (--depth == 0)
+				{
+					return index + 1;
+				}
+			}
+			else
+			{
+				callback(tokens, index);
+			}
+		}
+
+		return index;
+	}
+
+	/**
+	*	@brief Parses the options of a $sequence command, which are all on the same line except for event blocks.
+	*	Anything that isn't an option is an animation file, like in studiomdl.
+	*/
+	std::size_t ParseSequence(const std::vector<Token>& tokens, std::size_t index, int line)
+	{
+		//Sequence name
+		if (index < tokens.size() && tokens[index].Line == line)
+		{
+			++index;
+		}
+
+		while (index < tokens.size())
+		{
+			const Token& token = tokens[index];
+
+			if (token.Text == "{")
+			{
+				index = ParseBlock(tokens, index, [](const auto&, std::size_t&) {});
+				//Options can continue on the line that the block ended on
+				line = tokens[index - 1].Line;
+				continue;
+			}
+
+			if (token.Line != line)
+			{
+				break;
+			}
+
+			++index;
+
+			const QString option = token.Text.toLower();
+
+			//Number of arguments that the option takes
+			int argumentCount = 0;
+
+			if (option == "fps" || option == "rotate" || option == "scale" || option == "node")
+			{
+				argumentCount = 1;
+			}
+			else if (option == "frame" || option == "transition" || option == "rtransition")
+			{
+				argumentCount = 2;
+			}
+			else if (option == "origin" || option == "blend" || option == "pivot")
+			{
+				argumentCount = 3;
+			}
+			else if (option == "animation")
+			{
+				if (index < tokens.size() && tokens[index].Line == line)
+				{
+					AddMesh(tokens[index++].Text, false);
+				}
+			}
+			else if (option.startsWith("act_"))
+			{
+				//Activity weight
+				argumentCount = 1;
+			}
+			else if (option == "loop" || option == "deform" || IsMotionControl(option))
+			{
+			}
+			else
+			{
+				AddMesh(token.Text, false);
+			}
+
+			for (; argumentCount > 0 && index < tokens.size() && tokens[index].Line == line; --argumentCount)
+			{
+				++index;
+			}
+		}
+
+		return index;
+	}
+
+	void AddMesh(QString name, bool isReference)
+	{
+		if (!name.endsWith(".smd", Qt::CaseInsensitive))
+		{
+			name += ".smd";
+		}
+
+		QString fileName = QDir::cleanPath(QDir{_cdDirectory}.absoluteFilePath(name));
+
+		if (!QFileInfo::exists(fileName))
+		{
+			_dependencies.MissingFiles.append(fileName);
+			return;
+		}
+
+		AddInputFile(fileName);
+
+		if (isReference)
+		{
+			AddMeshTextures(fileName);
+		}
+	}
+
+	/**
+	*	@brief Finds the textures used by the triangles in a mesh. Each triangle is a texture name followed by 3 vertices.
+	*/
+	void AddMeshTextures(const QString& fileName)
+	{
+		QFile file{fileName};
+
+		if (!file.open(QFile::ReadOnly | QFile::Text))
+		{
+			return;
+		}
+
+		QTextStream stream{&file};
+
+		bool inTriangles = false;
+		int lineInTriangle = 0;
+
+		QString line;
+
+		while (stream.readLineInto(&line))
+		{
+			const QString trimmed = line.trimmed();
+
+			if (!inTriangles)
+			{
+				inTriangles = trimmed.compare("triangles", Qt::CaseInsensitive) == 0;
+				continue;
+			}
+
+			if (lineInTriangle == 0)
+			{
+				if (trimmed.compare("end", Qt::CaseInsensitive) == 0)
+				{
+					inTriangles = false;
+					continue;
+				}
+
+				if (!_textures.contains(trimmed, Qt::CaseInsensitive))
+				{
+					_textures.append(trimmed);
+				}
+			}
+
+			lineInTriangle = (lineInTriangle + 1) % 4;
+		}
+	}
+
+private:
+	const QString _workingDirectory;
+	QCDependencies& _dependencies;
+
+	QString _cdDirectory;
+	QStringList _textureDirectories;
+
+	QStringList _textures;
+};
+}
+
+QCDependencies FindQCDependencies(const QString& fileName, const QString& workingDirectory)
+{
+	QCDependencies dependencies;
+
+	QCParser parser{QDir{workingDirectory}.absolutePath(), dependencies};
+
+	parser.ParseFile(QFileInfo{fileName}.absoluteFilePath(), 0);
+	parser.AddTextures();
+
+	return dependencies;
+}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+namespace ui::assets::studiomodel
+{
+/**
+*	@brief Files that a QC file is compiled from, and the name of the model it produces.
+*/
+struct QCDependencies
+{
+	/**
+	*	@brief Absolute paths of the QC file, included QC files, SMD files and textures, in the order in which they are referenced.
+	*/
+	QStringList InputFiles;
+
+	/**
+	*	@brief Absolute path of the model to produce, from $modelname.
+	*/
+	QString ModelFileName;
+
+	/**
+	*	@brief Files that are referenced but could not be found.
+	*	If this is not empty the compilation is going to fail or produce a different result depending on files that aren't tracked.
+	*/
+	QStringList MissingFiles;
+};
+
+/**
+*	@brief Finds the files that a QC file depends on the same way studiomdl does.
+*	Reference meshes are also scanned for the textures they use.
+*	@param fileName Name of the QC file.
+*	@param workingDirectory Directory that the compiler is run in. Relative paths in the QC file are relative to this directory.
+*/
+QCDependencies FindQCDependencies(const QString& fileName, const QString& workingDirectory);
+}
@@ -1,9 +1,11 @@
 #include <QSignalBlocker>
+#include <QStandardPaths>
 #include <QString>
 
 #include "ui/EditorContext.hpp"
 #include "ui/options/OptionsPageStudioModel.hpp"
 #include "ui/settings/StudioModelSettings.hpp"
+#include "ui/assets/studiomodel/compiler/QCDependencies.hpp"
 #include "ui/assets/studiomodel/compiler/StudioModelCompilerFrontEnd.hpp"
 
 namespace ui::assets::studiomodel
@@ -11,6 +13,7 @@ namespace ui::assets::studiomodel
 StudioModelCompilerFrontEnd::StudioModelCompilerFrontEnd(EditorContext* editorContext, settings::StudioModelSettings* studioModelSettings, QWidget* parent)
 	: CommandLineFrontEnd(editorContext, parent)
 	, _studioModelSettings(studioModelSettings)
+	, _compilationCache(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/compiler")
 {
 	_settingsWidget = new QWidget(this);
 	_settingsUi.setupUi(_settingsWidget);
@@ -32,6 +35,8 @@ StudioModelCompilerFrontEnd::StudioModelCompilerFrontEnd(EditorContext* editorCo
 	connect(_settingsUi.TextureReplacements, &QTableWidget::currentItemChanged, this, &StudioModelCompilerFrontEnd::OnCurrentTextureReplacementChanged);
 	connect(_settingsUi.TextureReplacements, &QTableWidget::cellChanged, this, &StudioModelCompilerFrontEnd::UpdateCompleteCommandLine);
 
+	connect(_settingsUi.ClearCompilationCache, &QPushButton::clicked, this, &StudioModelCompilerFrontEnd::OnClearCompilationCache);
+
 	SetProgram(_studioModelSettings->GetStudiomdlCompilerFileName(), options::StudioModelExeFilter);
 	SetInputFileFilter("QC Files (*.qc);;All Files (*.*)");
 	SetSettingsWidget(_settingsWidget);
@@ -101,6 +106,35 @@ void StudioModelCompilerFrontEnd::GetArgumentsCore(QStringList& arguments)
 	}
 }
 
+QString StudioModelCompilerFrontEnd::GetOutputCacheKey(const QString& fileName, const QString& workingDirectory, const QStringList& arguments)
+{
+	if (!_settingsUi.SkipUnchangedModels->isChecked())
+	{
+		return {};
+	}
+
+	return _compilationCache.ComputeKey(GetProgram(), arguments, workingDirectory, FindQCDependencies(fileName, workingDirectory));
+}
+
+bool StudioModelCompilerFrontEnd::TryRestoreOutput(const QString& cacheKey, QStringList& restoredFiles)
+{
+	return _compilationCache.TryRestore(cacheKey, restoredFiles);
+}
+
+void StudioModelCompilerFrontEnd::StoreOutput(const QString& fileName, const QString& workingDirectory, const QStringList& arguments,
+	const QString& cacheKey, const QDateTime& startTime)
+{
+	const auto dependencies = FindQCDependencies(fileName, workingDirectory);
+
+	//Don't store the output if the inputs were changed during compilation
+	if (_compilationCache.ComputeKey(GetProgram(), arguments, workingDirectory, dependencies) != cacheKey)
+	{
+		return;
+	}
+
+	_compilationCache.Store(cacheKey, dependencies, startTime);
+}
+
 void StudioModelCompilerFrontEnd::OnAddTextureReplacement()
 {
 	const int row = _settingsUi.TextureReplacements->rowCount();
@@ -134,4 +168,9 @@ void StudioModelCompilerFrontEnd::OnCurrentTextureReplacementChanged(QTableWidge
 	const QSignalBlocker blocker{_settingsUi.TextureReplacements};
 	_settingsUi.RemoveTextureReplacement->setEnabled(current != nullptr);
 }
+
+void StudioModelCompilerFrontEnd::OnClearCompilationCache()
+{
+	_compilationCache.Clear();
+}
 }
@@ -6,6 +6,7 @@
 #include "ui_StudioModelCompilerFrontEnd.h"
 
 #include "ui/assets/studiomodel/compiler/CommandLineFrontEnd.hpp"
+#include "ui/assets/studiomodel/compiler/CompilationCache.hpp"
 
 namespace ui
 {
@@ -25,17 +26,28 @@ public:
 protected:
 	void GetArgumentsCore(QStringList& arguments) override;
 
+	QString GetOutputCacheKey(const QString& fileName, const QString& workingDirectory, const QStringList& arguments) override;
+
+	bool TryRestoreOutput(const QString& cacheKey, QStringList& restoredFiles) override;
+
+	void StoreOutput(const QString& fileName, const QString& workingDirectory, const QStringList& arguments,
+		const QString& cacheKey, const QDateTime& startTime) override;
+
 private slots:
 	void OnAddTextureReplacement();
 	void OnRemoveTextureReplacement();
 
 	void OnCurrentTextureReplacementChanged(QTableWidgetItem* current);
 
+	void OnClearCompilationCache();
+
 private:
 	settings::StudioModelSettings* const _studioModelSettings;
 
 	QWidget* _settingsWidget;
 	Ui_StudioModelCompilerFrontEnd _settingsUi;
+
+	CompilationCache _compilationCache;
 };
 }
 }
@@ -1,4 +1,5 @@
 #include <QSignalBlocker>
+#include <QUndoStack>
 
 #include "entity/HLMVStudioModelEntity.hpp"
 
@@ -16,8 +17,10 @@ StudioModelModelInfoPanel::StudioModelModelInfoPanel(StudioModelAsset* asset, QW
 	_ui.setupUi(this);
 
 	connect(_asset, &StudioModelAsset::LoadSnapshot, this, &StudioModelModelInfoPanel::InitializeUI);
+	connect(_asset->GetUndoStack(), &QUndoStack::indexChanged, this, &StudioModelModelInfoPanel::UpdateUndoHistory);
 
 	InitializeUI();
+	UpdateUndoHistory();
 
 	//TODO: listen to changes made to the model to update values
 }
@@ -41,4 +44,13 @@ void StudioModelModelInfoPanel::InitializeUI()
 	_ui.AttachmentsValue->setText(QString::number(model->Attachments.size()));
 	_ui.TransitionsValue->setText(QString::number(model->Transitions.size()));
 }
+
+void StudioModelModelInfoPanel::UpdateUndoHistory()
+{
+	const auto undoStack = _asset->GetUndoStack();
+
+	_ui.UndoHistoryValue->setText(QString{"%1 steps, %2"}
+		.arg(undoStack->count())
+		.arg(_asset->GetUndoDeltaStore()->GetFootprintDescription()));
+}
 }
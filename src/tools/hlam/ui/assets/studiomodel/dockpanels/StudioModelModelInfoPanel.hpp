@@ -21,6 +21,8 @@ public:
 private slots:
 	void InitializeUI();
 
+	void UpdateUndoHistory();
+
 private:
 	Ui_StudioModelModelInfoPanel _ui;
 	StudioModelAsset* const _asset;
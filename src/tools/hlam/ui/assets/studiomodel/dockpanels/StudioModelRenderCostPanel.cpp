@@ -0,0 +1,68 @@
+#include <QFontDatabase>
+#include <QScrollBar>
+#include <QTimer>
+
+#include "engine/shared/studiomodel/StudioModelRenderCost.hpp"
+
+#include "entity/HLMVStudioModelEntity.hpp"
+
+#include "ui/StateSnapshot.hpp"
+
+#include "ui/assets/studiomodel/StudioModelAsset.hpp"
+#include "ui/assets/studiomodel/dockpanels/StudioModelRenderCostPanel.hpp"
+
+namespace ui::assets::studiomodel
+{
+constexpr int RenderCostUpdateDelay = 250;
+
+StudioModelRenderCostPanel::StudioModelRenderCostPanel(StudioModelAsset* asset, QWidget* parent)
+	: QWidget(parent)
+	, _asset(asset)
+	, _updateTimer(new QTimer(this))
+{
+	_ui.setupUi(this);
+
+	_ui.Report->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+	_updateTimer->setSingleShot(true);
+	_updateTimer->setInterval(RenderCostUpdateDelay);
+
+	connect(_updateTimer, &QTimer::timeout, this, &StudioModelRenderCostPanel::UpdateReport);
+	connect(_asset, &StudioModelAsset::LoadSnapshot, this, &StudioModelRenderCostPanel::UpdateReport);
+	connect(_asset, &StudioModelAsset::ModelChanged, this, &StudioModelRenderCostPanel::OnModelChanged);
+	connect(_ui.Refresh, &QPushButton::clicked, this, &StudioModelRenderCostPanel::UpdateReport);
+
+	UpdateReport();
+}
+
+StudioModelRenderCostPanel::~StudioModelRenderCostPanel() = default;
+
+void StudioModelRenderCostPanel::OnModelChanged(const ModelChangeEvent& event)
+{
+	_updateTimer->start();
+}
+
+void StudioModelRenderCostPanel::UpdateReport()
+{
+	_updateTimer->stop();
+
+	const auto model = _asset->GetScene()->GetEntity()->GetEditableModel();
+
+	const auto report = studiomdl::AnalyzeRenderCost(*model);
+
+	if (report.IsOverBudget())
+	{
+		_ui.Status->setText(QString{"<b>Over budget</b> (%1 problems)"}.arg(report.BudgetViolations.size()));
+	}
+	else
+	{
+		_ui.Status->setText("Within budget");
+	}
+
+	//Keep the scroll position so the report can be watched while editing
+	const int scrollPosition = _ui.Report->verticalScrollBar()->value();
+
+	_ui.Report->setPlainText(QString::fromStdString(studiomdl::FormatRenderCostReport(report)));
+	_ui.Report->verticalScrollBar()->setValue(scrollPosition);
+}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QWidget>
+
+#include "ui_StudioModelRenderCostPanel.h"
+
+class QTimer;
+
+namespace ui::assets::studiomodel
+{
+class ModelChangeEvent;
+class StudioModelAsset;
+
+/**
+*	@brief Shows what the model costs to render and which budgets it exceeds.
+*/
+class StudioModelRenderCostPanel final : public QWidget
+{
+public:
+	StudioModelRenderCostPanel(StudioModelAsset* asset, QWidget* parent = nullptr);
+	~StudioModelRenderCostPanel();
+
+private slots:
+	void OnModelChanged(const ModelChangeEvent& event);
+
+	void UpdateReport();
+
+private:
+	Ui_StudioModelRenderCostPanel _ui;
+	StudioModelAsset* const _asset;
+
+	//Edits often come in bursts, so the report is only updated once they stop
+	QTimer* const _updateTimer;
+};
+}
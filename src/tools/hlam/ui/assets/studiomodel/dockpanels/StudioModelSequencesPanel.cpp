@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <limits>
 
 #include "engine/shared/activity.hpp"
 
+#include "entity/Events.hpp"
+
 #include "entity/HLMVStudioModelEntity.hpp"
 
 #include "qt/ByteLengthValidator.hpp"
@@ -19,9 +22,12 @@ namespace ui::assets::studiomodel
 StudioModelSequencesPanel::StudioModelSequencesPanel(StudioModelAsset* asset, QWidget* parent)
 	: QWidget(parent)
 	, _asset(asset)
+	, _soundStatusTimer(new QTimer(this))
 {
 	_ui.setupUi(this);
 
+	_soundStatusTimer->setInterval(SoundPrefetchStatusInterval);
+
 	_ui.EventId->setRange(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
 	_ui.EventType->setRange(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
 
@@ -32,6 +38,8 @@ StudioModelSequencesPanel::StudioModelSequencesPanel(StudioModelAsset* asset, QW
 	connect(_asset, &StudioModelAsset::LoadSnapshot, this, &StudioModelSequencesPanel::OnLoadSnapshot);
 	connect(_asset, &StudioModelAsset::PoseChanged, this, &StudioModelSequencesPanel::OnPoseChanged);
 
+	connect(_soundStatusTimer, &QTimer::timeout, this, &StudioModelSequencesPanel::UpdateSoundStatus);
+
 	connect(_ui.SequenceComboBox, qOverload<int>(&QComboBox::currentIndexChanged), this, &StudioModelSequencesPanel::OnSequenceChanged);
 	connect(_ui.LoopingModeComboBox, qOverload<int>(&QComboBox::currentIndexChanged), this, &StudioModelSequencesPanel::OnLoopingModeChanged);
 
@@ -99,9 +107,14 @@ void StudioModelSequencesPanel::OnModelChanged(const ModelChangeEvent& event)
 	{
 		const auto& listChange = static_cast<const ModelListSubListChangeEvent&>(event);
 
-		if (listChange.GetSourceIndex() == _ui.SequenceComboBox->currentIndex() && listChange.GetSourceSubIndex() == _ui.EventsComboBox->currentIndex())
+		if (listChange.GetSourceIndex() == _ui.SequenceComboBox->currentIndex())
 		{
-			OnEventChanged(_ui.EventsComboBox->currentIndex());
+			if (listChange.GetSourceSubIndex() == _ui.EventsComboBox->currentIndex())
+			{
+				OnEventChanged(_ui.EventsComboBox->currentIndex());
+			}
+
+			PrefetchSequenceSounds();
 		}
 		break;
 	}
@@ -158,6 +171,8 @@ void StudioModelSequencesPanel::OnModelChanged(const ModelChangeEvent& event)
 				_ui.EventsComboBox->setEnabled(hasEvents);
 				_ui.RemoveEvent->setEnabled(hasEvents);
 			}
+
+			PrefetchSequenceSounds();
 		}
 		break;
 	}
@@ -314,6 +329,107 @@ void StudioModelSequencesPanel::UpdateBlendValue(int blender, BlendUpdateSource
 	entity->SetBlending(blender, spinner->value());
 }
 
+void StudioModelSequencesPanel::PrefetchSequenceSounds()
+{
+	_sequenceSounds.clear();
+
+	auto entity = _asset->GetScene()->GetEntity();
+
+	const auto soundSystem = _asset->GetScene()->GetEntityContext()->SoundSystem;
+
+	//Only load sounds if they're going to be played
+	if (_ui.PlaySound->isChecked() && soundSystem->IsSoundAvailable() && entity->GetSequence() != -1)
+	{
+		const auto& sequence = *entity->GetEditableModel()->Sequences[entity->GetSequence()];
+
+		for (const auto event : sequence.SortedEvents)
+		{
+			if (IsSoundEvent(event->EventId) && !event->Options.empty()
+				&& std::find(_sequenceSounds.begin(), _sequenceSounds.end(), event->Options) == _sequenceSounds.end())
+			{
+				_sequenceSounds.push_back(event->Options);
+			}
+		}
+
+		soundSystem->PrefetchSounds(_sequenceSounds);
+	}
+
+	UpdateSoundStatus();
+}
+
+void StudioModelSequencesPanel::UpdateSoundStatus()
+{
+	if (_sequenceSounds.empty())
+	{
+		_soundStatusTimer->stop();
+		_ui.SoundStatusLabel->clear();
+		_ui.SoundStatusLabel->setVisible(false);
+		return;
+	}
+
+	const auto soundSystem = _asset->GetScene()->GetEntityContext()->SoundSystem;
+
+	int loadedCount = 0;
+	bool isLoading = false;
+
+	QStringList missingSounds;
+	QStringList invalidSounds;
+
+	for (const auto& sound : _sequenceSounds)
+	{
+		switch (soundSystem->GetSoundLoadStatus(sound))
+		{
+		case soundsystem::SoundLoadStatus::Pending:
+			isLoading = true;
+			break;
+
+		case soundsystem::SoundLoadStatus::Loaded:
+			++loadedCount;
+			break;
+
+		case soundsystem::SoundLoadStatus::Missing:
+			missingSounds.append(QString::fromStdString(sound));
+			break;
+
+		case soundsystem::SoundLoadStatus::Failed:
+			invalidSounds.append(QString::fromStdString(sound));
+			break;
+
+		//Another model has prefetched its sounds since, these will be loaded when they're played
+		default: break;
+		}
+	}
+
+	QStringList lines;
+
+	lines.append(QString{isLoading ? "Loading sounds: %1/%2" : "Sounds loaded: %1/%2"}.arg(loadedCount).arg(_sequenceSounds.size()));
+
+	if (!missingSounds.isEmpty())
+	{
+		lines.append(QString{"Warning: missing sounds: %1"}.arg(missingSounds.join(", ")));
+	}
+
+	if (!invalidSounds.isEmpty())
+	{
+		lines.append(QString{"Warning: unsupported sounds: %1"}.arg(invalidSounds.join(", ")));
+	}
+
+	_ui.SoundStatusLabel->setText(lines.join('\n'));
+	_ui.SoundStatusLabel->setVisible(true);
+
+	if (isLoading)
+	{
+		if (!_soundStatusTimer->isActive())
+		{
+			_soundStatusTimer->start();
+		}
+	}
+	else
+	{
+		_soundStatusTimer->stop();
+	}
+}
+
 void StudioModelSequencesPanel::OnSequenceChanged(int index)
 {
 	auto entity = _asset->GetScene()->GetEntity();
@@ -388,6 +504,8 @@ void StudioModelSequencesPanel::OnSequenceChanged(int index)
 	_ui.RemoveEvent->setEnabled(hasEvents);
 
 	_ui.EventsWidget->setEnabled(index != -1);
+
+	PrefetchSequenceSounds();
 }
 
 void StudioModelSequencesPanel::OnLoopingModeChanged(int index)
@@ -462,6 +580,8 @@ void StudioModelSequencesPanel::OnEventChanged(int index)
 void StudioModelSequencesPanel::OnPlaySoundChanged()
 {
 	_asset->GetScene()->GetEntity()->PlaySound = _ui.PlaySound->isChecked();
+
+	PrefetchSequenceSounds();
 }
 
 void StudioModelSequencesPanel::OnPitchFramerateAmplitudeChanged()
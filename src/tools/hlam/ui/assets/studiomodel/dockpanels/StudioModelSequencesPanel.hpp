@@ -1,7 +1,11 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include <QSlider>
 #include <QSpinBox>
+#include <QTimer>
 #include <QWidget>
 
 #include "ui_StudioModelSequencesPanel.h"
@@ -20,6 +24,11 @@ namespace assets::studiomodel
 class ModelChangeEvent;
 class StudioModelAsset;
 
+/**
+*	@brief Interval in milliseconds at which the status of sounds being prefetched is checked.
+*/
+constexpr int SoundPrefetchStatusInterval = 100;
+
 class StudioModelSequencesPanel final : public QWidget
 {
 public:
@@ -39,6 +48,13 @@ private:
 
 	void UpdateBlendValue(int blender, BlendUpdateSource source, QSlider* slider, QDoubleSpinBox* spinner);
 
+	/**
+	*	@brief Starts loading the sounds played by the current sequence so they play on time the first time around.
+	*/
+	void PrefetchSequenceSounds();
+
+	void UpdateSoundStatus();
+
 private slots:
 	void OnModelChanged(const ModelChangeEvent& event);
 
@@ -77,6 +93,11 @@ private:
 	StudioModelAsset* const _asset;
 
 	double _blendsScales[SequenceBlendCount]{};
+
+	QTimer* const _soundStatusTimer;
+
+	//Sounds played by the current sequence, in the order in which they are played
+	std::vector<std::string> _sequenceSounds;
 };
 }
 }
@@ -295,6 +295,23 @@ void StudioModelTexturesPanel::OnModelChanged(const ModelChangeEvent& event)
 		}
 		break;
 	}
+
+	//Textures may have been added or removed, so rebuild the list
+	case ModelChangeId::OptimizeTextures:
+	{
+		const int index = _ui.Textures->currentIndex();
+
+		InitializeUI();
+
+		if (index < _ui.Textures->count())
+		{
+			_ui.Textures->setCurrentIndex(index);
+		}
+
+		//TODO: shouldn't be done here
+		RemapTextures();
+		break;
+	}
 	}
 }
 
@@ -39,6 +39,7 @@ OptionsPageGeneralWidget::OptionsPageGeneralWidget(
 	_ui.setupUi(this);
 
 	_ui.TickRate->setRange(settings::GeneralSettings::MinimumTickRate, settings::GeneralSettings::MaximumTickRate);
+	_ui.UndoMemoryBudget->setRange(settings::GeneralSettings::MinimumUndoMemoryBudget, settings::GeneralSettings::MaximumUndoMemoryBudget);
 
 	_ui.MouseSensitivitySlider->setRange(settings::GeneralSettings::MinimumMouseSensitivity, settings::GeneralSettings::MaximumMouseSensitivity);
 	_ui.MouseSensitivitySpinner->setRange(settings::GeneralSettings::MinimumMouseSensitivity, settings::GeneralSettings::MaximumMouseSensitivity);
@@ -50,6 +51,7 @@ OptionsPageGeneralWidget::OptionsPageGeneralWidget(
 	_ui.PauseAnimationsOnTimelineClick->setChecked(_generalSettings->PauseAnimationsOnTimelineClick);
 	_ui.MaxRecentFiles->setValue(_recentFilesSettings->GetMaxRecentFiles());
 	_ui.TickRate->setValue(_generalSettings->GetTickRate());
+	_ui.UndoMemoryBudget->setValue(_generalSettings->GetUndoMemoryBudget());
 	_ui.InvertMouseX->setChecked(_generalSettings->ShouldInvertMouseX());
 	_ui.InvertMouseY->setChecked(_generalSettings->ShouldInvertMouseY());
 	_ui.MouseSensitivitySlider->setValue(_generalSettings->GetMouseSensitivity());
@@ -73,6 +75,7 @@ void OptionsPageGeneralWidget::ApplyChanges(QSettings& settings)
 	_generalSettings->PauseAnimationsOnTimelineClick = _ui.PauseAnimationsOnTimelineClick->isChecked();
 	_recentFilesSettings->SetMaxRecentFiles(_ui.MaxRecentFiles->value());
 	_generalSettings->SetTickRate(_ui.TickRate->value());
+	_generalSettings->SetUndoMemoryBudget(_ui.UndoMemoryBudget->value());
 	_generalSettings->SetInvertMouseX(_ui.InvertMouseX->isChecked());
 	_generalSettings->SetInvertMouseY(_ui.InvertMouseY->isChecked());
 	_generalSettings->SetMouseSensitivity(_ui.MouseSensitivitySlider->value());
@@ -17,6 +17,11 @@ public:
 	static constexpr int MinimumTickRate{1};
 	static constexpr int MaximumTickRate{1000};
 
+	//In MiB
+	static constexpr int DefaultUndoMemoryBudget{64};
+	static constexpr int MinimumUndoMemoryBudget{1};
+	static constexpr int MaximumUndoMemoryBudget{4096};
+
 	static constexpr int DefaultMouseSensitivity{5};
 	static constexpr int MinimumMouseSensitivity{1};
 	static constexpr int MaximumMouseSensitivity{20};
@@ -45,6 +50,8 @@ public:
 		settings.beginGroup("general");
 		PauseAnimationsOnTimelineClick = settings.value("PauseAnimationsOnTimelineClick", DefaultPauseAnimationsOnTimelineClick).toBool();
 		_tickRate = std::clamp(settings.value("TickRate", DefaultTickRate).toInt(), MinimumTickRate, MaximumTickRate);
+		_undoMemoryBudget = std::clamp(
+			settings.value("UndoMemoryBudget", DefaultUndoMemoryBudget).toInt(), MinimumUndoMemoryBudget, MaximumUndoMemoryBudget);
 		settings.endGroup();
 
 		settings.beginGroup("mouse");
@@ -68,6 +75,7 @@ public:
 		settings.beginGroup("general");
 		settings.setValue("PauseAnimationsOnTimelineClick", PauseAnimationsOnTimelineClick);
 		settings.setValue("TickRate", _tickRate);
+		settings.setValue("UndoMemoryBudget", _undoMemoryBudget);
 		settings.endGroup();
 
 		settings.beginGroup("mouse");
@@ -100,6 +108,20 @@ public:
 		}
 	}
 
+	/**
+	*	@brief Amount of memory in MiB that each asset's undo history can use before older history is moved to disk.
+	*/
+	int GetUndoMemoryBudget() const { return _undoMemoryBudget; }
+
+	void SetUndoMemoryBudget(int value)
+	{
+		if (_undoMemoryBudget != value)
+		{
+			_undoMemoryBudget = value;
+			emit UndoMemoryBudgetChanged(_undoMemoryBudget);
+		}
+	}
+
 	bool ShouldInvertMouseX() const { return _invertMouseX; }
 
 	void SetInvertMouseX(bool value)
@@ -143,6 +165,8 @@ public:
 signals:
 	void TickRateChanged(int value);
 
+	void UndoMemoryBudgetChanged(int value);
+
 public:
 	bool PauseAnimationsOnTimelineClick{DefaultPauseAnimationsOnTimelineClick};
 
@@ -151,6 +175,8 @@ private:
 
 	int _tickRate{DefaultTickRate};
 
+	int _undoMemoryBudget{DefaultUndoMemoryBudget};
+
 	bool _invertMouseX{false};
 	bool _invertMouseY{false};
 
@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "utility/Inflate.hpp"
+
+namespace
+{
+constexpr int MaxCodeBits = 15;
+constexpr int MaxLiteralLengthCodes = 286;
+constexpr int MaxDistanceCodes = 30;
+constexpr int FixedLiteralLengthCodes = 288;
+
+constexpr std::array<std::uint16_t, 29> LengthBase{{
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258}};
+
+constexpr std::array<std::uint8_t, 29> LengthExtraBits{{
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0}};
+
+constexpr std::array<std::uint16_t, 30> DistanceBase{{
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577}};
+
+constexpr std::array<std::uint8_t, 30> DistanceExtraBits{{
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13}};
+
+constexpr std::array<std::uint8_t, 19> CodeLengthOrder{{16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15}};
+
+/**
+*	@brief Thrown internally when the compressed data is malformed
+*/
+struct InflateError
+{
+};
+
+/**
+*	@brief Canonical Huffman code, stored as the number of codes of each length and the symbols ordered by code
+*/
+struct HuffmanTable
+{
+	std::array<std::uint16_t, MaxCodeBits + 1> Counts{};
+	std::array<std::uint16_t, FixedLiteralLengthCodes> Symbols{};
+
+	/**
+	*	@brief Builds the table from a list of code lengths. Incomplete codes are allowed, over-subscribed codes are not.
+	*/
+	void Build(const std::uint8_t* lengths, int count)
+	{
+		Counts.fill(0);
+
+		for (int symbol = 0; symbol < count; ++symbol)
+		{
+			++Counts[lengths[symbol]];
+		}
+
+		if (Counts[0] == count)
+		{
+			//No codes; valid, but any attempt to decode will fail
+			return;
+		}
+
+		int left = 1;
+
+		for (int length = 1; length <= MaxCodeBits; ++length)
+		{
+			left <<= 1;
+			left -= Counts[length];
+
+			if (left < 0)
+			{
+				throw InflateError{};
+			}
+		}
+
+		std::array<std::uint16_t, MaxCodeBits + 1> offsets{};
+
+		for (int length = 1; length < MaxCodeBits; ++length)
+		{
+			offsets[length + 1] = offsets[length] + Counts[length];
+		}
+
+		for (int symbol = 0; symbol < count; ++symbol)
+		{
+			if (lengths[symbol] != 0)
+			{
+				Symbols[offsets[lengths[symbol]]++] = static_cast<std::uint16_t>(symbol);
+			}
+		}
+	}
+};
+
+class Inflater final
+{
+public:
+	Inflater(const std::byte* source, std::size_t sourceSize, std::byte* dest, std::size_t destSize)
+		: _source(source)
+		, _sourceSize(sourceSize)
+		, _dest(dest)
+		, _destSize(destSize)
+	{
+	}
+
+	void Run()
+	{
+		bool isLastBlock;
+
+		do
+		{
+			isLastBlock = GetBits(1) != 0;
+
+			switch (GetBits(2))
+			{
+			case 0: StoredBlock(); break;
+			case 1: FixedBlock(); break;
+			case 2: DynamicBlock(); break;
+			default: throw InflateError{};
+			}
+		}
+		while (!isLastBlock);
+
+		if (_destPosition != _destSize)
+		{
+			throw InflateError{};
+		}
+	}
+
+private:
+	int GetBits(int count)
+	{
+		std::uint32_t value = _bitBuffer;
+
+		while (_bitCount < count)
+		{
+			if (_sourcePosition >= _sourceSize)
+			{
+				throw InflateError{};
+			}
+
+			value |= static_cast<std::uint32_t>(_source[_sourcePosition++]) << _bitCount;
+			_bitCount += 8;
+		}
+
+		_bitBuffer = value >> count;
+		_bitCount -= count;
+
+		return static_cast<int>(value & ((1U << count) - 1));
+	}
+
+	int Decode(const HuffmanTable& table)
+	{
+		int code = 0;
+		int first = 0;
+		int index = 0;
+
+		for (int length = 1; length <= MaxCodeBits; ++length)
+		{
+			code |= GetBits(1);
+
+			const int count = table.Counts[length];
+
+			if (code - count < first)
+			{
+				return table.Symbols[index + (code - first)];
+			}
+
+			index += count;
+			first += count;
+			first <<= 1;
+			code <<= 1;
+		}
+
+		throw InflateError{};
+	}
+
+	void StoredBlock()
+	{
+		//Discard remaining bits in the current byte
+		_bitBuffer = 0;
+		_bitCount = 0;
+
+		if (_sourcePosition + 4 > _sourceSize)
+		{
+			throw InflateError{};
+		}
+
+		const unsigned int length = std::to_integer<unsigned int>(_source[_sourcePosition]) | (std::to_integer<unsigned int>(_source[_sourcePosition + 1]) << 8);
+		const unsigned int complement = std::to_integer<unsigned int>(_source[_sourcePosition + 2]) | (std::to_integer<unsigned int>(_source[_sourcePosition + 3]) << 8);
+
+		_sourcePosition += 4;
+
+		if (length != (~complement & 0xFFFF)
+			|| _sourcePosition + length > _sourceSize
+			|| _destPosition + length > _destSize)
+		{
+			throw InflateError{};
+		}
+
+		std::copy(_source + _sourcePosition, _source + _sourcePosition + length, _dest + _destPosition);
+
+		_sourcePosition += length;
+		_destPosition += length;
+	}
+
+	void Codes(const HuffmanTable& literalLengths, const HuffmanTable& distances)
+	{
+		for (int symbol = Decode(literalLengths); symbol != 256; symbol = Decode(literalLengths))
+		{
+			if (symbol < 256)
+			{
+				if (_destPosition >= _destSize)
+				{
+					throw InflateError{};
+				}
+
+				_dest[_destPosition++] = std::byte(symbol);
+				continue;
+			}
+
+			symbol -= 257;
+
+			if (symbol >= static_cast<int>(LengthBase.size()))
+			{
+				throw InflateError{};
+			}
+
+			const std::size_t length = LengthBase[symbol] + GetBits(LengthExtraBits[symbol]);
+
+			const int distanceSymbol = Decode(distances);
+
+			if (distanceSymbol >= static_cast<int>(DistanceBase.size()))
+			{
+				throw InflateError{};
+			}
+
+			const std::size_t distance = DistanceBase[distanceSymbol] + GetBits(DistanceExtraBits[distanceSymbol]);
+
+			if (distance > _destPosition || _destPosition + length > _destSize)
+			{
+				throw InflateError{};
+			}
+
+			//Byte by byte since the source and destination may overlap
+			for (std::size_t i = 0; i < length; ++i, ++_destPosition)
+			{
+				_dest[_destPosition] = _dest[_destPosition - distance];
+			}
+		}
+	}
+
+	void FixedBlock()
+	{
+		static const auto tables = []()
+		{
+			std::array<std::uint8_t, FixedLiteralLengthCodes> lengths{};
+
+			int symbol = 0;
+
+			for (; symbol < 144; ++symbol)
+			{
+				lengths[symbol] = 8;
+			}
+
+			for (; symbol < 256; ++symbol)
+			{
+				lengths[symbol] = 9;
+			}
+
+			for (; symbol < 280; ++symbol)
+			{
+				lengths[symbol] = 7;
+			}
+
+			for (; symbol < FixedLiteralLengthCodes; ++symbol)
+			{
+				lengths[symbol] = 8;
+			}
+
+			std::pair<HuffmanTable, HuffmanTable> result;
+
+			result.first.Build(lengths.data(), FixedLiteralLengthCodes);
+
+			lengths.fill(5);
+
+			result.second.Build(lengths.data(), MaxDistanceCodes);
+
+			return result;
+		}();
+
+		Codes(tables.first, tables.second);
+	}
+
+	void DynamicBlock()
+	{
+		const int literalLengthCount = GetBits(5) + 257;
+		const int distanceCount = GetBits(5) + 1;
+		const int codeLengthCount = GetBits(4) + 4;
+
+		if (literalLengthCount > MaxLiteralLengthCodes || distanceCount > MaxDistanceCodes)
+		{
+			throw InflateError{};
+		}
+
+		std::array<std::uint8_t, MaxLiteralLengthCodes + MaxDistanceCodes> lengths{};
+
+		for (int i = 0; i < codeLengthCount; ++i)
+		{
+			lengths[CodeLengthOrder[i]] = static_cast<std::uint8_t>(GetBits(3));
+		}
+
+		HuffmanTable codeLengths;
+
+		codeLengths.Build(lengths.data(), static_cast<int>(CodeLengthOrder.size()));
+
+		for (int index = 0; index < literalLengthCount + distanceCount;)
+		{
+			const int symbol = Decode(codeLengths);
+
+			if (symbol < 16)
+			{
+				lengths[index++] = static_cast<std::uint8_t>(symbol);
+				continue;
+			}
+
+			std::uint8_t length = 0;
+			int repeat;
+
+			switch (symbol)
+			{
+			case 16:
+				if (index == 0)
+				{
+					throw InflateError{};
+				}
+
+				length = lengths[index - 1];
+				repeat = 3 + GetBits(2);
+				break;
+
+			case 17:
+				repeat = 3 + GetBits(3);
+				break;
+
+			default:
+				repeat = 11 + GetBits(7);
+				break;
+			}
+
+			if (index + repeat > literalLengthCount + distanceCount)
+			{
+				throw InflateError{};
+			}
+
+			while (repeat-- > 0)
+			{
+				lengths[index++] = length;
+			}
+		}
+
+		//The end of block code must exist
+		if (lengths[256] == 0)
+		{
+			throw InflateError{};
+		}
+
+		HuffmanTable literalLengths;
+		HuffmanTable distances;
+
+		literalLengths.Build(lengths.data(), literalLengthCount);
+		distances.Build(lengths.data() + literalLengthCount, distanceCount);
+
+		Codes(literalLengths, distances);
+	}
+
+private:
+	const std::byte* const _source;
+	const std::size_t _sourceSize;
+	std::size_t _sourcePosition = 0;
+
+	std::byte* const _dest;
+	const std::size_t _destSize;
+	std::size_t _destPosition = 0;
+
+	std::uint32_t _bitBuffer = 0;
+	int _bitCount = 0;
+};
+}
+
+bool Inflate(const std::byte* source, std::size_t sourceSize, std::byte* dest, std::size_t destSize)
+{
+	try
+	{
+		Inflater inflater{source, sourceSize, dest, destSize};
+		inflater.Run();
+		return true;
+	}
+	catch (const InflateError&)
+	{
+		return false;
+	}
+}
+
+std::uint32_t ComputeCrc32(const std::byte* data, std::size_t size)
+{
+	static const auto table = []()
+	{
+		std::array<std::uint32_t, 256> result{};
+
+		for (std::uint32_t i = 0; i < result.size(); ++i)
+		{
+			std::uint32_t value = i;
+
+			for (int bit = 0; bit < 8; ++bit)
+			{
+				value = (value & 1) ? (0xEDB88320U ^ (value >> 1)) : (value >> 1);
+			}
+
+			result[i] = value;
+		}
+
+		return result;
+	}();
+
+	std::uint32_t crc = 0xFFFFFFFFU;
+
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		crc = table[(crc ^ std::to_integer<std::uint32_t>(data[i])) & 0xFF] ^ (crc >> 8);
+	}
+
+	return crc ^ 0xFFFFFFFFU;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+*	@brief Decompresses raw DEFLATE data (RFC 1951) into a buffer whose size is known in advance,
+*	as is the case for zip archive entries.
+*	@param source Compressed data.
+*	@param sourceSize Size of the compressed data, in bytes.
+*	@param dest Buffer to decompress into.
+*	@param destSize Expected size of the decompressed data, in bytes.
+*	@return true if the data was valid and decompressed to exactly @p destSize bytes, false otherwise.
+*/
+bool Inflate(const std::byte* source, std::size_t sourceSize, std::byte* dest, std::size_t destSize);
+
+/**
+*	@brief Computes the CRC-32 checksum used by zip archives.
+*/
+std::uint32_t ComputeCrc32(const std::byte* data, std::size_t size);
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#include "utility/JsonWriter.hpp"
+
+namespace
+{
+//Large enough for any integer or shortest round trip float
+constexpr std::size_t MaxNumberLength = 32;
+
+constexpr char HexDigits[] = "0123456789abcdef";
+}
+
+JsonWriter::JsonWriter(FILE* file, std::size_t bufferSize)
+	: _file(file)
+{
+	_buffer.resize(std::max<std::size_t>(bufferSize, MaxNumberLength));
+}
+
+JsonWriter::~JsonWriter()
+{
+	Flush();
+}
+
+void JsonWriter::Clear()
+{
+	_size = 0;
+	_needsComma = false;
+	_afterKey = false;
+}
+
+bool JsonWriter::Flush()
+{
+	if (!_file || _size == 0)
+	{
+		return true;
+	}
+
+	const bool success = std::fwrite(_buffer.data(), 1, _size, _file) == _size;
+
+	_size = 0;
+
+	return success;
+}
+
+void JsonWriter::BeginObject()
+{
+	BeginValue();
+	Append('{');
+	_needsComma = false;
+}
+
+void JsonWriter::EndObject()
+{
+	Append('}');
+	_needsComma = true;
+}
+
+void JsonWriter::BeginArray()
+{
+	BeginValue();
+	Append('[');
+	_needsComma = false;
+}
+
+void JsonWriter::EndArray()
+{
+	Append(']');
+	_needsComma = true;
+}
+
+void JsonWriter::Key(std::string_view key)
+{
+	String(key);
+	Append(':');
+	_afterKey = true;
+}
+
+void JsonWriter::String(std::string_view value)
+{
+	BeginValue();
+
+	//Worst case every character is escaped as \u00XX
+	char* const start = Reserve(2 + (value.size() * 6));
+	char* out = start;
+
+	*out++ = '"';
+
+	for (const char c : value)
+	{
+		const auto byte = static_cast<unsigned char>(c);
+
+		switch (c)
+		{
+		case '"': *out++ = '\\'; *out++ = '"'; break;
+		case '\\': *out++ = '\\'; *out++ = '\\'; break;
+		case '\n': *out++ = '\\'; *out++ = 'n'; break;
+		case '\r': *out++ = '\\'; *out++ = 'r'; break;
+		case '\t': *out++ = '\\'; *out++ = 't'; break;
+
+		default:
+		{
+			//Names in model files are not UTF8; bytes outside of ASCII are treated as Latin-1 so the output is always valid
+			if (byte < 0x20 || byte >= 0x80)
+			{
+				*out++ = '\\';
+				*out++ = 'u';
+				*out++ = '0';
+				*out++ = '0';
+				*out++ = HexDigits[byte >> 4];
+				*out++ = HexDigits[byte & 0xF];
+			}
+			else
+			{
+				*out++ = c;
+			}
+			break;
+		}
+		}
+	}
+
+	*out++ = '"';
+
+	_size += out - start;
+}
+
+void JsonWriter::Int(long long value)
+{
+	BeginValue();
+
+	char* const start = Reserve(MaxNumberLength);
+
+	_size += std::to_chars(start, start + MaxNumberLength, value).ptr - start;
+}
+
+void JsonWriter::Float(float value)
+{
+	if (!std::isfinite(value))
+	{
+		Null();
+		return;
+	}
+
+	BeginValue();
+
+	char* const start = Reserve(MaxNumberLength);
+
+	_size += std::to_chars(start, start + MaxNumberLength, value).ptr - start;
+}
+
+void JsonWriter::Bool(bool value)
+{
+	BeginValue();
+	Append(value ? std::string_view{"true"} : std::string_view{"false"});
+}
+
+void JsonWriter::Null()
+{
+	BeginValue();
+	Append(std::string_view{"null"});
+}
+
+void JsonWriter::Raw(std::string_view text)
+{
+	Append(text);
+	_needsComma = false;
+	_afterKey = false;
+}
+
+std::size_t JsonWriter::CharArrayLength(const char* value, std::size_t size)
+{
+	const auto end = static_cast<const char*>(std::memchr(value, '\0', size));
+
+	return end ? end - value : size;
+}
+
+void JsonWriter::BeginValue()
+{
+	if (_afterKey)
+	{
+		_afterKey = false;
+	}
+	else if (_needsComma)
+	{
+		Append(',');
+	}
+
+	_needsComma = true;
+}
+
+char* JsonWriter::Reserve(std::size_t size)
+{
+	if (_size + size > _buffer.size())
+	{
+		//Write out what we have if possible, otherwise grow the buffer to fit
+		Flush();
+
+		if (_size + size > _buffer.size())
+		{
+			_buffer.resize(std::max(_buffer.size() * 2, _size + size));
+		}
+	}
+
+	return _buffer.data() + _size;
+}
+
+void JsonWriter::Append(std::string_view text)
+{
+	std::memcpy(Reserve(text.size()), text.data(), text.size());
+	_size += text.size();
+}
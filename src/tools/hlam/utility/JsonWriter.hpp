@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+/**
+*	@brief Writes compact JSON into a reusable buffer.
+*	Values are formatted directly into the buffer, so writing does not allocate once the buffer has grown large enough.
+*	Commas are inserted automatically; the caller is responsible for balancing objects and arrays.
+*/
+class JsonWriter final
+{
+public:
+	static constexpr std::size_t DefaultBufferSize = 64 * 1024;
+
+	/**
+	*	@param file If not null, the buffer is written to this file whenever it fills up and when Flush is called.
+	*/
+	explicit JsonWriter(FILE* file = nullptr, std::size_t bufferSize = DefaultBufferSize);
+	~JsonWriter();
+
+	JsonWriter(const JsonWriter&) = delete;
+	JsonWriter& operator=(const JsonWriter&) = delete;
+
+	std::string_view GetData() const { return {_buffer.data(), _size}; }
+
+	/**
+	*	@brief Discards the buffered output and starts a new document.
+	*/
+	void Clear();
+
+	/**
+	*	@brief Writes buffered output to the file, if any.
+	*	@return Whether all output was written.
+	*/
+	bool Flush();
+
+	void BeginObject();
+	void EndObject();
+
+	void BeginArray();
+	void EndArray();
+
+	void Key(std::string_view key);
+
+	void String(std::string_view value);
+
+	/**
+	*	@brief Writes a fixed size character array from a file format structure, which is not always null terminated.
+	*/
+	template<std::size_t Size>
+	void String(const char (&value)[Size])
+	{
+		String(std::string_view{value, CharArrayLength(value, Size)});
+	}
+
+	void Int(long long value);
+
+	/**
+	*	@brief Writes the shortest representation that reads back as the same value. Infinity and NaN are written as null.
+	*/
+	void Float(float value);
+
+	void Bool(bool value);
+
+	void Null();
+
+	/**
+	*	@brief Writes text as-is, for example to separate documents. Resets the comma state.
+	*/
+	void Raw(std::string_view text);
+
+	template<typename T>
+	void Field(std::string_view key, const T& value)
+	{
+		Key(key);
+		Write(value);
+	}
+
+	template<typename T>
+	void FloatArray(const T* values, std::size_t count)
+	{
+		BeginArray();
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			Float(values[i]);
+		}
+
+		EndArray();
+	}
+
+	template<typename T>
+	void IntArray(const T* values, std::size_t count)
+	{
+		BeginArray();
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			Int(values[i]);
+		}
+
+		EndArray();
+	}
+
+private:
+	static std::size_t CharArrayLength(const char* value, std::size_t size);
+
+	void Write(bool value) { Bool(value); }
+	void Write(int value) { Int(value); }
+	void Write(float value) { Float(value); }
+	void Write(std::string_view value) { String(value); }
+
+	template<std::size_t Size>
+	void Write(const char (&value)[Size]) { String(value); }
+
+	void BeginValue();
+
+	char* Reserve(std::size_t size);
+
+	void Append(std::string_view text);
+
+	void Append(char c)
+	{
+		*Reserve(1) = c;
+		++_size;
+	}
+
+private:
+	FILE* const _file;
+
+	std::vector<char> _buffer;
+	std::size_t _size = 0;
+
+	//Whether the next value in the current object or array needs a comma
+	bool _needsComma = false;
+	bool _afterKey = false;
+};
@@ -0,0 +1,129 @@
+#include <codecvt>
+#include <locale>
+#include <string>
+
+#include "utility/MemoryMappedFile.hpp"
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+#ifdef WIN32
+	if (_data)
+	{
+		UnmapViewOfFile(_data);
+	}
+
+	if (_mappingHandle)
+	{
+		CloseHandle(_mappingHandle);
+	}
+#else
+	if (_data)
+	{
+		munmap(const_cast<std::byte*>(_data), _size);
+	}
+#endif
+}
+
+std::shared_ptr<MemoryMappedFile> MemoryMappedFile::TryMap(const char* fileName)
+{
+	//Can't use make_shared with a private constructor
+	std::shared_ptr<MemoryMappedFile> file{new MemoryMappedFile()};
+
+#ifdef WIN32
+	std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> convert;
+
+	const auto wideFileName = convert.from_bytes(fileName);
+
+	const HANDLE fileHandle = CreateFileW(wideFileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return {};
+	}
+
+	LARGE_INTEGER size{};
+
+	if (!GetFileSizeEx(fileHandle, &size))
+	{
+		CloseHandle(fileHandle);
+		return {};
+	}
+
+	file->_size = static_cast<std::size_t>(size.QuadPart);
+
+	//Empty files can't be mapped, but are still valid files
+	if (file->_size > 0)
+	{
+		file->_mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		//The mapping keeps its own reference to the file
+		CloseHandle(fileHandle);
+
+		if (!file->_mappingHandle)
+		{
+			return {};
+		}
+
+		file->_data = static_cast<const std::byte*>(MapViewOfFile(file->_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+
+		if (!file->_data)
+		{
+			return {};
+		}
+	}
+	else
+	{
+		CloseHandle(fileHandle);
+	}
+#else
+	const int fileDescriptor = open(fileName, O_RDONLY);
+
+	if (fileDescriptor == -1)
+	{
+		return {};
+	}
+
+	struct stat info{};
+
+	if (fstat(fileDescriptor, &info) == -1 || !S_ISREG(info.st_mode))
+	{
+		close(fileDescriptor);
+		return {};
+	}
+
+	file->_size = static_cast<std::size_t>(info.st_size);
+
+	//Empty files can't be mapped, but are still valid files
+	if (file->_size > 0)
+	{
+		void* data = mmap(nullptr, file->_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+		//The mapping keeps its own reference to the file
+		close(fileDescriptor);
+
+		if (data == MAP_FAILED)
+		{
+			file->_size = 0;
+			return {};
+		}
+
+		file->_data = static_cast<const std::byte*>(data);
+	}
+	else
+	{
+		close(fileDescriptor);
+	}
+#endif
+
+	return file;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+/**
+*	@brief Read-only memory mapping of an entire file.
+*	The mapping stays valid for as long as this object exists.
+*/
+class MemoryMappedFile final
+{
+private:
+	MemoryMappedFile() = default;
+
+public:
+	~MemoryMappedFile();
+	MemoryMappedFile(const MemoryMappedFile&) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+	/**
+	*	@brief Maps the given file into memory.
+	*	@param fileName UTF8 encoded name of the file to map.
+	*	@return The mapped file, or nullptr if the file could not be opened or mapped.
+	*/
+	static std::shared_ptr<MemoryMappedFile> TryMap(const char* fileName);
+
+	const std::byte* GetData() const { return _data; }
+
+	std::size_t GetSize() const { return _size; }
+
+private:
+	const std::byte* _data{};
+	std::size_t _size{};
+
+#ifdef WIN32
+	void* _mappingHandle{};
+#endif
+};
@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "utility/Parallel.hpp"
+
+void RunInParallel(std::size_t count, const std::function<void(std::size_t)>& task, std::size_t maximumThreadCount)
+{
+	std::atomic<std::size_t> nextIndex{0};
+
+	std::mutex exceptionMutex;
+	std::exception_ptr exception;
+
+	const auto worker = [&]()
+	{
+		for (std::size_t index; (index = nextIndex++) < count;)
+		{
+			try
+			{
+				task(index);
+			}
+			catch (...)
+			{
+				std::lock_guard lock{exceptionMutex};
+
+				if (!exception)
+				{
+					exception = std::current_exception();
+				}
+			}
+		}
+	};
+
+	if (maximumThreadCount == 0)
+	{
+		maximumThreadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	const std::size_t threadCount = std::min(count, maximumThreadCount);
+
+	std::vector<std::thread> threads;
+
+	//The calling thread is also a worker
+	for (std::size_t i = 1; i < threadCount; ++i)
+	{
+		threads.emplace_back(worker);
+	}
+
+	worker();
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
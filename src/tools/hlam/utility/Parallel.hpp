@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+/**
+*	@brief Runs @p task for every index in [0, count) on as many threads as there are cores.
+*	The calling thread is also used to run tasks.
+*	The first exception thrown by a task is rethrown once all threads have finished.
+*	@param maximumThreadCount If not 0, no more than this many threads are used.
+*/
+void RunInParallel(std::size_t count, const std::function<void(std::size_t)>& task, std::size_t maximumThreadCount = 0);